@@ -0,0 +1,63 @@
+/**
+ * @brief Benchmarks the hash function, that places paths into buckets, against `std::hash`.
+ *
+ * Paths are mostly short, so the keys are a few bytes to a few hundred bytes long.
+ * Every iteration hashes a batch of different random keys of the same length,
+ * so that the results aren't dominated by a single cached key.
+ */
+#include <functional>  // `std::hash`
+#include <random>      // `std::mt19937`
+#include <string>      // `std::string`
+#include <string_view> // `std::string_view`
+#include <vector>      // `std::vector`
+
+#include <benchmark/benchmark.h>
+
+#include "helpers/hash.hpp"
+
+namespace bm = benchmark;
+using namespace unum::ukv;
+
+static constexpr std::size_t keys_count_k = 4096;
+
+static std::vector<std::string> make_keys(std::size_t length) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> printable('!', '~');
+    std::vector<std::string> keys(keys_count_k);
+    for (std::string& key : keys) {
+        key.resize(length);
+        for (char& c : key)
+            c = static_cast<char>(printable(generator));
+    }
+    return keys;
+}
+
+template <typename hash_at>
+static void hash_keys(bm::State& state, hash_at&& hash) {
+    std::vector<std::string> const keys = make_keys(static_cast<std::size_t>(state.range(0)));
+    std::uint64_t checksum = 0;
+    for (auto _ : state)
+        for (std::string const& key : keys)
+            checksum ^= hash(std::string_view(key));
+    bm::DoNotOptimize(checksum);
+    state.SetItemsProcessed(state.iterations() * keys_count_k);
+    state.SetBytesProcessed(state.iterations() * keys_count_k * state.range(0));
+}
+
+static void hash_std(bm::State& state) {
+    hash_keys(state, std::hash<std::string_view> {});
+}
+
+static void hash_stable(bm::State& state) {
+    hash_keys(state, [](std::string_view key) { return stable_hash(key.data(), key.size(), 0); });
+}
+
+int main(int argc, char** argv) {
+    bm::Initialize(&argc, argv);
+    for (auto benchmark : {bm::RegisterBenchmark("hash_std", &hash_std),
+                           bm::RegisterBenchmark("hash_stable", &hash_stable)})
+        benchmark->Arg(3)->Arg(8)->Arg(16)->Arg(24)->Arg(32)->Arg(64)->Arg(256);
+    bm::RunSpecifiedBenchmarks();
+    bm::Shutdown();
+    return 0;
+}
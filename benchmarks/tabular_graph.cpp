@@ -1,21 +1,115 @@
 /**
  * @file tabular_graph.cpp
- * @brief Imports a big Parquet/CSV/ORCA dataset as a labeled graph.
+ * @brief Imports a big Parquet/CSV/NDJSON dataset as a labeled graph.
  * @version 0.1
  * @date 2022-10-02
  *
- * Every row is treated as a separate edge.
- * All of its columns are treated as different document fields, except for
+ * Every row is treated as a separate edge, defined by:
  * - Integer column for source node ID.
  * - Integer column for target node ID.
  * - Optional integer column for document/edge ID.
- * If the last one isn't provided, the row number is used as the document ID.
+ * If the last one isn't provided, the `ukv_default_edge_id_k` is used.
+ *
+ * The first argument is the regular expression, matching the dataset files.
+ * After the import, the graph is exported back into a single Parquet file.
  *
  * https://arrow.apache.org/docs/cpp/dataset.html#dataset-discovery
  * https://arrow.apache.org/docs/cpp/parquet.html
  * https://arrow.apache.org/docs/cpp/csv.html
  */
+#include <cstdlib> // `std::getenv`
+#include <string>  // `std::string`
+
+#include <benchmark/benchmark.h>
+
+#include <ukv/ukv.hpp>
+
+#include "dataset.h"
+
+namespace bm = benchmark;
+using namespace unum::ukv;
+
+static std::string dataset_pattern = "~/Datasets/Graph/.*\\.(csv|ndjson|parquet)";
+static std::string export_prefix = "/tmp/ukv_tabular_graph";
+static database_t db;
+
+static std::size_t count_edges() {
+    graph_collection_t graph = db.main<graph_collection_t>();
+    auto csr = graph.export_csr(ukv_vertex_source_k, false).throw_or_release();
+    return csr.offsets.size() ? csr.offsets[csr.offsets.size() - 1] : 0;
+}
+
+static void import_graph(bm::State& state) {
+    std::size_t imported_edges = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        db.clear().throw_unhandled();
+        state.ResumeTiming();
+
+        status_t status;
+        ukv_graph_import_t graph_import {
+            .db = db,
+            .error = status.member_ptr(),
+            .paths_pattern = dataset_pattern.c_str(),
+            .max_batch_size = static_cast<ukv_size_t>(state.range(0)),
+        };
+        ukv_graph_import(&graph_import);
+        status.throw_unhandled();
+
+        state.PauseTiming();
+        imported_edges += count_edges();
+        state.ResumeTiming();
+    }
+    state.counters["edges/s"] = bm::Counter(imported_edges, bm::Counter::kIsRate);
+}
+
+static void export_graph(bm::State& state) {
+    std::size_t const edges = count_edges();
+    std::size_t exported_edges = 0;
+    for (auto _ : state) {
+        status_t status;
+        ukv_graph_export_t graph_export {
+            .db = db,
+            .error = status.member_ptr(),
+            .paths_prefix = export_prefix.c_str(),
+            .paths_extension = ".parquet",
+            .max_batch_size = static_cast<ukv_size_t>(state.range(0)),
+        };
+        ukv_graph_export(&graph_export);
+        status.throw_unhandled();
+        exported_edges += edges;
+    }
+    state.counters["edges/s"] = bm::Counter(exported_edges, bm::Counter::kIsRate);
+}
 
 int main(int argc, char** argv) {
+    bm::Initialize(&argc, argv);
+    if (argc > 1)
+        dataset_pattern = argv[1];
+    if (dataset_pattern.front() == '~')
+        if (auto home_path = std::getenv("HOME"); home_path)
+            dataset_pattern = std::string(home_path) + dataset_pattern.substr(1);
+
+    db.open().throw_unhandled();
+
+    std::size_t const small_batch_size = 16ul * 1024ul * 1024ul;
+    std::size_t const big_batch_size = 256ul * 1024ul * 1024ul;
+
+    bm::RegisterBenchmark("import_graph", &import_graph) //
+        ->Iterations(1)
+        ->UseRealTime()
+        ->Arg(small_batch_size)
+        ->Arg(big_batch_size);
+
+    // The export reuses the graph, left after the last import.
+    bm::RegisterBenchmark("export_graph", &export_graph) //
+        ->Iterations(1)
+        ->UseRealTime()
+        ->Arg(small_batch_size)
+        ->Arg(big_batch_size);
+
+    bm::RunSpecifiedBenchmarks();
+    bm::Shutdown();
+    db.clear().throw_unhandled();
     return 0;
-}
\ No newline at end of file
+}
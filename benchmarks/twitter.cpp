@@ -464,6 +464,49 @@ static void graph_traverse_two_hops(bm::State& state) {
     state.counters["edges/s"] = bm::Counter(received_edges, bm::Counter::kIsRate);
 }
 
+/**
+ * @brief Same two hops, but the frontier is deduplicated by `ukv_graph_traverse`
+ * inside the engine, instead of shipping all the edges to the client.
+ */
+static void graph_traverse_two_hops_inplace(bm::State& state) {
+    arena_t arena(db);
+
+    std::size_t received_bytes = 0;
+    std::size_t received_vertices = 0;
+    sample_tweet_id_batches(state, [&](ukv_key_t const* ids_tweets, ukv_size_t count) {
+        ukv_size_t levels_count = 0;
+        ukv_length_t* levels_offsets = nullptr;
+        ukv_key_t* visited_vertices = nullptr;
+
+        status_t status;
+        ukv_graph_traverse_t graph_traverse {};
+        graph_traverse.db = db;
+        graph_traverse.error = status.member_ptr();
+        graph_traverse.arena = arena.member_ptr();
+        graph_traverse.tasks_count = count;
+        graph_traverse.collections = &collection_graph_k;
+        graph_traverse.vertices = ids_tweets;
+        graph_traverse.vertices_stride = sizeof(ukv_key_t);
+        graph_traverse.role = ukv_vertex_role_any_k;
+        graph_traverse.max_depth = 2;
+        graph_traverse.levels_count = &levels_count;
+        graph_traverse.levels_offsets = &levels_offsets;
+        graph_traverse.visited_vertices = &visited_vertices;
+
+        ukv_graph_traverse(&graph_traverse);
+        if (!status)
+            return false;
+
+        auto visited_count = levels_offsets[levels_count];
+        received_bytes += visited_count * sizeof(ukv_key_t) + (levels_count + 1) * sizeof(ukv_length_t);
+        received_vertices += visited_count;
+        return true;
+    });
+    state.counters["bytes/s"] = bm::Counter(received_bytes, bm::Counter::kIsRate);
+    state.counters["bytes/it"] = bm::Counter(received_bytes, bm::Counter::kAvgIterations);
+    state.counters["vertices/s"] = bm::Counter(received_vertices, bm::Counter::kIsRate);
+}
+
 int main(int argc, char** argv) {
     bm::Initialize(&argc, argv);
 
@@ -642,6 +685,13 @@ int main(int argc, char** argv) {
             ->Arg(small_batch_size)
             ->Arg(mid_batch_size)
             ->Arg(big_batch_size);
+    if (can_build_graph)
+        bm::RegisterBenchmark("graph_traverse_two_hops_inplace", &graph_traverse_two_hops_inplace) //
+            ->MinTime(min_seconds)
+            ->Threads(thread_count)
+            ->Arg(small_batch_size)
+            ->Arg(mid_batch_size)
+            ->Arg(big_batch_size);
 
     bm::RunSpecifiedBenchmarks();
     bm::Shutdown();
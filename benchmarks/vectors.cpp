@@ -0,0 +1,430 @@
+/**
+ * @brief Benchmarks the Vectors Modality on synthetic or public datasets.
+ *
+ * Without arguments, generates a synthetic dataset of clustered unit vectors.
+ * Alternatively, pass a path to an `.fvecs` or `.bvecs` file, like the ones
+ * in SIFT or GIST. The last `queries_count` vectors are held out as queries.
+ *
+ * Measures:
+ * - construction throughput and memory (RAM and disk) per vector,
+ * - QPS and recall@k of the quantized scan across thread counts,
+ * - training time of the Product Quantization index,
+ * - QPS and recall@k of the PQ search across thread counts.
+ */
+#include <unistd.h> // `sysconf`
+
+#include <cmath>      // `std::sqrt`
+#include <cstdio>     // `std::fopen`
+#include <cstring>    // `std::memcpy`
+#include <algorithm>  // `std::partial_sort`
+#include <atomic>     // `std::atomic_size_t`
+#include <filesystem> // Measuring the size of the database on disk
+#include <fstream>    // Reading `/proc/self/statm`
+#include <vector>     //
+#include <thread>     //
+#include <random>     // `std::normal_distribution`
+
+#include <benchmark/benchmark.h>
+
+#include <ukv/ukv.hpp>
+
+namespace bm = benchmark;
+using namespace unum::ukv;
+
+using real_t = float;
+
+static constexpr std::size_t matches_k = 10;
+
+static std::size_t vectors_count = 1'000'000;
+static std::size_t queries_count = 1'000;
+static std::size_t dimensions = 96;
+static std::size_t clusters_count = 256;
+static std::string dataset_path;
+static std::string database_path;
+
+/// Both the dataset and the queries are row-major matrices of normalized vectors.
+static std::vector<real_t> dataset;
+static std::vector<real_t> queries;
+/// `queries_count` rows of `matches_k` closest vector indexes in `dataset`.
+static std::vector<std::size_t> ground_truth;
+static std::size_t baseline_memory = 0;
+
+static database_t db;
+static ukv_collection_t collection_vectors_k = ukv_collection_main_k;
+static ukv_vector_metric_t const metric_k = ukv_vector_metric_cos_k;
+
+/// Keys start from one, as zero can't be mirrored by engines without named collections.
+static ukv_key_t key_of(std::size_t vector_idx) noexcept { return static_cast<ukv_key_t>(vector_idx + 1); }
+
+static void normalize(real_t* vector) noexcept {
+    real_t norm = 0;
+    for (std::size_t i = 0; i != dimensions; ++i)
+        norm += vector[i] * vector[i];
+    norm = std::sqrt(norm);
+    if (norm != 0)
+        for (std::size_t i = 0; i != dimensions; ++i)
+            vector[i] /= norm;
+}
+
+static real_t dot(real_t const* a, real_t const* b) noexcept {
+    real_t sum = 0;
+    for (std::size_t i = 0; i != dimensions; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+static std::size_t resident_memory() {
+    std::size_t total_pages = 0, resident_pages = 0;
+    std::ifstream("/proc/self/statm") >> total_pages >> resident_pages;
+    return resident_pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+static std::size_t disk_usage() {
+    std::error_code error;
+    std::size_t total = 0;
+    if (database_path.empty() || !std::filesystem::exists(database_path, error))
+        return 0;
+    for (auto const& entry : std::filesystem::recursive_directory_iterator(database_path, error))
+        if (entry.is_regular_file(error))
+            total += entry.file_size(error);
+    return total;
+}
+
+/**
+ * @brief Generates Gaussian blobs around random centroids on a unit sphere.
+ */
+static void generate_dataset() {
+    std::mt19937 gen(42);
+    std::normal_distribution<real_t> centroid_dist(0, 1);
+    std::normal_distribution<real_t> noise_dist(0, 0.1);
+    std::uniform_int_distribution<std::size_t> choose_cluster(0, clusters_count - 1);
+
+    std::vector<real_t> centroids(clusters_count * dimensions);
+    for (std::size_t i = 0; i != clusters_count; ++i) {
+        for (std::size_t j = 0; j != dimensions; ++j)
+            centroids[i * dimensions + j] = centroid_dist(gen);
+        normalize(&centroids[i * dimensions]);
+    }
+
+    auto fill = [&](std::vector<real_t>& matrix, std::size_t count) {
+        matrix.resize(count * dimensions);
+        for (std::size_t i = 0; i != count; ++i) {
+            real_t const* centroid = &centroids[choose_cluster(gen) * dimensions];
+            for (std::size_t j = 0; j != dimensions; ++j)
+                matrix[i * dimensions + j] = centroid[j] + noise_dist(gen);
+            normalize(&matrix[i * dimensions]);
+        }
+    };
+    fill(dataset, vectors_count);
+    fill(queries, queries_count);
+}
+
+/**
+ * @brief Loads the TEXMEX formats, where every vector is prefixed by
+ * a 32-bit dimensions count, followed by `float` or `uint8_t` scalars.
+ * Our quantized scan expects normalized inputs, so we normalize everything.
+ */
+static void load_dataset() {
+    bool const is_bytes = std::filesystem::path(dataset_path).extension() == ".bvecs";
+    std::size_t const scalar_size = is_bytes ? sizeof(std::uint8_t) : sizeof(real_t);
+    std::FILE* file = std::fopen(dataset_path.c_str(), "rb");
+    if (!file)
+        throw std::runtime_error("Can't open dataset file");
+
+    std::uint32_t file_dimensions = 0;
+    if (std::fread(&file_dimensions, sizeof(file_dimensions), 1, file) != 1 || !file_dimensions)
+        throw std::runtime_error("Can't parse dataset file");
+    dimensions = file_dimensions;
+
+    std::size_t const row_size = sizeof(std::uint32_t) + dimensions * scalar_size;
+    std::size_t const rows_count = std::filesystem::file_size(dataset_path) / row_size;
+    if (rows_count <= queries_count)
+        throw std::runtime_error("Dataset is too small");
+    vectors_count = std::min(vectors_count, rows_count - queries_count);
+
+    std::vector<real_t> all((vectors_count + queries_count) * dimensions);
+    std::vector<std::uint8_t> row(row_size);
+    std::fseek(file, 0, SEEK_SET);
+    for (std::size_t i = 0; i != vectors_count + queries_count; ++i) {
+        // Queries are taken from the tail of the file
+        std::size_t const row_idx = i < vectors_count ? i : rows_count - (i - vectors_count) - 1;
+        std::fseek(file, static_cast<long>(row_idx * row_size), SEEK_SET);
+        if (std::fread(row.data(), row_size, 1, file) != 1)
+            throw std::runtime_error("Can't parse dataset file");
+        real_t* vector = &all[i * dimensions];
+        std::uint8_t const* scalars = row.data() + sizeof(std::uint32_t);
+        if (is_bytes)
+            std::copy_n(scalars, dimensions, vector);
+        else
+            std::memcpy(vector, scalars, dimensions * sizeof(real_t));
+        normalize(vector);
+    }
+    std::fclose(file);
+
+    dataset.assign(all.begin(), all.begin() + vectors_count * dimensions);
+    queries.assign(all.begin() + vectors_count * dimensions, all.end());
+}
+
+/**
+ * @brief Exhaustive search in full precision, that the recall is measured against.
+ */
+static void compute_ground_truth(std::size_t thread_count) {
+    ground_truth.resize(queries_count * matches_k);
+    std::atomic_size_t next_query = 0;
+    auto search = [&] {
+        std::vector<std::pair<real_t, std::size_t>> similarities(vectors_count);
+        for (std::size_t q = next_query++; q < queries_count; q = next_query++) {
+            for (std::size_t i = 0; i != vectors_count; ++i)
+                similarities[i] = {dot(&queries[q * dimensions], &dataset[i * dimensions]), i};
+            std::partial_sort(similarities.begin(),
+                              similarities.begin() + matches_k,
+                              similarities.end(),
+                              std::greater<> {});
+            for (std::size_t j = 0; j != matches_k; ++j)
+                ground_truth[q * matches_k + j] = similarities[j].second;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i != thread_count; ++i)
+        threads.emplace_back(search);
+    for (auto& thread : threads)
+        thread.join();
+}
+
+static void report_memory(bm::State& state) {
+    if (state.thread_index() != 0)
+        return;
+    std::size_t const memory = resident_memory();
+    state.counters["ram/vector"] = double(memory > baseline_memory ? memory - baseline_memory : 0) / vectors_count;
+    state.counters["disk/vector"] = double(disk_usage()) / vectors_count;
+}
+
+/**
+ * @brief Imports the dataset in batches, splitting it evenly between threads.
+ * @see `ukv_vectors_write()`.
+ */
+static void construct_vectors(bm::State& state) {
+    status_t status;
+    arena_t arena(db);
+
+    std::size_t const vectors_per_thread = vectors_count / state.threads();
+    std::size_t const first_vector_idx = state.thread_index() * vectors_per_thread;
+    auto const batch_size = static_cast<ukv_size_t>(state.range(0));
+    std::vector<ukv_key_t> batch_keys(batch_size);
+
+    ukv_vectors_write_t write {};
+    write.db = db;
+    write.error = status.member_ptr();
+    write.arena = arena.member_ptr();
+    write.dimensions = static_cast<ukv_length_t>(dimensions);
+    write.scalar_type = ukv_vector_scalar_f32_k;
+    write.collections = &collection_vectors_k;
+    write.keys = batch_keys.data();
+    write.keys_stride = sizeof(ukv_key_t);
+    write.vectors_stride = static_cast<ukv_size_t>(sizeof(real_t) * dimensions);
+
+    std::size_t vectors_success = 0;
+    std::size_t vector_idx = first_vector_idx;
+    for (auto _ : state) {
+        std::size_t const count = std::min<std::size_t>(batch_size, first_vector_idx + vectors_per_thread - vector_idx);
+        for (std::size_t i = 0; i != count; ++i)
+            batch_keys[i] = key_of(vector_idx + i);
+
+        auto batch_begin = reinterpret_cast<ukv_bytes_cptr_t>(&dataset[vector_idx * dimensions]);
+        write.tasks_count = static_cast<ukv_size_t>(count);
+        write.vectors_starts = &batch_begin;
+        ukv_vectors_write(&write);
+        status.throw_unhandled();
+
+        vector_idx += count;
+        vectors_success += count;
+    }
+
+    state.counters["vectors/s"] = bm::Counter(vectors_success, bm::Counter::kIsRate);
+    state.counters["bytes/s"] = bm::Counter(vectors_success * sizeof(real_t) * dimensions, bm::Counter::kIsRate);
+    report_memory(state);
+}
+
+/**
+ * @brief Replaces the quantized copies with PQ codes.
+ * @see `ukv_vectors_train()`.
+ */
+static void train_vectors(bm::State& state) {
+    status_t status;
+    arena_t arena(db);
+
+    ukv_vectors_train_t train {};
+    train.db = db;
+    train.error = status.member_ptr();
+    train.arena = arena.member_ptr();
+    train.collection = collection_vectors_k;
+    train.dimensions = static_cast<ukv_length_t>(dimensions);
+    train.scalar_type = ukv_vector_scalar_f32_k;
+    train.metric = metric_k;
+
+    for (auto _ : state) {
+        ukv_vectors_train(&train);
+        status.throw_unhandled();
+    }
+
+    state.counters["vectors/s"] = bm::Counter(vectors_count, bm::Counter::kIsRate);
+    report_memory(state);
+}
+
+/**
+ * @brief Batch-searches the held-out queries, comparing results with the exhaustive ones.
+ * Threads start at different offsets, to avoid searching the same queries in lockstep.
+ * @see `ukv_vectors_search()`.
+ */
+static void search_vectors(bm::State& state) {
+    status_t status;
+    arena_t arena(db);
+
+    auto const batch_size = static_cast<ukv_size_t>(state.range(0));
+    std::vector<ukv_length_t> limits(batch_size, matches_k);
+
+    ukv_length_t* found_counts = nullptr;
+    ukv_length_t* found_offsets = nullptr;
+    ukv_key_t* found_keys = nullptr;
+    ukv_vectors_search_t search {};
+    search.db = db;
+    search.error = status.member_ptr();
+    search.arena = arena.member_ptr();
+    search.tasks_count = batch_size;
+    search.dimensions = static_cast<ukv_length_t>(dimensions);
+    search.scalar_type = ukv_vector_scalar_f32_k;
+    search.metric = metric_k;
+    search.metric_threshold = -1;
+    search.collections = &collection_vectors_k;
+    search.match_counts_limits = limits.data();
+    search.match_counts_limits_stride = sizeof(ukv_length_t);
+    search.queries_stride = static_cast<ukv_size_t>(sizeof(real_t) * dimensions);
+    search.match_counts = &found_counts;
+    search.match_offsets = &found_offsets;
+    search.match_keys = &found_keys;
+
+    std::size_t queries_success = 0;
+    std::size_t recalled = 0;
+    std::size_t query_idx = (state.thread_index() * queries_count / state.threads()) / batch_size * batch_size;
+    for (auto _ : state) {
+        if (query_idx + batch_size > queries_count)
+            query_idx = 0;
+
+        auto batch_begin = reinterpret_cast<ukv_bytes_cptr_t>(&queries[query_idx * dimensions]);
+        search.queries_starts = &batch_begin;
+        ukv_vectors_search(&search);
+        status.throw_unhandled();
+
+        state.PauseTiming();
+        for (std::size_t i = 0; i != batch_size; ++i) {
+            auto expected = &ground_truth[(query_idx + i) * matches_k];
+            auto found = found_keys + found_offsets[i];
+            for (std::size_t j = 0; j != found_counts[i]; ++j)
+                recalled += std::any_of(expected, expected + matches_k, [=](std::size_t vector_idx) {
+                    return key_of(vector_idx) == found[j];
+                });
+        }
+        state.ResumeTiming();
+
+        query_idx += batch_size;
+        queries_success += batch_size;
+    }
+
+    state.counters["queries/s"] = bm::Counter(queries_success, bm::Counter::kIsRate);
+    state.counters["recall@10"] =
+        bm::Counter(queries_success ? double(recalled) / (queries_success * matches_k) : 0, bm::Counter::kAvgThreads);
+}
+
+int main(int argc, char** argv) {
+    bm::Initialize(&argc, argv);
+    if (argc > 1)
+        dataset_path = argv[1];
+
+    std::size_t thread_count = std::thread::hardware_concurrency();
+    std::size_t min_seconds = 10;
+    std::size_t write_batch_size = 1024;
+    std::size_t small_batch_size = 1;
+    std::size_t big_batch_size = 32;
+#if defined(UKV_DEBUG)
+    vectors_count = 10'000;
+    queries_count = 100;
+    thread_count = 1;
+    min_seconds = 1;
+#endif
+
+    // 1. Prepare the dataset
+    if (dataset_path.empty()) {
+        std::printf("Will generate %zu synthetic vectors...\n", vectors_count + queries_count);
+        generate_dataset();
+    }
+    else {
+        std::printf("Will load vectors from %s...\n", dataset_path.c_str());
+        load_dataset();
+    }
+    std::printf("- prepared %zu vectors and %zu queries of %zu dimensions\n", vectors_count, queries_count, dimensions);
+
+    // Every thread imports an equal share of the dataset
+    vectors_count -= vectors_count % thread_count;
+    dataset.resize(vectors_count * dimensions);
+
+    std::printf("Will compute the exact nearest neighbors...\n");
+    compute_ground_truth(thread_count);
+
+    // 2. Run the actual benchmarks
+#if defined(UKV_ENGINE_IS_LEVELDB)
+    database_path = "/mnt/md0/Vectors/LevelDB";
+#elif defined(UKV_ENGINE_IS_ROCKSDB)
+    database_path = "/mnt/md0/Vectors/RocksDB";
+#elif defined(UKV_ENGINE_IS_UDISK)
+    database_path = "/mnt/md0/Vectors/UnumDB";
+#endif
+    if (database_path.empty())
+        db.open().throw_unhandled();
+    else
+        db.open(database_path.c_str()).throw_unhandled();
+    baseline_memory = resident_memory();
+
+    if (ukv_supports_named_collections_k) {
+        status_t status;
+        ukv_collection_create_t collection_init {
+            .db = db,
+            .error = status.member_ptr(),
+            .name = "vectors",
+            .config = "",
+            .id = &collection_vectors_k,
+        };
+        ukv_collection_create(&collection_init);
+        status.throw_unhandled();
+    }
+
+    std::printf("Will benchmark...\n");
+    bm::RegisterBenchmark("construct_vectors", &construct_vectors) //
+        ->Iterations((vectors_count / thread_count + write_batch_size - 1) / write_batch_size)
+        ->UseRealTime()
+        ->Threads(thread_count)
+        ->Arg(write_batch_size);
+
+    bm::RegisterBenchmark("search_quantized", &search_vectors) //
+        ->MinTime(min_seconds)
+        ->UseRealTime()
+        ->ThreadRange(1, thread_count)
+        ->Arg(small_batch_size)
+        ->Arg(big_batch_size);
+
+    bm::RegisterBenchmark("train_product_quantization", &train_vectors) //
+        ->Iterations(1)
+        ->UseRealTime();
+
+    bm::RegisterBenchmark("search_product_quantization", &search_vectors) //
+        ->MinTime(min_seconds)
+        ->UseRealTime()
+        ->ThreadRange(1, thread_count)
+        ->Arg(small_batch_size)
+        ->Arg(big_batch_size);
+
+    bm::RunSpecifiedBenchmarks();
+    bm::Shutdown();
+
+    db.clear().throw_unhandled();
+    return 0;
+}
@@ -48,7 +48,7 @@ ExternalProject_Add(
     -DARROW_JEMALLOC=OFF
     -DARROW_IPC=OFF
     -DARROW_JSON=OFF
-    -DARROW_CSV=OFF
+    -DARROW_CSV=ON
     -DARROW_FLIGHT_SQL=OFF
     -DARROW_WITH_UCX=OFF
     -DARROW_BUILD_UTILITIES=OFF
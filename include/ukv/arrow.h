@@ -325,6 +325,115 @@ static void ukv_to_arrow_list( //
                         error);
 }
 
+/**
+ * @brief Fill a column in a continuous `arrow::RecordBatch`, like `ukv_to_arrow_list()`,
+ * but with 64-bit offsets, so that lists can address more than 2^31 entries in total.
+ */
+static void ukv_to_arrow_large_list( //
+    ukv_size_t const docs_count,
+    ukv_str_view_t const field_name,
+    ukv_doc_field_type_t const field_type,
+
+    ukv_octet_t const* column_validities,
+    ukv_size_t const* column_offsets,
+    void const* column_contents,
+
+    struct ArrowSchema* schema,
+    struct ArrowArray* array,
+
+    ukv_error_t* error) {
+
+    // https://arrow.apache.org/docs/format/Columnar.html#variable-size-list-layout
+    ukv_to_arrow_schema(docs_count, 1, schema, array, error);
+    if (*error)
+        return;
+
+    schema->name = field_name;
+    schema->metadata = NULL;
+    schema->flags = column_validities ? ARROW_FLAG_NULLABLE : 0;
+    schema->dictionary = NULL;
+    schema->format = "+L";
+
+    array->null_count = column_validities ? -1 : 0;
+    array->n_buffers = 2;
+
+    // Link our buffers
+    if (array->buffers)
+        free(array->buffers);
+    array->buffers = (void const**)malloc(sizeof(void*) * array->n_buffers);
+    if (!array->buffers) {
+        *error = "Failed to allocate memory";
+        return;
+    }
+
+    array->buffers[0] = (void*)column_validities;
+    array->buffers[1] = (void*)column_offsets;
+    ukv_to_arrow_column(column_offsets[docs_count],
+                        "chunks",
+                        field_type,
+                        nullptr,
+                        nullptr,
+                        column_contents,
+                        schema->children[0],
+                        array->children[0],
+                        error);
+}
+
+/**
+ * @brief Wraps the outputs of `ukv_graph_export_csr()` into a continuous `arrow::RecordBatch`
+ * with a row per vertex: its ID, the list of neighbor indexes and, optionally, of edge IDs.
+ * Both lists share the same offsets. Like other exports, buffers remain owned by the arena.
+ */
+static void ukv_graph_csr_to_arrow( //
+    ukv_size_t const vertices_count,
+    ukv_key_t const* vertices,
+    ukv_size_t const* offsets,
+    ukv_size_t const* neighbors,
+    ukv_key_t const* edges,
+
+    struct ArrowSchema* schema,
+    struct ArrowArray* array,
+    ukv_error_t* error) {
+
+    ukv_to_arrow_schema(vertices_count, edges ? 3 : 2, schema, array, error);
+    if (*error)
+        return;
+
+    ukv_to_arrow_column(vertices_count,
+                        "vertices",
+                        ukv_doc_field_i64_k,
+                        nullptr,
+                        nullptr,
+                        vertices,
+                        schema->children[0],
+                        array->children[0],
+                        error);
+    if (*error)
+        return;
+
+    ukv_to_arrow_large_list(vertices_count,
+                            "neighbors",
+                            ukv_doc_field_u64_k,
+                            nullptr,
+                            offsets,
+                            neighbors,
+                            schema->children[1],
+                            array->children[1],
+                            error);
+    if (*error || !edges)
+        return;
+
+    ukv_to_arrow_large_list(vertices_count,
+                            "edges",
+                            ukv_doc_field_i64_k,
+                            nullptr,
+                            offsets,
+                            edges,
+                            schema->children[2],
+                            array->children[2],
+                            error);
+}
+
 /**
  * @brief Placeholder for future streaming exports.
  */
@@ -8,6 +8,9 @@
  */
 
 #pragma once
+#include <chrono> // `std::chrono::seconds`
+#include <future> // `std::async`
+
 #include "ukv/ukv.h"
 #include "ukv/cpp/ranges.hpp" // `indexed_range_gt`
 
@@ -28,6 +31,10 @@ struct size_estimates_t;
  * Unlike classical iterators, keeps an internal state,
  * which makes it @b non copy-constructible!
  *
+ * Outside of transactions, the next batch of keys is scanned on a background
+ * thread, while the current one is being consumed. If the consumer catches up
+ * with that thread, the batches grow, up to `max_read_ahead_k`.
+ *
  * ## Class Specs
  * - Concurrency: Must be used from a single thread!
  * - Lifetime: @b Must live shorter then the collection it belongs to.
@@ -36,50 +43,119 @@ struct size_estimates_t;
  */
 class keys_stream_t {
 
+    /**
+     * @brief A batch of scanned keys, together with the memory they live in.
+     */
+    struct scanned_keys_t {
+        arena_t arena;
+        status_t status;
+        ukv_key_t start_key;
+        ukv_length_t limit;
+        ptr_range_gt<ukv_key_t> keys;
+    };
+
     ukv_database_t db_ {nullptr};
     ukv_collection_t collection_ {ukv_collection_main_k};
     ukv_transaction_t txn_ {nullptr};
 
     arena_t arena_ {nullptr};
+    arena_t spare_arena_ {nullptr};
+    std::future<scanned_keys_t> next_batch_;
     ukv_length_t read_ahead_ {0};
 
     ukv_key_t next_min_key_ {std::numeric_limits<ukv_key_t>::min()};
     ptr_range_gt<ukv_key_t> fetched_keys_ {};
     std::size_t fetched_offset_ {0};
 
-    status_t prefetch() noexcept {
-
-        if (next_min_key_ == ukv_key_unknown_k) {
-            ++fetched_offset_;
-            return {};
-        }
+    static scanned_keys_t scan(ukv_database_t db,
+                               ukv_transaction_t txn,
+                               ukv_collection_t collection,
+                               ukv_key_t start_key,
+                               ukv_length_t limit,
+                               arena_t arena) noexcept {
 
         ukv_length_t* found_counts = nullptr;
         ukv_key_t* found_keys = nullptr;
 
         status_t status;
         ukv_scan_t scan {
-            .db = db_,
+            .db = db,
             .error = status.member_ptr(),
-            .transaction = txn_,
-            .arena = arena_.member_ptr(),
+            .transaction = txn,
+            .arena = arena.member_ptr(),
             .tasks_count = 1,
-            .collections = &collection_,
-            .start_keys = &next_min_key_,
-            .count_limits = &read_ahead_,
+            .collections = &collection,
+            .start_keys = &start_key,
+            .count_limits = &limit,
             .counts = &found_counts,
             .keys = &found_keys,
         };
 
         ukv_scan(&scan);
-        if (!status)
-            return status;
+        ptr_range_gt<ukv_key_t> keys;
+        if (status)
+            keys = {found_keys, found_keys + *found_counts};
+        return {std::move(arena), std::move(status), start_key, limit, keys};
+    }
 
-        fetched_keys_ = ptr_range_gt<ukv_key_t> {found_keys, found_keys + *found_counts};
+    /**
+     * @brief Starts scanning the batch after the current one on a background thread.
+     * Transactions can't be shared between threads, so those are always scanned synchronously.
+     */
+    void scan_ahead() noexcept {
+        // Tiny batches, like the ones of `end()` iterators, aren't worth a thread
+        if (txn_ || next_min_key_ == ukv_key_unknown_k || read_ahead_ < default_read_ahead_k)
+            return;
+        try {
+            next_batch_ = std::async(std::launch::async,
+                                     &keys_stream_t::scan,
+                                     db_,
+                                     txn_,
+                                     collection_,
+                                     next_min_key_,
+                                     read_ahead_,
+                                     std::move(spare_arena_));
+        }
+        catch (...) {
+            // Without threads, the next batch will be scanned synchronously
+            spare_arena_ = arena_t(db_);
+        }
+    }
+
+    scanned_keys_t scan_next() noexcept {
+        if (next_batch_.valid()) {
+            if (next_batch_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                read_ahead_ = std::max(read_ahead_, std::min<ukv_length_t>(read_ahead_ * 2, max_read_ahead_k));
+            scanned_keys_t batch = next_batch_.get();
+            if (batch.start_key == next_min_key_)
+                return batch;
+            spare_arena_ = std::move(batch.arena);
+        }
+        return scan(db_, txn_, collection_, next_min_key_, read_ahead_, std::move(spare_arena_));
+    }
+
+    status_t prefetch() noexcept {
+
+        if (next_min_key_ == ukv_key_unknown_k) {
+            ++fetched_offset_;
+            return {};
+        }
+
+        scanned_keys_t batch = scan_next();
+        if (!batch.status) {
+            spare_arena_ = std::move(batch.arena);
+            return std::move(batch.status);
+        }
+
+        // The memory of the previous batch will be reused for the next one
+        std::swap(arena_, batch.arena);
+        spare_arena_ = std::move(batch.arena);
+        fetched_keys_ = batch.keys;
         fetched_offset_ = 0;
 
         auto count = static_cast<ukv_length_t>(fetched_keys_.size());
-        next_min_key_ = count < read_ahead_ ? ukv_key_unknown_k : fetched_keys_[count - 1] + 1;
+        next_min_key_ = count < batch.limit ? ukv_key_unknown_k : fetched_keys_[count - 1] + 1;
+        scan_ahead();
         return {};
     }
 
@@ -91,12 +167,14 @@ class keys_stream_t {
     using reference = ukv_key_t&;
 
     static constexpr std::size_t default_read_ahead_k = 256;
+    static constexpr ukv_length_t max_read_ahead_k = 64 * 1024;
 
     keys_stream_t(ukv_database_t db,
                   ukv_collection_t collection = ukv_collection_main_k,
                   std::size_t read_ahead = keys_stream_t::default_read_ahead_k,
                   ukv_transaction_t txn = nullptr)
-        : db_(db), collection_(collection), txn_(txn), arena_(db), read_ahead_(static_cast<ukv_size_t>(read_ahead)) {}
+        : db_(db), collection_(collection), txn_(txn), arena_(db), spare_arena_(db),
+          read_ahead_(static_cast<ukv_size_t>(read_ahead)) {}
 
     keys_stream_t(keys_stream_t&&) = default;
     keys_stream_t& operator=(keys_stream_t&&) = default;
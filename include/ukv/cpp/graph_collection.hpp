@@ -14,6 +14,113 @@
 
 namespace unum::ukv {
 
+/**
+ * @brief Vertices, visited by `graph_collection_t::traverse()`, grouped by levels.
+ */
+struct traversal_t {
+    ptr_range_gt<ukv_key_t> vertices;
+    ptr_range_gt<ukv_length_t> levels_offsets;
+
+    inline std::size_t levels() const noexcept { return levels_offsets.size() - 1; }
+    inline ptr_range_gt<ukv_key_t> level(std::size_t i) const noexcept {
+        return {vertices.begin() + levels_offsets[i], vertices.begin() + levels_offsets[i + 1]};
+    }
+};
+
+/**
+ * @brief Results of whole-graph analytics, like `graph_collection_t::pagerank()`.
+ * Only one of `scores` and `labels` is populated, depending on the algorithm.
+ */
+struct graph_analysis_t {
+    ptr_range_gt<ukv_key_t> vertices;
+    ptr_range_gt<ukv_float_t> scores;
+    ptr_range_gt<ukv_key_t> labels;
+};
+
+/**
+ * @brief Whole graph in the Compressed Sparse Row form, exported by `graph_collection_t::export_csr()`.
+ */
+struct graph_csr_t {
+    ptr_range_gt<ukv_key_t> vertices;
+    ptr_range_gt<ukv_size_t> offsets;
+    ptr_range_gt<ukv_size_t> neighbors;
+    ptr_range_gt<ukv_key_t> edges;
+
+    inline ptr_range_gt<ukv_size_t> neighbors_of(std::size_t i) const noexcept {
+        return {neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1]};
+    }
+};
+
+/**
+ * @brief Edges, sampled by `graph_collection_t::sample_neighbors()`, grouped by hops.
+ */
+struct graph_sample_t {
+    ptr_range_gt<ukv_length_t> hops_offsets;
+    ptr_range_gt<ukv_key_t> centers;
+    ptr_range_gt<ukv_key_t> neighbors;
+    ptr_range_gt<ukv_key_t> edges;
+
+    inline std::size_t hops() const noexcept { return hops_offsets.size() - 1; }
+};
+
+/**
+ * @brief Equal-length walks, generated by `graph_collection_t::random_walks()`.
+ */
+struct random_walks_t {
+    ptr_range_gt<ukv_key_t> vertices;
+    std::size_t walk_length = 0;
+
+    inline std::size_t size() const noexcept { return vertices.size() / (walk_length + 1); }
+    inline ptr_range_gt<ukv_key_t> walk(std::size_t i) const noexcept {
+        return {vertices.begin() + i * (walk_length + 1), vertices.begin() + (i + 1) * (walk_length + 1)};
+    }
+};
+
+/**
+ * @brief Common neighbors of pairs of vertices, found by `graph_collection_t::common_neighbors()`.
+ */
+struct common_neighbors_t {
+    ptr_range_gt<ukv_length_t> counts;
+    ptr_range_gt<ukv_length_t> offsets;
+    ptr_range_gt<ukv_key_t> neighbors;
+
+    inline ptr_range_gt<ukv_key_t> of(std::size_t i) const noexcept {
+        return {neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1]};
+    }
+};
+
+/**
+ * @brief Triangles and clustering coefficients, computed by `graph_collection_t::count_triangles()`.
+ */
+struct triangles_t {
+    ptr_range_gt<ukv_size_t> counts;
+    ptr_range_gt<ukv_float_t> clustering;
+};
+
+/**
+ * @brief Shortest paths from a few sources, found by `graph_collection_t::shortest_paths()`.
+ * The results for the `i`-th source and the `j`-th vertex are at `i * vertices.size() + j`.
+ */
+struct shortest_paths_t {
+    ptr_range_gt<ukv_key_t> vertices;
+    ptr_range_gt<ukv_float_t> distances;
+    ptr_range_gt<ukv_key_t> predecessors;
+    ptr_range_gt<ukv_key_t> predecessors_edges;
+
+    inline ptr_range_gt<ukv_float_t> distances_from(std::size_t i) const noexcept {
+        return {distances.begin() + i * vertices.size(), distances.begin() + (i + 1) * vertices.size()};
+    }
+};
+
+/**
+ * @brief Ends of edges, resolved by `graph_collection_t::find_edges_by_id()`.
+ * Missing edges have `ukv_key_unknown_k` ends.
+ */
+struct edges_ends_t {
+    ptr_range_gt<ukv_key_t> sources;
+    ptr_range_gt<ukv_key_t> targets;
+};
+
 /**
  * @brief Wraps relational/linking operations with cleaner type system.
  * Controls mainly just the inverted index collection and keeps a local
@@ -57,7 +164,11 @@ class graph_collection_t {
         return status;
     }
 
-    status_t upsert_edges(edges_view_t const& edges) noexcept {
+    /**
+     * @brief Inserts edges, optionally with non-negative weights, which need edge IDs.
+     * @see `ukv_graph_upsert_edges()`.
+     */
+    status_t upsert_edges(edges_view_t const& edges, strided_range_gt<ukv_float_t const> weights = {}) noexcept {
         status_t status;
 
         ukv_graph_upsert_edges_t graph_upsert_edges {
@@ -73,6 +184,8 @@ class graph_collection_t {
             .sources_stride = edges.source_ids.stride(),
             .targets_ids = edges.target_ids.begin().get(),
             .targets_stride = edges.target_ids.stride(),
+            .weights = weights.begin().get(),
+            .weights_stride = weights.stride(),
         };
 
         ukv_graph_upsert_edges(&graph_upsert_edges);
@@ -105,6 +218,35 @@ class graph_collection_t {
         return status;
     }
 
+    /**
+     * @brief Removes all the vertices with keys in `[min_key, max_key)` and their edges.
+     * @return The number of removed vertices.
+     * @see `ukv_graph_remove_vertices_range()`.
+     */
+    expected_gt<std::size_t> remove_vertices_range(ukv_key_t min_key, ukv_key_t max_key, bool flush = false) noexcept {
+
+        status_t status;
+        ukv_size_t removed_count = 0;
+        ukv_options_t options = flush ? ukv_option_write_flush_k : ukv_options_default_k;
+
+        ukv_graph_remove_vertices_range_t graph_remove_vertices_range {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = options,
+            .collection = collection_,
+            .min_key = min_key,
+            .max_key = max_key,
+            .removed_count = &removed_count,
+        };
+
+        ukv_graph_remove_vertices_range(&graph_remove_vertices_range);
+        if (!status)
+            return status;
+        return std::size_t(removed_count);
+    }
+
     status_t remove_edges(edges_view_t const& edges) noexcept {
         status_t status;
 
@@ -396,6 +538,470 @@ class graph_collection_t {
         return strided_range_gt<ukv_key_t> {es.target_ids};
     }
 
+    /**
+     * @brief Visits vertices up to `max_depth` hops away from the given ones, breadth-first.
+     * @see `ukv_graph_traverse()`.
+     */
+    expected_gt<traversal_t> traverse( //
+        strided_range_gt<ukv_key_t const> vertices,
+        std::size_t max_depth,
+        ukv_vertex_role_t role = ukv_vertex_role_any_k,
+        std::size_t max_vertices = 0,
+        bool watch = true) noexcept {
+
+        status_t status;
+        ukv_size_t levels_count = 0;
+        ukv_length_t* levels_offsets = nullptr;
+        ukv_key_t* visited_vertices = nullptr;
+
+        ukv_graph_traverse_t graph_traverse {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .tasks_count = vertices.count(),
+            .collections = &collection_,
+            .vertices = vertices.begin().get(),
+            .vertices_stride = vertices.stride(),
+            .role = role,
+            .max_depth = max_depth,
+            .max_vertices = max_vertices,
+            .levels_count = &levels_count,
+            .levels_offsets = &levels_offsets,
+            .visited_vertices = &visited_vertices,
+        };
+
+        ukv_graph_traverse(&graph_traverse);
+
+        if (!status)
+            return status;
+
+        return traversal_t {
+            {visited_vertices, visited_vertices + levels_offsets[levels_count]},
+            {levels_offsets, levels_offsets + levels_count + 1},
+        };
+    }
+
+    /**
+     * @brief Builds the index, mapping edge IDs to their ends, which is then kept up to date.
+     * @see `ukv_graph_index_edges()`.
+     */
+    status_t index_edges() noexcept {
+        status_t status;
+        ukv_graph_index_edges_t graph_index_edges {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .collection = collection_,
+        };
+        ukv_graph_index_edges(&graph_index_edges);
+        return status;
+    }
+
+    /**
+     * @brief Builds the index of vertex degrees, which is then kept up to date,
+     * so that `degrees()` doesn't fetch whole neighborhoods.
+     * @see `ukv_graph_index_degrees()`.
+     */
+    status_t index_degrees() noexcept {
+        status_t status;
+        ukv_graph_index_degrees_t graph_index_degrees {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .collection = collection_,
+        };
+        ukv_graph_index_degrees(&graph_index_degrees);
+        return status;
+    }
+
+    /**
+     * @brief Resolves edge IDs to their ends with the edge index.
+     * @see `ukv_graph_find_edges_by_id()`.
+     */
+    expected_gt<edges_ends_t> find_edges_by_id(strided_range_gt<ukv_key_t const> edges_ids,
+                                               bool watch = true) noexcept {
+        status_t status;
+        ukv_key_t* sources = nullptr;
+        ukv_key_t* targets = nullptr;
+        ukv_graph_find_edges_by_id_t graph_find_edges_by_id {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .tasks_count = edges_ids.count(),
+            .collections = &collection_,
+            .edges_ids = edges_ids.begin().get(),
+            .edges_stride = edges_ids.stride(),
+            .sources = &sources,
+            .targets = &targets,
+        };
+        ukv_graph_find_edges_by_id(&graph_find_edges_by_id);
+        if (!status)
+            return status;
+
+        return edges_ends_t {
+            {sources, sources + edges_ids.count()},
+            {targets, targets + edges_ids.count()},
+        };
+    }
+
+    /**
+     * @brief Scores all vertices with PageRank.
+     * @see `ukv_graph_analyze()`.
+     */
+    expected_gt<graph_analysis_t> pagerank(ukv_float_t damping = 0.85,
+                                           std::size_t max_iterations = 100,
+                                           ukv_float_t tolerance = 1e-6,
+                                           std::size_t threads_count = 0) noexcept {
+        ukv_graph_analyze_t graph_analyze {
+            .algorithm = ukv_graph_pagerank_k,
+            .max_iterations = max_iterations,
+            .damping = damping,
+            .tolerance = tolerance,
+            .threads_count = threads_count,
+        };
+        return analyze(graph_analyze);
+    }
+
+    /**
+     * @brief Labels all vertices with the smallest vertex ID in their weakly connected component.
+     * @see `ukv_graph_analyze()`.
+     */
+    expected_gt<graph_analysis_t> weakly_connected_components(std::size_t threads_count = 0) noexcept {
+        ukv_graph_analyze_t graph_analyze {
+            .algorithm = ukv_graph_weakly_connected_components_k,
+            .threads_count = threads_count,
+        };
+        return analyze(graph_analyze);
+    }
+
+    /**
+     * @brief Labels all vertices with the smallest vertex ID in their Louvain community.
+     * @see `ukv_graph_analyze()`.
+     */
+    expected_gt<graph_analysis_t> louvain(ukv_float_t resolution = 1,
+                                          std::size_t max_levels = 10,
+                                          ukv_float_t tolerance = 1e-7,
+                                          std::size_t threads_count = 0) noexcept {
+        ukv_graph_analyze_t graph_analyze {
+            .algorithm = ukv_graph_louvain_k,
+            .max_iterations = max_levels,
+            .resolution = resolution,
+            .tolerance = tolerance,
+            .threads_count = threads_count,
+        };
+        return analyze(graph_analyze);
+    }
+
+    /**
+     * @brief Runs a whole-graph algorithm, filling the context of the passed task.
+     * @see `ukv_graph_analyze()`.
+     */
+    expected_gt<graph_analysis_t> analyze(ukv_graph_analyze_t graph_analyze) noexcept {
+
+        status_t status;
+        ukv_size_t vertices_count = 0;
+        ukv_key_t* vertices = nullptr;
+        ukv_float_t* scores = nullptr;
+        ukv_key_t* labels = nullptr;
+
+        graph_analyze.db = db_;
+        graph_analyze.error = status.member_ptr();
+        graph_analyze.transaction = transaction_;
+        graph_analyze.arena = arena_;
+        graph_analyze.collection = collection_;
+        graph_analyze.vertices_count = &vertices_count;
+        graph_analyze.vertices = &vertices;
+        graph_analyze.scores = &scores;
+        graph_analyze.labels = &labels;
+        ukv_graph_analyze(&graph_analyze);
+
+        if (!status)
+            return status;
+
+        return graph_analysis_t {
+            {vertices, vertices + vertices_count},
+            {scores, scores ? scores + vertices_count : nullptr},
+            {labels, labels ? labels + vertices_count : nullptr},
+        };
+    }
+
+    /**
+     * @brief Exports the whole graph in the Compressed Sparse Row form.
+     * @see `ukv_graph_export_csr()`.
+     */
+    expected_gt<graph_csr_t> export_csr(ukv_vertex_role_t role = ukv_vertex_source_k,
+                                        bool with_edges = true,
+                                        std::size_t threads_count = 0,
+                                        bool watch = true) noexcept {
+
+        status_t status;
+        ukv_size_t vertices_count = 0;
+        ukv_key_t* vertices = nullptr;
+        ukv_size_t* offsets = nullptr;
+        ukv_size_t* neighbors = nullptr;
+        ukv_key_t* edges = nullptr;
+
+        ukv_graph_export_csr_t graph_export_csr {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .collection = collection_,
+            .role = role,
+            .threads_count = threads_count,
+            .vertices_count = &vertices_count,
+            .vertices = &vertices,
+            .offsets = &offsets,
+            .neighbors = &neighbors,
+            .edges = with_edges ? &edges : nullptr,
+        };
+
+        ukv_graph_export_csr(&graph_export_csr);
+        if (!status)
+            return status;
+
+        std::size_t const neighbors_count = offsets[vertices_count];
+        return graph_csr_t {
+            {vertices, vertices + vertices_count},
+            {offsets, offsets + vertices_count + 1},
+            {neighbors, neighbors + neighbors_count},
+            {edges, edges ? edges + neighbors_count : nullptr},
+        };
+    }
+
+    /**
+     * @brief Samples up to `fanouts[hop]` neighbors per vertex on every hop from the given ones.
+     * @see `ukv_graph_sample_neighbors()`.
+     */
+    expected_gt<graph_sample_t> sample_neighbors( //
+        strided_range_gt<ukv_key_t const> vertices,
+        strided_range_gt<ukv_size_t const> fanouts,
+        ukv_vertex_role_t role = ukv_vertex_role_any_k,
+        bool with_replacement = false,
+        std::size_t seed = 0,
+        bool watch = true) noexcept {
+
+        status_t status;
+        ukv_length_t* hops_offsets = nullptr;
+        ukv_key_t* centers = nullptr;
+        ukv_key_t* neighbors = nullptr;
+        ukv_key_t* edges = nullptr;
+
+        ukv_graph_sample_neighbors_t graph_sample_neighbors {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .collection = collection_,
+            .tasks_count = vertices.count(),
+            .vertices = vertices.begin().get(),
+            .vertices_stride = vertices.stride(),
+            .role = role,
+            .fanouts_count = fanouts.count(),
+            .fanouts = fanouts.begin().get(),
+            .with_replacement = with_replacement,
+            .seed = seed,
+            .hops_offsets = &hops_offsets,
+            .centers = &centers,
+            .neighbors = &neighbors,
+            .edges = &edges,
+        };
+
+        ukv_graph_sample_neighbors(&graph_sample_neighbors);
+        if (!status)
+            return status;
+
+        std::size_t const sampled_count = hops_offsets[fanouts.count()];
+        return graph_sample_t {
+            {hops_offsets, hops_offsets + fanouts.count() + 1},
+            {centers, centers + sampled_count},
+            {neighbors, neighbors + sampled_count},
+            {edges, edges + sampled_count},
+        };
+    }
+
+    /**
+     * @brief Generates a walk of `walk_length` steps from each of the given vertices.
+     * @see `ukv_graph_random_walks()`.
+     */
+    expected_gt<random_walks_t> random_walks( //
+        strided_range_gt<ukv_key_t const> vertices,
+        std::size_t walk_length,
+        ukv_float_t restart_probability = 0,
+        ukv_float_t return_param = 1,
+        ukv_float_t inout_param = 1,
+        ukv_vertex_role_t role = ukv_vertex_role_any_k,
+        std::size_t seed = 0,
+        bool watch = true) noexcept {
+
+        status_t status;
+        ukv_key_t* walks = nullptr;
+
+        ukv_graph_random_walks_t graph_random_walks {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .collection = collection_,
+            .tasks_count = vertices.count(),
+            .vertices = vertices.begin().get(),
+            .vertices_stride = vertices.stride(),
+            .role = role,
+            .walk_length = walk_length,
+            .restart_probability = restart_probability,
+            .return_param = return_param,
+            .inout_param = inout_param,
+            .seed = seed,
+            .walks = &walks,
+        };
+
+        ukv_graph_random_walks(&graph_random_walks);
+        if (!status)
+            return status;
+
+        return random_walks_t {
+            {walks, walks + vertices.count() * (walk_length + 1)},
+            walk_length,
+        };
+    }
+
+    /**
+     * @brief Finds the common neighbors of every pair of `firsts` and `seconds`.
+     * @see `ukv_graph_common_neighbors()`.
+     */
+    expected_gt<common_neighbors_t> common_neighbors( //
+        strided_range_gt<ukv_key_t const> firsts,
+        strided_range_gt<ukv_key_t const> seconds,
+        ukv_vertex_role_t role = ukv_vertex_role_any_k,
+        bool watch = true) noexcept {
+
+        status_t status;
+        ukv_length_t* counts = nullptr;
+        ukv_length_t* offsets = nullptr;
+        ukv_key_t* neighbors = nullptr;
+
+        ukv_graph_common_neighbors_t graph_common_neighbors {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .collection = collection_,
+            .tasks_count = firsts.count(),
+            .first_vertices = firsts.begin().get(),
+            .first_vertices_stride = firsts.stride(),
+            .second_vertices = seconds.begin().get(),
+            .second_vertices_stride = seconds.stride(),
+            .role = role,
+            .counts = &counts,
+            .offsets = &offsets,
+            .neighbors = &neighbors,
+        };
+
+        ukv_graph_common_neighbors(&graph_common_neighbors);
+        if (!status)
+            return status;
+
+        return common_neighbors_t {
+            {counts, counts + firsts.count()},
+            {offsets, offsets + firsts.count() + 1},
+            {neighbors, neighbors + offsets[firsts.count()]},
+        };
+    }
+
+    /**
+     * @brief Counts the triangles and clustering coefficients of the given vertices.
+     * @see `ukv_graph_count_triangles()`.
+     */
+    expected_gt<triangles_t> count_triangles(strided_range_gt<ukv_key_t const> vertices, bool watch = true) noexcept {
+
+        status_t status;
+        ukv_size_t* triangles = nullptr;
+        ukv_float_t* clustering = nullptr;
+
+        ukv_graph_count_triangles_t graph_count_triangles {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .collection = collection_,
+            .tasks_count = vertices.count(),
+            .vertices = vertices.begin().get(),
+            .vertices_stride = vertices.stride(),
+            .triangles = &triangles,
+            .clustering = &clustering,
+        };
+
+        ukv_graph_count_triangles(&graph_count_triangles);
+        if (!status)
+            return status;
+
+        return triangles_t {
+            {triangles, triangles + vertices.count()},
+            {clustering, clustering + vertices.count()},
+        };
+    }
+
+    /**
+     * @brief Finds the shortest paths from every one of the `sources` to all vertices.
+     * @see `ukv_graph_shortest_paths()`.
+     */
+    expected_gt<shortest_paths_t> shortest_paths(strided_range_gt<ukv_key_t const> sources,
+                                                 ukv_vertex_role_t role = ukv_vertex_role_any_k,
+                                                 ukv_float_t max_distance = 0,
+                                                 std::size_t threads_count = 0,
+                                                 bool watch = true) noexcept {
+
+        status_t status;
+        ukv_size_t vertices_count = 0;
+        ukv_key_t* vertices = nullptr;
+        ukv_float_t* distances = nullptr;
+        ukv_key_t* predecessors = nullptr;
+        ukv_key_t* predecessors_edges = nullptr;
+
+        ukv_graph_shortest_paths_t graph_shortest_paths {
+            .db = db_,
+            .error = status.member_ptr(),
+            .transaction = transaction_,
+            .arena = arena_,
+            .options = !watch ? ukv_option_transaction_dont_watch_k : ukv_options_default_k,
+            .collection = collection_,
+            .tasks_count = sources.count(),
+            .sources = sources.begin().get(),
+            .sources_stride = sources.stride(),
+            .role = role,
+            .max_distance = max_distance,
+            .threads_count = threads_count,
+            .vertices_count = &vertices_count,
+            .vertices = &vertices,
+            .distances = &distances,
+            .predecessors = &predecessors,
+            .predecessors_edges = &predecessors_edges,
+        };
+
+        ukv_graph_shortest_paths(&graph_shortest_paths);
+        if (!status)
+            return status;
+
+        std::size_t const exported_count = vertices_count * sources.count();
+        return shortest_paths_t {
+            {vertices, vertices + vertices_count},
+            {distances, distances + exported_count},
+            {predecessors, predecessors + exported_count},
+            {predecessors_edges, predecessors_edges + exported_count},
+        };
+    }
+
     status_t export_adjacency_list(std::string const& path,
                                    std::string_view column_separator,
                                    std::string_view line_delimiter);
@@ -8,6 +8,8 @@
  */
 
 #pragma once
+#include <future> // `std::future`
+
 #include "ukv/graph.h"
 #include "ukv/cpp/ranges.hpp"      // `edges_span_t`
 #include "ukv/cpp/blobs_range.hpp" // `keys_stream_t`
@@ -17,9 +19,22 @@ namespace unum::ukv {
 /**
  * @brief A stream of all @c edge_t's in a graph.
  * No particular order is guaranteed.
+ *
+ * Outside of transactions, the edges of the next batch of vertices are gathered
+ * on a background thread, while the current one is being consumed, so the memory
+ * of the two batches is kept in separate arenas.
  */
 class graph_stream_t {
 
+    /**
+     * @brief Edges of a batch of vertices, together with the memory they live in.
+     */
+    struct gathered_edges_t {
+        arena_t arena;
+        status_t status;
+        edges_span_t edges;
+    };
+
     ukv_database_t db_ {nullptr};
     ukv_collection_t collection_ {ukv_collection_main_k};
     ukv_transaction_t transaction_ {nullptr};
@@ -29,26 +44,36 @@ class graph_stream_t {
     std::size_t fetched_offset_ {0};
 
     arena_t arena_;
+    arena_t spare_arena_;
+    /// Declared before the `next_edges_`, as the background gather reads its keys until joined.
     keys_stream_t vertex_stream_;
+    std::future<gathered_edges_t> next_edges_;
+    /// The `vertex_stream_` is positioned on the batch after the fetched one.
+    bool gathering_ahead_ {false};
 
-    status_t prefetch_gather() noexcept {
+    static gathered_edges_t gather(ukv_database_t db,
+                                   ukv_transaction_t txn,
+                                   ukv_collection_t collection,
+                                   ukv_vertex_role_t role,
+                                   ptr_range_gt<ukv_key_t const> vertices_range,
+                                   arena_t arena) noexcept {
 
-        auto vertices = vertex_stream_.keys_batch().strided();
+        auto vertices = vertices_range.strided();
 
         status_t status;
         ukv_vertex_degree_t* degrees_per_vertex = nullptr;
         ukv_key_t* edges_per_vertex = nullptr;
 
         ukv_graph_find_edges_t graph_find_edges {
-            .db = db_,
+            .db = db,
             .error = status.member_ptr(),
-            .transaction = transaction_,
-            .arena = arena_.member_ptr(),
+            .transaction = txn,
+            .arena = arena.member_ptr(),
             .tasks_count = vertices.count(),
-            .collections = &collection_,
+            .collections = &collection,
             .vertices = vertices.begin().get(),
             .vertices_stride = vertices.stride(),
-            .roles = &role_,
+            .roles = &role,
             .degrees_per_vertex = &degrees_per_vertex,
             .edges_per_vertex = &edges_per_vertex,
         };
@@ -56,17 +81,97 @@ class graph_stream_t {
         ukv_graph_find_edges(&graph_find_edges);
 
         if (!status)
-            return status;
+            return {std::move(arena), std::move(status), {}};
 
         auto edges_begin = reinterpret_cast<edge_t*>(edges_per_vertex);
         auto edges_count = transform_reduce_n(degrees_per_vertex, vertices.size(), 0ul, [](ukv_vertex_degree_t deg) {
             return deg == ukv_vertex_degree_missing_k ? 0 : deg;
         });
+        return {std::move(arena), {}, edges_span_t {edges_begin, edges_begin + edges_count}};
+    }
+
+    status_t adopt(gathered_edges_t gathered) noexcept {
+        if (!gathered.status) {
+            spare_arena_ = std::move(gathered.arena);
+            return std::move(gathered.status);
+        }
+
+        // The memory of the previous batch will be reused for the next one
+        std::swap(arena_, gathered.arena);
+        spare_arena_ = std::move(gathered.arena);
         fetched_offset_ = 0;
-        fetched_edges_ = {edges_begin, edges_begin + edges_count};
+        fetched_edges_ = gathered.edges;
+        return {};
+    }
+
+    /**
+     * @brief Moves the `vertex_stream_` to the next batch and starts gathering its edges
+     * on a background thread. The keys stay valid until the `vertex_stream_` moves again.
+     */
+    status_t gather_ahead() noexcept {
+        if (transaction_ || vertex_stream_.is_end())
+            return {};
+        status_t status = vertex_stream_.seek_to_next_batch();
+        if (!status)
+            return status;
+
+        gathering_ahead_ = true;
+        try {
+            next_edges_ = std::async(std::launch::async,
+                                     &graph_stream_t::gather,
+                                     db_,
+                                     transaction_,
+                                     collection_,
+                                     role_,
+                                     vertex_stream_.keys_batch(),
+                                     std::move(spare_arena_));
+        }
+        catch (...) {
+            // Without threads, the edges will be gathered synchronously
+            spare_arena_ = arena_t(db_);
+        }
         return {};
     }
 
+    /**
+     * @brief Waits for the background thread, before the `vertex_stream_` can be moved elsewhere.
+     */
+    void cancel_gathering() noexcept {
+        if (next_edges_.valid())
+            spare_arena_ = std::move(next_edges_.get().arena);
+        gathering_ahead_ = false;
+    }
+
+    status_t prefetch_gather() noexcept {
+        status_t status =
+            adopt(gather(db_, transaction_, collection_, role_, vertex_stream_.keys_batch(), std::move(spare_arena_)));
+        if (!status)
+            return status;
+        return gather_ahead();
+    }
+
+    status_t gather_next() noexcept {
+        if (!gathering_ahead_) {
+            auto status = vertex_stream_.seek_to_next_batch();
+            if (!status)
+                return status;
+            return prefetch_gather();
+        }
+
+        gathering_ahead_ = false;
+        status_t status = next_edges_.valid()
+                              ? adopt(next_edges_.get())
+                              : adopt(gather(db_,
+                                             transaction_,
+                                             collection_,
+                                             role_,
+                                             vertex_stream_.keys_batch(),
+                                             std::move(spare_arena_)));
+        if (!status)
+            return status;
+        return gather_ahead();
+    }
+
   public:
     using iterator_category = std::forward_iterator_tag;
     using difference_type = std::ptrdiff_t;
@@ -81,16 +186,32 @@ class graph_stream_t {
                    ukv_transaction_t txn = nullptr,
                    std::size_t read_ahead_vertices = keys_stream_t::default_read_ahead_k,
                    ukv_vertex_role_t role = ukv_vertex_role_any_k)
-        : db_(db), collection_(collection), transaction_(txn), role_(role), arena_(db),
+        : db_(db), collection_(collection), transaction_(txn), role_(role), arena_(db), spare_arena_(db),
           vertex_stream_(db, collection, read_ahead_vertices, txn) {}
 
     graph_stream_t(graph_stream_t&&) = default;
-    graph_stream_t& operator=(graph_stream_t&&) = default;
+    graph_stream_t& operator=(graph_stream_t&& other) noexcept {
+        cancel_gathering();
+        db_ = other.db_;
+        collection_ = other.collection_;
+        transaction_ = other.transaction_;
+        role_ = other.role_;
+        fetched_edges_ = other.fetched_edges_;
+        fetched_offset_ = other.fetched_offset_;
+        arena_ = std::move(other.arena_);
+        spare_arena_ = std::move(other.spare_arena_);
+        vertex_stream_ = std::move(other.vertex_stream_);
+        next_edges_ = std::move(other.next_edges_);
+        gathering_ahead_ = std::exchange(other.gathering_ahead_, false);
+        return *this;
+    }
+    ~graph_stream_t() noexcept { cancel_gathering(); }
 
     graph_stream_t(graph_stream_t const&) = delete;
     graph_stream_t& operator=(graph_stream_t const&) = delete;
 
     status_t seek(ukv_key_t vertex_id) noexcept {
+        cancel_gathering();
         auto status = vertex_stream_.seek(vertex_id);
         if (!status)
             return status;
@@ -99,14 +220,17 @@ class graph_stream_t {
 
     status_t advance() noexcept {
 
-        if (fetched_offset_ >= fetched_edges_.size() - 1) {
-            auto status = vertex_stream_.seek_to_next_batch();
-            if (!status)
-                return status;
-            return prefetch_gather();
+        if (fetched_offset_ + 1 < fetched_edges_.size()) {
+            ++fetched_offset_;
+            return {};
         }
 
-        ++fetched_offset_;
+        // Skip the batches of vertices without edges
+        do {
+            auto status = gather_next();
+            if (!status)
+                return status;
+        } while (!fetched_edges_.size() && !is_end());
         return {};
     }
 
@@ -128,12 +252,7 @@ class graph_stream_t {
     edge_t edge() const noexcept { return fetched_edges_[fetched_offset_]; }
     edge_t operator*() const noexcept { return edge(); }
     status_t seek_to_first() noexcept { return seek(std::numeric_limits<ukv_key_t>::min()); }
-    status_t seek_to_next_batch() noexcept {
-        auto status = vertex_stream_.seek_to_next_batch();
-        if (!status)
-            return status;
-        return prefetch_gather();
-    }
+    status_t seek_to_next_batch() noexcept { return gather_next(); }
 
     /**
      * @brief Exposes all the fetched edges at once, including the passed ones.
@@ -144,15 +263,17 @@ class graph_stream_t {
         return fetched_edges_;
     }
 
-    bool is_end() const noexcept { return vertex_stream_.is_end() && fetched_offset_ >= fetched_edges_.size(); }
+    bool is_end() const noexcept {
+        return !gathering_ahead_ && vertex_stream_.is_end() && fetched_offset_ >= fetched_edges_.size();
+    }
 
     bool operator==(graph_stream_t const& other) const noexcept {
-        return vertex_stream_ == other.vertex_stream_ && fetched_offset_ == other.fetched_offset_;
+        if (is_end() || other.is_end())
+            return is_end() == other.is_end();
+        return fetched_offset_ == other.fetched_offset_ && edge() == other.edge();
     }
 
-    bool operator!=(graph_stream_t const& other) const noexcept {
-        return vertex_stream_ != other.vertex_stream_ || fetched_offset_ != other.fetched_offset_;
-    }
+    bool operator!=(graph_stream_t const& other) const noexcept { return !operator==(other); }
 };
 
 } // namespace unum::ukv
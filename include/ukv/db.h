@@ -188,6 +188,14 @@ typedef enum {
      * Apache Arrow buffers or standardized Tensor representations.
      */
     ukv_option_read_shared_memory_k = 1 << 5,
+    /**
+     * @brief Allows exporting views into the internal buffers, that the values
+     * were fetched into, instead of copying them into a separate tape.
+     * Is relevant for modalities, that pack many values into one entry,
+     * like `ukv_paths_read()`. The exported offsets may not be monotonic
+     * and the values may not be NULL-terminated, so the lengths must be used.
+     */
+    ukv_option_read_dont_copy_k = 1 << 6,
     /**
      * @brief When set, the underlying engine may avoid strict keys ordering
      * and may include irrelevant (deleted & duplicate) keys in order to maximize
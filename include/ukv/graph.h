@@ -123,6 +123,12 @@ extern ukv_vertex_degree_t ukv_vertex_degree_missing_k;
  * The `ukv_read()` on these same `collections` will return the presence
  * indicators for vertices. For edges, you will have to check the
  * collection that stores the metadata of the edges.
+ *
+ * ## Degrees Only
+ *
+ * If `edges_per_vertex` is NULL, only the degrees are exported. If the collection
+ * has a degrees index, built with `ukv_graph_index_degrees()`, those are read from
+ * it, without fetching the neighborhoods of the vertices.
  */
 typedef struct ukv_graph_find_edges_t {
 
@@ -174,9 +180,97 @@ typedef struct ukv_graph_find_edges_t {
  */
 void ukv_graph_find_edges(ukv_graph_find_edges_t*);
 
+/**
+ * @brief Breadth-first traversal, expanding the given vertices up to a fixed depth.
+ * @see `ukv_graph_traverse()`.
+ *
+ * All the `vertices` are traversed together, forming the first level.
+ * Every next level contains the vertices, connected to the previous one,
+ * that haven't been visited before. The frontier is deduplicated inside
+ * the engine, so multi-hop neighborhoods take a single call.
+ *
+ * ## Output Form
+ *
+ * Visited vertices are exported level by level, sorted within every level.
+ * The `levels_offsets` contain `levels_count + 1` entries, so that the `i`-th
+ * level spans from `levels_offsets[i]` to `levels_offsets[i + 1]`.
+ * Missing starting vertices are skipped, so the first level may be empty.
+ *
+ * Neighbors are always looked up in the same collection as the vertex,
+ * from which they were reached.
+ */
+typedef struct ukv_graph_traverse_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_size_t tasks_count;
+
+    ukv_collection_t const* collections;
+    ukv_size_t collections_stride;
+
+    ukv_key_t const* vertices;
+    ukv_size_t vertices_stride;
+
+    /**
+     * @brief The role of visited vertices in the edges to follow: sources for outgoing edges,
+     * targets for incoming ones. Unknown role is treated as `::ukv_vertex_role_any_k`.
+     */
+    ukv_vertex_role_t role;
+    /** @brief Maximum number of hops from the starting vertices. Zero only checks their presence. */
+    ukv_size_t max_depth;
+    /**
+     * @brief Optional limit on the number of visited vertices. The traversal stops at the level,
+     * where it is reached, keeping only the smallest keys of that level. Zero means no limit.
+     */
+    ukv_size_t max_vertices;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    /** @brief Number of exported levels. The first one is exported, even if it's empty. */
+    ukv_size_t* levels_count;
+    ukv_length_t** levels_offsets;
+    /** @brief Optional collections of visited vertices. */
+    ukv_collection_t** visited_collections;
+    ukv_key_t** visited_vertices;
+
+    /// @}
+
+} ukv_graph_traverse_t;
+
+/**
+ * @brief Breadth-first traversal, expanding the given vertices up to a fixed depth.
+ * @see `ukv_graph_traverse_t`.
+ */
+void ukv_graph_traverse(ukv_graph_traverse_t*);
+
 /**
  * @brief Inserts edges between provided vertices.
  * @see `ukv_graph_upsert_edges()`.
+ *
+ * ## Weights
+ *
+ * Edges with IDs can carry `ukv_float_t` weights, used by `ukv_graph_shortest_paths()`.
+ * Those are kept in an internal collection, keyed by edge IDs, and are updated in
+ * the same transaction as the neighborhoods. Upserts without `weights` preserve the
+ * existing ones, while removals drop them. Needs named collections.
  */
 typedef struct ukv_graph_upsert_edges_t {
 
@@ -211,6 +305,10 @@ typedef struct ukv_graph_upsert_edges_t {
     ukv_key_t const* targets_ids;
     ukv_size_t targets_stride;
 
+    /** @brief Optional non-negative weights. Weighted edges can't have default IDs. */
+    ukv_float_t const* weights;
+    ukv_size_t weights_stride;
+
     /// @}
 
 } ukv_graph_upsert_edges_t;
@@ -314,6 +412,9 @@ void ukv_graph_upsert_vertices(ukv_graph_upsert_vertices_t*);
 /**
  * @brief Removes vertices and all related edges from the graph.
  * @see `ukv_graph_remove_vertices()`.
+ *
+ * The removed vertices are read once, and all of their neighbors - in one more
+ * batched read, after which all the touched entries are written back at once.
  */
 typedef struct ukv_graph_remove_vertices_t { //
 
@@ -358,6 +459,716 @@ typedef struct ukv_graph_remove_vertices_t { //
  */
 void ukv_graph_remove_vertices(ukv_graph_remove_vertices_t*);
 
+/**
+ * @brief Removes all the vertices with keys in `[min_key, max_key)` and all related edges.
+ * @see `ukv_graph_remove_vertices_range()`.
+ *
+ * Useful for pruning stale subgraphs. Vertices are scanned and removed in batches,
+ * just like with `ukv_graph_remove_vertices()`. Within a transaction, the whole
+ * range is removed atomically. Otherwise, every batch is committed on its own.
+ */
+typedef struct ukv_graph_remove_vertices_range_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Scan, Read and Write options. @see `ukv_scan_t`, `ukv_read_t`, `ukv_write_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    /** @brief The smallest key to remove. */
+    ukv_key_t min_key;
+    /** @brief The key after the last one to remove. */
+    ukv_key_t max_key;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    /** @brief Optional number of removed vertices. */
+    ukv_size_t* removed_count;
+
+    /// @}
+
+} ukv_graph_remove_vertices_range_t;
+
+/**
+ * @brief Removes all the vertices with keys in a range and all related edges.
+ * @see `ukv_graph_remove_vertices_range_t`.
+ */
+void ukv_graph_remove_vertices_range(ukv_graph_remove_vertices_range_t*);
+
+/*********************************************************/
+/*****************	      Edge Index      ****************/
+/*********************************************************/
+
+/**
+ * @brief Builds an index, that maps edge IDs to their ends, for a graph collection.
+ * @see `ukv_graph_index_edges()`.
+ *
+ * The index is optional and is kept in an internal collection next to the graph.
+ * Once built, it is maintained by every upsert and removal of edges and vertices,
+ * inside the same transaction, so that `ukv_graph_find_edges_by_id()` is a single
+ * point lookup. Edges with the `ukv_default_edge_id_k` are not indexed. Edge IDs
+ * are expected to be unique within a collection: reusing one overwrites the entry.
+ *
+ * Requires the engine to support named collections. Building an existing index
+ * again refreshes it with the edges, that are currently present.
+ */
+typedef struct ukv_graph_index_edges_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read and Write options. @see `ukv_read_t`, `ukv_write_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+
+    /// @}
+
+} ukv_graph_index_edges_t;
+
+/**
+ * @brief Builds an index, that maps edge IDs to their ends, for a graph collection.
+ * @see `ukv_graph_index_edges_t`.
+ */
+void ukv_graph_index_edges(ukv_graph_index_edges_t*);
+
+/**
+ * @brief Resolves edge IDs to their source and target vertices, using the edge index.
+ * @see `ukv_graph_find_edges_by_id()`.
+ *
+ * Fails, if the edge index of any of the `collections` wasn't built with `ukv_graph_index_edges()`.
+ *
+ * ## Output Form
+ *
+ * Exports `sources` and `targets` for every task. Missing edges are exported with
+ * `ukv_key_unknown_k` ends and a zero bit in the optional `presences`.
+ */
+typedef struct ukv_graph_find_edges_by_id_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_size_t tasks_count;
+
+    ukv_collection_t const* collections;
+    ukv_size_t collections_stride;
+
+    ukv_key_t const* edges_ids;
+    ukv_size_t edges_stride;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    /** @brief Optional bitset of found edges. */
+    ukv_octet_t** presences;
+    ukv_key_t** sources;
+    ukv_key_t** targets;
+
+    /// @}
+
+} ukv_graph_find_edges_by_id_t;
+
+/**
+ * @brief Resolves edge IDs to their source and target vertices, using the edge index.
+ * @see `ukv_graph_find_edges_by_id_t`.
+ */
+void ukv_graph_find_edges_by_id(ukv_graph_find_edges_by_id_t*);
+
+/*********************************************************/
+/*****************	    Degrees Index     ****************/
+/*********************************************************/
+
+/**
+ * @brief Builds an index of vertex degrees for a graph collection.
+ * @see `ukv_graph_index_degrees()`.
+ *
+ * The index is optional and is kept in an internal collection next to the graph,
+ * storing just the outgoing and incoming degrees of every vertex. Once built,
+ * it is maintained by every upsert and removal of edges and vertices, inside the
+ * same transaction. Degree-only `ukv_graph_find_edges()` calls then read a few bytes
+ * per vertex, instead of the whole neighborhood, which matters most for hubs.
+ *
+ * Requires the engine to support named collections. Building an existing index
+ * again refreshes it with the vertices, that are currently present.
+ */
+typedef struct ukv_graph_index_degrees_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read and Write options. @see `ukv_read_t`, `ukv_write_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+
+    /// @}
+
+} ukv_graph_index_degrees_t;
+
+/**
+ * @brief Builds an index of vertex degrees for a graph collection.
+ * @see `ukv_graph_index_degrees_t`.
+ */
+void ukv_graph_index_degrees(ukv_graph_index_degrees_t*);
+
+/*********************************************************/
+/*****************	      Analytics       ****************/
+/*********************************************************/
+
+typedef enum ukv_graph_algorithm_t {
+    /** @brief Scores vertices by the stationary distribution of a random walk along outgoing edges. */
+    ukv_graph_pagerank_k = 0,
+    /** @brief Labels vertices, connected by edges in any direction. */
+    ukv_graph_weakly_connected_components_k = 1,
+    /** @brief Labels communities, greedily maximizing the modularity of the undirected graph. */
+    ukv_graph_louvain_k = 2,
+} ukv_graph_algorithm_t;
+
+/**
+ * @brief Runs a whole-graph algorithm over every vertex of a collection.
+ * @see `ukv_graph_analyze()`.
+ *
+ * The neighborhoods of all vertices are fetched in parallel into a transient
+ * Compressed Sparse Row representation, which is discarded once the results
+ * are exported. If a `transaction` is passed, it is used from a single thread.
+ *
+ * ## Output Form
+ *
+ * All present vertices are exported in sorted order. PageRank exports `scores`,
+ * summing up to one. Components and communities export `labels`, where every
+ * label is the smallest vertex ID in its group. Optionally, the results are also
+ * written into the `results_collection`, as binary `ukv_float_t` scores or
+ * `ukv_key_t` labels under the keys of the vertices.
+ */
+typedef struct ukv_graph_analyze_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read and Write options. @see `ukv_read_t`, `ukv_write_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    ukv_graph_algorithm_t algorithm;
+
+    /** @brief Limit on PageRank iterations or Louvain levels. Zero picks 100 and 10 respectively. */
+    ukv_size_t max_iterations;
+    /** @brief PageRank damping factor. Zero picks 0.85. */
+    ukv_float_t damping;
+    /** @brief Louvain resolution, where bigger values favor smaller communities. Zero picks 1. */
+    ukv_float_t resolution;
+    /**
+     * @brief Convergence threshold: for the L1 change of PageRank scores per vertex and for the modularity
+     * gain of a Louvain level. Zero picks 1e-6 and 1e-7 respectively.
+     */
+    ukv_float_t tolerance;
+    /** @brief Number of threads to use. Zero means all hardware threads. */
+    ukv_size_t threads_count;
+    /** @brief Optional collection, where the results will be written. */
+    ukv_collection_t const* results_collection;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    ukv_size_t* vertices_count;
+    ukv_key_t** vertices;
+    /** @brief PageRank scores. */
+    ukv_float_t** scores;
+    /** @brief Component or community labels. */
+    ukv_key_t** labels;
+
+    /// @}
+
+} ukv_graph_analyze_t;
+
+/**
+ * @brief Runs a whole-graph algorithm over every vertex of a collection.
+ * @see `ukv_graph_analyze_t`.
+ */
+void ukv_graph_analyze(ukv_graph_analyze_t*);
+
+/**
+ * @brief Exports a whole graph collection in the Compressed Sparse Row form.
+ * @see `ukv_graph_export_csr()`.
+ *
+ * Like in `ukv_graph_analyze_t`, the neighborhoods of all vertices are fetched
+ * in parallel, so that the whole graph can be passed to SciPy, cuGraph or PyG
+ * without per-edge round-trips. For Apache Arrow, @see `ukv_graph_csr_to_arrow()`.
+ *
+ * ## Output Form
+ *
+ * All present vertices are exported in sorted order. The neighbors of the `i`-th
+ * vertex span from `offsets[i]` to `offsets[i + 1]` in `neighbors` and `edges`.
+ * Neighbors are exported as indexes in `vertices`, rather than IDs, matching the
+ * `indptr` and `indices` arrays of SciPy. With `ukv_vertex_role_any_k`, outgoing
+ * neighbors precede incoming ones, and every edge is exported from both sides.
+ */
+typedef struct ukv_graph_export_csr_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    /** @brief Source role exports outgoing edges. Unknown role is treated as any. */
+    ukv_vertex_role_t role;
+    /** @brief Number of threads to use. Zero means all hardware threads. */
+    ukv_size_t threads_count;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    ukv_size_t* vertices_count;
+    ukv_key_t** vertices;
+    /** @brief Exports `vertices_count + 1` offsets into `neighbors`. */
+    ukv_size_t** offsets;
+    ukv_size_t** neighbors;
+    /** @brief Optional edge IDs, matching the `neighbors`. */
+    ukv_key_t** edges;
+
+    /// @}
+
+} ukv_graph_export_csr_t;
+
+/**
+ * @brief Exports a whole graph collection in the Compressed Sparse Row form.
+ * @see `ukv_graph_export_csr_t`.
+ */
+void ukv_graph_export_csr(ukv_graph_export_csr_t*);
+
+/*********************************************************/
+/*****************	       Sampling       ****************/
+/*********************************************************/
+
+/**
+ * @brief Samples multi-hop neighborhoods of the given vertices, like GNN mini-batch loaders.
+ * @see `ukv_graph_sample_neighbors()`.
+ *
+ * The deduplicated `vertices` form the first frontier. On every hop, at most `fanouts[hop]`
+ * neighbors of every frontier vertex are sampled, and the ones, that weren't reached before,
+ * form the next frontier. Neighborhoods are decoded inside the engine, so only the sampled
+ * edges are exported, regardless of the degrees of hub vertices.
+ *
+ * ## Output Form
+ *
+ * Sampled edges are exported hop by hop, as `centers`, `neighbors` and `edges` arrays.
+ * The `hops_offsets` contain `fanouts_count + 1` entries, so that the `i`-th hop spans
+ * from `hops_offsets[i]` to `hops_offsets[i + 1]`. Within a hop, edges are grouped by
+ * center, in ascending order of centers. Missing vertices have no neighbors.
+ */
+typedef struct ukv_graph_sample_neighbors_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    ukv_size_t tasks_count;
+    ukv_key_t const* vertices;
+    ukv_size_t vertices_stride;
+
+    /** @brief Source role samples outgoing edges. Unknown role is treated as any. */
+    ukv_vertex_role_t role;
+    /** @brief Number of hops. */
+    ukv_size_t fanouts_count;
+    /** @brief Limits on the number of neighbors, sampled per vertex on every hop. Zero keeps all. */
+    ukv_size_t const* fanouts;
+    /** @brief Draws exactly `fanout` neighbors of every non-isolated vertex, allowing repetitions. */
+    bool with_replacement;
+    /** @brief Seed of the pseudo-random generator, so that samples can be reproduced. */
+    ukv_size_t seed;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    ukv_length_t** hops_offsets;
+    ukv_key_t** centers;
+    ukv_key_t** neighbors;
+    /** @brief Optional edge IDs, matching the `neighbors`. */
+    ukv_key_t** edges;
+
+    /// @}
+
+} ukv_graph_sample_neighbors_t;
+
+/**
+ * @brief Samples multi-hop neighborhoods of the given vertices, like GNN mini-batch loaders.
+ * @see `ukv_graph_sample_neighbors_t`.
+ */
+void ukv_graph_sample_neighbors(ukv_graph_sample_neighbors_t*);
+
+/**
+ * @brief Generates random walks from the given vertices, optionally biased like in node2vec.
+ * @see `ukv_graph_random_walks()`.
+ *
+ * On every step a walk moves to a random neighbor of its current vertex or, with
+ * `restart_probability`, jumps back to the vertex it started from. With the default
+ * `return_param` and `inout_param` the neighbors are chosen uniformly. Otherwise,
+ * the second-order bias of node2vec is applied: going back to the previous vertex is
+ * weighted by `1 / p`, staying next to it - by one, and moving away - by `1 / q`.
+ * Biased steps are drawn by rejection sampling, without materializing the weights.
+ *
+ * ## Output Form
+ *
+ * Every walk is exported as `walk_length + 1` vertices, starting with the passed one.
+ * Walks, that reach a vertex without neighbors, are padded with `ukv_key_unknown_k`.
+ */
+typedef struct ukv_graph_random_walks_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    ukv_size_t tasks_count;
+    ukv_key_t const* vertices;
+    ukv_size_t vertices_stride;
+
+    /** @brief Source role follows outgoing edges. Unknown role is treated as any. */
+    ukv_vertex_role_t role;
+    /** @brief Number of steps in every walk. */
+    ukv_size_t walk_length;
+    /** @brief Probability of jumping back to the starting vertex on every step. */
+    ukv_float_t restart_probability;
+    /** @brief The `p` parameter of node2vec. Zero picks 1. */
+    ukv_float_t return_param;
+    /** @brief The `q` parameter of node2vec. Zero picks 1. */
+    ukv_float_t inout_param;
+    /** @brief Seed of the pseudo-random generator, so that walks can be reproduced. */
+    ukv_size_t seed;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    /** @brief Exports `tasks_count * (walk_length + 1)` vertices. */
+    ukv_key_t** walks;
+
+    /// @}
+
+} ukv_graph_random_walks_t;
+
+/**
+ * @brief Generates random walks from the given vertices, optionally biased like in node2vec.
+ * @see `ukv_graph_random_walks_t`.
+ */
+void ukv_graph_random_walks(ukv_graph_random_walks_t*);
+
+/*********************************************************/
+/*****************	    Intersections     ****************/
+/*********************************************************/
+
+/**
+ * @brief Finds the common neighbors of pairs of vertices, as used for link prediction.
+ * @see `ukv_graph_common_neighbors()`.
+ *
+ * Neighborhoods are intersected inside the engine, with AVX-512 or AVX2 when available,
+ * and by galloping through the longer one, if their sizes differ a lot. Every neighbor
+ * is counted once, regardless of the number of edges connecting it.
+ *
+ * ## Output Form
+ *
+ * The `counts` are exported for every task. If requested, the common neighbors of the
+ * `i`-th pair are exported in ascending order, spanning from `offsets[i]` to `offsets[i + 1]`.
+ */
+typedef struct ukv_graph_common_neighbors_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    ukv_size_t tasks_count;
+
+    ukv_key_t const* first_vertices;
+    ukv_size_t first_vertices_stride;
+
+    ukv_key_t const* second_vertices;
+    ukv_size_t second_vertices_stride;
+
+    /** @brief Source role intersects outgoing neighbors. Unknown role is treated as any. */
+    ukv_vertex_role_t role;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    ukv_length_t** counts;
+    /** @brief Optional offsets of `tasks_count + 1` entries into `neighbors`. */
+    ukv_length_t** offsets;
+    /** @brief Optional common neighbors. */
+    ukv_key_t** neighbors;
+
+    /// @}
+
+} ukv_graph_common_neighbors_t;
+
+/**
+ * @brief Finds the common neighbors of pairs of vertices, as used for link prediction.
+ * @see `ukv_graph_common_neighbors_t`.
+ */
+void ukv_graph_common_neighbors(ukv_graph_common_neighbors_t*);
+
+/**
+ * @brief Counts the triangles, every one of the given vertices belongs to.
+ * @see `ukv_graph_count_triangles()`.
+ *
+ * Edges are treated as undirected, ignoring their direction, multiplicity and self-loops.
+ * The triangles of a vertex are counted by intersecting its neighborhood with the ones of
+ * its neighbors, fetched in batches, so nothing but the counts leaves the engine.
+ *
+ * ## Output Form
+ *
+ * Exports the number of `triangles` for every task and, optionally, the local `clustering`
+ * coefficient: the share of pairs of neighbors, which are connected themselves.
+ */
+typedef struct ukv_graph_count_triangles_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    ukv_size_t tasks_count;
+    ukv_key_t const* vertices;
+    ukv_size_t vertices_stride;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    ukv_size_t** triangles;
+    /** @brief Optional local clustering coefficients. */
+    ukv_float_t** clustering;
+
+    /// @}
+
+} ukv_graph_count_triangles_t;
+
+/**
+ * @brief Counts the triangles, every one of the given vertices belongs to.
+ * @see `ukv_graph_count_triangles_t`.
+ */
+void ukv_graph_count_triangles(ukv_graph_count_triangles_t*);
+
+/*********************************************************/
+/*****************	    Shortest Paths    ****************/
+/*********************************************************/
+
+/**
+ * @brief Finds the shortest paths from every one of the given vertices to all others.
+ * @see `ukv_graph_shortest_paths()`.
+ *
+ * Like in `ukv_graph_analyze_t`, the neighborhoods of all vertices are fetched in
+ * parallel into a transient CSR, together with the weights of the edges, which are
+ * then searched with Dijkstra's algorithm, one source per thread at a time.
+ * Edges without weights weigh one, so unweighted graphs yield hop counts.
+ *
+ * ## Output Form
+ *
+ * All present vertices are exported in sorted order. For the `i`-th task, the
+ * distance to the `j`-th vertex is in `distances[i * vertices_count + j]`, and
+ * is infinite, if the vertex is unreachable or farther than `max_distance`.
+ * The `predecessors` and the `predecessors_edges` on the path from the source
+ * are laid out the same way, and are `ukv_key_unknown_k` for the source itself
+ * and the unreachable vertices.
+ */
+typedef struct ukv_graph_shortest_paths_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read options. @see `ukv_read_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    ukv_size_t tasks_count;
+    ukv_key_t const* sources;
+    ukv_size_t sources_stride;
+    /**
+     * @brief Edges to follow: the outgoing ones for `ukv_vertex_source_k`, the incoming ones
+     * for `ukv_vertex_target_k`, and all of them for `ukv_vertex_role_any_k`, the default.
+     */
+    ukv_vertex_role_t role;
+    /** @brief Vertices beyond that distance are treated as unreachable. Zero means no limit. */
+    ukv_float_t max_distance;
+    /** @brief Number of threads to use. Zero means all hardware threads. */
+    ukv_size_t threads_count;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    ukv_size_t* vertices_count;
+    ukv_key_t** vertices;
+    ukv_float_t** distances;
+    /** @brief Optional IDs of the previous vertices on the shortest paths. */
+    ukv_key_t** predecessors;
+    /** @brief Optional IDs of the last edges on the shortest paths. */
+    ukv_key_t** predecessors_edges;
+
+    /// @}
+
+} ukv_graph_shortest_paths_t;
+
+/**
+ * @brief Finds the shortest paths from every one of the given vertices to all others.
+ * @see `ukv_graph_shortest_paths_t`.
+ */
+void ukv_graph_shortest_paths(ukv_graph_shortest_paths_t*);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
@@ -148,6 +148,11 @@ typedef struct ukv_paths_read_t {
     /// @name Outputs
     /// @{
     ukv_octet_t** presences;
+    /**
+     * @brief Offsets of values in the exported `values` tape.
+     * With `::ukv_option_read_dont_copy_k` they point into the fetched buckets,
+     * so they aren't monotonic and the `lengths` must be used to slice values.
+     */
     ukv_length_t** offsets;
     ukv_length_t** lengths;
     ukv_byte_t** values;
@@ -162,6 +167,17 @@ typedef struct ukv_paths_read_t {
  */
 void ukv_paths_read(ukv_paths_read_t*);
 
+/**
+ * @brief Opaque position, where a listing of paths stopped.
+ * Zero-initialized cursors start from the beginning.
+ * @see `ukv_paths_match_t`.
+ */
+typedef struct ukv_paths_cursor_t {
+    ukv_key_t key;
+    ukv_length_t offset;
+    ukv_length_t flags;
+} ukv_paths_cursor_t;
+
 /**
  * @brief Vectorized "Prefix" and RegEx "Pattern Matching" for paths.
  * @see `ukv_paths_match()`.
@@ -169,6 +185,19 @@ void ukv_paths_read(ukv_paths_read_t*);
  * If a "pattern" contains RegEx special symbols, than it is
  * treated as a RegEx pattern: ., +, *, ?, ^, $, (, ), [, ], {, }, |, \.
  * Otherwise, it is treated as a prefix for search.
+ *
+ * Unless an ordered index is available, the whole collection is scanned,
+ * optionally split into key ranges between `threads_count` threads. Literal parts of RegEx patterns,
+ * that every match must contain, are searched for first, and only paths
+ * containing them are passed to the RegEx engine.
+ *
+ * ## Pagination
+ *
+ * Results can be paginated by passing the last path of the previous page
+ * in `previous`, which has to be hashed and found again, or by passing
+ * the `cursors` exported with the previous page, which address the position
+ * right after it. Cursors make deep pagination linear, but stay exact only while
+ * the collection isn't modified. Otherwise, paths may be skipped or repeated.
  */
 typedef struct ukv_paths_match_t {
 
@@ -221,14 +250,25 @@ typedef struct ukv_paths_match_t {
 
     ukv_length_t const* previous_lengths;
     ukv_size_t previous_lengths_stride;
+
+    /** @brief Positions, where the previous pages stopped. If set, the `previous` paths are ignored. */
+    ukv_paths_cursor_t const* cursors;
+    ukv_size_t cursors_stride;
     /// @}
 
+    /** @brief Number of threads to scan with, outside of transactions. Zero means the calling thread only. */
+    ukv_size_t threads_count;
+
     /// @}
     /// @name Outputs
     /// @{
     ukv_length_t** match_counts;
     ukv_length_t** paths_offsets;
     ukv_char_t** paths_strings;
+    /** @brief Positions to continue from with the next pages, if the `match_counts_limits` were reached. */
+    ukv_paths_cursor_t** cursors_next;
+    /** @brief Bitset of tasks, which have no more matches to export with the next pages. */
+    ukv_octet_t** cursors_exhausted;
     /// @}
 
 } ukv_paths_match_t;
@@ -239,6 +279,109 @@ typedef struct ukv_paths_match_t {
  */
 void ukv_paths_match(ukv_paths_match_t*);
 
+/**
+ * @brief Builds an ordered index of paths for a collection.
+ * @see `ukv_paths_index()`.
+ *
+ * Paths are hashed into buckets, so without an index every `ukv_paths_match()`
+ * has to scan the whole collection. The index is optional and is kept in an internal
+ * collection next to the paths: a directory of sorted front-coded runs of paths.
+ * Once built, it is maintained by every `ukv_paths_write()`, inside the same transaction.
+ * Prefix matches are then served in lexicographic order, fetching only the runs, that may
+ * contain matching paths. That way, listing a "directory" is just a prefix scan with the
+ * `path_separator` at the end of the prefix, and no mirror entries have to be kept.
+ *
+ * Requires the engine to support named collections. Building an existing index
+ * again refreshes and compacts it with the paths, that are currently present.
+ */
+typedef struct ukv_paths_index_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read and Write options. @see `ukv_read_t`, `ukv_write_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+
+    /// @}
+
+} ukv_paths_index_t;
+
+/**
+ * @brief Builds an ordered index of paths for a collection.
+ * @see `ukv_paths_index_t`.
+ */
+void ukv_paths_index(ukv_paths_index_t*);
+
+/**
+ * @brief Moves paths into the buckets, that the current hash function assigns them to.
+ * @see `ukv_paths_migrate()`.
+ *
+ * Paths are hashed with a stable seeded function, that doesn't depend on the standard
+ * library or the platform, so collections can be shared between builds and machines.
+ * Collections, written by older versions, which used `std::hash`, must be migrated once.
+ * The current format is recorded in every collection, and until a non-empty collection
+ * without that record is migrated, writes into it fail with a "needs migration" error.
+ * So do the reads, that miss some of the paths, and the matches, that continue after
+ * a `previous` path, as only those depend on hashing. Migrating an up-to-date collection
+ * moves nothing.
+ *
+ * Large collections are migrated in chunks, and paths are removed from the outdated buckets
+ * only after they were written into the new ones. So an interrupted migration loses nothing,
+ * and can simply be repeated.
+ */
+typedef struct ukv_paths_migrate_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read and Write options. @see `ukv_read_t`, `ukv_write_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+
+    /// @}
+    /// @name Outputs
+    /// @{
+
+    /** @brief Optional output for the number of moved paths. */
+    ukv_size_t* moved_count;
+
+    /// @}
+
+} ukv_paths_migrate_t;
+
+/**
+ * @brief Moves paths into the buckets, that the current hash function assigns them to.
+ * @see `ukv_paths_migrate_t`.
+ */
+void ukv_paths_migrate(ukv_paths_migrate_t*);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
\ No newline at end of file
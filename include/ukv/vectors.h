@@ -41,6 +41,9 @@ typedef enum {
  * same dimensionality and their scalar components would form
  * continuous chunks, we need less arguments for this call,
  * than some binary methods.
+ *
+ * Originals are stored in the provided collections, while their
+ * quantized copies go into internal companion collections.
  */
 typedef struct ukv_vectors_write_t {
 
@@ -94,6 +97,11 @@ void ukv_vectors_write(ukv_vectors_write_t*);
  * @brief Retrieves binary representations of vectors.
  * Generalization of @c ukv_read_t to numerical vectors.
  * Packs everything into a @b row-major dense matrix.
+ *
+ * Every row is `dimensions` scalars of `scalar_type`, converted if the vector
+ * was written in a different type. If the original is missing, but a quantized
+ * copy or PQ codes remain, the row is reconstructed from those. Rows that can't
+ * be recovered are zero-filled and marked in `presences`.
  * @see `ukv_vectors_read()`, `ukv_read_t`, `ukv_read()`.
  */
 typedef struct ukv_vectors_read_t {
@@ -126,14 +134,20 @@ typedef struct ukv_vectors_read_t {
     ukv_key_t const* keys;
     ukv_size_t keys_stride;
 
-    /// @}
-
     /// @}
     /// @name Outputs
     /// @{
+
+    /** @brief Bitset marking the rows, that were found. */
     ukv_octet_t** presences;
+    /**
+     * @brief `tasks_count + 1` offsets of rows in `vectors`, compatible with
+     * Apache Arrow. As rows are equally sized, can be dropped for `FixedSizeList`.
+     */
     ukv_length_t** offsets;
+    /** @brief Dense `tasks_count` by `dimensions` matrix, aligned to 64 bytes. */
     ukv_byte_t** vectors;
+
     /// @}
 
 } ukv_vectors_read_t;
@@ -148,6 +162,11 @@ void ukv_vectors_read(ukv_vectors_read_t*);
 /**
  * @brief Performs K-Approximate Nearest Neighbors Search.
  * @see `ukv_vectors_search()`.
+ *
+ * Results are sorted from the closest to the farthest. If the collection
+ * has a trained codebook, @see `ukv_vectors_train()`, only the compact
+ * PQ codes are scanned, and the best candidates are re-ranked against
+ * the original vectors, reporting exact metrics.
  */
 typedef struct ukv_vectors_search_t {
 
@@ -188,6 +207,35 @@ typedef struct ukv_vectors_search_t {
     ukv_length_t const* queries_offsets;
     ukv_size_t queries_offsets_stride;
 
+    /// @}
+    /// @name Filters
+    /// @{
+
+    /** @brief Optional inclusive lower bounds of matched keys, one per query. */
+    ukv_key_t const* start_keys;
+    ukv_size_t start_keys_stride;
+    /** @brief Optional exclusive upper bounds of matched keys, one per query. */
+    ukv_key_t const* end_keys;
+    ukv_size_t end_keys_stride;
+
+    /**
+     * @brief Optional sorted list of keys, shared by all queries, to search among.
+     * Those keys are fetched with point reads instead of scanning the whole collection.
+     */
+    ukv_key_t const* allowed_keys;
+    ukv_size_t allowed_keys_count;
+
+    /**
+     * @brief Optional path to a numeric or boolean field of documents in `filter_collection`,
+     * that must be within [`filter_min`, `filter_max`] for the document with the same key.
+     * The field is gathered with `ukv_docs_gather()` only for the candidates,
+     * that are close enough to enter the top.
+     */
+    ukv_str_view_t filter_field;
+    ukv_collection_t filter_collection;
+    ukv_float_t filter_min;
+    ukv_float_t filter_max;
+
     /// @}
     /// @name Outputs
     /// @{
@@ -205,6 +253,63 @@ typedef struct ukv_vectors_search_t {
  */
 void ukv_vectors_search(ukv_vectors_search_t*);
 
+/**
+ * @brief Trains a Product-Quantization codebook for a collection of vectors.
+ * @see `ukv_vectors_train()`.
+ *
+ * Splits every vector into `subspaces` equal slices and clusters each slice
+ * with K-Means into 16 centroids, so that every vector can be encoded in
+ * `subspaces / 2` bytes of 4-bit codes. Once the codebook is trained, all
+ * the present and future vectors in the collection are stored compressed,
+ * and `ukv_vectors_search()` switches to Asymmetric Distance Computation
+ * over lookup tables, re-ranking the best candidates against the originals.
+ *
+ * Codes and codebooks are kept in internal named collections, so it is
+ * only available on engines with `ukv_supports_named_collections_k`.
+ * Calling it again re-trains the codebook and re-encodes the collection.
+ */
+typedef struct ukv_vectors_train_t {
+
+    /// @name Context
+    /// @{
+
+    /** @brief Already open database instance. */
+    ukv_database_t db;
+    /** @brief Pointer to exported error message. */
+    ukv_error_t* error;
+    /** @brief The transaction in which the operation will be watched. */
+    ukv_transaction_t transaction;
+    /** @brief Reusable memory handle. */
+    ukv_arena_t* arena;
+    /** @brief Read and Write options. @see `ukv_read_t`, `ukv_write_t`. */
+    ukv_options_t options;
+
+    /// @}
+    /// @name Inputs
+    /// @{
+
+    ukv_collection_t collection;
+    ukv_length_t dimensions;
+    ukv_vector_scalar_t scalar_type;
+    /** @brief Vectors are normalized before quantization for `::ukv_vector_metric_cos_k`. */
+    ukv_vector_metric_t metric;
+    /** @brief Must divide `dimensions`. Defaults to the biggest divisor of `dimensions` up to 64. */
+    ukv_length_t subspaces;
+    /** @brief Number of vectors sampled for training. Defaults to 4096. */
+    ukv_length_t samples_limit;
+    /** @brief Number of K-Means iterations. Defaults to 10. */
+    ukv_length_t iterations;
+
+    /// @}
+
+} ukv_vectors_train_t;
+
+/**
+ * @brief Trains a Product-Quantization codebook for a collection of vectors.
+ * @see `ukv_vectors_train_t`.
+ */
+void ukv_vectors_train(ukv_vectors_train_t*);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
\ No newline at end of file
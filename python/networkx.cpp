@@ -1,3 +1,8 @@
+#include <unordered_map> // `std::unordered_map`
+
+#include <arrow/c/bridge.h>
+
+#include "ukv/arrow.h"
 #include "pybind.hpp"
 #include "crud.hpp"
 #include "cast_args.hpp"
@@ -413,6 +418,253 @@ void ukv::wrap_networkx(py::module& m) {
         return 0.0;
     });
 
+    // Bulk exports of the whole graph, filled by a parallel scan
+    // https://networkx.org/documentation/stable/reference/generated/networkx.convert_matrix.to_scipy_sparse_array.html
+    g.def(
+        "to_arrow_csr",
+        [](py_graph_t& g, bool edges) {
+            graph_csr_t csr;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                csr = g.ref().export_csr(ukv_vertex_source_k, edges).throw_or_release();
+            }
+
+            // The buffers remain in the arena of the graph until the next request
+            status_t status;
+            ArrowSchema c_arrow_schema;
+            ArrowArray c_arrow_array;
+            ukv_graph_csr_to_arrow( //
+                csr.vertices.size(),
+                csr.vertices.begin(),
+                csr.offsets.begin(),
+                csr.neighbors.begin(),
+                edges ? csr.edges.begin() : nullptr,
+                &c_arrow_schema,
+                &c_arrow_array,
+                status.member_ptr());
+            status.throw_unhandled();
+
+            arrow::Result<std::shared_ptr<arrow::RecordBatch>> batch_arrow =
+                arrow::ImportRecordBatch(&c_arrow_array, &c_arrow_schema);
+            PyObject* batch_python = arrow::py::wrap_batch(batch_arrow.ValueOrDie());
+            return py::reinterpret_steal<py::object>(batch_python);
+        },
+        py::arg("edges") = true);
+    m.def(
+        "to_scipy_sparse_array",
+        [](py_graph_t& g) {
+            graph_csr_t csr;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                auto role = g.is_directed ? ukv_vertex_source_k : ukv_vertex_role_any_k;
+                csr = g.ref().export_csr(role, false).throw_or_release();
+            }
+
+            std::size_t const count = csr.vertices.size();
+            py::array_t<std::int64_t> indptr(count + 1);
+            py::array_t<std::int64_t> indices(csr.neighbors.size());
+            std::copy(csr.offsets.begin(), csr.offsets.end(), indptr.mutable_data());
+            std::copy(csr.neighbors.begin(), csr.neighbors.end(), indices.mutable_data());
+            py::object data = py::module_::import("numpy").attr("ones")(csr.neighbors.size());
+            py::object sparse = py::module_::import("scipy.sparse");
+            return sparse.attr("csr_array")(py::make_tuple(data, indices, indptr),
+                                            py::arg("shape") = py::make_tuple(count, count));
+        },
+        py::arg("G"));
+
+    // Algorithms, implemented natively and running on all hardware threads
+    // https://networkx.org/documentation/stable/reference/algorithms/link_analysis.html
+    // https://networkx.org/documentation/stable/reference/algorithms/component.html
+    // https://networkx.org/documentation/stable/reference/algorithms/community.html
+    auto groups_of = [](graph_analysis_t const& analysis) {
+        // Labels are the smallest vertex IDs in every group, so each group starts with its label
+        py::list groups;
+        std::unordered_map<ukv_key_t, py::set> by_label;
+        for (std::size_t i = 0; i != analysis.vertices.size(); ++i) {
+            auto it = by_label.find(analysis.labels[i]);
+            if (it == by_label.end()) {
+                it = by_label.emplace(analysis.labels[i], py::set()).first;
+                groups.append(it->second);
+            }
+            it->second.add(analysis.vertices[i]);
+        }
+        return groups;
+    };
+    m.def(
+        "pagerank",
+        [](py_graph_t& g, float alpha, std::size_t max_iter, float tol) {
+            graph_analysis_t analysis;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                analysis = g.ref().pagerank(alpha, max_iter, tol).throw_or_release();
+            }
+            py::dict ranks;
+            for (std::size_t i = 0; i != analysis.vertices.size(); ++i)
+                ranks[py::int_(analysis.vertices[i])] = analysis.scores[i];
+            return ranks;
+        },
+        py::arg("G"),
+        py::arg("alpha") = 0.85f,
+        py::arg("max_iter") = 100,
+        py::arg("tol") = 1e-6f);
+    auto components = [=](py_graph_t& g) {
+        graph_analysis_t analysis;
+        {
+            [[maybe_unused]] py::gil_scoped_release release;
+            analysis = g.ref().weakly_connected_components().throw_or_release();
+        }
+        return groups_of(analysis);
+    };
+    m.def("weakly_connected_components", components, py::arg("G"));
+    m.def("connected_components", components, py::arg("G"));
+    m.def(
+        "number_weakly_connected_components",
+        [=](py_graph_t& g) { return py::len(components(g)); },
+        py::arg("G"));
+    m.def(
+        "louvain_communities",
+        [=](py_graph_t& g, float resolution, float threshold) {
+            graph_analysis_t analysis;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                analysis = g.ref().louvain(resolution, std::numeric_limits<std::size_t>::max(), threshold).throw_or_release();
+            }
+            return groups_of(analysis);
+        },
+        py::arg("G"),
+        py::arg("resolution") = 1.f,
+        py::arg("threshold") = 1e-7f);
+
+    // Sampling for GNN mini-batches, exporting flat NumPy arrays, like PyG and DGL loaders
+    // https://pytorch-geometric.readthedocs.io/en/latest/modules/loader.html#torch_geometric.loader.NeighborLoader
+    auto to_numpy = [](ptr_range_gt<ukv_key_t> range) {
+        py::array_t<ukv_key_t> array(range.size());
+        std::copy(range.begin(), range.end(), array.mutable_data());
+        return array;
+    };
+    m.def(
+        "sample_neighbors",
+        [=](py_graph_t& g, std::vector<ukv_key_t> nodes, std::vector<ukv_size_t> fanouts, bool replace, std::size_t seed) {
+            graph_sample_t sample;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                auto role = g.is_directed ? ukv_vertex_source_k : ukv_vertex_role_any_k;
+                sample = g.ref()
+                             .sample_neighbors(strided_range(nodes).immutable(),
+                                               strided_range(fanouts).immutable(),
+                                               role,
+                                               replace,
+                                               seed)
+                             .throw_or_release();
+            }
+            py::array_t<ukv_length_t> hops_offsets(sample.hops_offsets.size());
+            std::copy(sample.hops_offsets.begin(), sample.hops_offsets.end(), hops_offsets.mutable_data());
+            return py::make_tuple(hops_offsets,
+                                  to_numpy(sample.centers),
+                                  to_numpy(sample.neighbors),
+                                  to_numpy(sample.edges));
+        },
+        py::arg("G"),
+        py::arg("nodes"),
+        py::arg("fanouts"),
+        py::arg("replace") = false,
+        py::arg("seed") = 0,
+        "Samples multi-hop neighborhoods, returning hops offsets, centers, neighbors and edges IDs.");
+    m.def(
+        "random_walks",
+        [=](py_graph_t& g,
+            std::vector<ukv_key_t> nodes,
+            std::size_t walk_length,
+            float restart_prob,
+            float p,
+            float q,
+            std::size_t seed) {
+            random_walks_t walks;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                auto role = g.is_directed ? ukv_vertex_source_k : ukv_vertex_role_any_k;
+                walks = g.ref()
+                            .random_walks(strided_range(nodes).immutable(), walk_length, restart_prob, p, q, role, seed)
+                            .throw_or_release();
+            }
+            py::array_t<ukv_key_t> array({walks.size(), walk_length + 1});
+            std::copy(walks.vertices.begin(), walks.vertices.end(), array.mutable_data());
+            return array;
+        },
+        py::arg("G"),
+        py::arg("nodes"),
+        py::arg("walk_length"),
+        py::arg("restart_prob") = 0.f,
+        py::arg("p") = 1.f,
+        py::arg("q") = 1.f,
+        py::arg("seed") = 0,
+        "Generates a random walk from every node, padding the ones, that reach dead ends, with the unknown key.");
+
+    // Intersections of neighborhoods, computed without exporting them
+    // https://networkx.org/documentation/stable/reference/generated/networkx.classes.function.common_neighbors.html
+    // https://networkx.org/documentation/stable/reference/algorithms/clustering.html
+    m.def(
+        "common_neighbors",
+        [=](py_graph_t& g, ukv_key_t u, ukv_key_t v) {
+            common_neighbors_t common;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                auto role = g.is_directed ? ukv_vertex_source_k : ukv_vertex_role_any_k;
+                common = g.ref().common_neighbors({{&u}, 1}, {{&v}, 1}, role).throw_or_release();
+            }
+            return to_numpy(common.of(0));
+        },
+        py::arg("G"),
+        py::arg("u"),
+        py::arg("v"));
+    auto count_triangles = [](py_graph_t& g, std::vector<ukv_key_t> const& nodes) {
+        [[maybe_unused]] py::gil_scoped_release release;
+        return g.ref().count_triangles(strided_range(nodes).immutable()).throw_or_release();
+    };
+    m.def(
+        "triangles",
+        [=](py_graph_t& g, std::vector<ukv_key_t> nodes) {
+            triangles_t triangles = count_triangles(g, nodes);
+            py::dict result;
+            for (std::size_t i = 0; i != nodes.size(); ++i)
+                result[py::int_(nodes[i])] = triangles.counts[i];
+            return result;
+        },
+        py::arg("G"),
+        py::arg("nodes"));
+    m.def(
+        "clustering",
+        [=](py_graph_t& g, std::vector<ukv_key_t> nodes) {
+            triangles_t triangles = count_triangles(g, nodes);
+            py::dict result;
+            for (std::size_t i = 0; i != nodes.size(); ++i)
+                result[py::int_(nodes[i])] = triangles.clustering[i];
+            return result;
+        },
+        py::arg("G"),
+        py::arg("nodes"));
+
+    // Shortest paths over the weights of edges, stored by their IDs
+    // https://networkx.org/documentation/stable/reference/algorithms/generated/networkx.algorithms.shortest_paths.weighted.single_source_dijkstra_path_length.html
+    m.def(
+        "single_source_dijkstra_path_length",
+        [](py_graph_t& g, ukv_key_t source, std::optional<float> cutoff) {
+            shortest_paths_t paths;
+            {
+                [[maybe_unused]] py::gil_scoped_release release;
+                auto role = g.is_directed ? ukv_vertex_source_k : ukv_vertex_role_any_k;
+                paths = g.ref().shortest_paths({{&source}, 1}, role, cutoff.value_or(0.f)).throw_or_release();
+            }
+            py::dict result;
+            for (std::size_t i = 0; i != paths.vertices.size(); ++i)
+                if (paths.distances[i] != std::numeric_limits<ukv_float_t>::infinity())
+                    result[py::int_(paths.vertices[i])] = paths.distances[i];
+            return result;
+        },
+        py::arg("G"),
+        py::arg("source"),
+        py::arg("cutoff") = std::nullopt);
+
     // Reading and Writing Graphs
     // https://networkx.org/documentation/stable/reference/readwrite/
     // https://networkx.org/documentation/stable/reference/readwrite/adjlist.html
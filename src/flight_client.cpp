@@ -601,6 +601,10 @@ void ukv_paths_match(ukv_paths_match_t* c_ptr) {
 
     ukv_paths_match_t& c = *c_ptr;
     return_error_if_m(c.db, c.error, uninitialized_state_k, "DataBase is uninitialized");
+    return_error_if_m(!c.cursors && !c.cursors_next && !c.cursors_exhausted,
+                      c.error,
+                      missing_feature_k,
+                      "Paths cursors aren't supported in this implementation!");
 
     linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
     return_if_error_m(c.error);
@@ -978,6 +982,20 @@ void ukv_paths_read(ukv_paths_read_t* c_ptr) {
     }
 }
 
+void ukv_paths_index(ukv_paths_index_t* c_ptr) {
+
+    ukv_paths_index_t& c = *c_ptr;
+    return_error_if_m(c.db, c.error, uninitialized_state_k, "DataBase is uninitialized");
+    log_error_m(c.error, missing_feature_k, "Paths indexes aren't supported in this implementation!");
+}
+
+void ukv_paths_migrate(ukv_paths_migrate_t* c_ptr) {
+
+    ukv_paths_migrate_t& c = *c_ptr;
+    return_error_if_m(c.db, c.error, uninitialized_state_k, "DataBase is uninitialized");
+    log_error_m(c.error, missing_feature_k, "Paths migrations aren't supported in this implementation!");
+}
+
 void ukv_scan(ukv_scan_t* c_ptr) {
 
     ukv_scan_t& c = *c_ptr;
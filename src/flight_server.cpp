@@ -916,9 +916,14 @@ class UKVService : public arf::FlightServerBase {
             match.previous_offsets_stride = input_prevs.offsets_begin.stride();
             match.previous_lengths = input_prevs.lengths_begin.get();
             match.previous_lengths_stride = input_prevs.lengths_begin.stride();
+            match.cursors = nullptr;
+            match.cursors_stride = 0;
+            match.threads_count = 0;
             match.match_counts = &found_counts;
             match.paths_offsets = request_content ? &found_offsets : nullptr;
             match.paths_strings = request_content ? &found_values : nullptr;
+            match.cursors_next = nullptr;
+            match.cursors_exhausted = nullptr;
 
             ukv_paths_match(&match);
             if (!status)
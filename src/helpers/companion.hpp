@@ -0,0 +1,166 @@
+/**
+ * @file companion.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Resolving internal collections, that modalities keep next to user-facing ones.
+ */
+#pragma once
+#include <algorithm>   // `std::copy_n`, `std::fill_n`
+#include <cstring>     // `std::strlen`
+#include <string_view> // `std::string_view`
+
+#include "ukv/db.h"
+#include "helpers/linked_memory.hpp" // `linked_memory_lock_t`
+
+namespace unum::ukv {
+
+/**
+ * @brief Catalog of named collections, as exported by `ukv_collection_list()`.
+ * The names tape is a sequence of NULL-terminated strings.
+ */
+struct catalog_t {
+    ukv_size_t count = 0;
+    ukv_collection_t* ids = nullptr;
+    ukv_char_t* names = nullptr;
+};
+
+inline catalog_t list_catalog(ukv_database_t db,
+                                           linked_memory_lock_t& arena,
+                                           ukv_error_t* c_error) noexcept {
+    catalog_t listed;
+    ukv_collection_list_t list {
+        .db = db,
+        .error = c_error,
+        .arena = arena,
+        .options = ukv_option_dont_discard_memory_k,
+        .count = &listed.count,
+        .ids = &listed.ids,
+        .names = &listed.names,
+    };
+    ukv_collection_list(&list);
+    return listed;
+}
+
+/**
+ * @brief Finds the name of the `collection` in the catalog, empty for the main one.
+ * @return False, if the collection is unknown.
+ */
+inline bool find_collection_name(catalog_t const& listed,
+                                 ukv_collection_t collection,
+                                 std::string_view& name) noexcept {
+    name = {};
+    if (collection == ukv_collection_main_k)
+        return true;
+    ukv_str_view_t listed_name = listed.names;
+    for (std::size_t i = 0; i != listed.count; ++i, listed_name += std::strlen(listed_name) + 1) {
+        if (listed.ids[i] != collection)
+            continue;
+        name = listed_name;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Finds the companion with the `suffix` of a collection called `owner_name` in the catalog.
+ * @return `ukv_collection_main_k` if the companion is missing.
+ */
+inline ukv_collection_t find_companion(catalog_t const& listed,
+                                       std::string_view owner_name,
+                                       std::string_view suffix) noexcept {
+    ukv_str_view_t listed_name = listed.names;
+    for (std::size_t i = 0; i != listed.count; ++i, listed_name += std::strlen(listed_name) + 1) {
+        std::string_view name = listed_name;
+        if (name.size() == 2 + owner_name.size() + suffix.size() && name.front() == '.' &&
+            name.substr(1, owner_name.size()) == owner_name && name[1 + owner_name.size()] == ':' &&
+            name.substr(2 + owner_name.size()) == suffix)
+            return listed.ids[i];
+    }
+    return ukv_collection_main_k;
+}
+
+/**
+ * @brief Resolves the internal "companion" of a collection, used by modalities
+ * to store auxiliary data, like indexes or compressed copies of the values.
+ *
+ * The companion is a named collection, called after its owner: a dot, the owner's
+ * name, a colon and the `suffix`. So the PQ codes of the main collection would
+ * live in ".:vectors.pq", and for the "docs" collection - in ".docs:vectors.pq".
+ * Such collections must not be addressed by the users directly.
+ *
+ * @return `ukv_collection_main_k` if the companion is missing and wasn't created.
+ */
+inline ukv_collection_t companion_collection( //
+    ukv_database_t db,
+    ukv_collection_t collection,
+    ukv_str_view_t suffix,
+    bool create_if_missing,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) noexcept {
+
+    catalog_t listed = list_catalog(db, arena, c_error);
+    if (*c_error)
+        return ukv_collection_main_k;
+
+    std::string_view owner_name;
+    if (!find_collection_name(listed, collection, owner_name)) {
+        log_error_m(c_error, args_wrong_k, "Collection is unknown");
+        return ukv_collection_main_k;
+    }
+
+    ukv_collection_t companion = find_companion(listed, owner_name, suffix);
+    if (companion != ukv_collection_main_k || !create_if_missing)
+        return companion;
+
+    std::size_t const suffix_length = std::strlen(suffix);
+    std::size_t const name_length = 2 + owner_name.size() + suffix_length;
+    auto name = arena.alloc<char>(name_length + 1, c_error).begin();
+    if (*c_error)
+        return ukv_collection_main_k;
+
+    name[0] = '.';
+    std::copy_n(owner_name.data(), owner_name.size(), name + 1);
+    name[1 + owner_name.size()] = ':';
+    std::memcpy(name + 2 + owner_name.size(), suffix, suffix_length);
+    name[name_length] = '\0';
+
+    ukv_collection_create_t create {
+        .db = db,
+        .error = c_error,
+        .name = name,
+        .config = "",
+        .id = &companion,
+    };
+    ukv_collection_create(&create);
+    return companion;
+}
+
+/**
+ * @brief Resolves several companions of a collection with a single listing of the catalog,
+ * for operations, that may touch many of them. Missing companions aren't created,
+ * and are reported as `ukv_collection_main_k`.
+ */
+inline void companion_collections( //
+    ukv_database_t db,
+    ukv_collection_t collection,
+    ukv_str_view_t const* suffixes,
+    std::size_t suffixes_count,
+    ukv_collection_t* companions,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) noexcept {
+
+    std::fill_n(companions, suffixes_count, ukv_collection_main_k);
+    catalog_t listed = list_catalog(db, arena, c_error);
+    if (*c_error)
+        return;
+
+    std::string_view owner_name;
+    if (!find_collection_name(listed, collection, owner_name)) {
+        log_error_m(c_error, args_wrong_k, "Collection is unknown");
+        return;
+    }
+    for (std::size_t i = 0; i != suffixes_count; ++i)
+        companions[i] = find_companion(listed, owner_name, suffixes[i]);
+}
+
+} // namespace unum::ukv
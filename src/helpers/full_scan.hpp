@@ -45,7 +45,7 @@ void full_scan_collection( //
         if (*error)
             break;
 
-        if (found_blobs_count[0] <= 1)
+        if (!found_blobs_count[0])
             // We have reached the end of collection
             break;
 
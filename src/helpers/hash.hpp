@@ -0,0 +1,99 @@
+/**
+ * @file hash.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Stable seeded 64-bit hash for strings, that are persisted or shared between processes.
+ * Unlike `std::hash`, the result only depends on the bytes and the seed, and not on the
+ * standard library, its version or the endianness of the machine. The construction follows
+ * "wyhash": short keys are folded into two words with overlapping loads, longer ones are
+ * consumed in three independent 16-byte lanes, and every step is a 64x64->128 multiplication.
+ * https://github.com/wangyi-fudan/wyhash
+ */
+#pragma once
+#include <cstdint> // `std::uint64_t`
+#include <cstring> // `std::memcpy`
+
+namespace unum::ukv {
+
+constexpr std::uint64_t stable_hash_secret_k[4] {
+    0xa0761d6478bd642full,
+    0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull,
+    0x589965cc75374cc3ull,
+};
+
+inline void stable_hash_multiply(std::uint64_t& a, std::uint64_t& b) noexcept {
+    __uint128_t product = __uint128_t(a) * b;
+    a = static_cast<std::uint64_t>(product);
+    b = static_cast<std::uint64_t>(product >> 64);
+}
+
+inline std::uint64_t stable_hash_mix(std::uint64_t a, std::uint64_t b) noexcept {
+    stable_hash_multiply(a, b);
+    return a ^ b;
+}
+
+/// Loads are little-endian on every platform, so that hashes match across machines.
+inline std::uint64_t stable_hash_read_64(unsigned char const* ptr) noexcept {
+    std::uint64_t result;
+    std::memcpy(&result, ptr, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap64(result);
+#endif
+    return result;
+}
+
+inline std::uint64_t stable_hash_read_32(unsigned char const* ptr) noexcept {
+    std::uint32_t result;
+    std::memcpy(&result, ptr, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap32(result);
+#endif
+    return result;
+}
+
+inline std::uint64_t stable_hash(void const* data, std::size_t length, std::uint64_t seed) noexcept {
+
+    auto ptr = static_cast<unsigned char const*>(data);
+    auto const& secret = stable_hash_secret_k;
+    seed ^= stable_hash_mix(seed ^ secret[0], secret[1]);
+
+    std::uint64_t a = 0, b = 0;
+    if (length <= 16) {
+        if (length >= 4) {
+            std::size_t const shift = (length >> 3) << 2;
+            a = (stable_hash_read_32(ptr) << 32) | stable_hash_read_32(ptr + shift);
+            b = (stable_hash_read_32(ptr + length - 4) << 32) | stable_hash_read_32(ptr + length - 4 - shift);
+        }
+        else if (length > 0)
+            a = (std::uint64_t(ptr[0]) << 16) | (std::uint64_t(ptr[length >> 1]) << 8) | ptr[length - 1];
+    }
+    else {
+        std::size_t remaining = length;
+        if (remaining > 48) {
+            std::uint64_t second_seed = seed, third_seed = seed;
+            do {
+                seed = stable_hash_mix(stable_hash_read_64(ptr) ^ secret[1], stable_hash_read_64(ptr + 8) ^ seed);
+                second_seed = stable_hash_mix(stable_hash_read_64(ptr + 16) ^ secret[2],
+                                              stable_hash_read_64(ptr + 24) ^ second_seed);
+                third_seed = stable_hash_mix(stable_hash_read_64(ptr + 32) ^ secret[3],
+                                             stable_hash_read_64(ptr + 40) ^ third_seed);
+                ptr += 48, remaining -= 48;
+            } while (remaining > 48);
+            seed ^= second_seed ^ third_seed;
+        }
+        while (remaining > 16) {
+            seed = stable_hash_mix(stable_hash_read_64(ptr) ^ secret[1], stable_hash_read_64(ptr + 8) ^ seed);
+            ptr += 16, remaining -= 16;
+        }
+        a = stable_hash_read_64(ptr + remaining - 16);
+        b = stable_hash_read_64(ptr + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    stable_hash_multiply(a, b);
+    return stable_hash_mix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+} // namespace unum::ukv
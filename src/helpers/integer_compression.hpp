@@ -0,0 +1,133 @@
+/**
+ * @file integer_compression.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Primitives for compressing sorted integer sequences:
+ * ZigZag and variable-length encodings, and block bit-packing.
+ */
+#pragma once
+#include <algorithm> // `std::fill_n`
+#include <cstdint>   // `std::uint64_t`
+#include <cstring>   // `std::memcpy`
+
+#include "ukv/cpp/types.hpp" // `byte_t`
+
+namespace unum::ukv {
+
+inline std::uint64_t zigzag_encode(std::int64_t value) noexcept {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t zigzag_decode(std::uint64_t value) noexcept {
+    return static_cast<std::int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/**
+ * @brief Appends LEB128 variable-length encoding of `value`.
+ * @return Pointer past the last written byte.
+ */
+inline byte_t* varint_encode(std::uint64_t value, byte_t* output) noexcept {
+    while (value >= 0x80) {
+        *output++ = static_cast<byte_t>(value | 0x80);
+        value >>= 7;
+    }
+    *output++ = static_cast<byte_t>(value);
+    return output;
+}
+
+/**
+ * @return Pointer past the last consumed byte.
+ */
+inline byte_t const* varint_decode(byte_t const* input, std::uint64_t& value) noexcept {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        auto octet = static_cast<std::uint64_t>(*input++);
+        value |= (octet & 0x7F) << shift;
+        if (!(octet & 0x80))
+            break;
+    }
+    return input;
+}
+
+constexpr std::size_t varint_max_bytes_k = 10;
+
+/**
+ * @brief Number of bits, needed to represent any of the `values`.
+ */
+inline unsigned bits_width(std::uint64_t const* values, std::size_t count) noexcept {
+    std::uint64_t joined = 0;
+    for (std::size_t i = 0; i != count; ++i)
+        joined |= values[i];
+    return joined ? 64u - static_cast<unsigned>(__builtin_clzll(joined)) : 0u;
+}
+
+inline std::size_t packed_bytes(std::size_t count, unsigned width) noexcept {
+    return (count * width + 7) / 8;
+}
+
+/**
+ * @brief Packs the lowest `width` bits of every value into a continuous little-endian
+ * bitstream, flushing whole 64-bit words, while possible.
+ * @return Pointer past the last written byte.
+ */
+inline byte_t* pack_bits(std::uint64_t const* values, std::size_t count, unsigned width, byte_t* output) noexcept {
+    if (!width)
+        return output;
+    std::uint64_t buffer = 0;
+    unsigned filled = 0;
+    for (std::size_t i = 0; i != count; ++i) {
+        std::uint64_t value = values[i];
+        buffer |= value << filled;
+        if (filled + width < 64) {
+            filled += width;
+            continue;
+        }
+        std::memcpy(output, &buffer, sizeof(buffer));
+        output += sizeof(buffer);
+        buffer = filled ? value >> (64 - filled) : 0;
+        filled = filled + width - 64;
+    }
+    std::size_t const tail_bytes = (filled + 7) / 8;
+    std::memcpy(output, &buffer, tail_bytes);
+    return output + tail_bytes;
+}
+
+/**
+ * @brief Inverse of `pack_bits()`. Never reads beyond the `packed_bytes()` of the input.
+ * @return Pointer past the last consumed byte.
+ */
+inline byte_t const* unpack_bits(byte_t const* input,
+                                 std::size_t count,
+                                 unsigned width,
+                                 std::uint64_t* values) noexcept {
+    if (!width) {
+        std::fill_n(values, count, 0);
+        return input;
+    }
+    std::uint64_t const mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    std::size_t remaining_bytes = packed_bytes(count, width);
+    byte_t const* const end = input + remaining_bytes;
+    std::uint64_t buffer = 0;
+    unsigned available = 0;
+    for (std::size_t i = 0; i != count; ++i) {
+        if (available >= width) {
+            values[i] = buffer & mask;
+            buffer = width == 64 ? 0 : buffer >> width;
+            available -= width;
+            continue;
+        }
+        std::uint64_t word = 0;
+        std::size_t const loaded_bytes = std::min<std::size_t>(sizeof(word), remaining_bytes);
+        std::memcpy(&word, input, loaded_bytes);
+        input += loaded_bytes;
+        remaining_bytes -= loaded_bytes;
+
+        unsigned const consumed = width - available;
+        values[i] = (buffer | (word << available)) & mask;
+        buffer = consumed == 64 ? 0 : word >> consumed;
+        available = static_cast<unsigned>(loaded_bytes * 8) - consumed;
+    }
+    return end;
+}
+
+} // namespace unum::ukv
@@ -84,13 +84,13 @@ class limited_priority_queue_gt {
                 return false;
         }
         else {
-            if (length_ == capacity_)
-                std::destroy_at(ptr_ + capacity_ - 1);
-            auto source_ptr = element_ptr;
-            for (; source_ptr + 1 != end; ++source_ptr)
-                source_ptr[1] = std::move(source_ptr[0]);
+            // Shift the tail backwards, dropping the last element if we are full
+            if (length_ < capacity_) {
+                new (end) element_t(std::move(end[-1]));
+                ++length_;
+            }
+            std::move_backward(element_ptr, end - 1, end);
             *element_ptr = std::move(element);
-            length_ += length_ < capacity_;
             return true;
         }
     }
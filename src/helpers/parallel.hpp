@@ -0,0 +1,113 @@
+/**
+ * @file parallel.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Multi-threaded building blocks for big batches:
+ * splitting loops into contiguous slices and a stable LSD radix sort.
+ */
+#pragma once
+#include <algorithm> // `std::min`
+#include <array>     // `std::array`
+#include <cstdint>   // `std::uint64_t`
+#include <thread>    // `std::thread`
+#include <utility>   // `std::swap`
+#include <vector>    // `std::vector`
+
+namespace unum::ukv {
+
+/**
+ * @brief Splits `count` tasks into contiguous slices, calling `callback(thread_idx, begin, end)`
+ * for each of them on a separate thread. The calling thread handles the first slice.
+ */
+template <typename callback_at>
+void parallel_for_slices(std::size_t threads_count, std::size_t count, callback_at&& callback) {
+    threads_count = std::max<std::size_t>(1, std::min(threads_count, count));
+    std::vector<std::thread> threads;
+    threads.reserve(threads_count - 1);
+    try {
+        for (std::size_t i = 1; i != threads_count; ++i)
+            threads.emplace_back(callback, i, count * i / threads_count, count * (i + 1) / threads_count);
+    }
+    catch (...) {
+        for (std::thread& thread : threads)
+            thread.join();
+        throw;
+    }
+    callback(std::size_t(0), std::size_t(0), count / threads_count);
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+/// Radix sorts consume that many bits of the key per pass.
+constexpr unsigned radix_bits_k = 8;
+constexpr std::size_t radix_buckets_k = std::size_t(1) << radix_bits_k;
+
+/**
+ * @brief Stable LSD radix sort of `elements` by an unsigned 64-bit `key(element)`.
+ * Every pass histograms the slices of all threads, and then scatters them concurrently.
+ * Digits, that are equal in all the keys, are skipped, so sorting small or clustered
+ * keys costs just a few passes. Sorting by a composite key is done with several calls,
+ * starting from the least significant part.
+ *
+ * @param buffer Temporary memory for at least `count` elements.
+ */
+template <typename element_at, typename key_at>
+void radix_sort(element_at* elements,
+                element_at* buffer,
+                std::size_t count,
+                key_at&& key,
+                std::size_t threads_count = 1) {
+
+    if (count < 2)
+        return;
+
+    // Find the bits, that differ between any of the keys and the first one
+    threads_count = std::max<std::size_t>(1, std::min(threads_count, count));
+    std::vector<std::uint64_t> varying_bits(threads_count);
+    std::uint64_t const first_key = key(elements[0]);
+    parallel_for_slices(threads_count, count, [&](std::size_t thread_idx, std::size_t begin, std::size_t end) {
+        std::uint64_t varying = 0;
+        for (std::size_t i = begin; i != end; ++i)
+            varying |= key(elements[i]) ^ first_key;
+        varying_bits[thread_idx] = varying;
+    });
+    std::uint64_t varying = 0;
+    for (std::uint64_t thread_varying : varying_bits)
+        varying |= thread_varying;
+
+    std::vector<std::array<std::size_t, radix_buckets_k>> offsets(threads_count);
+    element_at* input = elements;
+    element_at* output = buffer;
+    for (unsigned shift = 0; shift < 64; shift += radix_bits_k) {
+        if (!((varying >> shift) & (radix_buckets_k - 1)))
+            continue;
+
+        auto digit = [&](element_at const& element) {
+            return static_cast<std::size_t>((key(element) >> shift) & (radix_buckets_k - 1));
+        };
+        parallel_for_slices(threads_count, count, [&](std::size_t thread_idx, std::size_t begin, std::size_t end) {
+            auto& histogram = offsets[thread_idx];
+            histogram.fill(0);
+            for (std::size_t i = begin; i != end; ++i)
+                ++histogram[digit(input[i])];
+        });
+
+        // Slices of every bucket are laid out in the order of threads, keeping the sort stable
+        std::size_t running_offset = 0;
+        for (std::size_t bucket = 0; bucket != radix_buckets_k; ++bucket)
+            for (auto& histogram : offsets)
+                running_offset += std::exchange(histogram[bucket], running_offset);
+
+        parallel_for_slices(threads_count, count, [&](std::size_t thread_idx, std::size_t begin, std::size_t end) {
+            auto& thread_offsets = offsets[thread_idx];
+            for (std::size_t i = begin; i != end; ++i)
+                output[thread_offsets[digit(input[i])]++] = input[i];
+        });
+        std::swap(input, output);
+    }
+
+    if (input != elements)
+        std::copy(input, input + count, elements);
+}
+
+} // namespace unum::ukv
@@ -0,0 +1,144 @@
+/**
+ * @file set_intersection.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Intersections of sorted arrays of unique integers.
+ * Arrays of similar lengths are merged in blocks with AVX-512 or AVX2, when available,
+ * while very different ones are intersected by galloping through the longer one.
+ */
+#pragma once
+#include <algorithm> // `std::lower_bound`
+#include <cstdint>   // `std::int64_t`
+#include <utility>   // `std::swap`
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h> // `_mm256_cmpeq_epi64`
+#endif
+
+namespace unum::ukv {
+
+/// If one array is that many times longer than the other, binary searches beat merging.
+constexpr std::size_t galloping_ratio_k = 32;
+
+/**
+ * @brief Appends `value` to `output`, unless only the size of the intersection is needed.
+ */
+inline std::size_t emit_common(std::int64_t value, std::int64_t* output, std::size_t count) noexcept {
+    if (output)
+        output[count] = value;
+    return count + 1;
+}
+
+inline std::size_t intersect_merging(std::int64_t const* a,
+                                     std::size_t a_length,
+                                     std::int64_t const* b,
+                                     std::size_t b_length,
+                                     std::int64_t* output,
+                                     std::size_t count = 0) noexcept {
+    std::size_t i = 0, j = 0;
+    while (i != a_length && j != b_length) {
+        if (a[i] < b[j])
+            ++i;
+        else if (b[j] < a[i])
+            ++j;
+        else
+            count = emit_common(a[i], output, count), ++i, ++j;
+    }
+    return count;
+}
+
+/**
+ * @brief Looks up every element of the shorter `a` in the longer `b`, doubling the step
+ * until it is overshot, and then narrowing it down with a binary search.
+ */
+inline std::size_t intersect_galloping(std::int64_t const* a,
+                                       std::size_t a_length,
+                                       std::int64_t const* b,
+                                       std::size_t b_length,
+                                       std::int64_t* output) noexcept {
+    std::size_t count = 0;
+    std::int64_t const* b_end = b + b_length;
+    for (std::size_t i = 0; i != a_length && b != b_end; ++i) {
+        std::size_t step = 1;
+        while (step < static_cast<std::size_t>(b_end - b) && b[step] < a[i])
+            step *= 2;
+        std::int64_t const* bound = b + std::min<std::size_t>(step + 1, b_end - b);
+        b = std::lower_bound(b, bound, a[i]);
+        if (b != b_end && *b == a[i])
+            count = emit_common(a[i], output, count), ++b;
+    }
+    return count;
+}
+
+/**
+ * @brief Compares blocks of both arrays "all-to-all", rotating the block of `b`,
+ * and advances the one with the smaller last element, or both, if those are equal.
+ */
+inline std::size_t intersect_blocks(std::int64_t const* a,
+                                    std::size_t a_length,
+                                    std::int64_t const* b,
+                                    std::size_t b_length,
+                                    std::int64_t* output) noexcept {
+    std::size_t i = 0, j = 0, count = 0;
+#if defined(__AVX512F__)
+    while (i + 8 <= a_length && j + 8 <= b_length) {
+        __m512i a_block = _mm512_loadu_si512(a + i);
+        __m512i b_block = _mm512_loadu_si512(b + j);
+        __mmask8 matches = _mm512_cmpeq_epi64_mask(a_block, b_block);
+        for (int shift = 1; shift != 8; ++shift) {
+            b_block = _mm512_alignr_epi64(b_block, b_block, 1);
+            matches |= _mm512_cmpeq_epi64_mask(a_block, b_block);
+        }
+        if (output)
+            for (unsigned mask = matches; mask; mask &= mask - 1)
+                output[count++] = a[i + __builtin_ctz(mask)];
+        else
+            count += __builtin_popcount(matches);
+        std::int64_t const a_last = a[i + 7], b_last = b[j + 7];
+        i += a_last <= b_last ? 8 : 0;
+        j += b_last <= a_last ? 8 : 0;
+    }
+#elif defined(__AVX2__)
+    while (i + 4 <= a_length && j + 4 <= b_length) {
+        __m256i a_block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i b_block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + j));
+        __m256i matches = _mm256_cmpeq_epi64(a_block, b_block);
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(a_block, _mm256_permute4x64_epi64(b_block, 0x39)));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(a_block, _mm256_permute4x64_epi64(b_block, 0x4E)));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(a_block, _mm256_permute4x64_epi64(b_block, 0x93)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(matches)));
+        if (output)
+            for (; mask; mask &= mask - 1)
+                output[count++] = a[i + __builtin_ctz(mask)];
+        else
+            count += __builtin_popcount(mask);
+        std::int64_t const a_last = a[i + 3], b_last = b[j + 3];
+        i += a_last <= b_last ? 4 : 0;
+        j += b_last <= a_last ? 4 : 0;
+    }
+#endif
+    return intersect_merging(a + i, a_length - i, b + j, b_length - j, output, count);
+}
+
+/**
+ * @brief Intersects two sorted arrays of unique integers.
+ * @param output Optional buffer for at least `min(a_length, b_length)` common elements.
+ * @return The number of common elements.
+ */
+inline std::size_t intersect_sorted(std::int64_t const* a,
+                                    std::size_t a_length,
+                                    std::int64_t const* b,
+                                    std::size_t b_length,
+                                    std::int64_t* output = nullptr) noexcept {
+    if (a_length > b_length)
+        std::swap(a, b), std::swap(a_length, b_length);
+    if (!a_length)
+        return 0;
+    if (a[a_length - 1] < b[0] || b[b_length - 1] < a[0])
+        return 0;
+    if (a_length * galloping_ratio_k < b_length)
+        return intersect_galloping(a, a_length, b, b_length, output);
+    return intersect_blocks(a, a_length, b, b_length, output);
+}
+
+} // namespace unum::ukv
@@ -0,0 +1,111 @@
+/**
+ * @file substring.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Substring search for short haystacks, like paths, used to prefilter RegEx matches.
+ * With AVX2 or SSE2, the first and the last characters of the needle are compared with
+ * 32 or 16 consecutive positions of the haystack at once, and only the positions,
+ * where both match, are verified byte-by-byte.
+ * http://0x80.pl/articles/simd-strfind.html
+ *
+ * The same broadcast-and-compare trick finds the matching one-byte fingerprints
+ * in the path buckets, before the full keys are compared.
+ */
+#pragma once
+#include <cstdint>     // `std::uint8_t`
+#include <cstring>     // `std::memcmp`
+#include <string_view> // `std::string_view`
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h> // `_mm256_cmpeq_epi8`
+#endif
+
+namespace unum::ukv {
+
+/**
+ * @brief Checks, if any of the `candidates` positions, starting at `offset`, is a full match.
+ * @param candidates Bitmask of positions, where the first and the last characters match.
+ */
+inline bool verify_candidates(std::string_view haystack,
+                              std::string_view needle,
+                              std::size_t offset,
+                              unsigned candidates) noexcept {
+    std::size_t const middle_length = needle.size() > 2 ? needle.size() - 2 : 0;
+    for (; candidates; candidates &= candidates - 1) {
+        char const* match = haystack.data() + offset + __builtin_ctz(candidates);
+        if (std::memcmp(match + 1, needle.data() + 1, middle_length) == 0)
+            return true;
+    }
+    return false;
+}
+
+inline bool contains_substring(std::string_view haystack, std::string_view needle) noexcept {
+    if (needle.empty())
+        return true;
+    if (haystack.size() < needle.size())
+        return false;
+
+    std::size_t offset = 0;
+    std::size_t const last = needle.size() - 1;
+#if defined(__AVX2__)
+    __m256i const firsts = _mm256_set1_epi8(needle.front());
+    __m256i const lasts = _mm256_set1_epi8(needle.back());
+    for (; offset + last + 32 <= haystack.size(); offset += 32) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack.data() + offset));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack.data() + offset + last));
+        __m256i matches =
+            _mm256_and_si256(_mm256_cmpeq_epi8(firsts, block_first), _mm256_cmpeq_epi8(lasts, block_last));
+        unsigned candidates = static_cast<unsigned>(_mm256_movemask_epi8(matches));
+        if (verify_candidates(haystack, needle, offset, candidates))
+            return true;
+    }
+#elif defined(__SSE2__)
+    __m128i const firsts = _mm_set1_epi8(needle.front());
+    __m128i const lasts = _mm_set1_epi8(needle.back());
+    for (; offset + last + 16 <= haystack.size(); offset += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack.data() + offset));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack.data() + offset + last));
+        __m128i matches = _mm_and_si128(_mm_cmpeq_epi8(firsts, block_first), _mm_cmpeq_epi8(lasts, block_last));
+        unsigned candidates = static_cast<unsigned>(_mm_movemask_epi8(matches));
+        if (verify_candidates(haystack, needle, offset, candidates))
+            return true;
+    }
+#endif
+    return haystack.substr(offset).find(needle) != std::string_view::npos;
+}
+
+/**
+ * @brief Calls `callback` with the indexes of `bytes`, equal to `value`, in increasing order,
+ * until it returns `true`.
+ * @return `true`, if any of the callbacks returned `true`.
+ */
+template <typename callback_at>
+bool find_equal_byte(std::uint8_t const* bytes, std::size_t count, std::uint8_t value, callback_at&& callback) {
+    std::size_t offset = 0;
+#if defined(__AVX2__)
+    __m256i const values = _mm256_set1_epi8(static_cast<char>(value));
+    for (; offset + 32 <= count; offset += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(bytes + offset));
+        unsigned matches = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(values, block)));
+        for (; matches; matches &= matches - 1)
+            if (callback(offset + __builtin_ctz(matches)))
+                return true;
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+    __m128i const values_half = _mm_set1_epi8(static_cast<char>(value));
+    for (; offset + 16 <= count; offset += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes + offset));
+        unsigned matches = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(values_half, block)));
+        for (; matches; matches &= matches - 1)
+            if (callback(offset + __builtin_ctz(matches)))
+                return true;
+    }
+#endif
+    for (; offset != count; ++offset)
+        if (bytes[offset] == value && callback(offset))
+            return true;
+    return false;
+}
+
+} // namespace unum::ukv
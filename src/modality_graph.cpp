@@ -10,15 +10,37 @@
  * - output degree
  * - inbound neighborships: neighbor ID + edge ID
  * - outbound neighborships: neighbor ID + edge ID
+ *
+ * Supernodes, with more than `page_capacity_k` neighborships, are split into pages,
+ * kept in a companion collection. The vertex entry then stores just the degrees and
+ * a directory of pages, so that updates only rewrite the pages they touch.
+ *
+ * Neighborships are stored packed, whenever that is smaller: neighbor IDs are
+ * delta-encoded, edge IDs are offset from the smallest one or elided altogether,
+ * if all are default, and both are bit-packed in blocks of `packing_block_k`.
+ * Updates work on unpacked copies, while exports decode straight into the output.
+ *
+ * Whole-graph analytics decode all neighborhoods into a transient CSR, indexed
+ * by the position of the vertex in the sorted list of keys, fetched in parallel.
  */
 
 #include <numeric>  // `std::accumulate`
 #include <optional> // `std::optional`
 #include <limits>   // `std::numeric_limits`
+#include <tuple>    // `std::tie`
+#include <vector>   // `std::vector`
+#include <thread>   // `std::thread`
+#include <atomic>   // `std::atomic`
+#include <cmath>    // `std::abs`
+#include <random>   // `std::mt19937_64`
 
 #include "ukv/ukv.hpp"
-#include "helpers/linked_memory.hpp" // `linked_memory_lock_t`
-#include "helpers/algorithm.hpp"     // `equal_subrange`
+#include "helpers/linked_memory.hpp"       // `linked_memory_lock_t`
+#include "helpers/algorithm.hpp"           // `equal_subrange`
+#include "helpers/companion.hpp"           // `companion_collection`
+#include "helpers/integer_compression.hpp" // `pack_bits`
+#include "helpers/set_intersection.hpp"    // `intersect_sorted`
+#include "helpers/parallel.hpp"            // `radix_sort`
 
 /*********************************************************/
 /*****************	 C++ Implementation	  ****************/
@@ -32,6 +54,182 @@ ukv_vertex_degree_t ukv_vertex_degree_missing_k = std::numeric_limits<ukv_vertex
 
 constexpr std::size_t bytes_in_degrees_header_k = 2 * sizeof(ukv_vertex_degree_t);
 
+/// Neighborhoods with more relations are split into pages of at most that size.
+constexpr std::size_t page_capacity_k = 4096;
+/// New pages are only filled halfway, leaving space for insertions.
+constexpr std::size_t page_fill_k = page_capacity_k / 2;
+constexpr ukv_str_view_t pages_suffix_k = "graph.pages";
+/// Every collection of pages keeps the next free page key under this key.
+constexpr ukv_key_t pages_counter_key_k = std::numeric_limits<ukv_key_t>::min();
+
+/**
+ * @brief Describes a single page in the directory of a supernode.
+ * Pages of the same role are sorted and don't overlap.
+ */
+struct page_ref_t {
+    /** @brief Smallest neighborship in the page. Meaningless for the first page of a role. */
+    neighborship_t first;
+    ukv_key_t key = 0;
+    ukv_vertex_degree_t count = 0;
+    ukv_vertex_degree_t padding = 0;
+};
+
+/**
+ * @brief Header of a paged vertex entry, followed by the directory of the outgoing
+ * and then the incoming pages. Every role has at least one page, even if empty.
+ * Starts with an impossible degree, to be distinguishable from regular entries.
+ */
+struct paged_header_t {
+    ukv_vertex_degree_t marker = ukv_vertex_degree_missing_k;
+    ukv_vertex_degree_t padding = 0;
+    ukv_vertex_degree_t degrees[2] = {0, 0};
+    ukv_vertex_degree_t pages[2] = {0, 0};
+};
+
+inline std::size_t role_idx(ukv_vertex_role_t role) noexcept {
+    return role == ukv_vertex_target_k;
+}
+
+inline bool is_paged(value_view_t bytes) noexcept {
+    return bytes.size() >= sizeof(paged_header_t) &&
+           reinterpret_cast<paged_header_t const*>(bytes.data())->marker == ukv_vertex_degree_missing_k;
+}
+
+struct paged_root_t {
+    paged_header_t* header = nullptr;
+    page_ref_t* refs = nullptr;
+
+    inline paged_root_t(ukv_bytes_ptr_t bytes) noexcept
+        : header(reinterpret_cast<paged_header_t*>(bytes)), refs(reinterpret_cast<page_ref_t*>(header + 1)) {}
+
+    inline std::size_t pages_count() const noexcept { return header->pages[0] + header->pages[1]; }
+    inline ptr_range_gt<page_ref_t> pages(std::size_t role_idx) const noexcept {
+        auto begin = refs + (role_idx ? header->pages[0] : 0);
+        return {begin, begin + header->pages[role_idx]};
+    }
+    static std::size_t size_bytes(std::size_t pages_count) noexcept {
+        return sizeof(paged_header_t) + pages_count * sizeof(page_ref_t);
+    }
+};
+
+/// Neighborships are delta-encoded and bit-packed in blocks of that many.
+constexpr std::size_t packing_block_k = 128;
+/// Packed lists, where every edge ID is `ukv_default_edge_id_k`, omit them.
+constexpr std::uint8_t packed_default_edges_k = 1;
+
+/**
+ * @brief Header of a packed vertex entry, followed by the packed lists of
+ * the outgoing and then the incoming neighborships.
+ * Starts with an impossible degree, to be distinguishable from regular entries.
+ */
+struct packed_header_t {
+    ukv_vertex_degree_t marker = std::numeric_limits<ukv_vertex_degree_t>::max() - 1;
+    ukv_vertex_degree_t degrees[2] = {0, 0};
+    ukv_length_t outgoing_bytes = 0;
+};
+
+inline bool is_packed(value_view_t bytes) noexcept {
+    return bytes.size() >= sizeof(packed_header_t) &&
+           reinterpret_cast<packed_header_t const*>(bytes.data())->marker == packed_header_t {}.marker;
+}
+
+/**
+ * @brief Upper bound on the size of a packed list of `count` neighborships.
+ */
+inline std::size_t packed_capacity(std::size_t count) noexcept {
+    if (!count)
+        return 0;
+    std::size_t const blocks = divide_round_up(count, packing_block_k);
+    return 1 + 2 * varint_max_bytes_k + blocks * 2 + count * sizeof(neighborship_t);
+}
+
+/**
+ * @brief Packs a sorted list of neighborships. Empty lists take no space.
+ * @return Pointer past the last written byte.
+ */
+byte_t* pack_ships(neighborship_t const* ships, std::size_t count, byte_t* output) noexcept {
+    if (!count)
+        return output;
+
+    auto is_default = [](neighborship_t const& ship) { return ship.edge_id == ukv_default_edge_id_k; };
+    bool const default_edges = std::all_of(ships, ships + count, is_default);
+    ukv_key_t min_edge = ships[0].edge_id;
+    for (std::size_t i = 1; i != count; ++i)
+        min_edge = std::min(min_edge, ships[i].edge_id);
+
+    *output++ = static_cast<byte_t>(default_edges ? packed_default_edges_k : 0);
+    output = varint_encode(zigzag_encode(ships[0].neighbor_id), output);
+    if (!default_edges)
+        output = varint_encode(zigzag_encode(min_edge), output);
+
+    std::uint64_t block[packing_block_k];
+    for (std::size_t offset = 0; offset < count; offset += packing_block_k) {
+        std::size_t const length = std::min(packing_block_k, count - offset);
+        for (std::size_t j = 0; j != length; ++j) {
+            std::size_t const previous = offset + j ? offset + j - 1 : 0;
+            block[j] = std::uint64_t(ships[offset + j].neighbor_id) - std::uint64_t(ships[previous].neighbor_id);
+        }
+        auto width = bits_width(block, length);
+        *output++ = static_cast<byte_t>(width);
+        output = pack_bits(block, length, width, output);
+        if (default_edges)
+            continue;
+
+        for (std::size_t j = 0; j != length; ++j)
+            block[j] = std::uint64_t(ships[offset + j].edge_id) - std::uint64_t(min_edge);
+        width = bits_width(block, length);
+        *output++ = static_cast<byte_t>(width);
+        output = pack_bits(block, length, width, output);
+    }
+    return output;
+}
+
+/**
+ * @brief Decodes a packed list of `count` neighborships block by block,
+ * passing them to the `callback` without materializing the whole list.
+ * @return Pointer past the last consumed byte.
+ */
+template <typename callback_at>
+byte_t const* for_each_packed_ship(byte_t const* input, std::size_t count, callback_at&& callback) noexcept {
+    if (!count)
+        return input;
+
+    bool const default_edges = static_cast<std::uint8_t>(*input++) & packed_default_edges_k;
+    std::uint64_t value = 0;
+    input = varint_decode(input, value);
+    auto neighbor_id = static_cast<std::uint64_t>(zigzag_decode(value));
+    auto min_edge = static_cast<std::uint64_t>(ukv_default_edge_id_k);
+    if (!default_edges)
+        input = varint_decode(input, value), min_edge = static_cast<std::uint64_t>(zigzag_decode(value));
+
+    std::uint64_t deltas[packing_block_k];
+    std::uint64_t edges[packing_block_k];
+    for (std::size_t offset = 0; offset < count; offset += packing_block_k) {
+        std::size_t const length = std::min(packing_block_k, count - offset);
+        auto const width = static_cast<unsigned>(*input++);
+        input = unpack_bits(input, length, width, deltas);
+        if (default_edges)
+            std::fill_n(edges, length, 0);
+        else {
+            auto const edges_width = static_cast<unsigned>(*input++);
+            input = unpack_bits(input, length, edges_width, edges);
+        }
+        for (std::size_t j = 0; j != length; ++j) {
+            neighbor_id += deltas[j];
+            callback(neighborship_t {static_cast<ukv_key_t>(neighbor_id), static_cast<ukv_key_t>(min_edge + edges[j])});
+        }
+    }
+    return input;
+}
+
+/**
+ * @return Pointer past the last decoded neighborship.
+ */
+inline neighborship_t* unpack_ships(byte_t const* input, std::size_t count, neighborship_t* output) noexcept {
+    for_each_packed_ship(input, count, [&](neighborship_t ship) { *output++ = ship; });
+    return output;
+}
+
 struct updated_entry_t : public collection_key_t {
     ukv_bytes_ptr_t content = nullptr;
     ukv_length_t length = ukv_length_missing_k;
@@ -55,8 +253,8 @@ ptr_range_gt<neighborship_t const> neighbors( //
 }
 
 ptr_range_gt<neighborship_t const> neighbors(value_view_t bytes, ukv_vertex_role_t role = ukv_vertex_role_any_k) {
-    // Handle missing vertices
-    if (bytes.size() < bytes_in_degrees_header_k)
+    // Handle missing vertices, the paged ones, which must be gathered first, and the packed ones
+    if (bytes.size() < bytes_in_degrees_header_k || is_paged(bytes) || is_packed(bytes))
         return {};
 
     auto degrees = reinterpret_cast<ukv_vertex_degree_t const*>(bytes.begin());
@@ -303,277 +501,1064 @@ void erase_from_entry(updated_entry_t& entry,
     entry.length -= sizeof(neighborship_t) * len;
 }
 
-template <bool export_center_ak = true, bool export_neighbor_ak = true, bool export_edge_ak = true>
-void export_edge_tuples( //
-    ukv_database_t const c_db,
-    ukv_transaction_t const c_transaction,
-    ukv_size_t const c_vertices_count,
+std::size_t neighbors_count(value_view_t bytes, ukv_vertex_role_t role) noexcept {
+    ukv_vertex_degree_t const* degrees = nullptr;
+    if (is_paged(bytes))
+        degrees = reinterpret_cast<paged_header_t const*>(bytes.data())->degrees;
+    else if (is_packed(bytes))
+        degrees = reinterpret_cast<packed_header_t const*>(bytes.data())->degrees;
+    else
+        return neighbors(bytes, role).size();
+    return (role & ukv_vertex_source_k ? degrees[0] : 0) + //
+           (role & ukv_vertex_target_k ? degrees[1] : 0);
+}
 
-    ukv_collection_t const* c_collections,
-    ukv_size_t const c_collections_stride,
+/**
+ * @brief Visits the neighborships of a regular or a packed entry in a single `role`.
+ */
+template <typename callback_at>
+void for_each_neighbor(value_view_t bytes, ukv_vertex_role_t role, callback_at&& callback) noexcept {
+    if (!is_packed(bytes)) {
+        for (neighborship_t ship : neighbors(bytes, role))
+            callback(ship);
+        return;
+    }
+    auto header = reinterpret_cast<packed_header_t const*>(bytes.data());
+    auto lists = reinterpret_cast<byte_t const*>(header + 1);
+    if (role == ukv_vertex_source_k)
+        for_each_packed_ship(lists, header->degrees[0], callback);
+    else
+        for_each_packed_ship(lists + header->outgoing_bytes, header->degrees[1], callback);
+}
 
-    ukv_key_t const* c_vertices,
-    ukv_size_t const c_vertices_stride,
+/**
+ * @brief Replaces a packed entry with its regular layout, so that it can be updated inplace.
+ */
+void unpack_entry(updated_entry_t& entry, linked_memory_lock_t& arena, ukv_error_t* c_error) {
+    if (!is_packed(entry))
+        return;
+    auto header = reinterpret_cast<packed_header_t const*>(entry.content);
+    std::size_t const ships_count = header->degrees[0] + header->degrees[1];
+    std::size_t const length = bytes_in_degrees_header_k + ships_count * sizeof(neighborship_t);
+    auto buffer = arena.alloc<byte_t>(length, c_error, alignof(neighborship_t));
+    return_if_error_m(c_error);
 
-    ukv_vertex_role_t const* c_roles,
-    ukv_size_t const c_roles_stride,
+    auto degrees = reinterpret_cast<ukv_vertex_degree_t*>(buffer.begin());
+    auto ships = reinterpret_cast<neighborship_t*>(degrees + 2);
+    auto lists = reinterpret_cast<byte_t const*>(header + 1);
+    degrees[0] = header->degrees[0];
+    degrees[1] = header->degrees[1];
+    ships = unpack_ships(lists, degrees[0], ships);
+    unpack_ships(lists + header->outgoing_bytes, degrees[1], ships);
+    entry.content = ukv_bytes_ptr_t(buffer.begin());
+    entry.length = static_cast<ukv_length_t>(length);
+}
 
-    ukv_options_t const c_options,
+/**
+ * @brief Packs a regular entry before it is written, unless that wouldn't make it smaller.
+ */
+void pack_entry(updated_entry_t& entry, linked_memory_lock_t& arena, ukv_error_t* c_error) {
+    if (entry.length == ukv_length_missing_k || entry.length < bytes_in_degrees_header_k || is_paged(entry) ||
+        is_packed(entry))
+        return;
+    auto degrees = reinterpret_cast<ukv_vertex_degree_t const*>(entry.content);
+    auto ships = reinterpret_cast<neighborship_t const*>(degrees + 2);
+    std::size_t const capacity = sizeof(packed_header_t) + packed_capacity(degrees[0]) + packed_capacity(degrees[1]);
+    auto buffer = arena.alloc<byte_t>(capacity, c_error);
+    return_if_error_m(c_error);
 
-    ukv_vertex_degree_t** c_degrees_per_vertex,
-    ukv_key_t** c_neighborships_per_vertex,
+    auto header = reinterpret_cast<packed_header_t*>(buffer.begin());
+    auto lists = reinterpret_cast<byte_t*>(header + 1);
+    auto lists_end = pack_ships(ships, degrees[0], lists);
+    *header = packed_header_t {};
+    header->degrees[0] = degrees[0];
+    header->degrees[1] = degrees[1];
+    header->outgoing_bytes = static_cast<ukv_length_t>(lists_end - lists);
+    lists_end = pack_ships(ships + degrees[0], degrees[1], lists_end);
 
+    std::size_t const length = lists_end - buffer.begin();
+    if (length >= entry.length)
+        return;
+    entry.content = ukv_bytes_ptr_t(buffer.begin());
+    entry.length = static_cast<ukv_length_t>(length);
+}
+
+/**
+ * @brief Locates the page, that contains the `ship` or should contain it.
+ * The first page of every role accepts all the smaller neighborships.
+ */
+std::size_t page_for(ptr_range_gt<page_ref_t> pages, neighborship_t ship) noexcept {
+    auto it = std::upper_bound(pages.begin() + 1, pages.end(), ship, [](neighborship_t s, page_ref_t const& page) {
+        return s < page.first;
+    });
+    return it - pages.begin() - 1;
+}
+
+/**
+ * @return `ukv_collection_main_k` if the pages collection is missing, or can't exist in this engine.
+ */
+ukv_collection_t pages_collection( //
+    ukv_database_t const c_db,
+    ukv_collection_t collection,
+    bool create_if_missing,
     linked_memory_lock_t& arena,
     ukv_error_t* c_error) {
+    if (!ukv_supports_named_collections_k)
+        return ukv_collection_main_k;
+    return companion_collection(c_db, collection, pages_suffix_k, create_if_missing, arena, c_error);
+}
 
-    // Even if we need just the node degrees, we can't limit ourselves to just entry lengths.
-    // Those may be compressed. We need to read the first bytes to parse the degree of the node.
-    ukv_bytes_ptr_t c_found_values = nullptr;
-    ukv_length_t* c_found_offsets = nullptr;
-    ukv_read_t read {
-        .db = c_db,
-        .error = c_error,
-        .transaction = c_transaction,
-        .arena = arena,
-        .options = c_options,
-        .tasks_count = c_vertices_count,
-        .collections = c_collections,
-        .collections_stride = c_collections_stride,
-        .keys = c_vertices,
-        .keys_stride = c_vertices_stride,
-        .offsets = &c_found_offsets,
-        .values = &c_found_values,
-    };
-
-    ukv_read(&read);
-    return_if_error_m(c_error);
+constexpr ukv_str_view_t edges_index_suffix_k = "graph.edges";
+constexpr ukv_str_view_t edges_weights_suffix_k = "graph.weights";
+constexpr ukv_str_view_t degrees_index_suffix_k = "graph.degrees";
 
-    joined_blobs_t values {c_vertices_count, c_found_offsets, c_found_values};
-    strided_iterator_gt<ukv_collection_t const> collections {c_collections, c_collections_stride};
-    strided_range_gt<ukv_key_t const> vertices {{c_vertices, c_vertices_stride}, c_vertices_count};
-    strided_iterator_gt<ukv_vertex_role_t const> roles {c_roles, c_roles_stride};
-    constexpr std::size_t tuple_size_k = export_center_ak + export_neighbor_ak + export_edge_ak;
+/**
+ * @brief Value of the edge index, which maps every non-default edge ID to its ends.
+ */
+struct indexed_edge_t {
+    ukv_key_t source_id;
+    ukv_key_t target_id;
+};
 
-    find_edges_t find_edges {collections, vertices.begin(), roles, c_vertices_count};
+/**
+ * @brief Value of the degrees index, which maps every vertex to its degrees in both roles.
+ */
+struct indexed_degrees_t {
+    ukv_vertex_degree_t outgoing;
+    ukv_vertex_degree_t incoming;
+};
 
-    // Estimate the amount of memory we will need for the arena
-    std::size_t count_ids = 0;
-    if constexpr (tuple_size_k != 0) {
-        joined_blobs_iterator_t values_it = values.begin();
-        for (ukv_size_t i = 0; i != c_vertices_count; ++i, ++values_it) {
-            value_view_t value = *values_it;
-            count_ids += neighbors(value, find_edges[i].role).size();
-        }
-        count_ids *= tuple_size_k;
-    }
+enum graph_companion_t : std::size_t {
+    edges_index_k = 0,
+    edges_weights_k,
+    degrees_index_k,
+    graph_companions_k,
+};
 
-    // Export into arena
-    auto ids = arena.alloc_or_dummy(count_ids, c_error, c_neighborships_per_vertex);
-    return_if_error_m(c_error);
-    auto degrees = arena.alloc_or_dummy(c_vertices_count, c_error, c_degrees_per_vertex);
-    return_if_error_m(c_error);
+/**
+ * @brief Companions of the last touched collection, like its edge and degrees indexes.
+ * Each update may have to reflect changes in all of them, so they are resolved together,
+ * with a single listing of the catalog per collection and call.
+ */
+struct graph_companions_t {
+    std::optional<ukv_collection_t> collection;
+    ukv_collection_t companions[graph_companions_k] {};
 
-    std::size_t passed_ids = 0;
-    joined_blobs_iterator_t values_it = values.begin();
-    for (std::size_t i = 0; i != c_vertices_count; ++i, ++values_it) {
-        value_view_t value = *values_it;
-        find_edge_t find_edge = find_edges[i];
+    /**
+     * @return `ukv_collection_main_k` if the companion is missing and wasn't created,
+     * or can't exist in this engine.
+     */
+    ukv_collection_t get( //
+        ukv_database_t const c_db,
+        ukv_collection_t const owner,
+        graph_companion_t const kind,
+        bool const create_if_missing,
+        linked_memory_lock_t& arena,
+        ukv_error_t* c_error) noexcept {
 
-        // Some values may be missing
-        if (!value) {
-            degrees[i] = ukv_vertex_degree_missing_k;
-            continue;
+        static constexpr ukv_str_view_t suffixes[graph_companions_k] {
+            edges_index_suffix_k,
+            edges_weights_suffix_k,
+            degrees_index_suffix_k,
+        };
+        if (!ukv_supports_named_collections_k)
+            return ukv_collection_main_k;
+        if (!collection || *collection != owner) {
+            companion_collections(c_db, owner, suffixes, graph_companions_k, companions, arena, c_error);
+            if (*c_error)
+                return ukv_collection_main_k;
+            collection = owner;
         }
+        if (companions[kind] == ukv_collection_main_k && create_if_missing)
+            companions[kind] = companion_collection(c_db, owner, suffixes[kind], true, arena, c_error);
+        return companions[kind];
+    }
+};
 
-        bool has_self_loop = false;
-        ukv_vertex_degree_t degree = 0;
-        if (find_edge.role & ukv_vertex_source_k) {
-            auto ns = neighbors(value, ukv_vertex_source_k);
-            if constexpr (tuple_size_k != 0)
-                for (neighborship_t n : ns) {
-                    if constexpr (export_center_ak)
-                        ids[passed_ids + 0] = find_edge.vertex_id;
-                    if constexpr (export_neighbor_ak)
-                        ids[passed_ids + export_center_ak] = n.neighbor_id;
-                    if constexpr (export_edge_ak)
-                        ids[passed_ids + export_center_ak + export_neighbor_ak] = n.edge_id;
-                    if (find_edge.vertex_id == n.neighbor_id)
-                        has_self_loop = true;
-                    passed_ids += tuple_size_k;
-                }
-            degree += static_cast<ukv_vertex_degree_t>(ns.size());
-        }
-        if (find_edge.role & ukv_vertex_target_k) {
-            auto ns = neighbors(value, ukv_vertex_target_k);
-            if constexpr (tuple_size_k != 0)
-                for (neighborship_t n : ns) {
-                    if (n.neighbor_id == find_edge.vertex_id && has_self_loop) {
-                        --degree;
-                        continue;
-                    }
-                    if constexpr (export_neighbor_ak)
-                        ids[passed_ids + 0] = n.neighbor_id;
-                    if constexpr (export_center_ak)
-                        ids[passed_ids + export_neighbor_ak] = find_edge.vertex_id;
-                    if constexpr (export_edge_ak)
-                        ids[passed_ids + export_center_ak + export_neighbor_ak] = n.edge_id;
-                    passed_ids += tuple_size_k;
-                }
-            degree += static_cast<ukv_vertex_degree_t>(ns.size());
-        }
+/**
+ * @return `ukv_collection_main_k` if the companion is missing, or can't exist in this engine.
+ */
+ukv_collection_t edges_companion_collection( //
+    ukv_database_t const c_db,
+    ukv_collection_t collection,
+    ukv_str_view_t suffix,
+    bool create_if_missing,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+    if (!ukv_supports_named_collections_k)
+        return ukv_collection_main_k;
+    return companion_collection(c_db, collection, suffix, create_if_missing, arena, c_error);
+}
 
-        degrees[i] = degree;
+ukv_collection_t edges_index_collection( //
+    ukv_database_t const c_db,
+    ukv_collection_t collection,
+    bool create_if_missing,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+    return edges_companion_collection(c_db, collection, edges_index_suffix_k, create_if_missing, arena, c_error);
+}
+
+/**
+ * @brief Checks if the edges of a collection are indexed or weighted,
+ * so that removals must also clean up the companions.
+ */
+bool has_edges_companions( //
+    ukv_database_t const c_db,
+    ukv_collection_t collection,
+    graph_companions_t& companions,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+    for (graph_companion_t kind : {edges_index_k, edges_weights_k}) {
+        auto companion = companions.get(c_db, collection, kind, false, arena, c_error);
+        if (*c_error || companion != ukv_collection_main_k)
+            return companion != ukv_collection_main_k;
     }
+    return false;
 }
 
-void pull_and_link_for_updates( //
+/**
+ * @brief Writes fixed-size values, produced by `value_of(task_idx)`, or removes them,
+ * under the IDs of edges in the `suffix` companions of their collections.
+ * Edges with default IDs and collections without companions are skipped,
+ * unless the companions are created on demand.
+ */
+template <typename value_of_at>
+void update_edges_companion( //
     ukv_database_t const c_db,
     ukv_transaction_t const c_transaction,
-    strided_range_gt<updated_entry_t> unique_entries,
+    graph_companions_t& companions,
+    graph_companion_t const kind,
+    bool const create_if_missing,
+    std::size_t const tasks_count,
+    strided_iterator_gt<ukv_collection_t const> collections,
+    strided_iterator_gt<ukv_key_t const> edges_ids,
+    bool const erase,
+    value_of_at&& value_of,
     ukv_options_t const c_options,
     linked_memory_lock_t& arena,
     ukv_error_t* c_error) {
 
-    // Fetch the existing entries
-    ukv_bytes_ptr_t found_binary_begin = nullptr;
-    ukv_length_t* found_binary_offs = nullptr;
-    ukv_size_t unique_count = static_cast<ukv_size_t>(unique_entries.size());
-    auto collections = unique_entries.immutable().members(&updated_entry_t::collection);
-    auto keys = unique_entries.immutable().members(&updated_entry_t::key);
-    auto opts = c_transaction ? ukv_options_t(c_options & ~ukv_option_transaction_dont_watch_k) : c_options;
-    ukv_read_t read {
+    using value_t = decltype(value_of(std::size_t(0)));
+    if (!ukv_supports_named_collections_k || !edges_ids || !tasks_count)
+        return;
+
+    auto companion_collections = arena.alloc<ukv_collection_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+    auto keys = arena.alloc<ukv_key_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+    auto values = arena.alloc<value_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+    auto offsets = arena.alloc<ukv_length_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+
+    std::size_t written_count = 0;
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        ukv_key_t const edge_id = edges_ids[i];
+        if (edge_id == ukv_default_edge_id_k)
+            continue;
+        ukv_collection_t const collection = collections ? collections[i] : ukv_collection_main_k;
+        ukv_collection_t const companion = companions.get(c_db, collection, kind, create_if_missing, arena, c_error);
+        return_if_error_m(c_error);
+        if (companion == ukv_collection_main_k)
+            continue;
+
+        companion_collections[written_count] = companion;
+        keys[written_count] = edge_id;
+        if (!erase)
+            values[written_count] = value_of(i);
+        offsets[written_count] = static_cast<ukv_length_t>(written_count * sizeof(value_t));
+        ++written_count;
+    }
+    if (!written_count)
+        return;
+
+    auto values_begin = reinterpret_cast<ukv_bytes_cptr_t>(values.begin());
+    ukv_length_t const length = sizeof(value_t);
+    ukv_write_t write {
         .db = c_db,
         .error = c_error,
         .transaction = c_transaction,
         .arena = arena,
-        .options = opts,
-        .tasks_count = unique_count,
-        .collections = collections.begin().get(),
-        .collections_stride = collections.begin().stride(),
-        .keys = keys.begin().get(),
-        .keys_stride = keys.begin().stride(),
-        .offsets = &found_binary_offs,
-        .values = &found_binary_begin,
+        .options = c_options,
+        .tasks_count = static_cast<ukv_size_t>(written_count),
+        .collections = companion_collections.begin(),
+        .collections_stride = sizeof(ukv_collection_t),
+        .keys = keys.begin(),
+        .keys_stride = sizeof(ukv_key_t),
+        .offsets = erase ? nullptr : offsets.begin(),
+        .offsets_stride = sizeof(ukv_length_t),
+        .lengths = erase ? nullptr : &length,
+        .values = erase ? nullptr : &values_begin,
     };
-
-    ukv_read(&read);
-    return_if_error_m(c_error);
-
-    // Link the response buffer to `unique_entries`
-    joined_blobs_t found_binaries {unique_count, found_binary_offs, found_binary_begin};
-    for (std::size_t i = 0; i != unique_count; ++i) {
-        auto found_binary = found_binaries[i];
-        unique_entries[i].content = ukv_bytes_ptr_t(found_binary.data());
-        unique_entries[i].length = found_binary ? static_cast<ukv_length_t>(found_binary.size()) : ukv_length_missing_k;
-    }
+    ukv_write(&write);
 }
 
-template <bool erase_ak>
-void update_neighborhoods( //
+/**
+ * @brief Reflects upserted or removed edges in the edge indexes of their collections, if those exist.
+ * Edge IDs are expected to be unique, so removals don't compare the ends of the indexed edge.
+ * The `sources_ids` and `targets_ids` are only needed for upserts.
+ */
+void update_edges_index( //
     ukv_database_t const c_db,
     ukv_transaction_t const c_transaction,
-    ukv_size_t const c_tasks_count,
+    graph_companions_t& companions,
+    std::size_t const tasks_count,
+    strided_iterator_gt<ukv_collection_t const> collections,
+    strided_iterator_gt<ukv_key_t const> edges_ids,
+    strided_iterator_gt<ukv_key_t const> sources_ids,
+    strided_iterator_gt<ukv_key_t const> targets_ids,
+    bool const erase,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
 
-    ukv_collection_t const* c_collections,
-    ukv_size_t const c_collections_stride,
+    update_edges_companion(
+        c_db,
+        c_transaction,
+        companions,
+        edges_index_k,
+        false,
+        tasks_count,
+        collections,
+        edges_ids,
+        erase,
+        [&](std::size_t i) { return indexed_edge_t {sources_ids[i], targets_ids[i]}; },
+        c_options,
+        arena,
+        c_error);
+}
 
-    ukv_key_t const* c_edges_ids,
-    ukv_size_t const c_edges_stride,
+/**
+ * @brief Stores the weights of upserted edges, creating the companion on demand,
+ * or drops the weights of removed edges, if the companion exists.
+ * Upserts without weights leave the existing ones intact.
+ */
+void update_edges_weights( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    graph_companions_t& companions,
+    std::size_t const tasks_count,
+    strided_iterator_gt<ukv_collection_t const> collections,
+    strided_iterator_gt<ukv_key_t const> edges_ids,
+    strided_iterator_gt<ukv_float_t const> weights,
+    bool const erase,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
 
-    ukv_key_t const* c_sources_ids,
-    ukv_size_t const c_sources_stride,
+    if (!erase && !weights)
+        return;
+    update_edges_companion(
+        c_db,
+        c_transaction,
+        companions,
+        edges_weights_k,
+        !erase,
+        tasks_count,
+        collections,
+        edges_ids,
+        erase,
+        [&](std::size_t i) { return weights[i]; },
+        c_options,
+        arena,
+        c_error);
+}
 
-    ukv_key_t const* c_targets_ids,
-    ukv_size_t const c_targets_stride,
+/**
+ * @brief Refreshes the degrees of vertices in the degrees indexes of their collections, if those exist.
+ * The `value_of(task_idx)` is the new neighborhood of a vertex, and missing ones drop their degrees.
+ */
+template <typename value_of_at>
+void update_degrees_index( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    graph_companions_t& companions,
+    std::size_t const tasks_count,
+    strided_iterator_gt<ukv_collection_t const> collections,
+    strided_iterator_gt<ukv_key_t const> vertices_ids,
+    value_of_at&& value_of,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    if (!ukv_supports_named_collections_k || !tasks_count)
+        return;
+
+    auto index_collections = arena.alloc<ukv_collection_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+    auto keys = arena.alloc<ukv_key_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+    auto degrees = arena.alloc<indexed_degrees_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+    auto contents = arena.alloc<ukv_bytes_cptr_t>(tasks_count, c_error);
+    return_if_error_m(c_error);
+
+    std::size_t written_count = 0;
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        ukv_collection_t const collection = collections ? collections[i] : ukv_collection_main_k;
+        ukv_collection_t const index = companions.get(c_db, collection, degrees_index_k, false, arena, c_error);
+        return_if_error_m(c_error);
+        if (index == ukv_collection_main_k)
+            continue;
 
+        value_view_t value = value_of(i);
+        index_collections[written_count] = index;
+        keys[written_count] = vertices_ids[i];
+        degrees[written_count] = indexed_degrees_t {
+            static_cast<ukv_vertex_degree_t>(neighbors_count(value, ukv_vertex_source_k)),
+            static_cast<ukv_vertex_degree_t>(neighbors_count(value, ukv_vertex_target_k)),
+        };
+        contents[written_count] = value ? reinterpret_cast<ukv_bytes_cptr_t>(&degrees[written_count]) : nullptr;
+        ++written_count;
+    }
+    if (!written_count)
+        return;
+
+    ukv_length_t const length = sizeof(indexed_degrees_t);
+    ukv_write_t write {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = c_options,
+        .tasks_count = static_cast<ukv_size_t>(written_count),
+        .collections = index_collections.begin(),
+        .collections_stride = sizeof(ukv_collection_t),
+        .keys = keys.begin(),
+        .keys_stride = sizeof(ukv_key_t),
+        .lengths = &length,
+        .values = contents.begin(),
+        .values_stride = sizeof(ukv_bytes_cptr_t),
+    };
+    ukv_write(&write);
+}
+
+/**
+ * @brief Exports the degrees of vertices from the degrees indexes of their collections.
+ * @return False, if any of the collections isn't indexed, so the neighborhoods must be read.
+ */
+bool export_indexed_degrees( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    graph_companions_t& companions,
+    find_edges_t const& find_edges,
     ukv_options_t const c_options,
+    ukv_vertex_degree_t** c_degrees_per_vertex,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    if (!ukv_supports_named_collections_k)
+        return false;
+
+    std::size_t const tasks_count = find_edges.size();
+    auto index_collections = arena.alloc<ukv_collection_t>(tasks_count, c_error);
+    if (*c_error)
+        return false;
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        ukv_collection_t const collection = find_edges[i].collection;
+        index_collections[i] = companions.get(c_db, collection, degrees_index_k, false, arena, c_error);
+        if (*c_error || index_collections[i] == ukv_collection_main_k)
+            return false;
+    }
+
+    ukv_bytes_ptr_t found_values = nullptr;
+    ukv_length_t* found_offsets = nullptr;
+    ukv_read_t read {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = ukv_options_t(c_options | ukv_option_dont_discard_memory_k),
+        .tasks_count = static_cast<ukv_size_t>(tasks_count),
+        .collections = index_collections.begin(),
+        .collections_stride = sizeof(ukv_collection_t),
+        .keys = find_edges.vertex_id_begin.get(),
+        .keys_stride = find_edges.vertex_id_begin.stride(),
+        .offsets = &found_offsets,
+        .values = &found_values,
+    };
+    ukv_read(&read);
+    if (*c_error)
+        return false;
+
+    auto degrees = arena.alloc_or_dummy(tasks_count, c_error, c_degrees_per_vertex);
+    if (*c_error)
+        return false;
+    joined_blobs_t found {tasks_count, found_offsets, found_values};
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        value_view_t value = found[i];
+        if (!value) {
+            degrees[i] = ukv_vertex_degree_missing_k;
+            continue;
+        }
+        // Like the neighborhoods themselves, absent entries are treated as empty
+        indexed_degrees_t indexed {0, 0};
+        if (value.size() == sizeof(indexed_degrees_t))
+            std::memcpy(&indexed, value.data(), sizeof(indexed_degrees_t));
+        ukv_vertex_role_t const role = find_edges[i].role;
+        degrees[i] = (role & ukv_vertex_source_k ? indexed.outgoing : 0) + //
+                     (role & ukv_vertex_target_k ? indexed.incoming : 0);
+    }
+    return true;
+}
 
+/**
+ * @brief Replaces the directories of paged vertices in `values` with complete
+ * neighborhoods in the regular layout, gathering all of their pages.
+ */
+void gather_pages( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    strided_iterator_gt<ukv_collection_t const> collections,
+    ptr_range_gt<value_view_t> values,
+    ukv_options_t const c_options,
     linked_memory_lock_t& arena,
     ukv_error_t* c_error) {
 
-    strided_iterator_gt<ukv_collection_t const> edge_collections {c_collections, c_collections_stride};
-    strided_iterator_gt<ukv_key_t const> edges_ids {c_edges_ids, c_edges_stride};
-    strided_iterator_gt<ukv_key_t const> sources_ids {c_sources_ids, c_sources_stride};
-    strided_iterator_gt<ukv_key_t const> targets_ids {c_targets_ids, c_targets_stride};
+    std::size_t pages_count = 0;
+    for (value_view_t value : values)
+        if (is_paged(value))
+            pages_count += paged_root_t(ukv_bytes_ptr_t(value.data())).pages_count();
+    if (!pages_count)
+        return;
 
-    // Fetch all the data related to touched vertices, and deduplicate them
-    auto unique_entries = arena.alloc<updated_entry_t>(c_tasks_count * 2, c_error);
+    // Resolve the collection of pages once per collection of vertices
+    auto pages = arena.alloc<collection_key_t>(pages_count, c_error);
     return_if_error_m(c_error);
-    std::fill(unique_entries.begin(), unique_entries.end(), updated_entry_t {});
-    for (ukv_size_t i = 0; i != c_tasks_count; ++i)
-        unique_entries[i].collection = edge_collections[i], unique_entries[i].key = sources_ids[i];
-    for (ukv_size_t i = 0; i != c_tasks_count; ++i)
-        unique_entries[c_tasks_count + i].collection = edge_collections[i],
-                                       unique_entries[c_tasks_count + i].key = targets_ids[i];
-
-    // Lets put all the unique IDs in the beginning of the range,
-    // and then refill the tail with replicas
-    auto unique_count = sort_and_deduplicate(unique_entries.begin(), unique_entries.end());
-    unique_entries = {unique_entries.begin(), unique_count};
+    ukv_collection_t last_collection = ukv_collection_main_k;
+    ukv_collection_t last_pages_collection = ukv_collection_main_k;
+    std::size_t passed_pages = 0;
+    for (std::size_t i = 0; i != values.size(); ++i) {
+        if (!is_paged(values[i]))
+            continue;
+        auto collection = collections ? collections[i] : ukv_collection_main_k;
+        if (last_pages_collection == ukv_collection_main_k || collection != last_collection) {
+            last_pages_collection = pages_collection(c_db, collection, false, arena, c_error);
+            return_if_error_m(c_error);
+            return_error_if_m(last_pages_collection != ukv_collection_main_k,
+                              c_error,
+                              consistency_k,
+                              "Missing pages of a supernode");
+            last_collection = collection;
+        }
+        paged_root_t root(ukv_bytes_ptr_t(values[i].data()));
+        for (std::size_t j = 0; j != root.pages_count(); ++j, ++passed_pages)
+            pages[passed_pages] = {last_pages_collection, root.refs[j].key};
+    }
 
-    // Fetch the existing entries
-    auto unique_strided = unique_entries.strided();
-    pull_and_link_for_updates(c_db, c_transaction, unique_strided, c_options, arena, c_error);
+    ukv_bytes_ptr_t found_pages_begin = nullptr;
+    ukv_length_t* found_pages_offs = nullptr;
+    ukv_read_t read {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = ukv_options_t(c_options | ukv_option_dont_discard_memory_k),
+        .tasks_count = static_cast<ukv_size_t>(pages_count),
+        .collections = &pages[0].collection,
+        .collections_stride = sizeof(collection_key_t),
+        .keys = &pages[0].key,
+        .keys_stride = sizeof(collection_key_t),
+        .offsets = &found_pages_offs,
+        .values = &found_pages_begin,
+    };
+    ukv_read(&read);
     return_if_error_m(c_error);
 
-    // Define our primary for-loop
-    auto for_each_task = [&](auto entry_role_target_edge_callback) {
-        for (std::size_t i = 0; i != c_tasks_count; ++i) {
-            auto collection = edge_collections[i];
-            auto source_id = sources_ids[i];
-            auto target_id = targets_ids[i];
-            auto edge_id = edges_ids ? edges_ids[i] : ukv_key_unknown_k;
-            auto source_idx = offset_in_sorted(unique_entries, collection_key_t {collection, source_id});
-            auto target_idx = offset_in_sorted(unique_entries, collection_key_t {collection, target_id});
-            entry_role_target_edge_callback(unique_entries[source_idx], ukv_vertex_source_k, target_id, edge_id);
-            entry_role_target_edge_callback(unique_entries[target_idx], ukv_vertex_target_k, source_id, edge_id);
+    // Concatenate the pages, outgoing first
+    joined_blobs_t found_pages {static_cast<ukv_size_t>(pages_count), found_pages_offs, found_pages_begin};
+    passed_pages = 0;
+    for (std::size_t i = 0; i != values.size(); ++i) {
+        if (!is_paged(values[i]))
+            continue;
+        paged_root_t root(ukv_bytes_ptr_t(values[i].data()));
+        std::size_t const ships_count = root.header->degrees[0] + root.header->degrees[1];
+        std::size_t const length = bytes_in_degrees_header_k + ships_count * sizeof(neighborship_t);
+        auto buffer = arena.alloc<byte_t>(length, c_error, alignof(neighborship_t));
+        return_if_error_m(c_error);
+
+        auto degrees = reinterpret_cast<ukv_vertex_degree_t*>(buffer.begin());
+        auto ships = reinterpret_cast<neighborship_t*>(degrees + 2);
+        degrees[0] = root.header->degrees[0];
+        degrees[1] = root.header->degrees[1];
+        for (std::size_t j = 0; j != root.pages_count(); ++j, ++passed_pages) {
+            value_view_t page = found_pages[passed_pages];
+            return_error_if_m(page, c_error, consistency_k, "Missing page of a supernode");
+            ships = unpack_ships(page.data(), root.refs[j].count, ships);
+        }
+        return_error_if_m(reinterpret_cast<byte_t*>(ships) == buffer.end(),
+                          c_error,
+                          consistency_k,
+                          "Pages of a supernode are inconsistent");
+        values[i] = value_view_t {buffer.begin(), length};
+    }
+}
+
+enum class page_update_kind_t {
+    insert_k,
+    erase_k,
+    erase_neighbor_k,
+    drop_k,
+};
+
+/**
+ * @brief Update of a paged vertex, which unlike `insert_into_entry()`
+ * and `erase_from_entry()` is postponed until its pages are fetched.
+ */
+struct page_update_t {
+    std::size_t entry_idx = 0;
+    ukv_vertex_role_t role = ukv_vertex_role_unknown_k;
+    neighborship_t ship;
+    page_update_kind_t kind = page_update_kind_t::insert_k;
+};
+
+struct page_updates_t {
+    ptr_range_gt<page_update_t> updates;
+    std::size_t count = 0;
+
+    inline void push(std::size_t entry_idx,
+                     ukv_vertex_role_t role,
+                     neighborship_t ship,
+                     page_update_kind_t kind) noexcept {
+        updates[count++] = page_update_t {entry_idx, role, ship, kind};
+    }
+    inline ptr_range_gt<page_update_t> pushed() const noexcept { return {updates.begin(), count}; }
+};
+
+struct touched_page_t {
+    std::size_t entry_idx = 0;
+    std::size_t role_idx = 0;
+    std::size_t page_idx = 0;
+    neighborship_t* ships = nullptr;
+    std::size_t count = 0;
+    std::size_t capacity = 0;
+
+    friend inline bool operator<(touched_page_t const& a, touched_page_t const& b) noexcept {
+        return std::tie(a.entry_idx, a.role_idx, a.page_idx) < std::tie(b.entry_idx, b.role_idx, b.page_idx);
+    }
+    friend inline bool operator==(touched_page_t const& a, touched_page_t const& b) noexcept {
+        return std::tie(a.entry_idx, a.role_idx, a.page_idx) == std::tie(b.entry_idx, b.role_idx, b.page_idx);
+    }
+};
+
+/**
+ * @brief Applies the postponed `updates` to paged vertices, and spills the regular
+ * ones, that have outgrown `page_capacity_k`, into pages. Overflowing pages are split
+ * and empty ones are removed. Writes the pages, but leaves the new directories in
+ * `entries` for the caller to write.
+ */
+void update_pages( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ptr_range_gt<updated_entry_t> entries,
+    ptr_range_gt<page_update_t> updates,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    auto should_spill = [](updated_entry_t const& entry) {
+        if (!ukv_supports_named_collections_k || entry.length == ukv_length_missing_k ||
+            entry.length < bytes_in_degrees_header_k || is_paged(entry))
+            return false;
+        auto degrees = reinterpret_cast<ukv_vertex_degree_t const*>(entry.content);
+        return degrees[0] + degrees[1] > page_capacity_k;
+    };
+    auto spilled_count = std::count_if(entries.begin(), entries.end(), should_spill);
+    if (!updates.size() && !spilled_count)
+        return;
+
+    auto opts = c_transaction ? ukv_options_t(c_options & ~ukv_option_transaction_dont_watch_k) : c_options;
+    opts = ukv_options_t(opts | ukv_option_dont_discard_memory_k);
+
+    // Resolve the collections of pages, once per collection, as entries are sorted
+    auto entries_pages = arena.alloc<ukv_collection_t>(entries.size(), c_error);
+    return_if_error_m(c_error);
+    ukv_collection_t last_collection = ukv_collection_main_k;
+    ukv_collection_t last_pages_collection = ukv_collection_main_k;
+    for (std::size_t i = 0; i != entries.size(); ++i) {
+        updated_entry_t const& entry = entries[i];
+        entries_pages[i] = ukv_collection_main_k;
+        if (!is_paged(entry) && !should_spill(entry))
+            continue;
+        if (last_pages_collection == ukv_collection_main_k || entry.collection != last_collection) {
+            last_pages_collection = pages_collection(c_db, entry.collection, true, arena, c_error);
+            return_if_error_m(c_error);
+            last_collection = entry.collection;
+        }
+        entries_pages[i] = last_pages_collection;
+    }
+
+    // Removed supernodes take all of their pages with them
+    std::size_t dropped_count = 0;
+    for (page_update_t const& update : updates)
+        if (update.kind == page_update_kind_t::drop_k && is_paged(entries[update.entry_idx]))
+            dropped_count += paged_root_t(entries[update.entry_idx].content).pages_count();
+    auto dropped = arena.alloc<collection_key_t>(dropped_count, c_error);
+    return_if_error_m(c_error);
+    dropped_count = 0;
+    for (page_update_t const& update : updates) {
+        updated_entry_t& entry = entries[update.entry_idx];
+        if (update.kind != page_update_kind_t::drop_k || !is_paged(entry))
+            continue;
+        paged_root_t root(entry.content);
+        for (std::size_t j = 0; j != root.pages_count(); ++j)
+            dropped[dropped_count++] = {entries_pages[update.entry_idx], root.refs[j].key};
+        entry.content = nullptr;
+        entry.length = ukv_length_missing_k;
+        entry.degree_delta += 1;
+    }
+
+    // Locate the pages, that every update touches
+    auto is_pending = [&](page_update_t const& update) {
+        return update.kind != page_update_kind_t::drop_k && is_paged(entries[update.entry_idx]);
+    };
+    auto pages_range = [&](page_update_t const& update) -> std::pair<std::size_t, std::size_t> {
+        auto pages = paged_root_t(entries[update.entry_idx].content).pages(role_idx(update.role));
+        if (update.kind != page_update_kind_t::erase_neighbor_k) {
+            auto page_idx = page_for(pages, update.ship);
+            return {page_idx, page_idx + 1};
         }
+        auto id = update.ship.neighbor_id;
+        auto first = page_for(pages, neighborship_t {id, std::numeric_limits<ukv_key_t>::min()});
+        auto last = page_for(pages, neighborship_t {id, std::numeric_limits<ukv_key_t>::max()});
+        return {first, last + 1};
     };
 
-    if constexpr (erase_ak)
-        for_each_task(&erase_from_entry);
-    else {
-        // Unlike erasing, which can reuse the memory, her we need three passes:
-        // 1. estimating final size
-        for_each_task(&count_inserts_into_entry);
-        // 2. reallocating into bigger buffers
-        for (std::size_t i = 0; i != unique_count; ++i) {
-            auto& unique_entry = unique_entries[i];
-            auto bytes_present = unique_entry.length != ukv_length_missing_k ? unique_entry.length : 0;
-            auto bytes_for_relations = unique_entry.degree_delta * sizeof(neighborship_t);
-            auto bytes_for_degrees = bytes_present > bytes_in_degrees_header_k ? 0 : bytes_in_degrees_header_k;
-            auto new_size = bytes_present + bytes_for_relations + bytes_for_degrees;
-            auto new_buffer = arena.alloc<byte_t>(new_size, c_error);
+    std::size_t touched_count = 0;
+    for (page_update_t const& update : updates)
+        if (is_pending(update)) {
+            auto range = pages_range(update);
+            touched_count += range.second - range.first;
+        }
+    auto touched = arena.alloc<touched_page_t>(touched_count, c_error);
+    return_if_error_m(c_error);
+    touched_count = 0;
+    for (page_update_t const& update : updates) {
+        if (!is_pending(update))
+            continue;
+        auto range = pages_range(update);
+        for (auto page_idx = range.first; page_idx != range.second; ++page_idx)
+            touched[touched_count++] = touched_page_t {update.entry_idx, role_idx(update.role), page_idx};
+    }
+    touched_count = sort_and_deduplicate(touched.begin(), touched.end());
+    touched = {touched.begin(), touched_count};
+    auto find_touched = [&](std::size_t entry_idx, std::size_t role_idx, std::size_t page_idx) -> touched_page_t& {
+        return touched[offset_in_sorted(touched, touched_page_t {entry_idx, role_idx, page_idx})];
+    };
+
+    // Fetch the touched pages, reserving space for insertions
+    if (touched_count) {
+        auto places = arena.alloc<collection_key_t>(touched_count, c_error);
+        return_if_error_m(c_error);
+        for (std::size_t i = 0; i != touched_count; ++i) {
+            touched_page_t const& page = touched[i];
+            auto pages = paged_root_t(entries[page.entry_idx].content).pages(page.role_idx);
+            places[i] = {entries_pages[page.entry_idx], pages[page.page_idx].key};
+        }
+
+        ukv_bytes_ptr_t found_pages_begin = nullptr;
+        ukv_length_t* found_pages_offs = nullptr;
+        ukv_read_t read {
+            .db = c_db,
+            .error = c_error,
+            .transaction = c_transaction,
+            .arena = arena,
+            .options = opts,
+            .tasks_count = static_cast<ukv_size_t>(touched_count),
+            .collections = &places[0].collection,
+            .collections_stride = sizeof(collection_key_t),
+            .keys = &places[0].key,
+            .keys_stride = sizeof(collection_key_t),
+            .offsets = &found_pages_offs,
+            .values = &found_pages_begin,
+        };
+        ukv_read(&read);
+        return_if_error_m(c_error);
+
+        for (page_update_t const& update : updates)
+            if (is_pending(update) && update.kind == page_update_kind_t::insert_k)
+                find_touched(update.entry_idx, role_idx(update.role), pages_range(update).first).capacity++;
+
+        joined_blobs_t found_pages {static_cast<ukv_size_t>(touched_count), found_pages_offs, found_pages_begin};
+        for (std::size_t i = 0; i != touched_count; ++i) {
+            touched_page_t& page = touched[i];
+            value_view_t found_page = found_pages[i];
+            return_error_if_m(found_page, c_error, consistency_k, "Missing page of a supernode");
+            page.count = paged_root_t(entries[page.entry_idx].content).pages(page.role_idx)[page.page_idx].count;
+            page.capacity += page.count;
+            auto ships = arena.alloc<neighborship_t>(std::max<std::size_t>(page.capacity, 1), c_error);
             return_if_error_m(c_error);
-            std::memcpy(new_buffer.begin(), unique_entry.content, bytes_present);
+            unpack_ships(found_page.data(), page.count, ships.begin());
+            page.ships = ships.begin();
+        }
+    }
 
-            unique_entry.content = (ukv_bytes_ptr_t)new_buffer.begin();
-            // No need to grow `length` here, we will update in `insert_into_entry` later
-            unique_entry.length = bytes_present;
+    // Apply the updates in their original order
+    for (page_update_t const& update : updates) {
+        if (!is_pending(update))
+            continue;
+        updated_entry_t& entry = entries[update.entry_idx];
+        paged_header_t& header = *paged_root_t(entry.content).header;
+        auto const update_role_idx = role_idx(update.role);
+        auto range = pages_range(update);
+        for (auto page_idx = range.first; page_idx != range.second; ++page_idx) {
+            touched_page_t& page = find_touched(update.entry_idx, update_role_idx, page_idx);
+            auto begin = page.ships;
+            auto end = page.ships + page.count;
+            std::size_t offset = 0;
+            std::size_t length = 0;
+            if (update.kind == page_update_kind_t::insert_k) {
+                auto it = std::lower_bound(begin, end, update.ship);
+                if (it != end && *it == update.ship)
+                    continue;
+                page.count = trivial_insert(page.ships, page.count, it - begin, &update.ship, &update.ship + 1);
+                header.degrees[update_role_idx] += 1;
+                entry.degree_delta += 1;
+                continue;
+            }
+            else if (update.kind == page_update_kind_t::erase_k) {
+                auto it = std::lower_bound(begin, end, update.ship);
+                if (it == end || *it != update.ship)
+                    continue;
+                offset = it - begin;
+                length = 1;
+            }
+            else {
+                auto pair = std::equal_range(begin, end, update.ship.neighbor_id);
+                offset = pair.first - begin;
+                length = pair.second - pair.first;
+            }
+            page.count = trivial_erase(page.ships, page.count, offset, length);
+            header.degrees[update_role_idx] -= length;
+            entry.degree_delta += length;
         }
-        // 3. performing insertions
-        for_each_task(&insert_into_entry);
     }
 
-    // Some of the requested updates may have been completely useless, like:
-    // > upserting an existing relation.
-    // > removing a missing relation.
-    // So we can further optimize by cancelling those writes.
-    std::partition(unique_entries.begin(), unique_entries.end(), std::mem_fn(&updated_entry_t::degree_delta));
+    // Estimate the number of new pages and the number of writes
+    auto chunks_count = [](std::size_t ships_count) -> std::size_t {
+        return ships_count > page_capacity_k ? divide_round_up(ships_count, page_fill_k) : 1;
+    };
+    auto spilled_chunks_count = [](std::size_t ships_count) -> std::size_t {
+        return std::max<std::size_t>(divide_round_up(ships_count, page_fill_k), 1);
+    };
+    auto new_pages = arena.alloc<std::size_t>(entries.size(), c_error);
+    return_if_error_m(c_error);
+    std::fill(new_pages.begin(), new_pages.end(), 0);
+    std::size_t writes_count = dropped_count;
+    for (touched_page_t const& page : touched) {
+        new_pages[page.entry_idx] += chunks_count(page.count) - 1;
+        writes_count += chunks_count(page.count);
+    }
+    for (std::size_t i = 0; i != entries.size(); ++i) {
+        if (!should_spill(entries[i]))
+            continue;
+        auto degrees = reinterpret_cast<ukv_vertex_degree_t const*>(entries[i].content);
+        new_pages[i] = spilled_chunks_count(degrees[0]) + spilled_chunks_count(degrees[1]);
+        writes_count += new_pages[i];
+    }
 
-    // Dump the data back to disk!
-    auto collections = unique_strided.immutable().members(&updated_entry_t::collection);
-    auto keys = unique_strided.immutable().members(&updated_entry_t::key);
-    auto contents = unique_strided.immutable().members(&updated_entry_t::content);
-    auto lengths = unique_strided.immutable().members(&updated_entry_t::length);
+    // Fetch the counters of page keys from every collection of pages in need
+    std::size_t counters_count = 0;
+    last_pages_collection = ukv_collection_main_k;
+    for (std::size_t i = 0; i != entries.size(); ++i)
+        if (new_pages[i] && entries_pages[i] != last_pages_collection)
+            last_pages_collection = entries_pages[i], ++counters_count;
+    writes_count += counters_count;
+
+    auto counters_places = arena.alloc<collection_key_t>(counters_count, c_error);
+    return_if_error_m(c_error);
+    auto counters = arena.alloc<ukv_key_t>(counters_count, c_error);
+    return_if_error_m(c_error);
+    counters_count = 0;
+    last_pages_collection = ukv_collection_main_k;
+    for (std::size_t i = 0; i != entries.size(); ++i)
+        if (new_pages[i] && entries_pages[i] != last_pages_collection)
+            last_pages_collection = entries_pages[i],
+            counters_places[counters_count++] = {last_pages_collection, pages_counter_key_k};
+
+    if (counters_count) {
+        ukv_bytes_ptr_t found_counters_begin = nullptr;
+        ukv_length_t* found_counters_offs = nullptr;
+        ukv_read_t read {
+            .db = c_db,
+            .error = c_error,
+            .transaction = c_transaction,
+            .arena = arena,
+            .options = opts,
+            .tasks_count = static_cast<ukv_size_t>(counters_count),
+            .collections = &counters_places[0].collection,
+            .collections_stride = sizeof(collection_key_t),
+            .keys = &counters_places[0].key,
+            .keys_stride = sizeof(collection_key_t),
+            .offsets = &found_counters_offs,
+            .values = &found_counters_begin,
+        };
+        ukv_read(&read);
+        return_if_error_m(c_error);
+
+        joined_blobs_t found_counters {static_cast<ukv_size_t>(counters_count),
+                                       found_counters_offs,
+                                       found_counters_begin};
+        for (std::size_t i = 0; i != counters_count; ++i) {
+            value_view_t found_counter = found_counters[i];
+            counters[i] = 0;
+            if (found_counter.size() == sizeof(ukv_key_t))
+                std::memcpy(&counters[i], found_counter.data(), sizeof(ukv_key_t));
+        }
+    }
+
+    // Rebuild the directories, collecting the pages to be written
+    auto writes = arena.alloc<updated_entry_t>(writes_count, c_error);
+    return_if_error_m(c_error);
+    std::size_t passed_writes = 0;
+    auto write_page = [&](ukv_collection_t collection, ukv_key_t key, neighborship_t const* ships, std::size_t count) {
+        updated_entry_t& write = writes[passed_writes++];
+        write.collection = collection;
+        write.key = key;
+        write.content = nullptr;
+        write.length = ukv_length_missing_k;
+        if (!ships || *c_error)
+            return;
+        // Even empty pages must be present, so we allocate at least one byte
+        auto packed = arena.alloc<byte_t>(std::max<std::size_t>(packed_capacity(count), 1), c_error);
+        if (*c_error)
+            return;
+        write.content = ukv_bytes_ptr_t(packed.begin());
+        write.length = static_cast<ukv_length_t>(pack_ships(ships, count, packed.begin()) - packed.begin());
+    };
+    for (collection_key_t const& page : dropped)
+        write_page(page.collection, page.key, nullptr, 0);
+
+    std::ptrdiff_t counter_idx = -1;
+    last_pages_collection = ukv_collection_main_k;
+    touched_page_t const* touched_it = touched.begin();
+    for (std::size_t i = 0; i != entries.size(); ++i) {
+        updated_entry_t& entry = entries[i];
+        bool const spill = should_spill(entry);
+        bool const is_touched = touched_it != touched.end() && touched_it->entry_idx == i;
+        if (!spill && !is_touched)
+            continue;
+
+        ukv_collection_t const pages = entries_pages[i];
+        if (new_pages[i] && pages != last_pages_collection)
+            last_pages_collection = pages, ++counter_idx;
+
+        std::size_t role_pages[2] = {0, 0};
+        auto new_header = paged_header_t {};
+        if (spill) {
+            auto degrees = reinterpret_cast<ukv_vertex_degree_t const*>(entry.content);
+            new_header.degrees[0] = degrees[0];
+            new_header.degrees[1] = degrees[1];
+            role_pages[0] = spilled_chunks_count(degrees[0]);
+            role_pages[1] = spilled_chunks_count(degrees[1]);
+        }
+        else {
+            paged_root_t root(entry.content);
+            new_header = *root.header;
+            touched_page_t const* role_touched_it = touched_it;
+            for (std::size_t r = 0; r != 2; ++r) {
+                for (std::size_t j = 0; j != root.header->pages[r]; ++j) {
+                    bool const is_page_touched = role_touched_it != touched.end() && role_touched_it->entry_idx == i &&
+                                                 role_touched_it->role_idx == r && role_touched_it->page_idx == j;
+                    if (!is_page_touched)
+                        role_pages[r] += 1;
+                    else {
+                        bool const is_removed = !role_touched_it->count && j != 0;
+                        role_pages[r] += is_removed ? 0 : chunks_count(role_touched_it->count);
+                        ++role_touched_it;
+                    }
+                }
+            }
+        }
+        new_header.pages[0] = static_cast<ukv_vertex_degree_t>(role_pages[0]);
+        new_header.pages[1] = static_cast<ukv_vertex_degree_t>(role_pages[1]);
+
+        std::size_t const new_length = paged_root_t::size_bytes(role_pages[0] + role_pages[1]);
+        auto new_root_bytes = arena.alloc<byte_t>(new_length, c_error);
+        return_if_error_m(c_error);
+        paged_root_t new_root(ukv_bytes_ptr_t(new_root_bytes.begin()));
+        *new_root.header = new_header;
+        page_ref_t* new_ref = new_root.refs;
+
+        // Evenly splits `count` neighborships into pages, reusing the `key` for the first one, if present
+        auto emit_pages = [&](neighborship_t const* ships,
+                              std::size_t count,
+                              std::size_t chunks,
+                              std::optional<ukv_key_t> key,
+                              neighborship_t first) {
+            std::size_t const chunk_size = divide_round_up(count, chunks);
+            for (std::size_t k = 0; k != chunks; ++k, ++new_ref) {
+                std::size_t const offset = k * chunk_size;
+                std::size_t const length = std::min(chunk_size, count - offset);
+                new_ref->first = length ? ships[offset] : first;
+                new_ref->key = k == 0 && key ? *key : counters[counter_idx]++;
+                new_ref->count = static_cast<ukv_vertex_degree_t>(length);
+                new_ref->padding = 0;
+                write_page(pages, new_ref->key, ships + offset, length);
+            }
+        };
+
+        if (spill) {
+            auto degrees = reinterpret_cast<ukv_vertex_degree_t const*>(entry.content);
+            auto ships = reinterpret_cast<neighborship_t const*>(degrees + 2);
+            emit_pages(ships, degrees[0], role_pages[0], std::nullopt, neighborship_t {});
+            emit_pages(ships + degrees[0], degrees[1], role_pages[1], std::nullopt, neighborship_t {});
+        }
+        else {
+            paged_root_t root(entry.content);
+            for (std::size_t r = 0; r != 2; ++r) {
+                auto old_refs = root.pages(r);
+                for (std::size_t j = 0; j != old_refs.size(); ++j) {
+                    bool const is_page_touched = touched_it != touched.end() && touched_it->entry_idx == i &&
+                                                 touched_it->role_idx == r && touched_it->page_idx == j;
+                    if (!is_page_touched) {
+                        *new_ref = old_refs[j];
+                        ++new_ref;
+                        continue;
+                    }
+                    touched_page_t const& page = *touched_it;
+                    ++touched_it;
+                    if (!page.count && j != 0)
+                        write_page(pages, old_refs[j].key, nullptr, 0);
+                    else
+                        emit_pages(page.ships,
+                                   page.count,
+                                   chunks_count(page.count),
+                                   old_refs[j].key,
+                                   old_refs[j].first);
+                }
+            }
+        }
+
+        return_if_error_m(c_error);
+        entry.content = ukv_bytes_ptr_t(new_root_bytes.begin());
+        entry.length = static_cast<ukv_length_t>(new_length);
+        entry.degree_delta += spill;
+    }
+
+    for (std::size_t i = 0; i != counters_count; ++i) {
+        updated_entry_t& write = writes[passed_writes++];
+        write.collection = counters_places[i].collection;
+        write.key = pages_counter_key_k;
+        write.content = ukv_bytes_ptr_t(&counters[i]);
+        write.length = sizeof(ukv_key_t);
+    }
 
+    if (!passed_writes)
+        return;
+    auto writes_strided = ptr_range_gt<updated_entry_t> {writes.begin(), passed_writes}.strided();
+    auto collections = writes_strided.immutable().members(&updated_entry_t::collection);
+    auto keys = writes_strided.immutable().members(&updated_entry_t::key);
+    auto contents = writes_strided.immutable().members(&updated_entry_t::content);
+    auto lengths = writes_strided.immutable().members(&updated_entry_t::length);
     ukv_write_t write {
         .db = c_db,
         .error = c_error,
         .transaction = c_transaction,
         .arena = arena,
-        .options = c_options,
-        .tasks_count = unique_count,
+        .options = ukv_options_t(c_options | ukv_option_dont_discard_memory_k),
+        .tasks_count = static_cast<ukv_size_t>(passed_writes),
         .collections = collections.begin().get(),
         .collections_stride = collections.begin().stride(),
         .keys = keys.begin().get(),
@@ -583,255 +1568,2668 @@ void update_neighborhoods( //
         .values = contents.begin().get(),
         .values_stride = contents.begin().stride(),
     };
+    ukv_write(&write);
+}
+
+/**
+ * @brief Exports the edges of vertices, which neighborhoods were already fetched into `values`.
+ * The directories of paged vertices in `values` are replaced with gathered neighborhoods.
+ */
+template <bool export_center_ak = true, bool export_neighbor_ak = true, bool export_edge_ak = true>
+void export_fetched_edge_tuples( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    find_edges_t const& find_edges,
+    ptr_range_gt<value_view_t> values,
+    ukv_options_t const c_options,
+    ukv_vertex_degree_t** c_degrees_per_vertex,
+    ukv_key_t** c_neighborships_per_vertex,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    constexpr std::size_t tuple_size_k = export_center_ak + export_neighbor_ak + export_edge_ak;
+
+    // Degrees of supernodes are known from their directories,
+    // but to export the neighbors we must gather their pages.
+    if constexpr (tuple_size_k != 0) {
+        gather_pages(c_db, c_transaction, find_edges.collections_begin, values, c_options, arena, c_error);
+        return_if_error_m(c_error);
+    }
+
+    // Estimate the amount of memory we will need for the arena
+    std::size_t count_ids = 0;
+    if constexpr (tuple_size_k != 0) {
+        for (std::size_t i = 0; i != values.size(); ++i)
+            count_ids += neighbors_count(values[i], find_edges[i].role);
+        count_ids *= tuple_size_k;
+    }
+
+    // Export into arena
+    auto ids = arena.alloc_or_dummy(count_ids, c_error, c_neighborships_per_vertex);
+    return_if_error_m(c_error);
+    auto degrees = arena.alloc_or_dummy(values.size(), c_error, c_degrees_per_vertex);
+    return_if_error_m(c_error);
+
+    std::size_t passed_ids = 0;
+    for (std::size_t i = 0; i != values.size(); ++i) {
+        value_view_t value = values[i];
+        find_edge_t find_edge = find_edges[i];
+
+        // Some values may be missing
+        if (!value) {
+            degrees[i] = ukv_vertex_degree_missing_k;
+            continue;
+        }
+
+        bool has_self_loop = false;
+        ukv_vertex_degree_t degree = 0;
+        // Packed neighborships are decoded directly into the output tuples
+        if (find_edge.role & ukv_vertex_source_k) {
+            if constexpr (tuple_size_k != 0)
+                for_each_neighbor(value, ukv_vertex_source_k, [&](neighborship_t n) {
+                    if constexpr (export_center_ak)
+                        ids[passed_ids + 0] = find_edge.vertex_id;
+                    if constexpr (export_neighbor_ak)
+                        ids[passed_ids + export_center_ak] = n.neighbor_id;
+                    if constexpr (export_edge_ak)
+                        ids[passed_ids + export_center_ak + export_neighbor_ak] = n.edge_id;
+                    if (find_edge.vertex_id == n.neighbor_id)
+                        has_self_loop = true;
+                    passed_ids += tuple_size_k;
+                });
+            degree += static_cast<ukv_vertex_degree_t>(neighbors_count(value, ukv_vertex_source_k));
+        }
+        if (find_edge.role & ukv_vertex_target_k) {
+            if constexpr (tuple_size_k != 0)
+                for_each_neighbor(value, ukv_vertex_target_k, [&](neighborship_t n) {
+                    if (n.neighbor_id == find_edge.vertex_id && has_self_loop) {
+                        --degree;
+                        return;
+                    }
+                    if constexpr (export_neighbor_ak)
+                        ids[passed_ids + 0] = n.neighbor_id;
+                    if constexpr (export_center_ak)
+                        ids[passed_ids + export_neighbor_ak] = find_edge.vertex_id;
+                    if constexpr (export_edge_ak)
+                        ids[passed_ids + export_center_ak + export_neighbor_ak] = n.edge_id;
+                    passed_ids += tuple_size_k;
+                });
+            degree += static_cast<ukv_vertex_degree_t>(neighbors_count(value, ukv_vertex_target_k));
+        }
+
+        degrees[i] = degree;
+    }
+}
+
+template <bool export_center_ak = true, bool export_neighbor_ak = true, bool export_edge_ak = true>
+void export_edge_tuples( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_size_t const c_vertices_count,
+
+    ukv_collection_t const* c_collections,
+    ukv_size_t const c_collections_stride,
+
+    ukv_key_t const* c_vertices,
+    ukv_size_t const c_vertices_stride,
+
+    ukv_vertex_role_t const* c_roles,
+    ukv_size_t const c_roles_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_vertex_degree_t** c_degrees_per_vertex,
+    ukv_key_t** c_neighborships_per_vertex,
+
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    // Even if we need just the node degrees, we can't limit ourselves to just entry lengths.
+    // Those may be compressed. We need to read the first bytes to parse the degree of the node.
+    ukv_bytes_ptr_t c_found_values = nullptr;
+    ukv_length_t* c_found_offsets = nullptr;
+    ukv_read_t read {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = c_options,
+        .tasks_count = c_vertices_count,
+        .collections = c_collections,
+        .collections_stride = c_collections_stride,
+        .keys = c_vertices,
+        .keys_stride = c_vertices_stride,
+        .offsets = &c_found_offsets,
+        .values = &c_found_values,
+    };
+
+    ukv_read(&read);
+    return_if_error_m(c_error);
+
+    strided_iterator_gt<ukv_collection_t const> collections {c_collections, c_collections_stride};
+    strided_iterator_gt<ukv_key_t const> vertices {c_vertices, c_vertices_stride};
+    strided_iterator_gt<ukv_vertex_role_t const> roles {c_roles, c_roles_stride};
+    find_edges_t find_edges {collections, vertices, roles, c_vertices_count};
+
+    joined_blobs_t found_values {c_vertices_count, c_found_offsets, c_found_values};
+    auto values = arena.alloc<value_view_t>(c_vertices_count, c_error);
+    return_if_error_m(c_error);
+    for (ukv_size_t i = 0; i != c_vertices_count; ++i)
+        values[i] = found_values[i];
+
+    export_fetched_edge_tuples<export_center_ak, export_neighbor_ak, export_edge_ak>( //
+        c_db,
+        c_transaction,
+        find_edges,
+        values,
+        c_options,
+        c_degrees_per_vertex,
+        c_neighborships_per_vertex,
+        arena,
+        c_error);
+}
+
+/**
+ * @brief Points the `entry` to its fetched `value`, unpacking it, if it will be updated inplace.
+ */
+void link_for_update(updated_entry_t& entry,
+                     value_view_t value,
+                     linked_memory_lock_t& arena,
+                     ukv_error_t* c_error) {
+    entry.content = ukv_bytes_ptr_t(value.data());
+    entry.length = value ? static_cast<ukv_length_t>(value.size()) : ukv_length_missing_k;
+    unpack_entry(entry, arena, c_error);
+}
+
+void pull_and_link_for_updates( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    strided_range_gt<updated_entry_t> unique_entries,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    // Fetch the existing entries
+    ukv_bytes_ptr_t found_binary_begin = nullptr;
+    ukv_length_t* found_binary_offs = nullptr;
+    ukv_size_t unique_count = static_cast<ukv_size_t>(unique_entries.size());
+    auto collections = unique_entries.immutable().members(&updated_entry_t::collection);
+    auto keys = unique_entries.immutable().members(&updated_entry_t::key);
+    auto opts = c_transaction ? ukv_options_t(c_options & ~ukv_option_transaction_dont_watch_k) : c_options;
+    ukv_read_t read {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = opts,
+        .tasks_count = unique_count,
+        .collections = collections.begin().get(),
+        .collections_stride = collections.begin().stride(),
+        .keys = keys.begin().get(),
+        .keys_stride = keys.begin().stride(),
+        .offsets = &found_binary_offs,
+        .values = &found_binary_begin,
+    };
+
+    ukv_read(&read);
+    return_if_error_m(c_error);
+
+    // Link the response buffer to `unique_entries`, unpacking what will be updated inplace
+    joined_blobs_t found_binaries {unique_count, found_binary_offs, found_binary_begin};
+    for (std::size_t i = 0; i != unique_count; ++i) {
+        link_for_update(unique_entries[i], found_binaries[i], arena, c_error);
+        return_if_error_m(c_error);
+    }
+}
+
+/**
+ * @brief One of the ends of an updated edge.
+ * The `task` index is offset by the number of tasks for the targets.
+ */
+struct half_edge_t {
+    collection_key_t vertex;
+    std::size_t task = 0;
+};
+
+/// Batches with fewer half-edges per thread are sorted and applied on the calling thread.
+constexpr std::size_t parallel_half_edges_k = 256 * 1024;
+
+template <bool erase_ak>
+void update_neighborhoods( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_size_t const c_tasks_count,
+
+    ukv_collection_t const* c_collections,
+    ukv_size_t const c_collections_stride,
+
+    ukv_key_t const* c_edges_ids,
+    ukv_size_t const c_edges_stride,
+
+    ukv_key_t const* c_sources_ids,
+    ukv_size_t const c_sources_stride,
+
+    ukv_key_t const* c_targets_ids,
+    ukv_size_t const c_targets_stride,
+
+    ukv_float_t const* c_weights,
+    ukv_size_t const c_weights_stride,
+
+    ukv_options_t const c_options,
+
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    strided_iterator_gt<ukv_collection_t const> edge_collections {c_collections, c_collections_stride};
+    strided_iterator_gt<ukv_key_t const> edges_ids {c_edges_ids, c_edges_stride};
+    strided_iterator_gt<ukv_key_t const> sources_ids {c_sources_ids, c_sources_stride};
+    strided_iterator_gt<ukv_key_t const> targets_ids {c_targets_ids, c_targets_stride};
+    strided_iterator_gt<ukv_float_t const> weights {c_weights, c_weights_stride};
+
+    // Validate the weights before anything is written
+    if (weights) {
+        return_error_if_m(ukv_supports_named_collections_k,
+                          c_error,
+                          missing_feature_k,
+                          "Edge weights need named collections");
+        return_error_if_m(edges_ids, c_error, args_wrong_k, "Weighted edges need IDs");
+        for (std::size_t i = 0; i != c_tasks_count; ++i) {
+            return_error_if_m(edges_ids[i] != ukv_default_edge_id_k,
+                              c_error,
+                              args_wrong_k,
+                              "Weighted edges need IDs");
+            return_error_if_m(weights[i] >= 0, c_error, args_wrong_k, "Edge weights must be non-negative");
+        }
+    }
+
+    // Group both ends of every edge by vertex with a stable radix sort, so that each entry
+    // is later updated by a single thread, visiting its neighbors in the order of tasks
+    std::size_t const half_edges_count = c_tasks_count * 2;
+    std::size_t const threads_count = std::clamp<std::size_t>( //
+        half_edges_count / parallel_half_edges_k,
+        1,
+        std::max(1u, std::thread::hardware_concurrency()));
+    auto half_edges = arena.alloc<half_edge_t>(half_edges_count, c_error);
+    return_if_error_m(c_error);
+    auto sorting_buffer = arena.alloc<half_edge_t>(half_edges_count, c_error);
+    return_if_error_m(c_error);
+    for (std::size_t i = 0; i != c_tasks_count; ++i) {
+        half_edges[i] = half_edge_t {{edge_collections[i], sources_ids[i]}, i};
+        half_edges[c_tasks_count + i] = half_edge_t {{edge_collections[i], targets_ids[i]}, c_tasks_count + i};
+    }
+    auto signed_key = [](half_edge_t const& half) {
+        return static_cast<std::uint64_t>(half.vertex.key) ^ (std::uint64_t(1) << 63);
+    };
+    auto collection = [](half_edge_t const& half) { return std::uint64_t(half.vertex.collection); };
+    radix_sort(half_edges.begin(), sorting_buffer.begin(), half_edges_count, signed_key, threads_count);
+    radix_sort(half_edges.begin(), sorting_buffer.begin(), half_edges_count, collection, threads_count);
+
+    // Every group of equal vertices becomes one of the `unique_entries`
+    auto unique_entries = arena.alloc<updated_entry_t>(half_edges_count, c_error);
+    return_if_error_m(c_error);
+    auto groups_offsets = arena.alloc<std::size_t>(half_edges_count + 1, c_error);
+    return_if_error_m(c_error);
+    std::size_t unique_count = 0;
+    for (std::size_t i = 0; i != half_edges_count; ++i) {
+        if (i && half_edges[i].vertex == half_edges[i - 1].vertex)
+            continue;
+        groups_offsets[unique_count] = i;
+        unique_entries[unique_count] = updated_entry_t {};
+        unique_entries[unique_count].collection = half_edges[i].vertex.collection;
+        unique_entries[unique_count].key = half_edges[i].vertex.key;
+        ++unique_count;
+    }
+    groups_offsets[unique_count] = half_edges_count;
+    unique_entries = {unique_entries.begin(), unique_count};
+
+    // Fetch the existing entries
+    auto unique_strided = unique_entries.strided();
+    pull_and_link_for_updates(c_db, c_transaction, unique_strided, c_options, arena, c_error);
+    return_if_error_m(c_error);
+
+    // Supernodes can't be updated inplace, so we postpone those updates until their pages are fetched
+    page_updates_t page_updates;
+    page_updates.updates = arena.alloc<page_update_t>(half_edges_count, c_error);
+    return_if_error_m(c_error);
+
+    // Define our primary for-loops
+    auto for_each_neighbor_in_group = [&](std::size_t entry_idx, auto role_neighbor_edge_callback) {
+        for (std::size_t i = groups_offsets[entry_idx]; i != groups_offsets[entry_idx + 1]; ++i) {
+            std::size_t task = half_edges[i].task;
+            bool is_target = task >= c_tasks_count;
+            task -= is_target ? c_tasks_count : 0;
+            auto edge_id = edges_ids ? edges_ids[task] : ukv_key_unknown_k;
+            if (is_target)
+                role_neighbor_edge_callback(ukv_vertex_target_k, sources_ids[task], edge_id);
+            else
+                role_neighbor_edge_callback(ukv_vertex_source_k, targets_ids[task], edge_id);
+        }
+    };
+    auto for_each_inplace_entry = [&](auto entry_idx_callback) {
+        parallel_for_slices(threads_count, unique_count, [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t idx = begin; idx != end; ++idx)
+                if (!is_paged(unique_entries[idx]))
+                    entry_idx_callback(unique_entries[idx], idx);
+        });
+    };
+    auto postpone_paged = [&](page_update_kind_t kind) {
+        for (std::size_t idx = 0; idx != unique_count; ++idx)
+            if (is_paged(unique_entries[idx]))
+                for_each_neighbor_in_group(idx, [&](ukv_vertex_role_t role, ukv_key_t neighbor, ukv_key_t edge) {
+                    page_updates.push(idx, role, neighborship_t {neighbor, edge}, kind);
+                });
+    };
+
+    if constexpr (erase_ak) {
+        for_each_inplace_entry([&](updated_entry_t& entry, std::size_t idx) {
+            for_each_neighbor_in_group(idx, [&](ukv_vertex_role_t role, ukv_key_t neighbor, ukv_key_t edge) {
+                erase_from_entry(entry, role, neighbor, edge);
+            });
+        });
+        postpone_paged(page_update_kind_t::erase_k);
+    }
+    else {
+        // Unlike erasing, which can reuse the memory, her we need three passes:
+        // 1. estimating final size
+        for_each_inplace_entry([&](updated_entry_t& entry, std::size_t idx) {
+            for_each_neighbor_in_group(idx, [&](ukv_vertex_role_t role, ukv_key_t neighbor, ukv_key_t edge) {
+                count_inserts_into_entry(entry, role, neighbor, edge);
+            });
+        });
+        // 2. reserving bigger buffers with a single allocation, keeping them word-aligned
+        auto grown_contents = arena.alloc<ukv_bytes_ptr_t>(unique_count, c_error);
+        return_if_error_m(c_error);
+        auto grown_size = [](updated_entry_t const& unique_entry) {
+            auto bytes_present = unique_entry.length != ukv_length_missing_k ? unique_entry.length : 0;
+            auto bytes_for_relations = unique_entry.degree_delta * sizeof(neighborship_t);
+            auto bytes_for_degrees = bytes_present > bytes_in_degrees_header_k ? 0 : bytes_in_degrees_header_k;
+            return divide_round_up<std::size_t>(bytes_present + bytes_for_relations + bytes_for_degrees,
+                                                sizeof(ukv_key_t));
+        };
+        std::size_t grown_words = 0;
+        for (std::size_t i = 0; i != unique_count; ++i)
+            if (!is_paged(unique_entries[i]))
+                grown_words += grown_size(unique_entries[i]);
+        auto grown_buffer = arena.alloc<ukv_key_t>(grown_words, c_error);
+        return_if_error_m(c_error);
+        grown_words = 0;
+        for (std::size_t i = 0; i != unique_count; ++i)
+            if (!is_paged(unique_entries[i]))
+                grown_contents[i] = ukv_bytes_ptr_t(grown_buffer.begin() + grown_words),
+                grown_words += grown_size(unique_entries[i]);
+        // 3. copying the old contents and performing insertions
+        for_each_inplace_entry([&](updated_entry_t& entry, std::size_t idx) {
+            auto bytes_present = entry.length != ukv_length_missing_k ? entry.length : 0;
+            std::memcpy(grown_contents[idx], entry.content, bytes_present);
+            entry.content = grown_contents[idx];
+            // No need to grow `length` here, we will update in `insert_into_entry` later
+            entry.length = bytes_present;
+            for_each_neighbor_in_group(idx, [&](ukv_vertex_role_t role, ukv_key_t neighbor, ukv_key_t edge) {
+                insert_into_entry(entry, role, neighbor, edge);
+            });
+        });
+        postpone_paged(page_update_kind_t::insert_k);
+    }
+
+    // Update the pages of supernodes, and split the neighborhoods, that have grown too big
+    update_pages(c_db, c_transaction, unique_entries, page_updates.pushed(), c_options, arena, c_error);
+    return_if_error_m(c_error);
+
+    // Some of the requested updates may have been completely useless, like:
+    // > upserting an existing relation.
+    // > removing a missing relation.
+    // So we can further optimize by cancelling those writes.
+    std::partition(unique_entries.begin(), unique_entries.end(), std::mem_fn(&updated_entry_t::degree_delta));
+    for (updated_entry_t& unique_entry : unique_entries) {
+        pack_entry(unique_entry, arena, c_error);
+        return_if_error_m(c_error);
+    }
+
+    // Dump the data back to disk!
+    auto collections = unique_strided.immutable().members(&updated_entry_t::collection);
+    auto keys = unique_strided.immutable().members(&updated_entry_t::key);
+    auto contents = unique_strided.immutable().members(&updated_entry_t::content);
+    auto lengths = unique_strided.immutable().members(&updated_entry_t::length);
+
+    ukv_write_t write {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = c_options,
+        .tasks_count = unique_count,
+        .collections = collections.begin().get(),
+        .collections_stride = collections.begin().stride(),
+        .keys = keys.begin().get(),
+        .keys_stride = keys.begin().stride(),
+        .lengths = lengths.begin().get(),
+        .lengths_stride = lengths.begin().stride(),
+        .values = contents.begin().get(),
+        .values_stride = contents.begin().stride(),
+    };
+
+    ukv_write(&write);
+    return_if_error_m(c_error);
+
+    // Degrees and edge indexes are updated in the same transaction, if any
+    graph_companions_t companions;
+    update_degrees_index(
+        c_db,
+        c_transaction,
+        companions,
+        unique_count,
+        collections.begin(),
+        keys.begin(),
+        [&](std::size_t i) { return value_view_t(unique_entries[i]); },
+        c_options,
+        arena,
+        c_error);
+    return_if_error_m(c_error);
+
+    update_edges_index(c_db,
+                       c_transaction,
+                       companions,
+                       c_tasks_count,
+                       edge_collections,
+                       edges_ids,
+                       sources_ids,
+                       targets_ids,
+                       erase_ak,
+                       c_options,
+                       arena,
+                       c_error);
+    return_if_error_m(c_error);
+
+    update_edges_weights(c_db,
+                         c_transaction,
+                         companions,
+                         c_tasks_count,
+                         edge_collections,
+                         edges_ids,
+                         weights,
+                         erase_ak,
+                         c_options,
+                         arena,
+                         c_error);
+}
+
+void ukv_graph_find_edges(ukv_graph_find_edges_t* c_ptr) {
+
+    ukv_graph_find_edges_t& c = *c_ptr;
+    if (!c.tasks_count)
+        return;
+
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+
+    bool only_degrees = !c.edges_per_vertex;
+    if (only_degrees) {
+        find_edges_t find_edges {{c.collections, c.collections_stride},
+                                 {c.vertices, c.vertices_stride},
+                                 {c.roles, c.roles_stride},
+                                 c.tasks_count};
+        graph_companions_t companions;
+        if (export_indexed_degrees(c.db,
+                                   c.transaction,
+                                   companions,
+                                   find_edges,
+                                   c.options,
+                                   c.degrees_per_vertex,
+                                   arena,
+                                   c.error) ||
+            *c.error)
+            return;
+    }
+
+    auto func = only_degrees //
+                    ? &export_edge_tuples<false, false, false>
+                    : &export_edge_tuples<true, true, true>;
+    return func( //
+        c.db,
+        c.transaction,
+        c.tasks_count,
+        c.collections,
+        c.collections_stride,
+        c.vertices,
+        c.vertices_stride,
+        c.roles,
+        c.roles_stride,
+        c.options,
+        c.degrees_per_vertex,
+        c.edges_per_vertex,
+        arena,
+        c.error);
+}
+
+void ukv_graph_traverse(ukv_graph_traverse_t* c_ptr) {
+
+    ukv_graph_traverse_t& c = *c_ptr;
+    return_error_if_m(c.levels_count && c.levels_offsets && c.visited_vertices,
+                      c.error,
+                      args_wrong_k,
+                      "Traversal outputs are missing");
+
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+
+    strided_iterator_gt<ukv_collection_t const> collections {c.collections, c.collections_stride};
+    strided_iterator_gt<ukv_key_t const> vertices {c.vertices, c.vertices_stride};
+    ukv_vertex_role_t const role = c.role != ukv_vertex_role_unknown_k ? c.role : ukv_vertex_role_any_k;
+    ukv_options_t const opts = ukv_options_t(c.options | ukv_option_dont_discard_memory_k);
+    std::size_t const max_vertices = c.max_vertices ? c.max_vertices : std::numeric_limits<std::size_t>::max();
+    auto degree_or_zero = [](ukv_vertex_degree_t degree) -> std::size_t {
+        return degree != ukv_vertex_degree_missing_k ? degree : 0;
+    };
+
+    // Visited vertices are appended level by level, and every level is sorted
+    auto visited = arena.alloc<collection_key_t>(c.tasks_count, c.error);
+    return_if_error_m(c.error);
+    for (std::size_t i = 0; i != c.tasks_count; ++i)
+        visited[i] = {collections ? collections[i] : ukv_collection_main_k, vertices[i]};
+    std::size_t level_begin = 0;
+    std::size_t level_end = sort_and_deduplicate(visited.begin(), visited.end());
+
+    // Skip the missing starting vertices
+    if (level_end) {
+        ukv_octet_t* found_presences = nullptr;
+        ukv_read_t read {
+            .db = c.db,
+            .error = c.error,
+            .transaction = c.transaction,
+            .arena = arena,
+            .options = opts,
+            .tasks_count = static_cast<ukv_size_t>(level_end),
+            .collections = &visited[0].collection,
+            .collections_stride = sizeof(collection_key_t),
+            .keys = &visited[0].key,
+            .keys_stride = sizeof(collection_key_t),
+            .presences = &found_presences,
+        };
+        ukv_read(&read);
+        return_if_error_m(c.error);
+
+        bits_view_t presences {found_presences};
+        std::size_t present_count = 0;
+        for (std::size_t i = 0; i != level_end; ++i)
+            if (presences[i])
+                visited[present_count++] = visited[i];
+        level_end = present_count;
+    }
+
+    auto offsets = arena.alloc<ukv_length_t>(1, c.error);
+    return_if_error_m(c.error);
+    offsets[0] = 0;
+
+    // Only the first level is exported, even if it's empty
+    for (std::size_t depth = 0; depth == 0 || level_begin != level_end; ++depth) {
+        bool const is_last = depth == c.max_depth || level_end >= max_vertices;
+        level_end = std::min(level_end, max_vertices);
+        auto level = ptr_range_gt<collection_key_t> {visited.begin() + level_begin, visited.begin() + level_end};
+
+        offsets = arena.grow(offsets, 1, c.error);
+        return_if_error_m(c.error);
+        offsets[depth + 1] = static_cast<ukv_length_t>(level_end);
+        if (is_last || level.empty())
+            break;
+
+        // Enumerate the neighbors of the current level
+        ukv_vertex_degree_t* degrees = nullptr;
+        ukv_key_t* neighbors_ids = nullptr;
+        export_edge_tuples<false, true, false>( //
+            c.db,
+            c.transaction,
+            static_cast<ukv_size_t>(level.size()),
+            &level[0].collection,
+            sizeof(collection_key_t),
+            &level[0].key,
+            sizeof(collection_key_t),
+            &role,
+            0,
+            opts,
+            &degrees,
+            &neighbors_ids,
+            arena,
+            c.error);
+        return_if_error_m(c.error);
+
+        std::size_t candidates_count = 0;
+        for (std::size_t i = 0; i != level.size(); ++i)
+            candidates_count += degree_or_zero(degrees[i]);
+        auto candidates = arena.alloc<collection_key_t>(candidates_count, c.error);
+        return_if_error_m(c.error);
+        candidates_count = 0;
+        for (std::size_t i = 0; i != level.size(); ++i)
+            for (std::size_t j = 0; j != degree_or_zero(degrees[i]); ++j, ++neighbors_ids)
+                candidates[candidates_count++] = {level[i].collection, *neighbors_ids};
+
+        // Deduplicate the frontier and drop the vertices, visited on any of the previous levels
+        candidates_count = sort_and_deduplicate(candidates.begin(), candidates.begin() + candidates_count);
+        auto is_visited = [&](collection_key_t const& candidate) {
+            for (std::size_t l = 0; l != depth + 1; ++l)
+                if (std::binary_search(visited.begin() + offsets[l], visited.begin() + offsets[l + 1], candidate))
+                    return true;
+            return false;
+        };
+        auto candidates_end = std::remove_if(candidates.begin(), candidates.begin() + candidates_count, is_visited);
+        candidates_count = candidates_end - candidates.begin();
+
+        visited = arena.grow(ptr_range_gt<collection_key_t> {visited.begin(), level_end}, candidates_count, c.error);
+        return_if_error_m(c.error);
+        std::copy_n(candidates.begin(), candidates_count, visited.begin() + level_end);
+        level_begin = level_end;
+        level_end += candidates_count;
+    }
+
+    std::size_t const levels_count = offsets.size() - 1;
+    auto exported_collections = arena.alloc_or_dummy(level_end, c.error, c.visited_collections);
+    return_if_error_m(c.error);
+    auto exported_vertices = arena.alloc<ukv_key_t>(level_end, c.error);
+    return_if_error_m(c.error);
+    for (std::size_t i = 0; i != level_end; ++i)
+        exported_collections[i] = visited[i].collection, exported_vertices[i] = visited[i].key;
+
+    *c.levels_count = static_cast<ukv_size_t>(levels_count);
+    *c.levels_offsets = offsets.begin();
+    *c.visited_vertices = exported_vertices.begin();
+}
+
+void ukv_graph_upsert_edges(ukv_graph_upsert_edges_t* c_ptr) {
+
+    ukv_graph_upsert_edges_t& c = *c_ptr;
+    if (!c.tasks_count)
+        return;
+
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+
+    safe_section("Upserting edges", c.error, [&] {
+        update_neighborhoods<false>( //
+            c.db,
+            c.transaction,
+            c.tasks_count,
+            c.collections,
+            c.collections_stride,
+            c.edges_ids,
+            c.edges_stride,
+            c.sources_ids,
+            c.sources_stride,
+            c.targets_ids,
+            c.targets_stride,
+            c.weights,
+            c.weights_stride,
+            c.options,
+            arena,
+            c.error);
+    });
+}
+
+void ukv_graph_remove_edges(ukv_graph_remove_edges_t* c_ptr) {
+
+    ukv_graph_remove_edges_t& c = *c_ptr;
+    if (!c.tasks_count)
+        return;
+
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+
+    safe_section("Removing edges", c.error, [&] {
+        update_neighborhoods<true>( //
+            c.db,
+            c.transaction,
+            c.tasks_count,
+            c.collections,
+            c.collections_stride,
+            c.edges_ids,
+            c.edges_stride,
+            c.sources_ids,
+            c.sources_stride,
+            c.targets_ids,
+            c.targets_stride,
+            nullptr,
+            0,
+            c.options,
+            arena,
+            c.error);
+    });
+}
+
+void ukv_graph_upsert_vertices(ukv_graph_upsert_vertices_t* c_ptr) {
+
+    ukv_graph_upsert_vertices_t& c = *c_ptr;
+    if (!c.tasks_count)
+        return;
+
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    ukv_length_t* c_found_lengths = nullptr;
+
+    ukv_read_t read {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .options = c.options,
+        .tasks_count = c.tasks_count,
+        .collections = c.collections,
+        .collections_stride = c.collections_stride,
+        .keys = c.vertices,
+        .keys_stride = c.vertices_stride,
+        .lengths = &c_found_lengths,
+    };
+
+    ukv_read(&read);
+    return_if_error_m(c.error);
+
+    std::size_t idx = 0;
+    auto vertices_to_upsert = arena.alloc<ukv_key_t>(c.tasks_count, c.error);
+    strided_range_gt<ukv_key_t const> vertices {{c.vertices, c.vertices_stride}, c.tasks_count};
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        if (c_found_lengths[i] == ukv_length_missing_k) {
+            vertices_to_upsert[idx] = vertices[i];
+            ++idx;
+        }
+    }
+
+    ukv_length_t length = 0;
+    value_view_t empty_value = "";
+    ukv_write_t write {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .tasks_count = idx,
+        .collections = c.collections,
+        .collections_stride = c.collections_stride,
+        .keys = vertices_to_upsert.begin(),
+        .keys_stride = sizeof(ukv_key_t),
+        .lengths = &length,
+        .values = empty_value.member_ptr(),
+    };
+
+    ukv_write(&write);
+    return_if_error_m(c.error);
+
+    graph_companions_t companions;
+    update_degrees_index(
+        c.db,
+        c.transaction,
+        companions,
+        idx,
+        {c.collections, c.collections_stride},
+        {vertices_to_upsert.begin(), sizeof(ukv_key_t)},
+        [&](std::size_t) { return empty_value; },
+        c.options,
+        arena,
+        c.error);
+}
+
+/**
+ * @brief Checks if any collection of removed vertices has an edge index or weights,
+ * so that the IDs of their edges must be collected, while those are still present.
+ */
+bool any_edges_companions( //
+    ukv_database_t const c_db,
+    std::size_t const tasks_count,
+    strided_iterator_gt<ukv_collection_t const> collections,
+    graph_companions_t& companions,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    if (!ukv_supports_named_collections_k)
+        return false;
+
+    std::optional<ukv_collection_t> last_collection;
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        ukv_collection_t const collection = collections ? collections[i] : ukv_collection_main_k;
+        if (last_collection && *last_collection == collection)
+            continue;
+        if (has_edges_companions(c_db, collection, companions, arena, c_error) || *c_error)
+            return !*c_error;
+        last_collection = collection;
+    }
+    return false;
+}
+
+void remove_vertices(ukv_graph_remove_vertices_t& c, linked_memory_lock_t& arena) {
+
+    strided_iterator_gt<ukv_collection_t const> vertex_collections {c.collections, c.collections_stride};
+    strided_range_gt<ukv_key_t const> vertices {{c.vertices, c.vertices_stride}, c.tasks_count};
+    strided_iterator_gt<ukv_vertex_role_t const> vertex_roles {c.roles, c.roles_stride};
+    find_edges_t find_edges {vertex_collections, vertices.begin(), vertex_roles, c.tasks_count};
+
+    // The removed vertices are fetched just once. Their neighborhoods name the entries
+    // to update, and they are later linked for the update, instead of being read again.
+    ukv_bytes_ptr_t found_values = nullptr;
+    ukv_length_t* found_offsets = nullptr;
+    auto opts = c.transaction ? ukv_options_t(c.options & ~ukv_option_transaction_dont_watch_k) : c.options;
+    ukv_read_t read {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .options = opts,
+        .tasks_count = c.tasks_count,
+        .collections = c.collections,
+        .collections_stride = c.collections_stride,
+        .keys = c.vertices,
+        .keys_stride = c.vertices_stride,
+        .offsets = &found_offsets,
+        .values = &found_values,
+    };
+    ukv_read(&read);
+    return_if_error_m(c.error);
+
+    joined_blobs_t found {c.tasks_count, found_offsets, found_values};
+    auto fetched = arena.alloc<value_view_t>(c.tasks_count, c.error);
+    return_if_error_m(c.error);
+    auto gathered = arena.alloc<value_view_t>(c.tasks_count, c.error);
+    return_if_error_m(c.error);
+    for (std::size_t i = 0; i != c.tasks_count; ++i)
+        fetched[i] = gathered[i] = found[i];
+
+    // Export the neighbors together with the IDs of the edges, leading to them
+    ukv_vertex_degree_t* degrees_per_vertex = nullptr;
+    ukv_key_t* neighbors_and_edges = nullptr;
+    export_fetched_edge_tuples<false, true, true>( //
+        c.db,
+        c.transaction,
+        find_edges,
+        gathered,
+        opts,
+        &degrees_per_vertex,
+        &neighbors_and_edges,
+        arena,
+        c.error);
+    return_if_error_m(c.error);
+    strided_iterator_gt<ukv_key_t const> neighbors_ids {neighbors_and_edges, sizeof(ukv_key_t) * 2};
+    strided_iterator_gt<ukv_key_t const> edges_ids {neighbors_and_edges + 1, sizeof(ukv_key_t) * 2};
+
+    // Enumerate the opposite ends, from which that same reference must be removed.
+    // Here all the keys will be in the sorted order.
+    auto degree_or_zero = [](ukv_vertex_degree_t degree) -> std::size_t {
+        return degree != ukv_vertex_degree_missing_k ? degree : 0;
+    };
+    std::size_t neighbors_count = 0;
+    for (std::size_t i = 0; i != c.tasks_count; ++i)
+        neighbors_count += degree_or_zero(degrees_per_vertex[i]);
+
+    // The IDs of removed edges are dropped from the companions, if there are any
+    graph_companions_t companions;
+    bool const has_companions =
+        any_edges_companions(c.db, c.tasks_count, vertex_collections, companions, arena, c.error);
+    return_if_error_m(c.error);
+    std::size_t const removed_edges_count = has_companions ? neighbors_count : 0;
+    auto removed_edges_collections = arena.alloc<ukv_collection_t>(removed_edges_count, c.error);
+    return_if_error_m(c.error);
+    for (std::size_t i = 0, passed = 0; i != c.tasks_count && has_companions; ++i)
+        for (std::size_t j = 0; j != degree_or_zero(degrees_per_vertex[i]); ++j, ++passed)
+            removed_edges_collections[passed] = find_edges[i].collection;
+
+    std::size_t unique_count = c.tasks_count + neighbors_count;
+    auto unique_entries = arena.alloc<updated_entry_t>(unique_count, c.error);
+    return_if_error_m(c.error);
+    std::fill(unique_entries.begin(), unique_entries.end(), updated_entry_t {});
+
+    // Sorting the tasks would help us faster locate them in the future.
+    // We may also face repetitions when connected vertices are removed.
+    {
+        auto planned_entries = unique_entries.begin();
+        std::size_t passed_neighbors = 0;
+        for (std::size_t i = 0; i != c.tasks_count; ++i) {
+            auto collection = planned_entries->collection = vertex_collections[i];
+            planned_entries->key = vertices[i];
+            ++planned_entries;
+            for (std::size_t j = 0; j != degree_or_zero(degrees_per_vertex[i]); ++j, ++planned_entries)
+                planned_entries->collection = collection, planned_entries->key = neighbors_ids[passed_neighbors++];
+        }
+        unique_count = sort_and_deduplicate(unique_entries.begin(), planned_entries);
+        unique_entries = {unique_entries.begin(), unique_count};
+    }
+
+    // Link the removed vertices to their fetched neighborhoods,
+    // and read the other opposite ends in a single batch.
+    auto pending_entries = arena.alloc<updated_entry_t>(unique_count, c.error);
+    return_if_error_m(c.error);
+    auto pending_offsets = arena.alloc<std::size_t>(unique_count, c.error);
+    return_if_error_m(c.error);
+    auto is_linked = arena.alloc<bool>(unique_count, c.error);
+    return_if_error_m(c.error);
+    std::fill(is_linked.begin(), is_linked.end(), false);
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        auto vertex_idx = offset_in_sorted(unique_entries, collection_key_t {vertex_collections[i], vertices[i]});
+        if (is_linked[vertex_idx])
+            continue;
+        link_for_update(unique_entries[vertex_idx], fetched[i], arena, c.error);
+        return_if_error_m(c.error);
+        is_linked[vertex_idx] = true;
+    }
+    std::size_t pending_count = 0;
+    for (std::size_t i = 0; i != unique_count; ++i)
+        if (!is_linked[i])
+            pending_entries[pending_count] = unique_entries[i], pending_offsets[pending_count++] = i;
+    pending_entries = {pending_entries.begin(), pending_count};
+    pull_and_link_for_updates(c.db, c.transaction, pending_entries.strided(), c.options, arena, c.error);
+    return_if_error_m(c.error);
+    for (std::size_t i = 0; i != pending_count; ++i)
+        unique_entries[pending_offsets[i]] = pending_entries[i];
+    auto unique_strided = unique_entries.strided();
+
+    // Supernodes can't be updated inplace, so we postpone those updates until their pages are fetched
+    page_updates_t page_updates;
+    page_updates.updates = arena.alloc<page_update_t>(neighbors_count * 2 + c.tasks_count, c.error);
+    return_if_error_m(c.error);
+
+    // From every opposite end - remove a match, and only then - the content itself
+    std::size_t passed_neighbors = 0;
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        auto vertex_collection = vertex_collections[i];
+        auto vertex_id = vertices[i];
+        auto vertex_role = vertex_roles ? vertex_roles[i] : ukv_vertex_role_any_k;
+        auto vertex_degree = degree_or_zero(degrees_per_vertex[i]);
+
+        for (std::size_t j = 0; j != vertex_degree; ++j, ++passed_neighbors) {
+            ukv_key_t neighbor_id = neighbors_ids[passed_neighbors];
+            auto neighbor_idx = offset_in_sorted(unique_entries, collection_key_t {vertex_collection, neighbor_id});
+            updated_entry_t& neighbor_value = unique_entries[neighbor_idx];
+            auto erase = [&](ukv_vertex_role_t role) {
+                if (!is_paged(neighbor_value))
+                    return erase_from_entry(neighbor_value, role, vertex_id);
+                auto ship = neighborship_t {vertex_id, ukv_key_unknown_k};
+                page_updates.push(neighbor_idx, role, ship, page_update_kind_t::erase_neighbor_k);
+            };
+            if (vertex_role == ukv_vertex_role_any_k) {
+                erase(ukv_vertex_source_k);
+                erase(ukv_vertex_target_k);
+            }
+            else
+                erase(invert(vertex_role));
+        }
+
+        auto vertex_idx = offset_in_sorted(unique_entries, collection_key_t {vertex_collection, vertex_id});
+        updated_entry_t& vertex_value = unique_entries[vertex_idx];
+        if (is_paged(vertex_value))
+            page_updates.push(vertex_idx, vertex_role, neighborship_t {}, page_update_kind_t::drop_k);
+        else {
+            vertex_value.content = nullptr;
+            vertex_value.length = ukv_length_missing_k;
+        }
+    }
+
+    update_pages(c.db, c.transaction, unique_entries, page_updates.pushed(), c.options, arena, c.error);
+    return_if_error_m(c.error);
+    for (updated_entry_t& unique_entry : unique_entries) {
+        pack_entry(unique_entry, arena, c.error);
+        return_if_error_m(c.error);
+    }
+
+    // Now we will go through all the explicitly deleted vertices
+    auto collections = unique_strided.immutable().members(&updated_entry_t::collection);
+    auto keys = unique_strided.immutable().members(&updated_entry_t::key);
+    auto lengths = unique_strided.immutable().members(&updated_entry_t::length);
+    auto contents = unique_strided.immutable().members(&updated_entry_t::content);
+
+    ukv_write_t write {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .options = c.options,
+        .tasks_count = unique_count,
+        .collections = collections.begin().get(),
+        .collections_stride = collections.begin().stride(),
+        .keys = keys.begin().get(),
+        .keys_stride = keys.begin().stride(),
+        .lengths = lengths.begin().get(),
+        .lengths_stride = lengths.begin().stride(),
+        .values = contents.begin().get(),
+        .values_stride = contents.begin().stride(),
+    };
+
+    ukv_write(&write);
+    return_if_error_m(c.error);
+
+    update_degrees_index(
+        c.db,
+        c.transaction,
+        companions,
+        unique_count,
+        collections.begin(),
+        keys.begin(),
+        [&](std::size_t i) { return value_view_t(unique_entries[i]); },
+        c.options,
+        arena,
+        c.error);
+    return_if_error_m(c.error);
+
+    update_edges_index(c.db,
+                       c.transaction,
+                       companions,
+                       removed_edges_count,
+                       {removed_edges_collections.begin(), sizeof(ukv_collection_t)},
+                       edges_ids,
+                       {},
+                       {},
+                       true,
+                       c.options,
+                       arena,
+                       c.error);
+    return_if_error_m(c.error);
+
+    update_edges_weights(c.db,
+                         c.transaction,
+                         companions,
+                         removed_edges_count,
+                         {removed_edges_collections.begin(), sizeof(ukv_collection_t)},
+                         edges_ids,
+                         {},
+                         true,
+                         c.options,
+                         arena,
+                         c.error);
+}
+
+void ukv_graph_remove_vertices(ukv_graph_remove_vertices_t* c_ptr) {
+
+    ukv_graph_remove_vertices_t& c = *c_ptr;
+    if (!c.tasks_count)
+        return;
+
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Removing vertices", c.error, [&] { remove_vertices(c, arena); });
+}
+
+/// Vertices in a key range are scanned and removed in batches of that size.
+constexpr ukv_length_t removal_batch_k = 1024;
+
+void remove_vertices_range(ukv_graph_remove_vertices_range_t& c) {
+
+    // Memory is reused between batches, as the range may be huge
+    ukv_options_t const batch_options = ukv_options_t(c.options & ~ukv_option_dont_discard_memory_k);
+    ukv_key_t start_key = c.min_key;
+    std::size_t removed_count = 0;
+    while (start_key < c.max_key) {
+        linked_memory_lock_t batch = linked_memory(c.arena, batch_options, c.error);
+        return_if_error_m(c.error);
+
+        ukv_length_t* found_counts = nullptr;
+        ukv_key_t* found_keys = nullptr;
+        ukv_scan_t scan {
+            .db = c.db,
+            .error = c.error,
+            .transaction = c.transaction,
+            .arena = batch,
+            .options = c.options,
+            .tasks_count = 1,
+            .collections = &c.collection,
+            .start_keys = &start_key,
+            .count_limits = &removal_batch_k,
+            .counts = &found_counts,
+            .keys = &found_keys,
+        };
+        ukv_scan(&scan);
+        return_if_error_m(c.error);
+
+        auto keys = ptr_range_gt<ukv_key_t const> {found_keys, found_keys + found_counts[0]};
+        auto keys_end = std::lower_bound(keys.begin(), keys.end(), c.max_key);
+        std::size_t const keys_count = keys_end - keys.begin();
+        if (!keys_count)
+            break;
+
+        ukv_graph_remove_vertices_t remove {
+            .db = c.db,
+            .error = c.error,
+            .transaction = c.transaction,
+            .arena = c.arena,
+            .options = ukv_options_t(batch_options | ukv_option_dont_discard_memory_k),
+            .tasks_count = static_cast<ukv_size_t>(keys_count),
+            .collections = &c.collection,
+            .vertices = keys.begin(),
+            .vertices_stride = sizeof(ukv_key_t),
+        };
+        remove_vertices(remove, batch);
+        return_if_error_m(c.error);
+
+        removed_count += keys_count;
+        if (keys_end != keys.end() || keys_count < removal_batch_k)
+            break;
+        start_key = keys[keys_count - 1] + 1;
+    }
+
+    if (c.removed_count)
+        *c.removed_count = static_cast<ukv_size_t>(removed_count);
+}
+
+void ukv_graph_remove_vertices_range(ukv_graph_remove_vertices_range_t* c_ptr) {
+
+    ukv_graph_remove_vertices_range_t& c = *c_ptr;
+    return_error_if_m(c.min_key <= c.max_key, c.error, args_wrong_k, "Key range is inverted");
+    safe_section("Removing vertices range", c.error, [&] { remove_vertices_range(c); });
+}
+
+/*********************************************************/
+/*****************	      Analytics       ****************/
+/*********************************************************/
+
+using vertex_idx_t = std::uint32_t;
+
+/// Vertices are scanned, fetched and written back in batches of that size.
+constexpr std::size_t analytics_batch_k = 1024;
+
+/**
+ * @brief Transient Compressed Sparse Row representation of a whole collection.
+ * Neighbors are addressed by their index in the sorted `keys`, outgoing ones first,
+ * then incoming ones. So if both roles are fetched, every edge appears twice, and
+ * a self-loop - in both halves of the same vertex. The `edges` are optional.
+ */
+struct csr_t {
+    std::vector<ukv_key_t> keys;
+    std::vector<std::size_t> offsets;
+    std::vector<vertex_idx_t> out_degrees;
+    std::vector<vertex_idx_t> neighbors;
+    std::vector<ukv_key_t> edges;
+
+    std::size_t size() const noexcept { return keys.size(); }
+    ptr_range_gt<vertex_idx_t const> all(std::size_t i) const noexcept {
+        return {neighbors.data() + offsets[i], neighbors.data() + offsets[i + 1]};
+    }
+    ptr_range_gt<vertex_idx_t const> outgoing(std::size_t i) const noexcept {
+        return {neighbors.data() + offsets[i], neighbors.data() + offsets[i] + out_degrees[i]};
+    }
+    ptr_range_gt<vertex_idx_t const> incoming(std::size_t i) const noexcept {
+        return {neighbors.data() + offsets[i] + out_degrees[i], neighbors.data() + offsets[i + 1]};
+    }
+};
+
+void scan_vertices( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_options_t const c_options,
+    std::vector<ukv_key_t>& keys,
+    ukv_error_t* c_error) {
+
+    arena_t scan_arena(c_db);
+    ukv_key_t start_key = std::numeric_limits<ukv_key_t>::min();
+    ukv_length_t const count_limit = analytics_batch_k;
+    while (true) {
+        ukv_length_t* found_counts = nullptr;
+        ukv_key_t* found_keys = nullptr;
+        ukv_scan_t scan {
+            .db = c_db,
+            .error = c_error,
+            .transaction = c_transaction,
+            .arena = scan_arena.member_ptr(),
+            .options = ukv_options_t(c_options & ~ukv_option_dont_discard_memory_k),
+            .tasks_count = 1,
+            .collections = &c_collection,
+            .start_keys = &start_key,
+            .count_limits = &count_limit,
+            .counts = &found_counts,
+            .keys = &found_keys,
+        };
+        ukv_scan(&scan);
+        return_if_error_m(c_error);
+        if (!found_counts[0])
+            return;
+
+        keys.insert(keys.end(), found_keys, found_keys + found_counts[0]);
+        if (keys.back() == std::numeric_limits<ukv_key_t>::max())
+            return;
+        start_key = keys.back() + 1;
+    }
+}
+
+/**
+ * @brief Fetches the neighborhoods of all the `csr.keys` in the given `role`. Every thread
+ * reads its own contiguous slice of vertices in batches, so that slices are concatenated
+ * in order. Neighbors, missing from the `csr.keys`, are skipped.
+ */
+void fetch_csr( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_options_t const c_options,
+    ukv_vertex_role_t const role,
+    bool const with_edges,
+    std::size_t const threads_count,
+    csr_t& csr,
+    ukv_error_t* c_error) {
+
+    struct slice_t {
+        std::vector<vertex_idx_t> neighbors;
+        std::vector<ukv_key_t> edges;
+    };
+
+    std::size_t const count = csr.size();
+    csr.offsets.assign(count + 1, 0);
+    csr.out_degrees.assign(count, 0);
+    std::vector<slice_t> slices(threads_count);
+    std::vector<ukv_error_t> errors(threads_count, nullptr);
+    ukv_options_t const batch_options = ukv_options_t(c_options & ~ukv_option_dont_discard_memory_k);
+    ukv_options_t const read_options = ukv_options_t(c_options | ukv_option_dont_discard_memory_k);
+
+    auto fetch_slice = [&](std::size_t thread_idx, std::size_t begin, std::size_t end) noexcept {
+        ukv_error_t* error = &errors[thread_idx];
+        slice_t& slice = slices[thread_idx];
+        arena_t thread_arena(c_db);
+        safe_section("Fetching neighborhoods", error, [&] {
+            for (std::size_t batch_begin = begin; batch_begin < end; batch_begin += analytics_batch_k) {
+                std::size_t const batch_size = std::min(end - batch_begin, analytics_batch_k);
+                linked_memory_lock_t arena = linked_memory(thread_arena.member_ptr(), batch_options, error);
+                return_if_error_m(error);
+
+                ukv_bytes_ptr_t found_values = nullptr;
+                ukv_length_t* found_offsets = nullptr;
+                ukv_read_t read {
+                    .db = c_db,
+                    .error = error,
+                    .transaction = c_transaction,
+                    .arena = arena,
+                    .options = read_options,
+                    .tasks_count = batch_size,
+                    .collections = &c_collection,
+                    .keys = csr.keys.data() + batch_begin,
+                    .keys_stride = sizeof(ukv_key_t),
+                    .offsets = &found_offsets,
+                    .values = &found_values,
+                };
+                ukv_read(&read);
+                return_if_error_m(error);
+
+                joined_blobs_t found {batch_size, found_offsets, found_values};
+                auto values = arena.alloc<value_view_t>(batch_size, error);
+                return_if_error_m(error);
+                for (std::size_t i = 0; i != batch_size; ++i)
+                    values[i] = found[i];
+                gather_pages(c_db, c_transaction, {&c_collection, 0}, values, read_options, arena, error);
+                return_if_error_m(error);
+
+                for (std::size_t i = 0; i != batch_size; ++i) {
+                    value_view_t value = values[i];
+                    if (!value)
+                        continue;
+                    // Reserving upfront, as the decoding callbacks can't throw
+                    std::size_t const slice_begin = slice.neighbors.size();
+                    std::size_t const slice_capacity = slice_begin + neighbors_count(value, role);
+                    slice.neighbors.reserve(slice_capacity);
+                    if (with_edges)
+                        slice.edges.reserve(slice_capacity);
+                    auto append = [&](neighborship_t ship) {
+                        auto it = std::lower_bound(csr.keys.begin(), csr.keys.end(), ship.neighbor_id);
+                        if (it == csr.keys.end() || *it != ship.neighbor_id)
+                            return;
+                        slice.neighbors.push_back(static_cast<vertex_idx_t>(it - csr.keys.begin()));
+                        if (with_edges)
+                            slice.edges.push_back(ship.edge_id);
+                    };
+                    if (role & ukv_vertex_source_k)
+                        for_each_neighbor(value, ukv_vertex_source_k, append);
+                    std::size_t const out_degree = slice.neighbors.size() - slice_begin;
+                    csr.out_degrees[batch_begin + i] = static_cast<vertex_idx_t>(out_degree);
+                    if (role & ukv_vertex_target_k)
+                        for_each_neighbor(value, ukv_vertex_target_k, append);
+                    csr.offsets[batch_begin + i + 1] = slice.neighbors.size() - slice_begin;
+                }
+            }
+        });
+    };
+    parallel_for_slices(threads_count, count, fetch_slice);
+    for (ukv_error_t error : errors)
+        return_error_if_m(!error, c_error, error_unknown_k, error);
+
+    std::partial_sum(csr.offsets.begin(), csr.offsets.end(), csr.offsets.begin());
+    csr.neighbors.reserve(csr.offsets.back());
+    csr.edges.reserve(with_edges ? csr.offsets.back() : 0);
+    for (slice_t& slice : slices) {
+        csr.neighbors.insert(csr.neighbors.end(), slice.neighbors.begin(), slice.neighbors.end());
+        csr.edges.insert(csr.edges.end(), slice.edges.begin(), slice.edges.end());
+        slice = {};
+    }
+}
+
+/**
+ * @brief Scans all the vertices of a collection and fetches their neighborhoods.
+ */
+void load_csr( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_options_t const c_options,
+    ukv_vertex_role_t const role,
+    bool const with_edges,
+    std::size_t const threads_count,
+    csr_t& csr,
+    ukv_error_t* c_error) {
+
+    scan_vertices(c_db, c_transaction, c_collection, c_options, csr.keys, c_error);
+    return_if_error_m(c_error);
+    return_error_if_m(csr.size() < std::numeric_limits<vertex_idx_t>::max(),
+                      c_error,
+                      args_wrong_k,
+                      "Too many vertices in one graph");
+    fetch_csr(c_db, c_transaction, c_collection, c_options, role, with_edges, threads_count, csr, c_error);
+}
+
+inline std::size_t scan_threads(ukv_transaction_t transaction, ukv_size_t threads_count) noexcept {
+    // Transactions may not be shared between threads
+    if (transaction)
+        return 1;
+    return threads_count ? threads_count : std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Pull-based PageRank, where dangling vertices spread their score uniformly.
+ * Stops once the L1 change of scores drops below `tolerance` per vertex.
+ */
+void pagerank( //
+    csr_t const& csr,
+    std::size_t const threads_count,
+    std::size_t const max_iterations,
+    double const damping,
+    double const tolerance,
+    std::vector<double>& ranks) {
+
+    std::size_t const count = csr.size();
+    ranks.assign(count, 1.0 / count);
+    std::vector<double> contributions(count);
+    std::vector<double> next_ranks(count);
+    std::vector<double> partials(threads_count);
+
+    for (std::size_t iteration = 0; iteration != max_iterations; ++iteration) {
+        std::fill(partials.begin(), partials.end(), 0.0);
+        parallel_for_slices(threads_count, count, [&](std::size_t thread_idx, std::size_t begin, std::size_t end) {
+            double dangling = 0;
+            for (std::size_t i = begin; i != end; ++i) {
+                vertex_idx_t const degree = csr.out_degrees[i];
+                contributions[i] = degree ? ranks[i] / degree : 0.0;
+                dangling += degree ? 0.0 : ranks[i];
+            }
+            partials[thread_idx] = dangling;
+        });
+        double const dangling = std::accumulate(partials.begin(), partials.end(), 0.0);
+        double const base = (1.0 - damping + damping * dangling) / count;
+
+        std::fill(partials.begin(), partials.end(), 0.0);
+        parallel_for_slices(threads_count, count, [&](std::size_t thread_idx, std::size_t begin, std::size_t end) {
+            double change = 0;
+            for (std::size_t i = begin; i != end; ++i) {
+                double pulled = 0;
+                for (vertex_idx_t source : csr.incoming(i))
+                    pulled += contributions[source];
+                next_ranks[i] = base + damping * pulled;
+                change += std::abs(next_ranks[i] - ranks[i]);
+            }
+            partials[thread_idx] = change;
+        });
+        std::swap(ranks, next_ranks);
+        if (std::accumulate(partials.begin(), partials.end(), 0.0) < tolerance * count)
+            break;
+    }
+}
+
+/**
+ * @brief Lock-free Union-Find, where the bigger root is always hooked under the smaller one.
+ * So the root of every component ends up being its smallest vertex.
+ */
+void weakly_connected_components( //
+    csr_t const& csr,
+    std::size_t const threads_count,
+    std::vector<vertex_idx_t>& roots) {
+
+    std::size_t const count = csr.size();
+    std::vector<std::atomic<vertex_idx_t>> parents(count);
+    for (std::size_t i = 0; i != count; ++i)
+        parents[i].store(static_cast<vertex_idx_t>(i), std::memory_order_relaxed);
+
+    auto find = [&](vertex_idx_t vertex) noexcept {
+        vertex_idx_t parent;
+        while ((parent = parents[vertex].load()) != vertex) {
+            // Path halving
+            vertex_idx_t grand = parents[parent].load();
+            if (grand != parent)
+                parents[vertex].compare_exchange_weak(parent, grand);
+            vertex = grand;
+        }
+        return vertex;
+    };
+    auto unite = [&](vertex_idx_t a, vertex_idx_t b) noexcept {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            vertex_idx_t expected = a;
+            if (parents[a].compare_exchange_strong(expected, b))
+                return;
+        }
+    };
+
+    parallel_for_slices(threads_count, count, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i != end; ++i)
+            for (vertex_idx_t target : csr.outgoing(i))
+                unite(static_cast<vertex_idx_t>(i), target);
+    });
+
+    roots.resize(count);
+    for (std::size_t i = 0; i != count; ++i)
+        roots[i] = find(static_cast<vertex_idx_t>(i));
+}
+
+/**
+ * @brief Undirected weighted graph, where every edge appears in the lists of both of its vertices.
+ * So the weights of all lists sum up to the double of the total weight.
+ */
+struct weighted_graph_t {
+    std::vector<std::size_t> offsets;
+    std::vector<vertex_idx_t> targets;
+    std::vector<double> weights;
+
+    std::size_t size() const noexcept { return offsets.size() - 1; }
+};
+
+double louvain_modularity( //
+    weighted_graph_t const& graph,
+    std::vector<vertex_idx_t> const& communities,
+    double const resolution) {
+
+    std::size_t const count = graph.size();
+    std::vector<double> internals(count, 0.0);
+    std::vector<double> totals(count, 0.0);
+    for (std::size_t i = 0; i != count; ++i) {
+        for (std::size_t k = graph.offsets[i]; k != graph.offsets[i + 1]; ++k) {
+            totals[communities[i]] += graph.weights[k];
+            if (communities[graph.targets[k]] == communities[i])
+                internals[communities[i]] += graph.weights[k];
+        }
+    }
+    double const weights = std::accumulate(graph.weights.begin(), graph.weights.end(), 0.0);
+    if (!weights)
+        return 0;
+
+    double modularity = 0;
+    for (std::size_t c = 0; c != count; ++c)
+        modularity += internals[c] / weights - resolution * (totals[c] / weights) * (totals[c] / weights);
+    return modularity;
+}
+
+/**
+ * @brief Local moving phase of Louvain: greedily moves every node into the neighboring
+ * community with the biggest modularity gain, until no node moves.
+ * @return Whether any node has changed its community.
+ */
+bool louvain_move_nodes( //
+    weighted_graph_t const& graph,
+    double const resolution,
+    std::vector<vertex_idx_t>& communities) {
+
+    std::size_t const count = graph.size();
+    communities.resize(count);
+    std::iota(communities.begin(), communities.end(), vertex_idx_t(0));
+
+    std::vector<double> degrees(count, 0.0);
+    for (std::size_t i = 0; i != count; ++i)
+        for (std::size_t k = graph.offsets[i]; k != graph.offsets[i + 1]; ++k)
+            degrees[i] += graph.weights[k];
+    std::vector<double> totals = degrees;
+    double const weights = std::accumulate(degrees.begin(), degrees.end(), 0.0);
+    if (!weights)
+        return false;
+
+    // Weights of links from the current node into every community
+    std::vector<double> links(count, 0.0);
+    std::vector<vertex_idx_t> touched;
+    bool moved_any = false;
+    for (bool moved = true; moved;) {
+        moved = false;
+        for (std::size_t i = 0; i != count; ++i) {
+            for (std::size_t k = graph.offsets[i]; k != graph.offsets[i + 1]; ++k) {
+                vertex_idx_t const target = graph.targets[k];
+                if (target == i)
+                    continue;
+                vertex_idx_t const community = communities[target];
+                if (!links[community])
+                    touched.push_back(community);
+                links[community] += graph.weights[k];
+            }
+
+            vertex_idx_t const current = communities[i];
+            totals[current] -= degrees[i];
+            vertex_idx_t best = current;
+            double best_gain = links[current] - resolution * totals[current] * degrees[i] / weights;
+            for (vertex_idx_t community : touched) {
+                double gain = links[community] - resolution * totals[community] * degrees[i] / weights;
+                if (gain > best_gain)
+                    best = community, best_gain = gain;
+            }
+            totals[best] += degrees[i];
+            communities[i] = best;
+            if (best != current)
+                moved = moved_any = true;
+
+            for (vertex_idx_t community : touched)
+                links[community] = 0;
+            touched.clear();
+        }
+    }
+    return moved_any;
+}
+
+/**
+ * @brief Collapses every community into a single node, renumbering the `communities`
+ * in the order of their first appearance.
+ */
+weighted_graph_t louvain_aggregate( //
+    weighted_graph_t const& graph,
+    std::vector<vertex_idx_t>& communities) {
+
+    std::size_t const count = graph.size();
+    std::vector<vertex_idx_t> renumbered(count, std::numeric_limits<vertex_idx_t>::max());
+    vertex_idx_t communities_count = 0;
+    for (vertex_idx_t& community : communities) {
+        if (renumbered[community] == std::numeric_limits<vertex_idx_t>::max())
+            renumbered[community] = communities_count++;
+        community = renumbered[community];
+    }
+
+    // Counting sort of nodes by their community
+    std::vector<std::size_t> members_offsets(communities_count + 1, 0);
+    for (vertex_idx_t community : communities)
+        ++members_offsets[community + 1];
+    std::partial_sum(members_offsets.begin(), members_offsets.end(), members_offsets.begin());
+    std::vector<vertex_idx_t> members(count);
+    std::vector<std::size_t> cursors(members_offsets.begin(), members_offsets.end() - 1);
+    for (std::size_t i = 0; i != count; ++i)
+        members[cursors[communities[i]]++] = static_cast<vertex_idx_t>(i);
+
+    weighted_graph_t aggregated;
+    aggregated.offsets.reserve(communities_count + 1);
+    aggregated.offsets.push_back(0);
+    std::vector<double> links(communities_count, 0.0);
+    std::vector<vertex_idx_t> touched;
+    for (vertex_idx_t community = 0; community != communities_count; ++community) {
+        for (std::size_t m = members_offsets[community]; m != members_offsets[community + 1]; ++m) {
+            vertex_idx_t const member = members[m];
+            for (std::size_t k = graph.offsets[member]; k != graph.offsets[member + 1]; ++k) {
+                vertex_idx_t const target = communities[graph.targets[k]];
+                if (!links[target])
+                    touched.push_back(target);
+                links[target] += graph.weights[k];
+            }
+        }
+        for (vertex_idx_t target : touched) {
+            aggregated.targets.push_back(target);
+            aggregated.weights.push_back(links[target]);
+            links[target] = 0;
+        }
+        touched.clear();
+        aggregated.offsets.push_back(aggregated.targets.size());
+    }
+    return aggregated;
+}
+
+/**
+ * @brief Louvain community detection, treating every edge as undirected with unit weight.
+ * Stops once a level improves the modularity by no more than `tolerance`.
+ */
+void louvain( //
+    csr_t const& csr,
+    std::size_t const max_levels,
+    double const resolution,
+    double const tolerance,
+    std::vector<vertex_idx_t>& membership) {
+
+    weighted_graph_t graph;
+    graph.offsets = csr.offsets;
+    graph.targets = csr.neighbors;
+    graph.weights.assign(csr.neighbors.size(), 1.0);
+
+    membership.resize(csr.size());
+    std::iota(membership.begin(), membership.end(), vertex_idx_t(0));
+    double modularity = louvain_modularity(graph, membership, resolution);
+
+    std::vector<vertex_idx_t> communities;
+    for (std::size_t level = 0; level != max_levels; ++level) {
+        if (!louvain_move_nodes(graph, resolution, communities))
+            break;
+        double const next_modularity = louvain_modularity(graph, communities, resolution);
+        graph = louvain_aggregate(graph, communities);
+        for (vertex_idx_t& member : membership)
+            member = communities[member];
+        if (next_modularity - modularity <= tolerance)
+            break;
+        modularity = next_modularity;
+    }
+}
+
+template <typename scalar_at>
+void write_results( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_options_t const c_options,
+    std::vector<ukv_key_t> const& keys,
+    std::vector<scalar_at> const& results,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    auto offsets = arena.alloc<ukv_length_t>(std::min(keys.size(), analytics_batch_k), c_error);
+    return_if_error_m(c_error);
+    for (std::size_t i = 0; i != offsets.size(); ++i)
+        offsets[i] = static_cast<ukv_length_t>(i * sizeof(scalar_at));
+    ukv_length_t const length = sizeof(scalar_at);
+
+    for (std::size_t begin = 0; begin < keys.size(); begin += analytics_batch_k) {
+        auto values = reinterpret_cast<ukv_bytes_cptr_t>(results.data() + begin);
+        ukv_write_t write {
+            .db = c_db,
+            .error = c_error,
+            .transaction = c_transaction,
+            .arena = arena,
+            .options = c_options,
+            .tasks_count = std::min(keys.size() - begin, analytics_batch_k),
+            .collections = &c_collection,
+            .keys = keys.data() + begin,
+            .keys_stride = sizeof(ukv_key_t),
+            .offsets = offsets.begin(),
+            .offsets_stride = sizeof(ukv_length_t),
+            .lengths = &length,
+            .values = &values,
+        };
+        ukv_write(&write);
+        return_if_error_m(c_error);
+    }
+}
+
+void analyze_graph(ukv_graph_analyze_t& c, linked_memory_lock_t& arena) {
+
+    std::size_t const threads_count = scan_threads(c.transaction, c.threads_count);
+    csr_t csr;
+    load_csr(c.db, c.transaction, c.collection, c.options, ukv_vertex_role_any_k, false, threads_count, csr, c.error);
+    return_if_error_m(c.error);
+
+    std::size_t const count = csr.size();
+    std::vector<ukv_float_t> scores;
+    std::vector<ukv_key_t> labels;
+    switch (c.algorithm) {
+    case ukv_graph_pagerank_k: {
+        std::vector<double> ranks;
+        if (count)
+            pagerank(csr,
+                     threads_count,
+                     c.max_iterations ? c.max_iterations : 100,
+                     c.damping ? c.damping : 0.85,
+                     c.tolerance ? c.tolerance : 1e-6,
+                     ranks);
+        scores.assign(ranks.begin(), ranks.end());
+        break;
+    }
+    case ukv_graph_weakly_connected_components_k: {
+        std::vector<vertex_idx_t> roots;
+        weakly_connected_components(csr, threads_count, roots);
+        labels.resize(count);
+        for (std::size_t i = 0; i != count; ++i)
+            labels[i] = csr.keys[roots[i]];
+        break;
+    }
+    case ukv_graph_louvain_k: {
+        std::vector<vertex_idx_t> membership;
+        louvain(csr,
+                c.max_iterations ? c.max_iterations : 10,
+                c.resolution ? c.resolution : 1.0,
+                c.tolerance ? c.tolerance : 1e-7,
+                membership);
+        // Vertices are sorted, so the first member of a community is the smallest
+        std::vector<ukv_key_t> smallest(count, ukv_key_unknown_k);
+        labels.resize(count);
+        for (std::size_t i = 0; i != count; ++i) {
+            if (smallest[membership[i]] == ukv_key_unknown_k)
+                smallest[membership[i]] = csr.keys[i];
+            labels[i] = smallest[membership[i]];
+        }
+        break;
+    }
+    default: log_error_m(c.error, args_wrong_k, "Unknown graph algorithm"); return;
+    }
+
+    if (c.results_collection) {
+        if (labels.empty())
+            write_results(c.db, c.transaction, *c.results_collection, c.options, csr.keys, scores, arena, c.error);
+        else
+            write_results(c.db, c.transaction, *c.results_collection, c.options, csr.keys, labels, arena, c.error);
+        return_if_error_m(c.error);
+    }
+
+    if (c.vertices_count)
+        *c.vertices_count = count;
+    auto exported_vertices = arena.alloc_or_dummy(count, c.error, c.vertices);
+    return_if_error_m(c.error);
+    auto exported_scores = arena.alloc_or_dummy(scores.size(), c.error, c.scores);
+    return_if_error_m(c.error);
+    auto exported_labels = arena.alloc_or_dummy(labels.size(), c.error, c.labels);
+    return_if_error_m(c.error);
+    for (std::size_t i = 0; i != count; ++i)
+        exported_vertices[i] = csr.keys[i];
+    for (std::size_t i = 0; i != scores.size(); ++i)
+        exported_scores[i] = scores[i];
+    for (std::size_t i = 0; i != labels.size(); ++i)
+        exported_labels[i] = labels[i];
+}
+
+void ukv_graph_analyze(ukv_graph_analyze_t* c_ptr) {
+
+    ukv_graph_analyze_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Analyzing graph", c.error, [&] { analyze_graph(c, arena); });
+}
+
+void export_csr(ukv_graph_export_csr_t& c, linked_memory_lock_t& arena) {
+
+    ukv_vertex_role_t const role = c.role != ukv_vertex_role_unknown_k ? c.role : ukv_vertex_role_any_k;
+    std::size_t const threads_count = scan_threads(c.transaction, c.threads_count);
+    csr_t csr;
+    load_csr(c.db, c.transaction, c.collection, c.options, role, c.edges != nullptr, threads_count, csr, c.error);
+    return_if_error_m(c.error);
+
+    std::size_t const count = csr.size();
+    std::size_t const neighbors_count = csr.neighbors.size();
+    if (c.vertices_count)
+        *c.vertices_count = count;
+    arena.alloc_or_dummy(count, c.error, c.vertices);
+    return_if_error_m(c.error);
+    arena.alloc_or_dummy(count + 1, c.error, c.offsets);
+    return_if_error_m(c.error);
+    arena.alloc_or_dummy(neighbors_count, c.error, c.neighbors);
+    return_if_error_m(c.error);
+    arena.alloc_or_dummy(neighbors_count, c.error, c.edges);
+    return_if_error_m(c.error);
+
+    if (c.vertices)
+        std::copy(csr.keys.begin(), csr.keys.end(), *c.vertices);
+    if (c.offsets)
+        std::copy(csr.offsets.begin(), csr.offsets.end(), *c.offsets);
+    if (c.edges)
+        std::copy(csr.edges.begin(), csr.edges.end(), *c.edges);
+    if (c.neighbors)
+        // Widening is sliced between threads, as exports of big graphs are memory-bound
+        parallel_for_slices(threads_count, neighbors_count, [&](std::size_t, std::size_t begin, std::size_t end) {
+            std::copy(csr.neighbors.begin() + begin, csr.neighbors.begin() + end, *c.neighbors + begin);
+        });
+}
+
+void ukv_graph_export_csr(ukv_graph_export_csr_t* c_ptr) {
+
+    ukv_graph_export_csr_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Exporting CSR", c.error, [&] { export_csr(c, arena); });
+}
+
+/*********************************************************/
+/*****************	       Sampling       ****************/
+/*********************************************************/
+
+/**
+ * @brief Neighborhoods of a few sorted unique `keys`, decoded into contiguous lists.
+ * Every list is sorted by neighbor IDs, so membership can be checked with a binary search.
+ */
+struct decoded_neighborhoods_t {
+    std::vector<ukv_key_t> keys;
+    std::vector<std::size_t> offsets;
+    std::vector<neighborship_t> ships;
+
+    ptr_range_gt<neighborship_t const> of(std::size_t i) const noexcept {
+        return {ships.data() + offsets[i], ships.data() + offsets[i + 1]};
+    }
+    ptr_range_gt<neighborship_t const> find(ukv_key_t key) const noexcept {
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        if (it == keys.end() || *it != key)
+            return {};
+        return of(it - keys.begin());
+    }
+};
+
+/**
+ * @brief Reads and decodes the neighborhoods of `decoded.keys`, reusing the memory
+ * of the `read_arena` between calls. Missing vertices get empty lists.
+ */
+void decode_neighborhoods( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_options_t const c_options,
+    ukv_vertex_role_t const role,
+    decoded_neighborhoods_t& decoded,
+    arena_t& read_arena,
+    ukv_error_t* c_error) {
+
+    std::size_t const count = decoded.keys.size();
+    decoded.offsets.assign(count + 1, 0);
+    decoded.ships.clear();
+    if (!count)
+        return;
+
+    ukv_options_t const read_options = ukv_options_t(c_options | ukv_option_dont_discard_memory_k);
+    linked_memory_lock_t arena =
+        linked_memory(read_arena.member_ptr(), ukv_options_t(c_options & ~ukv_option_dont_discard_memory_k), c_error);
+    return_if_error_m(c_error);
+
+    ukv_bytes_ptr_t found_values = nullptr;
+    ukv_length_t* found_offsets = nullptr;
+    ukv_read_t read {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = read_options,
+        .tasks_count = static_cast<ukv_size_t>(count),
+        .collections = &c_collection,
+        .keys = decoded.keys.data(),
+        .keys_stride = sizeof(ukv_key_t),
+        .offsets = &found_offsets,
+        .values = &found_values,
+    };
+    ukv_read(&read);
+    return_if_error_m(c_error);
+
+    joined_blobs_t found {static_cast<ukv_size_t>(count), found_offsets, found_values};
+    auto values = arena.alloc<value_view_t>(count, c_error);
+    return_if_error_m(c_error);
+    for (std::size_t i = 0; i != count; ++i)
+        values[i] = found[i];
+    gather_pages(c_db, c_transaction, {&c_collection, 0}, values, read_options, arena, c_error);
+    return_if_error_m(c_error);
+
+    std::size_t ships_count = 0;
+    for (value_view_t value : values)
+        ships_count += value ? neighbors_count(value, role) : 0;
+    // Reserving upfront, as the decoding callbacks can't throw
+    decoded.ships.reserve(ships_count);
+    auto append = [&](neighborship_t ship) { decoded.ships.push_back(ship); };
+    for (std::size_t i = 0; i != count; ++i) {
+        value_view_t value = values[i];
+        std::size_t const list_begin = decoded.ships.size();
+        if (value && (role & ukv_vertex_source_k))
+            for_each_neighbor(value, ukv_vertex_source_k, append);
+        if (value && (role & ukv_vertex_target_k))
+            for_each_neighbor(value, ukv_vertex_target_k, append);
+        // Only the concatenation of both roles may be unordered
+        if (role == ukv_vertex_role_any_k)
+            std::sort(decoded.ships.begin() + list_begin, decoded.ships.end());
+        decoded.offsets[i + 1] = decoded.ships.size();
+    }
+}
+
+void sample_neighbors(ukv_graph_sample_neighbors_t& c, linked_memory_lock_t& arena) {
+
+    return_error_if_m(c.fanouts_count == 0 || c.fanouts, c.error, args_wrong_k, "Fanouts are missing");
+    ukv_vertex_role_t const role = c.role != ukv_vertex_role_unknown_k ? c.role : ukv_vertex_role_any_k;
+    strided_iterator_gt<ukv_key_t const> vertices {c.vertices, c.vertices_stride};
+    std::mt19937_64 generator(c.seed);
+
+    decoded_neighborhoods_t frontier;
+    frontier.keys.assign(vertices, vertices + c.tasks_count);
+    frontier.keys.resize(sort_and_deduplicate(frontier.keys.begin(), frontier.keys.end()));
+    std::vector<ukv_key_t> reached = frontier.keys;
+    std::vector<ukv_key_t> next_keys;
+    std::vector<ukv_key_t> merged;
+
+    std::vector<ukv_length_t> hops_offsets {0};
+    std::vector<ukv_key_t> centers;
+    std::vector<ukv_key_t> neighbors;
+    std::vector<ukv_key_t> edges;
+    std::vector<std::size_t> picks;
+    arena_t read_arena(c.db);
+
+    for (std::size_t hop = 0; hop != c.fanouts_count; ++hop) {
+        decode_neighborhoods(c.db, c.transaction, c.collection, c.options, role, frontier, read_arena, c.error);
+        return_if_error_m(c.error);
+
+        std::size_t const fanout = c.fanouts[hop];
+        std::size_t const hop_begin = neighbors.size();
+        for (std::size_t i = 0; i != frontier.keys.size(); ++i) {
+            auto ships = frontier.of(i);
+            std::size_t const degree = ships.size();
+            if (!degree)
+                continue;
+
+            picks.clear();
+            if (!fanout || (!c.with_replacement && degree <= fanout)) {
+                picks.resize(degree);
+                std::iota(picks.begin(), picks.end(), 0);
+            }
+            else if (c.with_replacement) {
+                std::uniform_int_distribution<std::size_t> distribution(0, degree - 1);
+                for (std::size_t j = 0; j != fanout; ++j)
+                    picks.push_back(distribution(generator));
+                std::sort(picks.begin(), picks.end());
+            }
+            else {
+                // Floyd's algorithm draws distinct indexes in `fanout` steps, regardless of the degree
+                for (std::size_t j = degree - fanout; j != degree; ++j) {
+                    std::size_t const pick = std::uniform_int_distribution<std::size_t>(0, j)(generator);
+                    bool const is_taken = std::find(picks.begin(), picks.end(), pick) != picks.end();
+                    picks.push_back(is_taken ? j : pick);
+                }
+                std::sort(picks.begin(), picks.end());
+            }
+
+            for (std::size_t pick : picks) {
+                centers.push_back(frontier.keys[i]);
+                neighbors.push_back(ships[pick].neighbor_id);
+                edges.push_back(ships[pick].edge_id);
+            }
+        }
+        hops_offsets.push_back(static_cast<ukv_length_t>(neighbors.size()));
+        if (hop + 1 == c.fanouts_count)
+            break;
+
+        // Only the neighbors, reached for the first time, are expanded on the next hop
+        next_keys.assign(neighbors.begin() + hop_begin, neighbors.end());
+        next_keys.resize(sort_and_deduplicate(next_keys.begin(), next_keys.end()));
+        frontier.keys.clear();
+        std::set_difference(next_keys.begin(),
+                            next_keys.end(),
+                            reached.begin(),
+                            reached.end(),
+                            std::back_inserter(frontier.keys));
+        merged.clear();
+        std::merge(reached.begin(),
+                   reached.end(),
+                   frontier.keys.begin(),
+                   frontier.keys.end(),
+                   std::back_inserter(merged));
+        std::swap(reached, merged);
+    }
+
+    std::size_t const sampled_count = neighbors.size();
+    auto exported_offsets = arena.alloc<ukv_length_t>(hops_offsets.size(), c.error);
+    return_if_error_m(c.error);
+    auto exported_centers = arena.alloc_or_dummy(sampled_count, c.error, c.centers);
+    return_if_error_m(c.error);
+    auto exported_neighbors = arena.alloc_or_dummy(sampled_count, c.error, c.neighbors);
+    return_if_error_m(c.error);
+    auto exported_edges = arena.alloc_or_dummy(sampled_count, c.error, c.edges);
+    return_if_error_m(c.error);
+
+    std::copy(hops_offsets.begin(), hops_offsets.end(), exported_offsets.begin());
+    for (std::size_t i = 0; i != sampled_count; ++i)
+        exported_centers[i] = centers[i], exported_neighbors[i] = neighbors[i], exported_edges[i] = edges[i];
+    if (c.hops_offsets)
+        *c.hops_offsets = exported_offsets.begin();
+}
+
+void ukv_graph_sample_neighbors(ukv_graph_sample_neighbors_t* c_ptr) {
+
+    ukv_graph_sample_neighbors_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Sampling neighbors", c.error, [&] { sample_neighbors(c, arena); });
+}
+
+void random_walks(ukv_graph_random_walks_t& c, linked_memory_lock_t& arena) {
+
+    return_error_if_m(c.walks, c.error, args_wrong_k, "Walks output is missing");
+    return_error_if_m(c.restart_probability >= 0 && c.restart_probability <= 1,
+                      c.error,
+                      args_wrong_k,
+                      "Restart probability must be within [0, 1]");
+    return_error_if_m(c.return_param >= 0 && c.inout_param >= 0,
+                      c.error,
+                      args_wrong_k,
+                      "Node2vec parameters can't be negative");
+
+    ukv_vertex_role_t const role = c.role != ukv_vertex_role_unknown_k ? c.role : ukv_vertex_role_any_k;
+    strided_iterator_gt<ukv_key_t const> vertices {c.vertices, c.vertices_stride};
+    std::size_t const stride = c.walk_length + 1;
+    auto walks = arena.alloc<ukv_key_t>(c.tasks_count * stride, c.error);
+    return_if_error_m(c.error);
+    std::fill(walks.begin(), walks.end(), ukv_key_unknown_k);
+    for (std::size_t i = 0; i != c.tasks_count; ++i)
+        walks[i * stride] = vertices[i];
+
+    // The acceptance weights of node2vec are normalized by the biggest of them
+    double const p = c.return_param ? c.return_param : 1.0;
+    double const q = c.inout_param ? c.inout_param : 1.0;
+    bool const is_biased = p != 1.0 || q != 1.0;
+    double const max_weight = std::max({1.0 / p, 1.0, 1.0 / q});
+    double const return_weight = 1.0 / p / max_weight;
+    double const stay_weight = 1.0 / max_weight;
+    double const away_weight = 1.0 / q / max_weight;
+
+    std::mt19937_64 generator(c.seed);
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::vector<std::size_t> alive(c.tasks_count);
+    std::iota(alive.begin(), alive.end(), 0);
+    // Restarts don't follow edges, so the step after them isn't biased
+    std::vector<bool> follows_edge(c.tasks_count, false);
+    decoded_neighborhoods_t current;
+    arena_t read_arena(c.db);
+
+    for (std::size_t step = 1; step <= c.walk_length && !alive.empty(); ++step) {
+        current.keys.clear();
+        for (std::size_t walk : alive) {
+            current.keys.push_back(walks[walk * stride + step - 1]);
+            if (is_biased && follows_edge[walk])
+                current.keys.push_back(walks[walk * stride + step - 2]);
+        }
+        current.keys.resize(sort_and_deduplicate(current.keys.begin(), current.keys.end()));
+        decode_neighborhoods(c.db, c.transaction, c.collection, c.options, role, current, read_arena, c.error);
+        return_if_error_m(c.error);
+
+        std::size_t alive_count = 0;
+        for (std::size_t walk : alive) {
+            ukv_key_t* path = walks.begin() + walk * stride;
+            auto ships = current.find(path[step - 1]);
+            if (ships.empty())
+                continue;
+
+            alive[alive_count++] = walk;
+            if (c.restart_probability && coin(generator) < c.restart_probability) {
+                path[step] = path[0];
+                follows_edge[walk] = false;
+                continue;
+            }
+
+            std::uniform_int_distribution<std::size_t> distribution(0, ships.size() - 1);
+            ukv_key_t next = ships[distribution(generator)].neighbor_id;
+            if (is_biased && follows_edge[walk]) {
+                ukv_key_t const previous = path[step - 2];
+                auto previous_ships = current.find(previous);
+                while (true) {
+                    double const weight = next == previous ? return_weight
+                                          : std::binary_search(previous_ships.begin(), previous_ships.end(), next)
+                                              ? stay_weight
+                                              : away_weight;
+                    if (coin(generator) < weight)
+                        break;
+                    next = ships[distribution(generator)].neighbor_id;
+                }
+            }
+            path[step] = next;
+            follows_edge[walk] = true;
+        }
+        alive.resize(alive_count);
+    }
+
+    *c.walks = walks.begin();
+}
+
+void ukv_graph_random_walks(ukv_graph_random_walks_t* c_ptr) {
+
+    ukv_graph_random_walks_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Generating random walks", c.error, [&] { random_walks(c, arena); });
+}
+
+/*********************************************************/
+/*****************	    Intersections     ****************/
+/*********************************************************/
+
+/**
+ * @brief Sorted unique neighbor IDs of a few sorted unique `keys`, ready to be intersected.
+ */
+struct neighbor_sets_t {
+    std::vector<ukv_key_t> keys;
+    std::vector<std::size_t> offsets;
+    std::vector<ukv_key_t> ids;
+
+    ptr_range_gt<ukv_key_t const> of(std::size_t i) const noexcept {
+        return {ids.data() + offsets[i], ids.data() + offsets[i + 1]};
+    }
+    ptr_range_gt<ukv_key_t const> find(ukv_key_t key) const noexcept {
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        if (it == keys.end() || *it != key)
+            return {};
+        return of(it - keys.begin());
+    }
+};
+
+void load_neighbor_sets( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_options_t const c_options,
+    ukv_vertex_role_t const role,
+    bool const drop_self_loops,
+    neighbor_sets_t& sets,
+    arena_t& read_arena,
+    ukv_error_t* c_error) {
 
-    ukv_write(&write);
+    decoded_neighborhoods_t decoded;
+    decoded.keys = std::move(sets.keys);
+    decode_neighborhoods(c_db, c_transaction, c_collection, c_options, role, decoded, read_arena, c_error);
+    sets.keys = std::move(decoded.keys);
+    return_if_error_m(c_error);
+
+    // Decoded lists are sorted by neighbor IDs, so the duplicates are adjacent
+    std::size_t const count = sets.keys.size();
+    sets.offsets.assign(count + 1, 0);
+    sets.ids.clear();
+    sets.ids.reserve(decoded.ships.size());
+    for (std::size_t i = 0; i != count; ++i) {
+        std::size_t const set_begin = sets.ids.size();
+        for (neighborship_t ship : decoded.of(i)) {
+            if (drop_self_loops && ship.neighbor_id == sets.keys[i])
+                continue;
+            if (sets.ids.size() != set_begin && sets.ids.back() == ship.neighbor_id)
+                continue;
+            sets.ids.push_back(ship.neighbor_id);
+        }
+        sets.offsets[i + 1] = sets.ids.size();
+    }
 }
 
-void ukv_graph_find_edges(ukv_graph_find_edges_t* c_ptr) {
+void common_neighbors(ukv_graph_common_neighbors_t& c, linked_memory_lock_t& arena) {
 
-    ukv_graph_find_edges_t& c = *c_ptr;
-    if (!c.tasks_count)
+    ukv_vertex_role_t const role = c.role != ukv_vertex_role_unknown_k ? c.role : ukv_vertex_role_any_k;
+    strided_iterator_gt<ukv_key_t const> firsts {c.first_vertices, c.first_vertices_stride};
+    strided_iterator_gt<ukv_key_t const> seconds {c.second_vertices, c.second_vertices_stride};
+
+    neighbor_sets_t sets;
+    sets.keys.reserve(c.tasks_count * 2);
+    sets.keys.insert(sets.keys.end(), firsts, firsts + c.tasks_count);
+    sets.keys.insert(sets.keys.end(), seconds, seconds + c.tasks_count);
+    sets.keys.resize(sort_and_deduplicate(sets.keys.begin(), sets.keys.end()));
+    arena_t read_arena(c.db);
+    load_neighbor_sets(c.db, c.transaction, c.collection, c.options, role, false, sets, read_arena, c.error);
+    return_if_error_m(c.error);
+
+    auto counts = arena.alloc_or_dummy(c.tasks_count, c.error, c.counts);
+    return_if_error_m(c.error);
+    auto offsets = arena.alloc_or_dummy(c.tasks_count + 1, c.error, c.offsets);
+    return_if_error_m(c.error);
+    std::size_t total_count = 0;
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        auto first = sets.find(firsts[i]);
+        auto second = sets.find(seconds[i]);
+        std::size_t const count = intersect_sorted(first.begin(), first.size(), second.begin(), second.size());
+        counts[i] = static_cast<ukv_length_t>(count);
+        offsets[i] = static_cast<ukv_length_t>(total_count);
+        total_count += count;
+    }
+    offsets[c.tasks_count] = static_cast<ukv_length_t>(total_count);
+    if (!c.neighbors)
         return;
 
-    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    // Sizes are known now, so the second pass exports straight into the arena
+    auto neighbors = arena.alloc<ukv_key_t>(total_count, c.error);
     return_if_error_m(c.error);
+    ukv_key_t* output = neighbors.begin();
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        auto first = sets.find(firsts[i]);
+        auto second = sets.find(seconds[i]);
+        output += intersect_sorted(first.begin(), first.size(), second.begin(), second.size(), output);
+    }
+    *c.neighbors = neighbors.begin();
+}
 
-    bool only_degrees = !c.edges_per_vertex;
-    auto func = only_degrees //
-                    ? &export_edge_tuples<false, false, false>
-                    : &export_edge_tuples<true, true, true>;
-    return func( //
-        c.db,
-        c.transaction,
-        c.tasks_count,
-        c.collections,
-        c.collections_stride,
-        c.vertices,
-        c.vertices_stride,
-        c.roles,
-        c.roles_stride,
-        c.options,
-        c.degrees_per_vertex,
-        c.edges_per_vertex,
-        arena,
-        c.error);
+void ukv_graph_common_neighbors(ukv_graph_common_neighbors_t* c_ptr) {
+
+    ukv_graph_common_neighbors_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Intersecting neighborhoods", c.error, [&] { common_neighbors(c, arena); });
 }
 
-void ukv_graph_upsert_edges(ukv_graph_upsert_edges_t* c_ptr) {
+void count_triangles(ukv_graph_count_triangles_t& c, linked_memory_lock_t& arena) {
 
-    ukv_graph_upsert_edges_t& c = *c_ptr;
-    if (!c.tasks_count)
-        return;
+    strided_iterator_gt<ukv_key_t const> vertices {c.vertices, c.vertices_stride};
+    auto triangles = arena.alloc_or_dummy(c.tasks_count, c.error, c.triangles);
+    return_if_error_m(c.error);
+    auto clustering = arena.alloc_or_dummy(c.tasks_count, c.error, c.clustering);
+    return_if_error_m(c.error);
 
+    neighbor_sets_t centers;
+    neighbor_sets_t neighbors;
+    arena_t read_arena(c.db);
+    for (std::size_t batch_begin = 0; batch_begin < c.tasks_count; batch_begin += analytics_batch_k) {
+        std::size_t const batch_end = std::min<std::size_t>(c.tasks_count, batch_begin + analytics_batch_k);
+        centers.keys.assign(vertices + batch_begin, vertices + batch_end);
+        centers.keys.resize(sort_and_deduplicate(centers.keys.begin(), centers.keys.end()));
+        load_neighbor_sets(c.db,
+                           c.transaction,
+                           c.collection,
+                           c.options,
+                           ukv_vertex_role_any_k,
+                           true,
+                           centers,
+                           read_arena,
+                           c.error);
+        return_if_error_m(c.error);
+
+        neighbors.keys = centers.ids;
+        neighbors.keys.resize(sort_and_deduplicate(neighbors.keys.begin(), neighbors.keys.end()));
+        load_neighbor_sets(c.db,
+                           c.transaction,
+                           c.collection,
+                           c.options,
+                           ukv_vertex_role_any_k,
+                           true,
+                           neighbors,
+                           read_arena,
+                           c.error);
+        return_if_error_m(c.error);
+
+        // Every triangle is closed by two of the neighbors
+        for (std::size_t i = batch_begin; i != batch_end; ++i) {
+            auto own = centers.find(vertices[i]);
+            std::size_t closing_count = 0;
+            for (ukv_key_t neighbor : own) {
+                auto theirs = neighbors.find(neighbor);
+                closing_count += intersect_sorted(own.begin(), own.size(), theirs.begin(), theirs.size());
+            }
+            std::size_t const degree = own.size();
+            std::size_t const count = closing_count / 2;
+            triangles[i] = static_cast<ukv_size_t>(count);
+            clustering[i] = degree > 1 ? static_cast<ukv_float_t>(2.0 * count / (degree * (degree - 1))) : 0;
+        }
+    }
+}
+
+void ukv_graph_count_triangles(ukv_graph_count_triangles_t* c_ptr) {
+
+    ukv_graph_count_triangles_t& c = *c_ptr;
     linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
     return_if_error_m(c.error);
-
-    return update_neighborhoods<false>( //
-        c.db,
-        c.transaction,
-        c.tasks_count,
-        c.collections,
-        c.collections_stride,
-        c.edges_ids,
-        c.edges_stride,
-        c.sources_ids,
-        c.sources_stride,
-        c.targets_ids,
-        c.targets_stride,
-        c.options,
-        arena,
-        c.error);
+    safe_section("Counting triangles", c.error, [&] { count_triangles(c, arena); });
 }
 
-void ukv_graph_remove_edges(ukv_graph_remove_edges_t* c_ptr) {
+/*********************************************************/
+/*****************	      Edge Index      ****************/
+/*********************************************************/
 
-    ukv_graph_remove_edges_t& c = *c_ptr;
-    if (!c.tasks_count)
-        return;
+void index_edges(ukv_graph_index_edges_t& c, linked_memory_lock_t& arena) {
 
-    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_error_if_m(ukv_supports_named_collections_k,
+                      c.error,
+                      missing_feature_k,
+                      "Edge index needs named collections");
+    graph_companions_t companions;
+    companions.get(c.db, c.collection, edges_index_k, true, arena, c.error);
     return_if_error_m(c.error);
 
-    return update_neighborhoods<true>( //
-        c.db,
-        c.transaction,
-        c.tasks_count,
-        c.collections,
-        c.collections_stride,
-        c.edges_ids,
-        c.edges_stride,
-        c.sources_ids,
-        c.sources_stride,
-        c.targets_ids,
-        c.targets_stride,
-        c.options,
-        arena,
-        c.error);
+    std::vector<ukv_key_t> keys;
+    scan_vertices(c.db, c.transaction, c.collection, c.options, keys, c.error);
+    return_if_error_m(c.error);
+
+    // Every edge is indexed once, from its source
+    arena_t batch_arena(c.db);
+    ukv_vertex_role_t const role = ukv_vertex_source_k;
+    ukv_options_t const batch_options = ukv_options_t(c.options & ~ukv_option_dont_discard_memory_k);
+    ukv_options_t const read_options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k);
+    for (std::size_t batch_begin = 0; batch_begin < keys.size(); batch_begin += analytics_batch_k) {
+        std::size_t const batch_size = std::min(keys.size() - batch_begin, analytics_batch_k);
+        linked_memory_lock_t batch = linked_memory(batch_arena.member_ptr(), batch_options, c.error);
+        return_if_error_m(c.error);
+
+        ukv_vertex_degree_t* degrees = nullptr;
+        ukv_key_t* tuples = nullptr;
+        export_edge_tuples<true, true, true>( //
+            c.db,
+            c.transaction,
+            static_cast<ukv_size_t>(batch_size),
+            &c.collection,
+            0,
+            keys.data() + batch_begin,
+            sizeof(ukv_key_t),
+            &role,
+            0,
+            read_options,
+            &degrees,
+            &tuples,
+            batch,
+            c.error);
+        return_if_error_m(c.error);
+
+        std::size_t edges_count = 0;
+        for (std::size_t i = 0; i != batch_size; ++i)
+            edges_count += degrees[i] != ukv_vertex_degree_missing_k ? degrees[i] : 0;
+        update_edges_index(c.db,
+                           c.transaction,
+                           companions,
+                           edges_count,
+                           {&c.collection, 0},
+                           {tuples + 2, sizeof(ukv_key_t) * 3},
+                           {tuples + 0, sizeof(ukv_key_t) * 3},
+                           {tuples + 1, sizeof(ukv_key_t) * 3},
+                           false,
+                           read_options,
+                           batch,
+                           c.error);
+        return_if_error_m(c.error);
+    }
 }
 
-void ukv_graph_upsert_vertices(ukv_graph_upsert_vertices_t* c_ptr) {
+void ukv_graph_index_edges(ukv_graph_index_edges_t* c_ptr) {
 
-    ukv_graph_upsert_vertices_t& c = *c_ptr;
+    ukv_graph_index_edges_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Indexing edges", c.error, [&] { index_edges(c, arena); });
+}
+
+void ukv_graph_find_edges_by_id(ukv_graph_find_edges_by_id_t* c_ptr) {
+
+    ukv_graph_find_edges_by_id_t& c = *c_ptr;
     if (!c.tasks_count)
         return;
 
     linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
     return_if_error_m(c.error);
-    ukv_length_t* c_found_lengths = nullptr;
 
+    strided_iterator_gt<ukv_collection_t const> collections {c.collections, c.collections_stride};
+    auto index_collections = arena.alloc<ukv_collection_t>(c.tasks_count, c.error);
+    return_if_error_m(c.error);
+    std::optional<ukv_collection_t> last_collection;
+    ukv_collection_t last_index = ukv_collection_main_k;
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        ukv_collection_t const collection = collections ? collections[i] : ukv_collection_main_k;
+        if (!last_collection || *last_collection != collection) {
+            last_index = edges_index_collection(c.db, collection, false, arena, c.error);
+            return_if_error_m(c.error);
+            return_error_if_m(last_index != ukv_collection_main_k, c.error, args_wrong_k, "Edge index is missing");
+            last_collection = collection;
+        }
+        index_collections[i] = last_index;
+    }
+
+    ukv_bytes_ptr_t found_values = nullptr;
+    ukv_length_t* found_offsets = nullptr;
     ukv_read_t read {
         .db = c.db,
         .error = c.error,
         .transaction = c.transaction,
         .arena = arena,
-        .options = c.options,
+        .options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k),
         .tasks_count = c.tasks_count,
-        .collections = c.collections,
-        .collections_stride = c.collections_stride,
-        .keys = c.vertices,
-        .keys_stride = c.vertices_stride,
-        .lengths = &c_found_lengths,
+        .collections = index_collections.begin(),
+        .collections_stride = sizeof(ukv_collection_t),
+        .keys = c.edges_ids,
+        .keys_stride = c.edges_stride,
+        .presences = c.presences,
+        .offsets = &found_offsets,
+        .values = &found_values,
     };
-
     ukv_read(&read);
     return_if_error_m(c.error);
 
-    std::size_t idx = 0;
-    auto vertices_to_upsert = arena.alloc<ukv_key_t>(c.tasks_count, c.error);
-    strided_range_gt<ukv_key_t const> vertices {{c.vertices, c.vertices_stride}, c.tasks_count};
+    auto sources = arena.alloc_or_dummy(c.tasks_count, c.error, c.sources);
+    return_if_error_m(c.error);
+    auto targets = arena.alloc_or_dummy(c.tasks_count, c.error, c.targets);
+    return_if_error_m(c.error);
+    joined_blobs_t found {c.tasks_count, found_offsets, found_values};
     for (std::size_t i = 0; i != c.tasks_count; ++i) {
-        if (c_found_lengths[i] == ukv_length_missing_k) {
-            vertices_to_upsert[idx] = vertices[i];
-            ++idx;
-        }
+        value_view_t value = found[i];
+        indexed_edge_t edge {ukv_key_unknown_k, ukv_key_unknown_k};
+        if (value.size() == sizeof(indexed_edge_t))
+            std::memcpy(&edge, value.data(), sizeof(indexed_edge_t));
+        sources[i] = edge.source_id;
+        targets[i] = edge.target_id;
     }
+}
 
-    ukv_length_t length = 0;
-    value_view_t empty_value = "";
-    ukv_write_t write {
-        .db = c.db,
-        .error = c.error,
-        .transaction = c.transaction,
-        .arena = arena,
-        .tasks_count = idx,
-        .collections = c.collections,
-        .collections_stride = c.collections_stride,
-        .keys = vertices_to_upsert.begin(),
-        .keys_stride = sizeof(ukv_key_t),
-        .lengths = &length,
-        .values = empty_value.member_ptr(),
-    };
+/*********************************************************/
+/*****************	    Degrees Index     ****************/
+/*********************************************************/
 
-    ukv_write(&write);
-}
+void index_degrees(ukv_graph_index_degrees_t& c, linked_memory_lock_t& arena) {
 
-void ukv_graph_remove_vertices(ukv_graph_remove_vertices_t* c_ptr) {
+    return_error_if_m(ukv_supports_named_collections_k,
+                      c.error,
+                      missing_feature_k,
+                      "Degrees index needs named collections");
+    graph_companions_t companions;
+    companions.get(c.db, c.collection, degrees_index_k, true, arena, c.error);
+    return_if_error_m(c.error);
 
-    ukv_graph_remove_vertices_t& c = *c_ptr;
-    if (!c.tasks_count)
-        return;
+    std::vector<ukv_key_t> keys;
+    scan_vertices(c.db, c.transaction, c.collection, c.options, keys, c.error);
+    return_if_error_m(c.error);
+
+    // Degrees of paged vertices are known from their directories, so pages aren't gathered
+    arena_t batch_arena(c.db);
+    ukv_options_t const batch_options = ukv_options_t(c.options & ~ukv_option_dont_discard_memory_k);
+    ukv_options_t const read_options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k);
+    for (std::size_t batch_begin = 0; batch_begin < keys.size(); batch_begin += analytics_batch_k) {
+        std::size_t const batch_size = std::min(keys.size() - batch_begin, analytics_batch_k);
+        linked_memory_lock_t batch = linked_memory(batch_arena.member_ptr(), batch_options, c.error);
+        return_if_error_m(c.error);
+
+        ukv_bytes_ptr_t found_values = nullptr;
+        ukv_length_t* found_offsets = nullptr;
+        ukv_read_t read {
+            .db = c.db,
+            .error = c.error,
+            .transaction = c.transaction,
+            .arena = batch,
+            .options = read_options,
+            .tasks_count = static_cast<ukv_size_t>(batch_size),
+            .collections = &c.collection,
+            .keys = keys.data() + batch_begin,
+            .keys_stride = sizeof(ukv_key_t),
+            .offsets = &found_offsets,
+            .values = &found_values,
+        };
+        ukv_read(&read);
+        return_if_error_m(c.error);
+
+        joined_blobs_t found {batch_size, found_offsets, found_values};
+        update_degrees_index(
+            c.db,
+            c.transaction,
+            companions,
+            batch_size,
+            {&c.collection, 0},
+            {keys.data() + batch_begin, sizeof(ukv_key_t)},
+            [&](std::size_t i) { return found[i]; },
+            read_options,
+            batch,
+            c.error);
+        return_if_error_m(c.error);
+    }
+}
 
+void ukv_graph_index_degrees(ukv_graph_index_degrees_t* c_ptr) {
+
+    ukv_graph_index_degrees_t& c = *c_ptr;
     linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
     return_if_error_m(c.error);
+    safe_section("Indexing degrees", c.error, [&] { index_degrees(c, arena); });
+}
 
-    strided_iterator_gt<ukv_collection_t const> vertex_collections {c.collections, c.collections_stride};
-    strided_range_gt<ukv_key_t const> vertices {{c.vertices, c.vertices_stride}, c.tasks_count};
-    strided_iterator_gt<ukv_vertex_role_t const> vertex_roles {c.roles, c.roles_stride};
+/*********************************************************/
+/*****************	    Shortest Paths    ****************/
+/*********************************************************/
 
-    // Initially, just retrieve the bare minimum information about the vertices
-    ukv_vertex_degree_t* degrees_per_vertex = nullptr;
-    ukv_key_t* neighbors_per_vertex = nullptr;
-    export_edge_tuples<false, true, false>( //
-        c.db,
-        c.transaction,
-        c.tasks_count,
-        c.collections,
-        c.collections_stride,
-        c.vertices,
-        c.vertices_stride,
-        c.roles,
-        c.roles_stride,
-        c.options,
-        &degrees_per_vertex,
-        &neighbors_per_vertex,
-        arena,
-        c.error);
-    return_if_error_m(c.error);
+/**
+ * @brief Reads the weights of all the `csr.edges`, where edges without weights weigh one.
+ * Every distinct edge ID is read once, as with both roles fetched, edges appear twice.
+ */
+void load_weights( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_options_t const c_options,
+    csr_t const& csr,
+    std::vector<ukv_float_t>& weights,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
 
-    // Enumerate the opposite ends, from which that same reference must be removed.
-    // Here all the keys will be in the sorted order.
-    auto unique_count = std::accumulate(degrees_per_vertex, degrees_per_vertex + c.tasks_count, c.tasks_count);
-    auto unique_entries = arena.alloc<updated_entry_t>(unique_count, c.error);
-    return_if_error_m(c.error);
-    std::fill(unique_entries.begin(), unique_entries.end(), updated_entry_t {});
+    weights.assign(csr.edges.size(), 1);
+    auto companion = edges_companion_collection(c_db, c_collection, edges_weights_suffix_k, false, arena, c_error);
+    return_if_error_m(c_error);
+    if (companion == ukv_collection_main_k)
+        return;
 
-    // Sorting the tasks would help us faster locate them in the future.
-    // We may also face repetitions when connected vertices are removed.
-    {
-        auto planned_entries = unique_entries.begin();
-        for (std::size_t i = 0; i != c.tasks_count; ++i) {
-            auto collection = planned_entries->collection = vertex_collections[i];
-            planned_entries->key = vertices[i];
-            ++planned_entries;
-            for (std::size_t j = 0; j != degrees_per_vertex[i]; ++j, ++neighbors_per_vertex, ++planned_entries)
-                planned_entries->collection = collection, planned_entries->key = *neighbors_per_vertex;
+    std::vector<ukv_key_t> ids;
+    ids.reserve(csr.edges.size());
+    for (ukv_key_t id : csr.edges)
+        if (id != ukv_default_edge_id_k)
+            ids.push_back(id);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    std::vector<ukv_float_t> ids_weights(ids.size(), 1);
+    arena_t read_arena(c_db);
+    for (std::size_t begin = 0; begin < ids.size(); begin += analytics_batch_k) {
+        ukv_size_t const batch_size = std::min(ids.size() - begin, analytics_batch_k);
+        ukv_bytes_ptr_t found_values = nullptr;
+        ukv_length_t* found_offsets = nullptr;
+        ukv_read_t read {
+            .db = c_db,
+            .error = c_error,
+            .transaction = c_transaction,
+            .arena = read_arena.member_ptr(),
+            .options = ukv_options_t(c_options & ~ukv_option_dont_discard_memory_k),
+            .tasks_count = batch_size,
+            .collections = &companion,
+            .keys = ids.data() + begin,
+            .keys_stride = sizeof(ukv_key_t),
+            .offsets = &found_offsets,
+            .values = &found_values,
+        };
+        ukv_read(&read);
+        return_if_error_m(c_error);
+
+        joined_blobs_t found {batch_size, found_offsets, found_values};
+        for (std::size_t i = 0; i != batch_size; ++i) {
+            value_view_t value = found[i];
+            if (value.size() == sizeof(ukv_float_t))
+                std::memcpy(&ids_weights[begin + i], value.data(), sizeof(ukv_float_t));
         }
-        unique_count = sort_and_deduplicate(unique_entries.begin(), planned_entries);
-        unique_entries = {unique_entries.begin(), unique_count};
     }
 
-    // Fetch the opposite ends, from which that same reference must be removed.
-    // Here all the keys will be in the sorted order.
-    auto unique_strided = unique_entries.strided();
-    pull_and_link_for_updates(c.db, c.transaction, unique_strided, c.options, arena, c.error);
-    return_if_error_m(c.error);
+    for (std::size_t i = 0; i != csr.edges.size(); ++i) {
+        ukv_key_t const id = csr.edges[i];
+        if (id != ukv_default_edge_id_k)
+            weights[i] = ids_weights[offset_in_sorted(ids, id)];
+    }
+}
 
-    // From every opposite end - remove a match, and only then - the content itself
-    for (std::size_t i = 0; i != unique_strided.size(); ++i) {
-        auto vertex_collection = vertex_collections[i];
-        auto vertex_id = vertices[i];
-        auto vertex_role = vertex_roles ? vertex_roles[i] : ukv_vertex_role_any_k;
+/**
+ * @brief Dijkstra's algorithm with a binary heap, that may contain outdated entries,
+ * skipped once popped. Exports indexes of predecessors and of the last edges in CSR.
+ */
+void dijkstra( //
+    csr_t const& csr,
+    std::vector<ukv_float_t> const& weights,
+    vertex_idx_t source,
+    ukv_float_t max_distance,
+    ukv_float_t* distances,
+    vertex_idx_t* predecessors,
+    std::size_t* predecessors_edges) {
 
-        auto vertex_idx = offset_in_sorted(unique_entries, collection_key_t {vertex_collection, vertex_id});
-        updated_entry_t& vertex_value = unique_entries[vertex_idx];
+    using entry_t = std::pair<ukv_float_t, vertex_idx_t>;
+    std::vector<entry_t> heap;
+    auto closer = std::greater<entry_t>();
 
-        for (neighborship_t n : neighbors(vertex_value, vertex_role)) {
-            auto neighbor_idx = offset_in_sorted(unique_entries, collection_key_t {vertex_collection, n.neighbor_id});
-            updated_entry_t& neighbor_value = unique_entries[neighbor_idx];
-            if (vertex_role == ukv_vertex_role_any_k) {
-                erase_from_entry(neighbor_value, ukv_vertex_source_k, vertex_id);
-                erase_from_entry(neighbor_value, ukv_vertex_target_k, vertex_id);
-            }
-            else
-                erase_from_entry(neighbor_value, invert(vertex_role), vertex_id);
-        }
+    distances[source] = 0;
+    heap.emplace_back(0, source);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), closer);
+        auto [distance, vertex] = heap.back();
+        heap.pop_back();
+        if (distance > distances[vertex])
+            continue;
 
-        vertex_value.content = nullptr;
-        vertex_value.length = ukv_length_missing_k;
+        for (std::size_t i = csr.offsets[vertex]; i != csr.offsets[vertex + 1]; ++i) {
+            vertex_idx_t const neighbor = csr.neighbors[i];
+            ukv_float_t const neighbor_distance = distance + weights[i];
+            if (neighbor_distance >= distances[neighbor] || neighbor_distance > max_distance)
+                continue;
+            distances[neighbor] = neighbor_distance;
+            predecessors[neighbor] = vertex;
+            predecessors_edges[neighbor] = i;
+            heap.emplace_back(neighbor_distance, neighbor);
+            std::push_heap(heap.begin(), heap.end(), closer);
+        }
     }
+}
 
-    // Now we will go through all the explicitly deleted vertices
-    auto collections = unique_strided.immutable().members(&updated_entry_t::collection);
-    auto keys = unique_strided.immutable().members(&updated_entry_t::key);
-    auto lengths = unique_strided.immutable().members(&updated_entry_t::length);
-    auto contents = unique_strided.immutable().members(&updated_entry_t::content);
+void shortest_paths(ukv_graph_shortest_paths_t& c, linked_memory_lock_t& arena) {
 
-    ukv_write_t write {
-        .db = c.db,
-        .error = c.error,
-        .transaction = c.transaction,
-        .arena = arena,
-        .options = c.options,
-        .tasks_count = unique_count,
-        .collections = collections.begin().get(),
-        .collections_stride = collections.begin().stride(),
-        .keys = keys.begin().get(),
-        .keys_stride = keys.begin().stride(),
-        .lengths = lengths.begin().get(),
-        .lengths_stride = lengths.begin().stride(),
-        .values = contents.begin().get(),
-        .values_stride = contents.begin().stride(),
-    };
+    ukv_vertex_role_t const role = c.role != ukv_vertex_role_unknown_k ? c.role : ukv_vertex_role_any_k;
+    ukv_float_t const max_distance = c.max_distance ? c.max_distance : std::numeric_limits<ukv_float_t>::infinity();
+    return_error_if_m(max_distance > 0, c.error, args_wrong_k, "Distance limit must be positive");
 
-    ukv_write(&write);
-}
\ No newline at end of file
+    std::size_t const threads_count = scan_threads(c.transaction, c.threads_count);
+    csr_t csr;
+    load_csr(c.db, c.transaction, c.collection, c.options, role, true, threads_count, csr, c.error);
+    return_if_error_m(c.error);
+    std::vector<ukv_float_t> weights;
+    load_weights(c.db, c.transaction, c.collection, c.options, csr, weights, arena, c.error);
+    return_if_error_m(c.error);
+
+    std::size_t const count = csr.size();
+    std::size_t const exported_count = c.tasks_count * count;
+    if (c.vertices_count)
+        *c.vertices_count = count;
+    auto vertices = arena.alloc_or_dummy(count, c.error, c.vertices);
+    return_if_error_m(c.error);
+    for (std::size_t i = 0; i != count; ++i)
+        vertices[i] = csr.keys[i];
+
+    // Outputs are filled concurrently, so the missing ones are skipped, instead of using dummies
+    auto distances = c.distances ? arena.alloc<ukv_float_t>(exported_count, c.error).begin() : nullptr;
+    return_if_error_m(c.error);
+    auto predecessors = c.predecessors ? arena.alloc<ukv_key_t>(exported_count, c.error).begin() : nullptr;
+    return_if_error_m(c.error);
+    auto predecessors_edges =
+        c.predecessors_edges ? arena.alloc<ukv_key_t>(exported_count, c.error).begin() : nullptr;
+    return_if_error_m(c.error);
+    if (c.distances)
+        *c.distances = distances;
+    if (c.predecessors)
+        *c.predecessors = predecessors;
+    if (c.predecessors_edges)
+        *c.predecessors_edges = predecessors_edges;
+
+    // Every source is searched by a single thread, reusing its buffers
+    strided_iterator_gt<ukv_key_t const> sources {c.sources, c.sources_stride};
+    parallel_for_slices(threads_count, c.tasks_count, [&](std::size_t, std::size_t begin, std::size_t end) {
+        std::vector<ukv_float_t> task_distances(count);
+        std::vector<vertex_idx_t> task_predecessors(count);
+        std::vector<std::size_t> task_predecessors_edges(count);
+        for (std::size_t task = begin; task != end; ++task) {
+            std::fill(task_distances.begin(), task_distances.end(), std::numeric_limits<ukv_float_t>::infinity());
+            auto it = std::lower_bound(csr.keys.begin(), csr.keys.end(), sources[task]);
+            bool const is_present = it != csr.keys.end() && *it == sources[task];
+            vertex_idx_t const source = static_cast<vertex_idx_t>(it - csr.keys.begin());
+            if (is_present)
+                dijkstra(csr,
+                         weights,
+                         source,
+                         max_distance,
+                         task_distances.data(),
+                         task_predecessors.data(),
+                         task_predecessors_edges.data());
+
+            std::size_t const task_offset = task * count;
+            if (distances)
+                std::copy(task_distances.begin(), task_distances.end(), distances + task_offset);
+            for (std::size_t i = 0; i != count && (predecessors || predecessors_edges); ++i) {
+                bool const is_reached = task_distances[i] != std::numeric_limits<ukv_float_t>::infinity();
+                bool const has_predecessor = is_reached && i != source;
+                if (predecessors)
+                    predecessors[task_offset + i] =
+                        has_predecessor ? csr.keys[task_predecessors[i]] : ukv_key_unknown_k;
+                if (predecessors_edges)
+                    predecessors_edges[task_offset + i] =
+                        has_predecessor ? csr.edges[task_predecessors_edges[i]] : ukv_key_unknown_k;
+            }
+        }
+    });
+}
+
+void ukv_graph_shortest_paths(ukv_graph_shortest_paths_t* c_ptr) {
+
+    ukv_graph_shortest_paths_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Finding shortest paths", c.error, [&] { shortest_paths(c, arena); });
+}
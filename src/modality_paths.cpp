@@ -6,25 +6,37 @@
  * Sits on top of any @see "ukv.h"-compatible system.
  *
  * For every string key hash we store:
- * - N = number of entries (1 if no collisions appeared)
- * - N key offsets
- * - N value lengths
- * - N concatenated keys
+ * - N = number of entries (1 if no collisions appeared), with the highest bit set
+ * - N key end offsets
+ * - N value end offsets
+ * - N one-byte fingerprints of keys
+ * - N concatenated keys, sorted
  * - N concatenated values
  *
- * ## Mirror "Directory" Entries for Nested Paths
+ * Lookups compare the fingerprints of all entries at once with SIMD,
+ * and only the matching keys in full. Buckets without the highest bit
+ * in the header come from older versions and store key and value lengths
+ * instead of offsets and no fingerprints. Those are still readable
+ * and are converted on the next update.
  *
- * Furthermore, we need to store mirror entries, that will
- * store the directory tree. In other words, for an input
- * like @b home/user/media/name we would keep:
- * - home/: @b home/user
- * - home/user/: @b home/user/media
- * - home/user/media/: @b home/user/media/name
+ * The version of this layout and of the hash function is kept under a reserved
+ * key of every collection. Non-empty collections without it were written by
+ * older versions and must be migrated before they are read or updated.
  *
- * The mirror "directory" entries can have negative IDs.
- * Their values would be structured differently.
+ * ## Ordered Index for Nested Paths
+ *
+ * Hashing scatters the paths, so listing a "directory", like all
+ * the entries starting with @b home/user/ requires a full scan.
+ * Instead of mirroring every directory level in separate entries,
+ * collections can opt into an ordered index in a companion collection:
+ * - key 0: the directory of leaves, with front-coded separators.
+ * - other keys: leaves with sorted front-coded runs of paths.
+ * Prefix matches then become range scans over a few leaves.
  */
 
+#include <atomic> // `std::atomic`
+#include <cctype> // `std::isalnum`
+
 #define PCRE2_CODE_UNIT_WIDTH 8
 #include <pcre2.h>
 
@@ -35,6 +47,10 @@
 #include "helpers/linked_array.hpp"  // `uninitialized_array_gt`
 #include "helpers/algorithm.hpp"     // `sort_and_deduplicate`
 #include "helpers/full_scan.hpp"     // `full_scan_collection`
+#include "helpers/companion.hpp"     // `companion_collection`
+#include "helpers/hash.hpp"          // `stable_hash`
+#include "helpers/substring.hpp"     // `contains_substring`
+#include "helpers/parallel.hpp"      // `parallel_for_slices`
 
 /*********************************************************/
 /*****************	 C++ Implementation	  ****************/
@@ -43,43 +59,113 @@
 using namespace unum::ukv;
 using namespace unum;
 
+/**
+ * @brief Buckets are addressed by this seed and `stable_hash`, so they are portable across
+ * builds and machines, and other processes can shard paths the same way.
+ * Changing it moves every path into a different bucket, @see `ukv_paths_migrate()`.
+ */
+constexpr std::uint64_t paths_hash_seed_k = 0;
+
+/**
+ * @brief Every paths collection keeps the version of its buckets layout and hashing
+ * under this key, the largest one, that isn't `ukv_key_unknown_k`. No path is hashed into it.
+ */
+constexpr ukv_key_t paths_format_key_k = std::numeric_limits<ukv_key_t>::max() - 1;
+constexpr std::uint64_t paths_format_version_k = 1;
+
+struct paths_format_t {
+    std::uint64_t version = paths_format_version_k;
+    std::uint64_t hash_seed = paths_hash_seed_k;
+};
+
 struct hash_t {
     ukv_key_t operator()(std::string_view key_str) const noexcept {
-        using umem_t = std::hash<std::string_view>;
-        auto result = umem_t {}(key_str);
+        auto result = stable_hash(key_str.data(), key_str.size(), paths_hash_seed_k);
 #ifdef UKV_DEBUG
         result %= 10ul;
 #endif
-        return static_cast<ukv_key_t>(result);
+        auto key = static_cast<ukv_key_t>(result);
+        return key != paths_format_key_k ? key : paths_format_key_k - 1;
     }
 };
 
+/// Fingerprints come from a differently seeded hash, as paths in one bucket often share the bucket hash.
+constexpr std::uint64_t fingerprint_seed_k = ~paths_hash_seed_k;
+
+using fingerprint_t = std::uint8_t;
+
+fingerprint_t fingerprint(std::string_view key_str) noexcept {
+    return static_cast<fingerprint_t>(stable_hash(key_str.data(), key_str.size(), fingerprint_seed_k) >> 56);
+}
+
 constexpr std::size_t counter_size_k = sizeof(ukv_length_t);
 constexpr std::size_t bytes_in_header_k = counter_size_k;
+/// Buckets in the current format have this bit set in the header, next to the number of entries.
+constexpr ukv_length_t bucket_fingerprints_flag_k = ukv_length_t(1) << 31;
+
+ukv_length_t get_bucket_header(value_view_t bucket) noexcept {
+    ukv_length_t header = 0;
+    if (bucket.size() > bytes_in_header_k)
+        std::memcpy(&header, bucket.data(), bytes_in_header_k);
+    return header;
+}
 
 ukv_length_t get_bucket_size(value_view_t bucket) noexcept {
-    auto lengths = reinterpret_cast<ukv_length_t const*>(bucket.data());
-    return bucket.size() > bytes_in_header_k ? *lengths : 0u;
+    return get_bucket_header(bucket) & ~bucket_fingerprints_flag_k;
 }
 
-ptr_range_gt<ukv_length_t const> get_bucket_counters(value_view_t bucket, ukv_length_t size) noexcept {
-    auto lengths = reinterpret_cast<ukv_length_t const*>(bucket.data());
-    return {lengths, lengths + size * 2u + 1u};
+bool has_fingerprints(value_view_t bucket) noexcept {
+    return get_bucket_header(bucket) & bucket_fingerprints_flag_k;
 }
 
-consecutive_strs_iterator_t get_bucket_keys(value_view_t bucket, ukv_length_t size) noexcept {
+consecutive_strs_iterator_t get_legacy_bucket_keys(value_view_t bucket, ukv_length_t size) noexcept {
     auto lengths = reinterpret_cast<ukv_length_t const*>(bucket.data());
     auto bytes_for_counters = size * 2u * counter_size_k;
     return {lengths + 1u, bucket.data() + bytes_in_header_k + bytes_for_counters};
 }
 
-consecutive_blobs_iterator_t get_bucket_vals(value_view_t bucket, ukv_length_t size) noexcept {
+consecutive_blobs_iterator_t get_legacy_bucket_vals(value_view_t bucket, ukv_length_t size) noexcept {
     auto lengths = reinterpret_cast<ukv_length_t const*>(bucket.data());
     auto bytes_for_counters = size * 2u * counter_size_k;
     auto bytes_for_keys = std::accumulate(lengths + 1u, lengths + 1u + size, 0ul);
     return {lengths + 1u + size, bucket.data() + bytes_in_header_k + bytes_for_counters + bytes_for_keys};
 }
 
+/**
+ * @brief Random access to the members of a bucket in the current format.
+ * Keys and values are addressed by their end offsets, so no prefix sums are needed.
+ */
+struct bucket_layout_t {
+    std::size_t size = 0;
+    ukv_length_t const* keys_ends = nullptr;
+    ukv_length_t const* vals_ends = nullptr;
+    fingerprint_t const* fingerprints = nullptr;
+    byte_t const* keys = nullptr;
+    byte_t const* vals = nullptr;
+
+    static std::size_t bytes_before_keys(std::size_t size) noexcept {
+        return bytes_in_header_k + size * (2u * counter_size_k + sizeof(fingerprint_t));
+    }
+
+    bucket_layout_t(value_view_t bucket) noexcept : size(get_bucket_size(bucket)) {
+        keys_ends = reinterpret_cast<ukv_length_t const*>(bucket.data() + bytes_in_header_k);
+        vals_ends = keys_ends + size;
+        fingerprints = reinterpret_cast<fingerprint_t const*>(vals_ends + size);
+        keys = bucket.data() + bytes_before_keys(size);
+        vals = keys + (size ? keys_ends[size - 1] : 0u);
+    }
+
+    std::string_view key(std::size_t i) const noexcept {
+        ukv_length_t const begin = i ? keys_ends[i - 1] : 0u;
+        return {reinterpret_cast<char const*>(keys) + begin, keys_ends[i] - begin};
+    }
+
+    value_view_t value(std::size_t i) const noexcept {
+        ukv_length_t const begin = i ? vals_ends[i - 1] : 0u;
+        return {vals + begin, vals_ends[i] - begin};
+    }
+};
+
 struct bucket_member_t {
     std::size_t idx = 0;
     std::string_view key;
@@ -93,21 +179,105 @@ void for_each_in_bucket(value_view_t bucket, bucket_member_callback_at member_ca
     auto bucket_size = get_bucket_size(bucket);
     if (!bucket_size)
         return;
-    auto bucket_keys = get_bucket_keys(bucket, bucket_size);
-    auto bucket_vals = get_bucket_vals(bucket, bucket_size);
+    if (has_fingerprints(bucket)) {
+        bucket_layout_t layout(bucket);
+        for (std::size_t i = 0; i != bucket_size; ++i)
+            member_callback(bucket_member_t {i, layout.key(i), layout.value(i)});
+        return;
+    }
+    auto bucket_keys = get_legacy_bucket_keys(bucket, bucket_size);
+    auto bucket_vals = get_legacy_bucket_vals(bucket, bucket_size);
     for (std::size_t i = 0; i != bucket_size; ++i, ++bucket_keys, ++bucket_vals)
         member_callback(bucket_member_t {i, *bucket_keys, *bucket_vals});
 }
 
+/**
+ * @brief Finds a path in a bucket, comparing the fingerprints of all members at once,
+ * and the full strings only for the matching fingerprints.
+ */
 bucket_member_t find_in_bucket(value_view_t bucket, std::string_view key_str) noexcept {
     bucket_member_t result;
-    for_each_in_bucket(bucket, [&](bucket_member_t const& member) {
-        if (member.key == key_str)
-            result = member;
+    if (!has_fingerprints(bucket)) {
+        for_each_in_bucket(bucket, [&](bucket_member_t const& member) {
+            if (member.key == key_str)
+                result = member;
+        });
+        return result;
+    }
+
+    bucket_layout_t layout(bucket);
+    find_equal_byte(layout.fingerprints, layout.size, fingerprint(key_str), [&](std::size_t i) {
+        if (layout.key(i) != key_str)
+            return false;
+        result = {i, layout.key(i), layout.value(i)};
+        return true;
     });
     return result;
 }
 
+struct bucket_entry_t {
+    std::string_view key;
+    value_view_t value;
+};
+
+/**
+ * @brief Old member or a new version of a path in one of the updated buckets.
+ * Old members have zero `rank`, and updates are ranked by their order in the batch,
+ * so after sorting the last entry of every path is the one to keep.
+ */
+struct bucket_update_t {
+    std::size_t bucket_idx = 0;
+    std::size_t rank = 0;
+    bucket_entry_t entry;
+
+    bool operator<(bucket_update_t const& other) const noexcept {
+        if (bucket_idx != other.bucket_idx)
+            return bucket_idx < other.bucket_idx;
+        if (entry.key != other.entry.key)
+            return entry.key < other.entry.key;
+        return rank < other.rank;
+    }
+};
+
+/**
+ * @brief Serializes the `entries` into a new bucket in the current format.
+ * @return An empty view, if no entries are left, to remove the bucket.
+ */
+value_view_t encode_bucket(ptr_range_gt<bucket_entry_t const> entries,
+                           linked_memory_lock_t& arena,
+                           ukv_error_t* c_error) noexcept {
+    std::size_t const size = entries.size();
+    if (!size)
+        return {};
+
+    std::size_t bytes_for_keys = 0, bytes_for_vals = 0;
+    for (bucket_entry_t const& entry : entries)
+        bytes_for_keys += entry.key.size(), bytes_for_vals += entry.value.size();
+    std::size_t const bytes_before_keys = bucket_layout_t::bytes_before_keys(size);
+    auto new_bytes = bytes_before_keys + bytes_for_keys + bytes_for_vals;
+    auto new_begin = arena.alloc<byte_t>(new_bytes, c_error, sizeof(ukv_length_t)).begin();
+    if (*c_error)
+        return {};
+
+    ukv_length_t const header = static_cast<ukv_length_t>(size) | bucket_fingerprints_flag_k;
+    std::memcpy(new_begin, &header, bytes_in_header_k);
+    auto keys_ends = reinterpret_cast<ukv_length_t*>(new_begin + bytes_in_header_k);
+    auto vals_ends = keys_ends + size;
+    auto fingerprints = reinterpret_cast<fingerprint_t*>(vals_ends + size);
+    auto keys_output = new_begin + bytes_before_keys;
+    auto vals_output = keys_output + bytes_for_keys;
+    ukv_length_t key_end = 0, val_end = 0;
+    for (std::size_t i = 0; i != size; ++i) {
+        bucket_entry_t const& entry = entries[i];
+        std::memcpy(keys_output + key_end, entry.key.data(), entry.key.size());
+        std::memcpy(vals_output + val_end, entry.value.data(), entry.value.size());
+        keys_ends[i] = key_end += static_cast<ukv_length_t>(entry.key.size());
+        vals_ends[i] = val_end += static_cast<ukv_length_t>(entry.value.size());
+        fingerprints[i] = fingerprint(entry.key);
+    }
+    return {new_begin, new_bytes};
+}
+
 bool starts_with(std::string_view str, std::string_view prefix) noexcept {
     return str.size() >= prefix.size() && str.substr(0, prefix.size()) == prefix;
 }
@@ -146,102 +316,683 @@ bool is_prefix(std::string_view prefix_or_pattern) noexcept {
 }
 
 /**
- * @brief Removes part of variable length string.
- * @return The shortened view of the input. Will start from same address.
+ * @brief Flags of `ukv_paths_cursor_t`, that are hidden from users.
+ * Cursors of full scans address members in buckets, while cursors
+ * of ordered indexes address paths in leaves.
  */
-value_view_t remove_part(value_view_t full, value_view_t part) noexcept {
-    auto removed_length = part.size();
-    auto moved_length = full.size() - part.size();
-    std::memmove((void*)part.begin(), (void*)part.end(), moved_length);
-    return {full.begin(), full.size() - removed_length};
-}
-
-void remove_from_bucket(value_view_t& bucket, std::string_view key_str) noexcept {
-    // If the entry was present, it must be clamped.
-    // Matching key and length entry will be removed.
-    auto [old_idx, old_key, old_val] = find_in_bucket(bucket, key_str);
-    if (!old_val)
-        return;
+constexpr ukv_length_t cursor_started_k = 1u << 0;
+constexpr ukv_length_t cursor_exhausted_k = 1u << 1;
+constexpr ukv_length_t cursor_indexed_k = 1u << 2;
 
-    // Most of the time slots contain just one entry
-    auto old_size = get_bucket_size(bucket);
-    if (old_size == 1) {
-        bucket = {};
-        return;
+constexpr ukv_paths_cursor_t exhausted_cursor_k {0, 0, cursor_exhausted_k};
+
+/// Addresses the path following the one at `offset` in the bucket or leaf under `key`.
+ukv_paths_cursor_t cursor_after(ukv_key_t key, std::size_t offset, ukv_length_t flags = 0) noexcept {
+    return {key, static_cast<ukv_length_t>(offset + 1), cursor_started_k | flags};
+}
+
+/*********************************************************/
+/*****************	    Ordered Index	  ****************/
+/*********************************************************/
+
+constexpr ukv_str_view_t index_suffix_k = "paths.index";
+/// The directory of leaves always lives under this key, while leaves get increasing keys.
+constexpr ukv_key_t index_directory_key_k = 0;
+/// Leaves, that have grown bigger, are split into pieces of half that size.
+constexpr std::size_t index_leaf_capacity_k = 4096;
+constexpr std::size_t index_leaf_fill_k = index_leaf_capacity_k / 2;
+/// Prefix scans fetch that many consecutive leaves at once.
+constexpr std::size_t index_read_ahead_k = 4;
+/// Full scans over all the buckets fetch that many at once.
+constexpr ukv_length_t buckets_read_ahead_k = 1024;
+
+using sorted_paths_t = std::vector<std::string>;
+
+/**
+ * @brief The root of a two-level ordered index over the paths of one collection.
+ * Every leaf is a sorted run of paths, and the directory maps the smallest path,
+ * that may be stored in a leaf, to its key. The first separator is always empty.
+ *
+ * Serialized as the next free leaf key, the number of leaves, their keys
+ * and the front-coded separators.
+ */
+struct index_directory_t {
+    ukv_key_t next_free_key = index_directory_key_k + 1;
+    std::vector<ukv_key_t> leaves;
+    sorted_paths_t separators;
+
+    std::size_t leaf_offset(std::string_view path) const noexcept {
+        auto it = std::upper_bound(separators.begin(), separators.end(), path);
+        return it == separators.begin() ? 0 : static_cast<std::size_t>(it - separators.begin()) - 1;
+    }
+};
+
+/**
+ * @brief Appends sorted strings, replacing the prefix shared with the previous one with its length.
+ * Every entry is the length of the shared prefix, the length of the suffix and the suffix itself.
+ */
+void append_front_coded(sorted_paths_t const& strings, std::string& output) {
+    std::string_view previous;
+    for (std::string const& str : strings) {
+        auto mismatch = std::mismatch(previous.begin(), previous.end(), str.begin(), str.end());
+        ukv_length_t const shared = static_cast<ukv_length_t>(mismatch.first - previous.begin());
+        ukv_length_t const lengths[2] {shared, static_cast<ukv_length_t>(str.size() - shared)};
+        output.append(reinterpret_cast<char const*>(lengths), sizeof(lengths));
+        output.append(str, shared);
+        previous = str;
     }
+}
+
+bool parse_front_coded(char const* input, char const* end, std::size_t count, sorted_paths_t& strings) {
+    strings.resize(count);
+    for (std::size_t i = 0; i != count; ++i) {
+        ukv_length_t lengths[2];
+        if (static_cast<std::size_t>(end - input) < sizeof(lengths))
+            return false;
+        std::memcpy(lengths, input, sizeof(lengths));
+        input += sizeof(lengths);
+        std::size_t const previous_length = i ? strings[i - 1].size() : 0;
+        if (lengths[0] > previous_length || static_cast<std::size_t>(end - input) < lengths[1])
+            return false;
+        strings[i].reserve(lengths[0] + lengths[1]);
+        strings[i].assign(i ? strings[i - 1].data() : "", lengths[0]);
+        strings[i].append(input, lengths[1]);
+        input += lengths[1];
+    }
+    return input == end;
+}
+
+std::string encode_index_leaf(sorted_paths_t const& paths) {
+    ukv_length_t const count = static_cast<ukv_length_t>(paths.size());
+    std::string result(reinterpret_cast<char const*>(&count), sizeof(count));
+    append_front_coded(paths, result);
+    return result;
+}
+
+bool decode_index_leaf(value_view_t bytes, sorted_paths_t& paths) {
+    ukv_length_t count = 0;
+    if (bytes.size() < sizeof(count))
+        return false;
+    std::memcpy(&count, bytes.data(), sizeof(count));
+    auto begin = reinterpret_cast<char const*>(bytes.data());
+    return parse_front_coded(begin + sizeof(count), begin + bytes.size(), count, paths);
+}
+
+std::string encode_index_directory(index_directory_t const& directory) {
+    ukv_length_t const count = static_cast<ukv_length_t>(directory.leaves.size());
+    std::string result;
+    result.append(reinterpret_cast<char const*>(&directory.next_free_key), sizeof(ukv_key_t));
+    result.append(reinterpret_cast<char const*>(&count), sizeof(count));
+    result.append(reinterpret_cast<char const*>(directory.leaves.data()), count * sizeof(ukv_key_t));
+    append_front_coded(directory.separators, result);
+    return result;
+}
+
+bool decode_index_directory(value_view_t bytes, index_directory_t& directory) {
+    ukv_length_t count = 0;
+    constexpr std::size_t header_size_k = sizeof(ukv_key_t) + sizeof(ukv_length_t);
+    if (bytes.size() < header_size_k)
+        return false;
+    auto begin = reinterpret_cast<char const*>(bytes.data());
+    std::memcpy(&directory.next_free_key, begin, sizeof(ukv_key_t));
+    std::memcpy(&count, begin + sizeof(ukv_key_t), sizeof(count));
+    if (bytes.size() < header_size_k + count * sizeof(ukv_key_t))
+        return false;
+    directory.leaves.resize(count);
+    std::memcpy(directory.leaves.data(), begin + header_size_k, count * sizeof(ukv_key_t));
+    return parse_front_coded(begin + header_size_k + count * sizeof(ukv_key_t),
+                             begin + bytes.size(),
+                             count,
+                             directory.separators);
+}
+
+/**
+ * @brief The shortest prefix of `right`, that is still bigger than `left`,
+ * so that the directory keeps only as much of a path, as is needed for routing.
+ */
+std::string shortest_separator(std::string_view left, std::string_view right) {
+    auto mismatch = std::mismatch(left.begin(), left.end(), right.begin(), right.end());
+    return std::string(right.substr(0, static_cast<std::size_t>(mismatch.second - right.begin()) + 1));
+}
+
+/**
+ * @brief Cuts a sorted run of paths into pieces of roughly `index_leaf_fill_k` serialized bytes.
+ * @return The offsets of the first paths of every piece.
+ */
+std::vector<std::size_t> split_into_leaves(sorted_paths_t const& paths) {
+    std::vector<std::size_t> begins;
+    std::size_t fill = index_leaf_fill_k;
+    for (std::size_t i = 0; i != paths.size(); ++i) {
+        if (fill >= index_leaf_fill_k)
+            begins.push_back(i), fill = sizeof(ukv_length_t);
+        fill += 2 * sizeof(ukv_length_t) + paths[i].size();
+    }
+    return begins;
+}
+
+/// Upper bound of the serialized size, as front-coding only shrinks the strings.
+std::size_t leaf_size_upper_bound(sorted_paths_t const& paths) noexcept {
+    std::size_t result = sizeof(ukv_length_t);
+    for (std::string const& path : paths)
+        result += 2 * sizeof(ukv_length_t) + path.size();
+    return result;
+}
+
+ukv_collection_t paths_index_collection( //
+    ukv_database_t const c_db,
+    ukv_collection_t const c_collection,
+    bool create_if_missing,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+    if (!ukv_supports_named_collections_k)
+        return ukv_collection_main_k;
+    return companion_collection(c_db, c_collection, index_suffix_k, create_if_missing, arena, c_error);
+}
+
+/**
+ * @brief Fetches the directory or the leaves of the index in a single batch.
+ * Missing entries are exported as empty values.
+ */
+joined_blobs_t read_index_entries( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_index,
+    ukv_key_t const* keys,
+    std::size_t const count,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    ukv_length_t* found_offsets = nullptr;
+    ukv_byte_t* found_values = nullptr;
+    ukv_read_t read {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = ukv_options_t(c_options | ukv_option_dont_discard_memory_k),
+        .tasks_count = static_cast<ukv_size_t>(count),
+        .collections = &c_index,
+        .keys = keys,
+        .keys_stride = sizeof(ukv_key_t),
+        .offsets = &found_offsets,
+        .values = &found_values,
+    };
+    ukv_read(&read);
+    if (*c_error)
+        return {};
+    return {static_cast<ukv_size_t>(count), found_offsets, found_values};
+}
+
+index_directory_t read_index_directory( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_index,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
 
-    bucket = remove_part(bucket, old_val);
-    bucket = remove_part(bucket, old_key);
+    index_directory_t directory;
+    joined_blobs_t found =
+        read_index_entries(c_db, c_transaction, c_index, &index_directory_key_k, 1, c_options, arena, c_error);
+    if (*c_error || !found[0].size())
+        return directory;
+    if (!decode_index_directory(found[0], directory))
+        log_error_m(c_error, consistency_k, "Corrupted paths index");
+    return directory;
+}
+
+/**
+ * @brief Writes serialized entries, like leaves of the index, removing the ones with empty values.
+ */
+void write_or_remove_entries( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    std::vector<ukv_key_t> const& keys,
+    std::vector<std::string> const& values,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
 
-    // Remove the value counter
-    auto begin = bucket.data();
-    value_view_t value_length_bytes {begin + counter_size_k * (old_size + old_idx + 1u), counter_size_k};
-    bucket = remove_part(bucket, value_length_bytes);
-    value_view_t key_length_bytes {begin + counter_size_k * (old_idx + 1u), counter_size_k};
-    bucket = remove_part(bucket, key_length_bytes);
+    std::vector<value_view_t> contents(values.size());
+    for (std::size_t i = 0; i != values.size(); ++i)
+        if (!values[i].empty())
+            contents[i] = {reinterpret_cast<byte_t const*>(values[i].data()), values[i].size()};
 
-    // Decrement the size
-    auto lengths = (ukv_length_t*)begin;
-    lengths[0] -= 1u;
+    ukv_write_t write {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = c_options,
+        .tasks_count = static_cast<ukv_size_t>(keys.size()),
+        .collections = &c_collection,
+        .keys = keys.data(),
+        .keys_stride = sizeof(ukv_key_t),
+        .lengths = contents[0].member_length(),
+        .lengths_stride = sizeof(value_view_t),
+        .values = contents[0].member_ptr(),
+        .values_stride = sizeof(value_view_t),
+    };
+    ukv_write(&write);
 }
 
-void upsert_in_bucket( //
-    value_view_t& bucket,
-    std::string_view key,
-    value_view_t val,
+/**
+ * @brief Inserts present paths into the ordered index and removes the absent ones.
+ * Reads the directory and all the touched leaves in two batches, and writes them back
+ * in one, splitting overflown leaves and dropping empty ones. Leaves are never merged,
+ * so after many removals the index can be compacted by building it again.
+ *
+ * @param updates Unique paths and their presence, sorted by path.
+ */
+void update_paths_index( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_index,
+    std::vector<std::pair<std::string_view, bool>> const& updates,
+    ukv_options_t const c_options,
     linked_memory_lock_t& arena,
-    ukv_error_t* c_error) noexcept {
-
-    auto old_size = get_bucket_size(bucket);
-    auto old_bytes_for_counters = old_size * 2u * counter_size_k;
-    auto old_lengths = reinterpret_cast<ukv_length_t const*>(bucket.data());
-    auto old_bytes_for_keys = bucket ? std::accumulate(old_lengths + 1u, old_lengths + 1u + old_size, 0ul) : 0ul;
-    auto old_bytes_for_vals =
-        bucket ? std::accumulate(old_lengths + 1u + old_size, old_lengths + 1u + old_size * 2ul, 0ul) : 0ul;
-    auto [old_idx, old_key, old_val] = find_in_bucket(bucket, key);
-    bool is_missing = !old_val;
-
-    auto new_size = old_size + is_missing;
-    auto new_bytes_for_counters = new_size * 2u * counter_size_k;
-    auto new_bytes_for_keys = old_bytes_for_keys - old_key.size() + key.size();
-    auto new_bytes_for_vals = old_bytes_for_vals - old_val.size() + val.size();
-    auto new_bytes = bytes_in_header_k + new_bytes_for_counters + new_bytes_for_keys + new_bytes_for_vals;
-
-    auto new_begin = arena.alloc<byte_t>(new_bytes, c_error).begin();
+    ukv_error_t* c_error) {
+
+    if (updates.empty())
+        return;
+
+    index_directory_t old_directory = read_index_directory(c_db, c_transaction, c_index, c_options, arena, c_error);
     return_if_error_m(c_error);
-    auto new_lengths = reinterpret_cast<ukv_length_t*>(new_begin);
-    new_lengths[0] = new_size;
-    auto new_keys_lengths = new_lengths + 1ul;
-    auto new_vals_lengths = new_lengths + 1ul + new_size;
-    auto new_keys_output = new_begin + bytes_in_header_k + new_bytes_for_counters;
-    auto new_vals_output = new_begin + bytes_in_header_k + new_bytes_for_counters + new_bytes_for_keys;
-
-    auto old_keys = get_bucket_keys(bucket, old_size);
-    auto old_vals = get_bucket_vals(bucket, old_size);
-    std::size_t new_idx = 0;
-    for (std::size_t i = 0; i != old_size; ++i, ++old_keys, ++old_vals) {
-        if (!is_missing && i == old_idx)
+    if (old_directory.leaves.empty()) {
+        old_directory.leaves.push_back(old_directory.next_free_key++);
+        old_directory.separators.emplace_back();
+    }
+
+    // As updates are sorted, every leaf receives a contiguous range of them
+    std::vector<std::size_t> touched_offsets;
+    std::vector<std::size_t> touched_updates_begins;
+    for (std::size_t i = 0; i != updates.size(); ++i) {
+        std::size_t const offset = old_directory.leaf_offset(updates[i].first);
+        if (touched_offsets.empty() || touched_offsets.back() != offset)
+            touched_offsets.push_back(offset), touched_updates_begins.push_back(i);
+    }
+    touched_updates_begins.push_back(updates.size());
+
+    std::vector<ukv_key_t> touched_keys(touched_offsets.size());
+    for (std::size_t i = 0; i != touched_offsets.size(); ++i)
+        touched_keys[i] = old_directory.leaves[touched_offsets[i]];
+    joined_blobs_t found_leaves = read_index_entries( //
+        c_db,
+        c_transaction,
+        c_index,
+        touched_keys.data(),
+        touched_keys.size(),
+        c_options,
+        arena,
+        c_error);
+    return_if_error_m(c_error);
+
+    index_directory_t directory;
+    directory.next_free_key = old_directory.next_free_key;
+    std::vector<ukv_key_t> written_keys;
+    std::vector<std::string> written_values;
+    sorted_paths_t paths;
+    for (std::size_t offset = 0, touched_idx = 0; offset != old_directory.leaves.size(); ++offset) {
+        ukv_key_t const leaf_key = old_directory.leaves[offset];
+        std::string& separator = old_directory.separators[offset];
+        if (touched_idx == touched_offsets.size() || touched_offsets[touched_idx] != offset) {
+            directory.leaves.push_back(leaf_key);
+            directory.separators.push_back(std::move(separator));
             continue;
+        }
 
-        value_view_t old_key = *old_keys;
-        value_view_t old_val = *old_vals;
-        new_keys_lengths[new_idx] = static_cast<ukv_length_t>(old_key.size());
-        new_vals_lengths[new_idx] = static_cast<ukv_length_t>(old_val.size());
-        std::memcpy(new_keys_output, old_key.data(), old_key.size());
-        std::memcpy(new_vals_output, old_val.data(), old_val.size());
+        paths.clear();
+        value_view_t found_leaf = found_leaves[touched_idx];
+        if (found_leaf.size())
+            return_error_if_m(decode_index_leaf(found_leaf, paths), c_error, consistency_k, "Corrupted paths index");
+        for (std::size_t i = touched_updates_begins[touched_idx]; i != touched_updates_begins[touched_idx + 1]; ++i) {
+            auto [path, present] = updates[i];
+            auto it = std::lower_bound(paths.begin(), paths.end(), path);
+            bool const exists = it != paths.end() && *it == path;
+            if (present && !exists)
+                paths.emplace(it, path);
+            else if (!present && exists)
+                paths.erase(it);
+        }
+        ++touched_idx;
 
-        new_keys_output += old_key.size();
-        new_vals_output += old_val.size();
-        ++new_idx;
+        // Empty leaves are dropped, and overflown ones are split
+        if (paths.empty()) {
+            written_keys.push_back(leaf_key);
+            written_values.emplace_back();
+            continue;
+        }
+        std::vector<std::size_t> begins {0};
+        if (leaf_size_upper_bound(paths) > index_leaf_capacity_k)
+            begins = split_into_leaves(paths);
+        begins.push_back(paths.size());
+        for (std::size_t piece = 0; piece + 1 != begins.size(); ++piece) {
+            sorted_paths_t piece_paths(paths.begin() + begins[piece], paths.begin() + begins[piece + 1]);
+            directory.leaves.push_back(piece ? directory.next_free_key++ : leaf_key);
+            directory.separators.push_back(
+                piece ? shortest_separator(paths[begins[piece] - 1], paths[begins[piece]]) : std::move(separator));
+            written_keys.push_back(directory.leaves.back());
+            written_values.push_back(encode_index_leaf(piece_paths));
+        }
     }
 
-    // Append the new entry at the end
-    new_keys_lengths[new_idx] = static_cast<ukv_length_t>(key.size());
-    new_vals_lengths[new_idx] = static_cast<ukv_length_t>(val.size());
-    std::memcpy(new_keys_output, key.data(), key.size());
-    std::memcpy(new_vals_output, val.data(), val.size());
+    if (!directory.separators.empty())
+        directory.separators.front().clear();
+    written_keys.push_back(index_directory_key_k);
+    written_values.push_back(encode_index_directory(directory));
+    write_or_remove_entries(c_db, c_transaction, c_index, written_keys, written_values, c_options, arena, c_error);
+}
+
+/**
+ * @brief Updates the ordered indexes of all the collections, that have them.
+ * If the same path is addressed several times, the last write wins.
+ */
+void update_paths_indexes( //
+    ukv_paths_write_t const& c,
+    contents_arg_t const& paths,
+    contents_arg_t const& contents,
+    ukv_options_t const c_options,
+    linked_memory_lock_t& arena) {
+
+    if (!ukv_supports_named_collections_k)
+        return;
+
+    strided_iterator_gt<ukv_collection_t const> collections {c.collections, c.collections_stride};
+    std::vector<ukv_collection_t> unique_collections(c.tasks_count);
+    for (std::size_t i = 0; i != c.tasks_count; ++i)
+        unique_collections[i] = collections ? collections[i] : ukv_collection_main_k;
+    std::sort(unique_collections.begin(), unique_collections.end());
+    unique_collections.erase(std::unique(unique_collections.begin(), unique_collections.end()),
+                             unique_collections.end());
+
+    std::vector<std::pair<std::string_view, bool>> updates;
+    for (ukv_collection_t collection : unique_collections) {
+        auto index = paths_index_collection(c.db, collection, false, arena, c.error);
+        return_if_error_m(c.error);
+        if (index == ukv_collection_main_k)
+            continue;
+
+        updates.clear();
+        for (std::size_t i = 0; i != c.tasks_count; ++i)
+            if ((collections ? collections[i] : ukv_collection_main_k) == collection)
+                updates.emplace_back(paths[i], bool(contents[i]));
+        std::stable_sort(updates.begin(), updates.end(), [](auto const& a, auto const& b) {
+            return a.first < b.first;
+        });
+        auto last_writes_end = std::unique(updates.rbegin(), updates.rend(), [](auto const& a, auto const& b) {
+            return a.first == b.first;
+        });
+        updates.erase(updates.begin(), last_writes_end.base());
+
+        update_paths_index(c.db, c.transaction, index, updates, c_options, arena, c.error);
+        return_if_error_m(c.error);
+    }
+}
 
-    bucket = {new_begin, new_bytes};
+/**
+ * @brief Exports paths with a given prefix in lexicographic order, starting after `previous_path`
+ * or at the `cursor`, which is then replaced with the position after the exported paths.
+ * Only the leaves, that may contain such paths, are fetched.
+ */
+void index_scan_w_prefix( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_index,
+    std::string_view prefix,
+    std::string_view previous_path,
+    ukv_paths_cursor_t& cursor,
+    ukv_length_t c_count_limit,
+    ukv_options_t const c_options,
+    std::size_t,
+    ukv_length_t& count,
+    growing_tape_t& paths,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    count = 0;
+    if (!c_count_limit)
+        return;
+    index_directory_t directory = read_index_directory(c_db, c_transaction, c_index, c_options, arena, c_error);
+    return_if_error_m(c_error);
+
+    // Cursors address leaves by keys, which are never reused, unless the index is rebuilt
+    std::string_view const start = std::max(prefix, previous_path);
+    std::size_t first_offset = directory.leaf_offset(start);
+    if (cursor.flags & cursor_started_k) {
+        auto leaf_it = std::find(directory.leaves.begin(), directory.leaves.end(), cursor.key);
+        return_error_if_m(leaf_it != directory.leaves.end(), c_error, args_wrong_k, "Paths cursor is outdated");
+        first_offset = static_cast<std::size_t>(leaf_it - directory.leaves.begin());
+    }
+    ukv_paths_cursor_t const start_cursor = std::exchange(cursor, exhausted_cursor_k);
+
+    sorted_paths_t leaf;
+    for (std::size_t offset = first_offset; offset < directory.leaves.size();) {
+        std::size_t const batch_size = std::min(index_read_ahead_k, directory.leaves.size() - offset);
+        joined_blobs_t found_leaves = read_index_entries( //
+            c_db,
+            c_transaction,
+            c_index,
+            directory.leaves.data() + offset,
+            batch_size,
+            c_options,
+            arena,
+            c_error);
+        return_if_error_m(c_error);
+
+        for (std::size_t i = 0; i != batch_size; ++i) {
+            bool const is_valid = decode_index_leaf(found_leaves[i], leaf);
+            return_error_if_m(is_valid, c_error, consistency_k, "Corrupted paths index");
+            bool const is_resumed = (start_cursor.flags & cursor_started_k) && offset + i == first_offset;
+            auto it = is_resumed ? leaf.begin() + std::min<std::size_t>(start_cursor.offset, leaf.size())
+                                 : std::lower_bound(leaf.begin(), leaf.end(), start);
+            for (; it != leaf.end(); ++it) {
+                if (!starts_with(*it, prefix))
+                    return;
+                if (!previous_path.empty() && *it == previous_path)
+                    continue;
+                paths.push_back(std::string_view(*it), c_error);
+                return_if_error_m(c_error);
+                paths.add_terminator(byte_t {0}, c_error);
+                return_if_error_m(c_error);
+                if (++count == c_count_limit) {
+                    cursor = cursor_after(directory.leaves[offset + i], it - leaf.begin(), cursor_indexed_k);
+                    return;
+                }
+            }
+        }
+        offset += batch_size;
+    }
+}
+
+/**
+ * @brief Builds the ordered index from scratch, collecting all the paths from buckets.
+ * New leaves are only filled halfway, leaving space for future insertions.
+ */
+void index_paths(ukv_paths_index_t& c, linked_memory_lock_t& arena) {
+
+    return_error_if_m(ukv_supports_named_collections_k,
+                      c.error,
+                      missing_feature_k,
+                      "Paths index needs named collections");
+    auto index = paths_index_collection(c.db, c.collection, true, arena, c.error);
+    return_if_error_m(c.error);
+
+    sorted_paths_t paths;
+    full_scan_collection(c.db,
+                         c.transaction,
+                         c.collection,
+                         c.options,
+                         std::numeric_limits<ukv_key_t>::min(),
+                         buckets_read_ahead_k,
+                         arena,
+                         c.error,
+                         [&](ukv_key_t key, value_view_t bucket) {
+                             if (key == paths_format_key_k)
+                                 return true;
+                             for_each_in_bucket(bucket, [&](bucket_member_t const& member) {
+                                 paths.emplace_back(member.key);
+                             });
+                             return true;
+                         });
+    return_if_error_m(c.error);
+    std::sort(paths.begin(), paths.end());
+
+    index_directory_t old_directory = read_index_directory(c.db, c.transaction, index, c.options, arena, c.error);
+    return_if_error_m(c.error);
+
+    index_directory_t directory;
+    std::vector<ukv_key_t> written_keys;
+    std::vector<std::string> written_values;
+    std::vector<std::size_t> begins = split_into_leaves(paths);
+    begins.push_back(paths.size());
+    for (std::size_t piece = 0; piece + 1 != begins.size(); ++piece) {
+        sorted_paths_t piece_paths(paths.begin() + begins[piece], paths.begin() + begins[piece + 1]);
+        directory.leaves.push_back(directory.next_free_key++);
+        directory.separators.push_back(piece ? shortest_separator(paths[begins[piece] - 1], paths[begins[piece]])
+                                             : std::string());
+        written_keys.push_back(directory.leaves.back());
+        written_values.push_back(encode_index_leaf(piece_paths));
+    }
+
+    // Leaves of the previous build, that weren't overwritten, are removed
+    for (ukv_key_t old_leaf : old_directory.leaves)
+        if (old_leaf >= directory.next_free_key)
+            written_keys.push_back(old_leaf), written_values.emplace_back();
+    written_keys.push_back(index_directory_key_k);
+    written_values.push_back(encode_index_directory(directory));
+    write_or_remove_entries(c.db, c.transaction, index, written_keys, written_values, c.options, arena, c.error);
+}
+
+void ukv_paths_index(ukv_paths_index_t* c_ptr) {
+
+    ukv_paths_index_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Indexing paths", c.error, [&] { index_paths(c, arena); });
+}
+
+/*********************************************************/
+/*****************	    Format Marker	  ****************/
+/*********************************************************/
+
+/**
+ * @brief Checks, that the paths in every collection are laid out and hashed the way this version does.
+ * Collections without the marker are accepted only while empty, and get marked if `mark_empty` is set.
+ * Otherwise they come from older versions, where the paths may be in other buckets, so instead of
+ * reporting misses, the caller is asked to `ukv_paths_migrate()` them.
+ */
+void validate_paths_format( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    strided_iterator_gt<ukv_collection_t const> collections,
+    std::size_t const tasks_count,
+    ukv_options_t const c_options,
+    bool const mark_empty,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error) {
+
+    if (!tasks_count)
+        return;
+    std::size_t const collections_count = collections ? tasks_count : 1u;
+    auto unique_collections = arena.alloc<ukv_collection_t>(collections_count, c_error);
+    return_if_error_m(c_error);
+    for (std::size_t i = 0; i != collections_count; ++i)
+        unique_collections[i] = collections ? collections[i] : ukv_collection_main_k;
+    std::size_t const unique_count = sort_and_deduplicate(unique_collections.begin(), unique_collections.end());
+
+    // The marker doesn't change with regular writes, so it isn't watched in transactions
+    auto const options = ukv_options_t((c_options & ~ukv_option_read_dont_copy_k) |
+                                       ukv_option_transaction_dont_watch_k | ukv_option_dont_discard_memory_k);
+    ukv_length_t* found_offsets = nullptr;
+    ukv_length_t* found_lengths = nullptr;
+    ukv_byte_t* found_values = nullptr;
+    ukv_read_t read {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = options,
+        .tasks_count = static_cast<ukv_size_t>(unique_count),
+        .collections = unique_collections.begin(),
+        .collections_stride = sizeof(ukv_collection_t),
+        .keys = &paths_format_key_k,
+        .keys_stride = 0,
+        .offsets = &found_offsets,
+        .lengths = &found_lengths,
+        .values = &found_values,
+    };
+    ukv_read(&read);
+    return_if_error_m(c_error);
+
+    paths_format_t const expected_format;
+    std::size_t unmarked_count = 0;
+    for (std::size_t i = 0; i != unique_count; ++i) {
+        ukv_length_t const length = found_lengths[i];
+        if (length == ukv_length_missing_k) {
+            unique_collections[unmarked_count++] = unique_collections[i];
+            continue;
+        }
+        bool const matches = length == sizeof(paths_format_t) &&
+                             std::memcmp(found_values + found_offsets[i], &expected_format, sizeof(paths_format_t)) == 0;
+        return_error_if_m(matches,
+                          c_error,
+                          consistency_k,
+                          "Paths were written by another version, call ukv_paths_migrate()");
+    }
+    if (!unmarked_count)
+        return;
+
+    // Unmarked collections must be empty
+    ukv_key_t const start_key = std::numeric_limits<ukv_key_t>::min();
+    ukv_length_t const count_limit = 1;
+    ukv_length_t* found_counts = nullptr;
+    ukv_key_t* found_keys = nullptr;
+    ukv_scan_t scan {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = options,
+        .tasks_count = static_cast<ukv_size_t>(unmarked_count),
+        .collections = unique_collections.begin(),
+        .collections_stride = sizeof(ukv_collection_t),
+        .start_keys = &start_key,
+        .start_keys_stride = 0,
+        .count_limits = &count_limit,
+        .count_limits_stride = 0,
+        .counts = &found_counts,
+        .keys = &found_keys,
+    };
+    ukv_scan(&scan);
+    return_if_error_m(c_error);
+    for (std::size_t i = 0; i != unmarked_count; ++i)
+        return_error_if_m(!found_counts[i],
+                          c_error,
+                          consistency_k,
+                          "Paths collection needs migration, call ukv_paths_migrate()");
+    if (!mark_empty)
+        return;
+
+    value_view_t const marker {reinterpret_cast<byte_t const*>(&expected_format), sizeof(paths_format_t)};
+    ukv_write_t write {
+        .db = c_db,
+        .error = c_error,
+        .transaction = c_transaction,
+        .arena = arena,
+        .options = ukv_options_t(c_options & ~ukv_option_read_dont_copy_k),
+        .tasks_count = static_cast<ukv_size_t>(unmarked_count),
+        .collections = unique_collections.begin(),
+        .collections_stride = sizeof(ukv_collection_t),
+        .keys = &paths_format_key_k,
+        .keys_stride = 0,
+        .lengths = marker.member_length(),
+        .lengths_stride = 0,
+        .values = marker.member_ptr(),
+        .values_stride = 0,
+    };
+    ukv_write(&write);
 }
 
 void ukv_paths_write(ukv_paths_write_t* c_ptr) {
@@ -250,6 +1001,10 @@ void ukv_paths_write(ukv_paths_write_t* c_ptr) {
     linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
     return_if_error_m(c.error);
 
+    strided_iterator_gt<ukv_collection_t const> collections {c.collections, c.collections_stride};
+    validate_paths_format(c.db, c.transaction, collections, c.tasks_count, c.options, true, arena, c.error);
+    return_if_error_m(c.error);
+
     contents_arg_t keys_str_args;
     keys_str_args.offsets_begin = {c.paths_offsets, c.paths_offsets_stride};
     keys_str_args.lengths_begin = {c.paths_lengths, c.paths_lengths_stride};
@@ -261,7 +1016,6 @@ void ukv_paths_write(ukv_paths_write_t* c_ptr) {
 
     // Parse and hash input string unique_col_keys
     hash_t hash;
-    strided_iterator_gt<ukv_collection_t const> collections {c.collections, c.collections_stride};
     for (std::size_t i = 0; i != c.tasks_count; ++i)
         unique_col_keys[i] = {collections ? collections[i] : ukv_collection_main_k, hash(keys_str_args[i])};
 
@@ -311,21 +1065,46 @@ void ukv_paths_write(ukv_paths_write_t* c_ptr) {
     strided_iterator_gt<ukv_bytes_cptr_t const> vals {c.values_bytes, c.values_bytes_stride};
     contents_arg_t contents {presences, offs, lens, vals, c.tasks_count};
 
-    // Update every unique bucket
+    // Gather the old members and the updates of every bucket, so that each bucket
+    // is re-encoded once, no matter how many of its paths are updated.
+    std::size_t entries_count = c.tasks_count;
+    for (value_view_t bucket : updated_buckets)
+        entries_count += get_bucket_size(bucket);
+    auto updates = arena.alloc<bucket_update_t>(entries_count, c.error);
+    return_if_error_m(c.error);
+
+    std::size_t updates_count = 0;
+    for (std::size_t bucket_idx = 0; bucket_idx != unique_places.count; ++bucket_idx)
+        for_each_in_bucket(updated_buckets[bucket_idx], [&](bucket_member_t const& member) {
+            updates[updates_count++] = {bucket_idx, 0, {member.key, member.value}};
+        });
     for (std::size_t i = 0; i != c.tasks_count; ++i) {
         std::string_view key_str = keys_str_args[i];
-        ukv_key_t key = hash(key_str);
-        value_view_t new_val = contents[i];
-        collection_key_t collection_key {collections ? collections[i] : ukv_collection_main_k, key};
+        collection_key_t collection_key {collections ? collections[i] : ukv_collection_main_k, hash(key_str)};
         auto bucket_idx = offset_in_sorted(unique_col_keys, collection_key);
-        value_view_t& bucket = updated_buckets[bucket_idx];
+        updates[updates_count++] = {bucket_idx, i + 1, {key_str, contents[i]}};
+    }
+    std::sort(updates.begin(), updates.end());
 
-        if (new_val) {
-            upsert_in_bucket(bucket, key_str, new_val, arena, c.error);
-            return_if_error_m(c.error);
+    // Only the last update of every path survives, and the removed paths are dropped
+    auto entries = arena.alloc<bucket_entry_t>(entries_count, c.error);
+    return_if_error_m(c.error);
+    for (std::size_t run_begin = 0; run_begin != updates_count;) {
+        std::size_t const bucket_idx = updates[run_begin].bucket_idx;
+        std::size_t run_end = run_begin;
+        std::size_t bucket_entries_count = 0;
+        for (; run_end != updates_count && updates[run_end].bucket_idx == bucket_idx; ++run_end) {
+            bool const is_last = run_end + 1 == updates_count ||
+                                 updates[run_end + 1].bucket_idx != bucket_idx ||
+                                 updates[run_end + 1].entry.key != updates[run_end].entry.key;
+            if (is_last && updates[run_end].entry.value)
+                entries[bucket_entries_count++] = updates[run_end].entry;
         }
-        else
-            remove_from_bucket(bucket, key_str);
+        auto bucket_entries = entries.begin();
+        updated_buckets[bucket_idx] =
+            encode_bucket({bucket_entries, bucket_entries + bucket_entries_count}, arena, c.error);
+        return_if_error_m(c.error);
+        run_begin = run_end;
     }
 
     ukv_write_t write {
@@ -347,6 +1126,10 @@ void ukv_paths_write(ukv_paths_write_t* c_ptr) {
 
     // Once all is updated, we can safely write back
     ukv_write(&write);
+    return_if_error_m(c.error);
+    safe_section("Updating paths index", c.error, [&] {
+        update_paths_indexes(c, keys_str_args, contents, opts, arena);
+    });
 }
 
 void ukv_paths_read(ukv_paths_read_t* c_ptr) {
@@ -401,10 +1184,16 @@ void ukv_paths_read(ukv_paths_read_t* c_ptr) {
     // Some of the entries will contain more then one key-value pair in case of collisions.
     ukv_length_t exported_volume = 0;
     joined_blobs_t buckets {c.tasks_count, buckets_offsets, buckets_values};
-    auto presences =
-        arena.alloc_or_dummy(divide_round_up<std::size_t>(c.tasks_count, bits_in_byte_k), c.error, c.presences);
+    auto presences = arena.alloc_or_dummy(c.tasks_count, c.error, c.presences);
     auto lengths = arena.alloc_or_dummy(c.tasks_count, c.error, c.lengths);
-    auto offsets = arena.alloc_or_dummy(c.tasks_count, c.error, c.offsets);
+    auto offsets = arena.alloc_or_dummy(c.tasks_count + 1, c.error, c.offsets);
+    return_if_error_m(c.error);
+
+    // Large values are better left in the buckets, than compacted into a new tape,
+    // if the caller can handle the gaps between them.
+    bool const dont_copy = c.options & ukv_option_read_dont_copy_k;
+    ukv_length_t const buckets_volume = buckets_offsets ? buckets_offsets[c.tasks_count] : 0u;
+    bool has_misses = false;
 
     for (std::size_t i = 0; i != c.tasks_count; ++i) {
         std::string_view key_str = keys_str_args[i];
@@ -412,7 +1201,12 @@ void ukv_paths_read(ukv_paths_read_t* c_ptr) {
 
         // Now that we have found our match - clamp everything else.
         value_view_t val = find_in_bucket(bucket, key_str).value;
-        if (val) {
+        if (val && dont_copy) {
+            presences[i] = true;
+            offsets[i] = static_cast<ukv_length_t>(reinterpret_cast<ukv_byte_t const*>(val.data()) - buckets_values);
+            lengths[i] = static_cast<ukv_length_t>(val.size());
+        }
+        else if (val) {
             presences[i] = true;
             offsets[i] = exported_volume;
             lengths[i] = static_cast<ukv_length_t>(val.size());
@@ -423,87 +1217,250 @@ void ukv_paths_read(ukv_paths_read_t* c_ptr) {
         }
         else {
             presences[i] = false;
-            offsets[i] = exported_volume;
+            offsets[i] = dont_copy ? buckets_volume : exported_volume;
             lengths[i] = ukv_length_missing_k;
+            has_misses = true;
         }
     }
 
-    offsets[c.tasks_count] = exported_volume;
+    offsets[c.tasks_count] = dont_copy ? buckets_volume : exported_volume;
     if (c.values)
         *c.values = buckets_values;
+    if (!has_misses)
+        return;
+
+    // Collections of older versions can only cause misses, so the format is checked just then
+    strided_iterator_gt<ukv_collection_t const> collections {c.collections, c.collections_stride};
+    validate_paths_format(c.db, c.transaction, collections, c.tasks_count, c.options, false, arena, c.error);
 }
 
 /**
- * - Same collection
- * - One scan request
- * - May have previous results
+ * @brief Passes the paths, that satisfy the `predicate`, from buckets with keys in `[first_key, last_key]`
+ * to the `callback` with their positions, until it returns false. If the `previous_path` is given,
+ * the first bucket must be its own, and the paths up to it are skipped, as they were exported before.
+ * Similarly, the members of the first bucket before the `first_offset` are skipped.
  */
-template <typename predicate_at>
-void full_scan_collection_w_predicate( //
-    ukv_database_t c_db,
-    ukv_transaction_t c_transaction,
-    ukv_collection_t c_collection,
+template <typename predicate_at, typename callback_at>
+void scan_buckets_w_predicate( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    ukv_key_t const first_key,
+    std::size_t const first_offset,
+    ukv_key_t const last_key,
     std::string_view previous_path,
-    ukv_length_t c_count_limit,
-    ukv_options_t c_options,
-    ukv_length_t& paths_count,
-    growing_tape_t& paths,
+    ukv_length_t const read_ahead,
+    ukv_options_t const c_options,
     linked_memory_lock_t& arena,
     ukv_error_t* c_error,
-    predicate_at predicate) {
+    predicate_at&& predicate,
+    callback_at&& callback) {
 
-    hash_t hash;
     bool has_reached_previous = previous_path.empty();
-    ukv_key_t start_key = !previous_path.empty() ? hash(previous_path) : std::numeric_limits<ukv_key_t>::min();
-
-    paths_count = 0;
-    auto scan_in_bucket = [&](ukv_key_t, value_view_t bucket) noexcept {
+    bool should_continue = true;
+    auto scan_in_bucket = [&](ukv_key_t key, value_view_t bucket) noexcept {
+        if (key > last_key)
+            return false;
+        if (key == paths_format_key_k)
+            return true;
+        // Even if the previous path was removed, the results continue from the next bucket
+        has_reached_previous |= key != first_key;
         for_each_in_bucket(bucket, [&](bucket_member_t const& member) {
-            if (!predicate(member.key))
+            if (!should_continue || (key == first_key && member.idx < first_offset) || !predicate(member.key))
                 // Skip irrelevant entries
                 return;
-            if (member.key == previous_path) {
-                // We may have reached the boundary between old results and new ones
-                has_reached_previous = true;
-                return;
-            }
-            if (!has_reached_previous)
+            if (!has_reached_previous) {
                 // Skip the results we have already seen
+                has_reached_previous = member.key == previous_path;
                 return;
-            if (paths_count >= c_count_limit)
-                // We have more than we need
-                return;
-
-            // All the matches in this section should be exported
-            paths.push_back(member.key, c_error);
-            return_if_error_m(c_error);
-            paths.add_terminator(byte_t {0}, c_error);
-            return_if_error_m(c_error);
-            ++paths_count;
+            }
+            should_continue = callback(member.key, key, member.idx);
         });
-
-        return paths_count < c_count_limit;
+        return should_continue;
     };
 
     full_scan_collection(c_db,
                          c_transaction,
                          c_collection,
                          c_options,
-                         start_key,
-                         c_count_limit,
+                         first_key,
+                         read_ahead,
                          arena,
                          c_error,
                          scan_in_bucket);
 }
 
+/**
+ * @brief Exports up to `c_count_limit` paths, that satisfy the predicate, starting after the `previous_path`
+ * or at the `cursor`. If the limit is reached, the `cursor` is replaced with the position after
+ * the last exported path, so that the next page doesn't have to search for it.
+ * @param make_predicate Produces a separate predicate for every thread.
+ *
+ * With several threads, the key range after the `previous_path` is split into contiguous
+ * slices, scanned concurrently with separate arenas. As bucket keys are hashes, the slices
+ * are balanced. Every slice stops, once the preceding ones have found enough, and their
+ * results are concatenated in order, so the output and the pagination are the same,
+ * as with a single thread.
+ */
+template <typename make_predicate_at>
+void full_scan_collection_w_predicate( //
+    ukv_database_t const c_db,
+    ukv_transaction_t const c_transaction,
+    ukv_collection_t const c_collection,
+    std::string_view previous_path,
+    ukv_paths_cursor_t& cursor,
+    ukv_length_t const c_count_limit,
+    ukv_options_t const c_options,
+    std::size_t const threads_count,
+    ukv_length_t& paths_count,
+    growing_tape_t& paths,
+    linked_memory_lock_t& arena,
+    ukv_error_t* c_error,
+    make_predicate_at&& make_predicate) {
+
+    paths_count = 0;
+    if (!c_count_limit)
+        return;
+    return_error_if_m(!(cursor.flags & cursor_indexed_k), c_error, args_wrong_k, "Paths cursor needs an index");
+
+    hash_t hash;
+    bool const has_cursor = cursor.flags & cursor_started_k;
+    ukv_key_t const first_key = has_cursor               ? cursor.key
+                                : !previous_path.empty() ? hash(previous_path)
+                                                         : std::numeric_limits<ukv_key_t>::min();
+    std::size_t const first_offset = has_cursor ? cursor.offset : 0u;
+    ukv_key_t const last_key = std::numeric_limits<ukv_key_t>::max();
+    std::uint64_t const span = static_cast<std::uint64_t>(last_key) - static_cast<std::uint64_t>(first_key);
+    cursor = exhausted_cursor_k;
+
+    if (threads_count == 1 || span < threads_count) {
+        auto export_path = [&](std::string_view path, ukv_key_t key, std::size_t offset) noexcept {
+            paths.push_back(path, c_error);
+            if (*c_error)
+                return false;
+            paths.add_terminator(byte_t {0}, c_error);
+            if (*c_error)
+                return false;
+            if (++paths_count != c_count_limit)
+                return true;
+            cursor = cursor_after(key, offset);
+            return false;
+        };
+        scan_buckets_w_predicate(c_db,
+                                 c_transaction,
+                                 c_collection,
+                                 first_key,
+                                 first_offset,
+                                 last_key,
+                                 previous_path,
+                                 std::min(c_count_limit, buckets_read_ahead_k),
+                                 c_options,
+                                 arena,
+                                 c_error,
+                                 make_predicate(std::size_t(0)),
+                                 export_path);
+        return;
+    }
+
+    struct slice_paths_t {
+        ukv_length_t const* offsets = nullptr;
+        ukv_length_t const* lengths = nullptr;
+        byte_t const* contents = nullptr;
+        ukv_paths_cursor_t const* cursors = nullptr;
+    };
+    std::vector<arena_t> arenas;
+    arenas.reserve(threads_count);
+    for (std::size_t i = 0; i != threads_count; ++i)
+        arenas.emplace_back(c_db);
+    std::vector<ukv_error_t> errors(threads_count, nullptr);
+    std::vector<std::atomic<std::size_t>> counts(threads_count);
+    std::vector<slice_paths_t> found(threads_count);
+
+    auto slice_first_key = [&](std::size_t slice_idx) {
+        __uint128_t const offset = __uint128_t(span) * slice_idx / threads_count + (slice_idx != 0);
+        return static_cast<ukv_key_t>(static_cast<std::uint64_t>(first_key) + static_cast<std::uint64_t>(offset));
+    };
+    auto preceding_count = [&](std::size_t slice_idx) {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i != slice_idx; ++i)
+            count += counts[i].load(std::memory_order_relaxed);
+        return count;
+    };
+
+    auto scan_slice = [&](std::size_t slice_idx, std::size_t, std::size_t) noexcept {
+        ukv_error_t* error = &errors[slice_idx];
+        linked_memory_lock_t slice_arena = linked_memory(arenas[slice_idx].member_ptr(), c_options, error);
+        if (*error)
+            return;
+
+        growing_tape_t slice_paths(slice_arena);
+        uninitialized_array_gt<ukv_paths_cursor_t> slice_cursors(slice_arena);
+        std::size_t slice_count = 0;
+        auto export_path = [&](std::string_view path, ukv_key_t key, std::size_t offset) noexcept {
+            slice_paths.push_back(path, error);
+            if (*error)
+                return false;
+            slice_paths.add_terminator(byte_t {0}, error);
+            if (*error)
+                return false;
+            slice_cursors.push_back(cursor_after(key, offset), error);
+            if (*error)
+                return false;
+            counts[slice_idx].store(++slice_count, std::memory_order_relaxed);
+            return slice_count < c_count_limit && preceding_count(slice_idx) < c_count_limit;
+        };
+        bool const is_last = slice_idx + 1 == threads_count;
+        ukv_key_t const slice_last_key = is_last ? last_key : slice_first_key(slice_idx + 1) - 1;
+        scan_buckets_w_predicate(c_db,
+                                 nullptr,
+                                 c_collection,
+                                 slice_first_key(slice_idx),
+                                 slice_idx ? 0u : first_offset,
+                                 slice_last_key,
+                                 slice_idx ? std::string_view() : previous_path,
+                                 buckets_read_ahead_k,
+                                 ukv_options_t(c_options | ukv_option_dont_discard_memory_k),
+                                 slice_arena,
+                                 error,
+                                 make_predicate(slice_idx),
+                                 export_path);
+        found[slice_idx] = {
+            slice_paths.offsets().begin().get(),
+            slice_paths.lengths().begin().get(),
+            slice_paths.contents().begin().get(),
+            slice_cursors.begin(),
+        };
+    };
+    safe_section("Scanning paths", c_error, [&] { parallel_for_slices(threads_count, threads_count, scan_slice); });
+    return_if_error_m(c_error);
+
+    // Concatenate the results of slices in order
+    for (ukv_error_t error : errors)
+        return_error_if_m(!error, c_error, error_unknown_k, error);
+    for (std::size_t slice_idx = 0; slice_idx != threads_count; ++slice_idx) {
+        slice_paths_t const& slice = found[slice_idx];
+        std::size_t const slice_count = counts[slice_idx].load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i != slice_count && paths_count != c_count_limit; ++i) {
+            paths.push_back(value_view_t {slice.contents + slice.offsets[i], slice.lengths[i]}, c_error);
+            return_if_error_m(c_error);
+            paths.add_terminator(byte_t {0}, c_error);
+            return_if_error_m(c_error);
+            if (++paths_count == c_count_limit)
+                cursor = slice.cursors[i];
+        }
+    }
+}
+
 void full_scan_w_prefix( //
     ukv_database_t const c_db,
     ukv_transaction_t const c_transaction,
     ukv_collection_t c_collection,
     std::string_view prefix,
     std::string_view previous_path,
+    ukv_paths_cursor_t& cursor,
     ukv_length_t c_count_limit,
     ukv_options_t const c_options,
+    std::size_t const threads_count,
     ukv_length_t& count,
     growing_tape_t& paths,
     linked_memory_lock_t& arena,
@@ -514,13 +1471,144 @@ void full_scan_w_prefix( //
         c_transaction,
         c_collection,
         previous_path,
+        cursor,
         c_count_limit,
         c_options,
+        threads_count,
         count,
         paths,
         arena,
         c_error,
-        [=](std::string_view body) { return starts_with(body, prefix); });
+        [=](std::size_t) { return [=](std::string_view body) { return starts_with(body, prefix); }; });
+}
+
+/**
+ * @brief Finds the end of a RegEx character class, starting at `begin`.
+ * @return The offset of the closing bracket or `std::string_view::npos`.
+ */
+std::size_t skip_character_class(std::string_view pattern, std::size_t begin) noexcept {
+    std::size_t i = begin + 1;
+    if (i < pattern.size() && pattern[i] == '^')
+        ++i;
+    // A closing bracket right after the opening one is a member of the class
+    if (i < pattern.size() && pattern[i] == ']')
+        ++i;
+    for (; i < pattern.size(); ++i) {
+        if (pattern[i] == '\\')
+            ++i;
+        else if (pattern[i] == '[' && i + 1 < pattern.size() && pattern[i + 1] == ':') {
+            // POSIX classes, like "[:alpha:]", may contain closing brackets
+            i = pattern.find(":]", i + 2);
+            if (i == std::string_view::npos)
+                return i;
+            ++i;
+        }
+        else if (pattern[i] == ']')
+            return i;
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * @brief Extracts the longest literal, that every match of a RegEx `pattern` must contain.
+ * Paths without it are rejected with a cheap substring search, before running the RegEx engine.
+ *
+ * The analysis is conservative: groups, classes and escaped character types end literals,
+ * characters followed by optional quantifiers are dropped, and patterns with top-level
+ * alternations, inline options or unusual escapes yield nothing.
+ */
+std::string required_literal(std::string_view pattern) {
+    std::string longest, current;
+    auto flush = [&] {
+        if (current.size() > longest.size())
+            longest = current;
+        current.clear();
+    };
+    // The whole preceding character may be repeated zero times, including multi-byte UTF-8 ones
+    auto drop_optional = [&] {
+        while (!current.empty() && (static_cast<unsigned char>(current.back()) & 0xC0) == 0x80)
+            current.pop_back();
+        if (!current.empty())
+            current.pop_back();
+        flush();
+    };
+
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        char const c = pattern[i];
+        switch (c) {
+        case '|': return {};
+        case '.':
+        case '^':
+        case '$':
+        case '+': flush(); break;
+        case '*':
+        case '?': drop_optional(); break;
+        case '[':
+            i = skip_character_class(pattern, i);
+            if (i == std::string_view::npos)
+                return {};
+            flush();
+            break;
+        case '(': {
+            // Groups may hold their own alternations, and "(?" can enable case-insensitive matching
+            if (i + 1 < pattern.size() && pattern[i + 1] == '?')
+                return {};
+            std::size_t depth = 0;
+            for (; i < pattern.size(); ++i) {
+                if (pattern[i] == '\\')
+                    ++i;
+                else if (pattern[i] == '[')
+                    i = skip_character_class(pattern, i);
+                else if (pattern[i] == '(')
+                    ++depth;
+                else if (pattern[i] == ')' && --depth == 0)
+                    break;
+                if (i == std::string_view::npos)
+                    return {};
+            }
+            if (i >= pattern.size())
+                return {};
+            flush();
+            break;
+        }
+        case '{': {
+            // Only "{n}", "{n,}" and "{n,m}" are quantifiers, otherwise the brace is a literal
+            std::size_t digits_end = i + 1;
+            while (digits_end < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[digits_end])))
+                ++digits_end;
+            std::size_t const closing = pattern.find('}', i);
+            if (i + 1 < pattern.size() && pattern[i + 1] == ',')
+                return {};
+            if (digits_end == i + 1 || closing == std::string_view::npos ||
+                (pattern[digits_end] != '}' && pattern[digits_end] != ',')) {
+                current += c;
+                break;
+            }
+            bool const may_be_absent = pattern.find_first_not_of('0', i + 1) == digits_end;
+            may_be_absent ? drop_optional() : flush();
+            i = closing;
+            break;
+        }
+        case '\\': {
+            if (i + 1 == pattern.size())
+                return {};
+            char const escaped = pattern[++i];
+            if (!std::isalnum(static_cast<unsigned char>(escaped))) {
+                current += escaped;
+                break;
+            }
+            // Single-token escapes, like "\d" or "\b", just end the literal
+            constexpr std::string_view single_token_escapes_k = "dDwWsShHvVbBRXAzZGKntrfea";
+            if (single_token_escapes_k.find(escaped) == std::string_view::npos)
+                return {};
+            flush();
+            break;
+        }
+        default: current += c; break;
+        }
+    }
+    flush();
+    return longest;
 }
 
 struct pcre2_ctx_t {
@@ -543,8 +1631,10 @@ void full_scan_w_regex( //
     ukv_collection_t c_collection,
     std::string_view pattern,
     std::string_view previous_path,
+    ukv_paths_cursor_t& cursor,
     ukv_length_t c_count_limit,
     ukv_options_t const c_options,
+    std::size_t const threads_count,
     ukv_length_t& count,
     growing_tape_t& paths,
     linked_memory_lock_t& arena,
@@ -564,44 +1654,55 @@ void full_scan_w_regex( //
         &pcre2_pattern_error_code,
         &pcre2_pattern_error_offset,
         pcre2_compile_context);
+    if (!pcre2_code)
+        *c_error = "Failed to compile the RegEx query";
 
     // https://www.pcre.org/current/doc/html/pcre2_jit_compile.html
-    auto jit_status = pcre2_jit_compile(pcre2_code, PCRE2_JIT_COMPLETE);
-    if (jit_status != 0)
+    if (!*c_error && pcre2_jit_compile(pcre2_code, PCRE2_JIT_COMPLETE) != 0)
         *c_error = "Failed to JIT-compile the RegEx query";
 
-    pcre2_match_data* match_data = pcre2_match_data_create_from_pattern(pcre2_code, pcre2_context);
-    if (!match_data)
-        *c_error = "Failed to allocate memory for RegEx pattern matches";
+    // Every thread needs its own match data, while the compiled pattern is shared
+    std::vector<pcre2_match_data*> matches_data(threads_count, nullptr);
+    for (std::size_t i = 0; i != threads_count && !*c_error; ++i) {
+        matches_data[i] = pcre2_match_data_create_from_pattern(pcre2_code, pcre2_context);
+        if (!matches_data[i])
+            *c_error = "Failed to allocate memory for RegEx pattern matches";
+    }
 
+    std::string const literal = required_literal(pattern);
     if (!*c_error)
         full_scan_collection_w_predicate( //
             c_db,
             c_transaction,
             c_collection,
             previous_path,
+            cursor,
             c_count_limit,
             c_options,
+            threads_count,
             count,
             paths,
             arena,
             c_error,
-            [=](std::string_view body) {
-                // https://www.pcre.org/current/doc/html/pcre2_jit_match.html
-                // pcre2_match_data match_data;
-                // pcre2_match_context match_context;
-                auto found_matches = pcre2_jit_match( //
-                    pcre2_code,
-                    PCRE2_SPTR(body.data()),
-                    PCRE2_SIZE(body.size()),
-                    PCRE2_SIZE(0), // start offset
-                    PCRE2_NO_UTF_CHECK,
-                    match_data,
-                    NULL);
-                return found_matches > 0;
+            [&](std::size_t thread_idx) {
+                return [&, match_data = matches_data[thread_idx]](std::string_view body) {
+                    if (!contains_substring(body, literal))
+                        return false;
+                    // https://www.pcre.org/current/doc/html/pcre2_jit_match.html
+                    auto found_matches = pcre2_jit_match( //
+                        pcre2_code,
+                        PCRE2_SPTR(body.data()),
+                        PCRE2_SIZE(body.size()),
+                        PCRE2_SIZE(0), // start offset
+                        PCRE2_NO_UTF_CHECK,
+                        match_data,
+                        NULL);
+                    return found_matches > 0;
+                };
             });
 
-    pcre2_match_data_free(match_data);
+    for (pcre2_match_data* match_data : matches_data)
+        pcre2_match_data_free(match_data);
     pcre2_code_free(pcre2_code);
     pcre2_compile_context_free(pcre2_compile_context);
     pcre2_general_context_free(pcre2_context);
@@ -613,6 +1714,19 @@ void ukv_paths_match(ukv_paths_match_t* c_ptr) {
     linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
     return_if_error_m(c.error);
 
+    // Scans don't depend on hashing, unless they resume after the bucket of the previous path
+    if (!c.cursors && c.previous) {
+        validate_paths_format(c.db,
+                              c.transaction,
+                              {c.collections, c.collections_stride},
+                              c.tasks_count,
+                              c.options,
+                              false,
+                              arena,
+                              c.error);
+        return_if_error_m(c.error);
+    }
+
     contents_arg_t patterns_args;
     patterns_args.offsets_begin = {c.patterns_offsets, c.patterns_offsets_stride};
     patterns_args.lengths_begin = {c.patterns_lengths, c.patterns_lengths_stride};
@@ -629,29 +1743,71 @@ void ukv_paths_match(ukv_paths_match_t* c_ptr) {
     strided_range_gt<ukv_length_t const> count_limits {{c.match_counts_limits, c.match_counts_limits_stride},
                                                        c.tasks_count};
 
+    strided_iterator_gt<ukv_paths_cursor_t const> cursors {c.cursors, c.cursors_stride};
+
     auto count_limits_sum = transform_reduce_n(count_limits.begin(), c.tasks_count, 0ul);
     auto found_counts = arena.alloc<ukv_length_t>(c.tasks_count, c.error);
     auto found_paths = growing_tape_t(arena);
     found_paths.reserve(count_limits_sum, c.error);
     return_if_error_m(c.error);
+    auto next_cursors = arena.alloc_or_dummy(c.tasks_count, c.error, c.cursors_next);
+    return_if_error_m(c.error);
+    auto exhausted = arena.alloc_or_dummy(c.tasks_count, c.error, c.cursors_exhausted);
+    return_if_error_m(c.error);
+
+    // Transactions may not be shared between threads
+    // Threads only pay off for large scans, so they are opt-in
+    std::size_t threads_count = std::max<std::size_t>(c.threads_count, 1u);
+    if (c.transaction)
+        threads_count = 1;
+
+    // Prefix matches in ordered collections don't need full scans
+    ukv_collection_t last_collection = ukv_collection_main_k;
+    ukv_collection_t last_index = ukv_collection_main_k;
+    bool has_last_index = false;
 
     for (std::size_t i = 0; i != c.tasks_count && !*c.error; ++i) {
         auto col = collections ? collections[i] : ukv_collection_main_k;
         auto pattern = patterns_args[i];
-        auto previous = previous_args[i];
+        auto previous = cursors ? std::string_view() : std::string_view(previous_args[i]);
         auto limit = count_limits[i];
+        ukv_paths_cursor_t cursor = cursors ? cursors[i] : ukv_paths_cursor_t {};
+        if (cursor.flags & cursor_exhausted_k) {
+            found_counts[i] = 0;
+            next_cursors[i] = cursor;
+            exhausted[i] = true;
+            continue;
+        }
+
+        // Cursors of full scans are resumed with full scans, even if an index was built since
         auto func = is_prefix(pattern) ? &full_scan_w_prefix : &full_scan_w_regex;
+        auto target = col;
+        bool const may_use_index = !(cursor.flags & cursor_started_k) || (cursor.flags & cursor_indexed_k);
+        if (ukv_supports_named_collections_k && func == &full_scan_w_prefix && may_use_index) {
+            if (!has_last_index || col != last_collection) {
+                last_index = paths_index_collection(c.db, col, false, arena, c.error);
+                return_if_error_m(c.error);
+                last_collection = col;
+                has_last_index = true;
+            }
+            if (last_index != ukv_collection_main_k)
+                func = &index_scan_w_prefix, target = last_index;
+        }
         func(c.db,
              c.transaction,
-             col,
+             target,
              pattern,
              previous,
+             cursor,
              limit,
              c.options,
+             threads_count,
              found_counts[i],
              found_paths,
              arena,
              c.error);
+        next_cursors[i] = cursor;
+        exhausted[i] = cursor.flags & cursor_exhausted_k;
     }
 
     // Export the results
@@ -661,4 +1817,186 @@ void ukv_paths_match(ukv_paths_match_t* c_ptr) {
         *c.paths_offsets = found_paths.offsets().begin().get();
     if (c.paths_strings)
         *c.paths_strings = (ukv_char_t*)found_paths.contents().begin().get();
-}
\ No newline at end of file
+}
+/*********************************************************/
+/*****************	      Migration	      ****************/
+/*********************************************************/
+
+/**
+ * @brief Finds the paths, that were hashed by an older function, and moves them.
+ * Buckets keep the full paths, so such entries are found by hashing them again.
+ *
+ * The collection is migrated in chunks of up to `buckets_read_ahead_k` outdated buckets.
+ * For every chunk, the collection is marked with the current format, the paths are written
+ * into their new buckets, which also keeps the ordered index up to date, and only then they
+ * are removed from the outdated buckets. If interrupted in between, the paths are left in
+ * both places, and the next migration just removes the outdated copies, as the paths,
+ * that are already present in their new buckets, are never overwritten.
+ */
+void migrate_paths(ukv_paths_migrate_t& c, linked_memory_lock_t& arena) {
+
+    auto const options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k);
+    hash_t hash;
+    bool is_marked = false;
+    std::size_t moved_count = 0;
+    std::vector<ukv_key_t> outdated_keys;
+    std::vector<std::string> moved_paths;
+    std::vector<std::string> moved_values;
+    std::vector<ukv_str_view_t> paths;
+    std::vector<ukv_length_t> paths_lengths;
+    std::vector<ukv_bytes_cptr_t> values;
+    std::vector<ukv_length_t> values_lengths;
+    std::vector<bucket_entry_t> remaining;
+
+    auto move_outdated = [&]() {
+        if (!is_marked) {
+            paths_format_t const format;
+            std::vector<std::string> marker {std::string(reinterpret_cast<char const*>(&format), sizeof(format))};
+            write_or_remove_entries(c.db, c.transaction, c.collection, {paths_format_key_k}, marker, options, arena, c.error);
+            return_if_error_m(c.error);
+            is_marked = true;
+        }
+        if (outdated_keys.empty())
+            return;
+
+        paths.resize(moved_paths.size());
+        paths_lengths.resize(moved_paths.size());
+        for (std::size_t i = 0; i != moved_paths.size(); ++i) {
+            paths[i] = moved_paths[i].data();
+            paths_lengths[i] = static_cast<ukv_length_t>(moved_paths[i].size());
+        }
+
+        // After an interrupted migration, the new copies of paths may have been updated since
+        ukv_octet_t* found_presences = nullptr;
+        ukv_paths_read_t paths_read {
+            .db = c.db,
+            .error = c.error,
+            .transaction = c.transaction,
+            .arena = arena,
+            .options = options,
+            .tasks_count = static_cast<ukv_size_t>(paths.size()),
+            .collections = &c.collection,
+            .paths = paths.data(),
+            .paths_stride = sizeof(ukv_str_view_t),
+            .paths_lengths = paths_lengths.data(),
+            .paths_lengths_stride = sizeof(ukv_length_t),
+            .presences = &found_presences,
+        };
+        ukv_paths_read(&paths_read);
+        return_if_error_m(c.error);
+
+        bits_view_t presences {found_presences};
+        std::size_t missing_count = 0;
+        values.resize(moved_values.size());
+        values_lengths.resize(moved_values.size());
+        for (std::size_t i = 0; i != moved_paths.size(); ++i) {
+            if (presences[i])
+                continue;
+            paths[missing_count] = moved_paths[i].data();
+            paths_lengths[missing_count] = static_cast<ukv_length_t>(moved_paths[i].size());
+            values[missing_count] = reinterpret_cast<ukv_bytes_cptr_t>(moved_values[i].data());
+            values_lengths[missing_count] = static_cast<ukv_length_t>(moved_values[i].size());
+            ++missing_count;
+        }
+        ukv_paths_write_t paths_write {
+            .db = c.db,
+            .error = c.error,
+            .transaction = c.transaction,
+            .arena = arena,
+            .options = options,
+            .tasks_count = static_cast<ukv_size_t>(missing_count),
+            .collections = &c.collection,
+            .paths = paths.data(),
+            .paths_stride = sizeof(ukv_str_view_t),
+            .paths_lengths = paths_lengths.data(),
+            .paths_lengths_stride = sizeof(ukv_length_t),
+            .values_lengths = values_lengths.data(),
+            .values_lengths_stride = sizeof(ukv_length_t),
+            .values_bytes = values.data(),
+            .values_bytes_stride = sizeof(ukv_bytes_cptr_t),
+        };
+        if (missing_count)
+            ukv_paths_write(&paths_write);
+        return_if_error_m(c.error);
+
+        // The outdated buckets are fetched again, as the moved paths may have landed in them
+        joined_blobs_t outdated_buckets = read_index_entries(c.db,
+                                                             c.transaction,
+                                                             c.collection,
+                                                             outdated_keys.data(),
+                                                             outdated_keys.size(),
+                                                             options,
+                                                             arena,
+                                                             c.error);
+        return_if_error_m(c.error);
+        std::vector<std::string> cleaned_buckets(outdated_keys.size());
+        for (std::size_t i = 0; i != outdated_keys.size(); ++i) {
+            ukv_key_t const key = outdated_keys[i];
+            remaining.clear();
+            for_each_in_bucket(outdated_buckets[i], [&](bucket_member_t const& member) {
+                if (hash(member.key) == key)
+                    remaining.push_back({member.key, member.value});
+            });
+            value_view_t cleaned = encode_bucket({remaining.data(), remaining.data() + remaining.size()}, arena, c.error);
+            return_if_error_m(c.error);
+            if (cleaned)
+                cleaned_buckets[i] = std::string(reinterpret_cast<char const*>(cleaned.data()), cleaned.size());
+        }
+        write_or_remove_entries(c.db,
+                                c.transaction,
+                                c.collection,
+                                outdated_keys,
+                                cleaned_buckets,
+                                options,
+                                arena,
+                                c.error);
+        return_if_error_m(c.error);
+
+        outdated_keys.clear();
+        moved_paths.clear();
+        moved_values.clear();
+    };
+
+    auto collect_outdated = [&](ukv_key_t key, value_view_t bucket) {
+        if (key == paths_format_key_k)
+            return true;
+        std::size_t const moved_before = moved_paths.size();
+        for_each_in_bucket(bucket, [&](bucket_member_t const& member) {
+            if (hash(member.key) == key)
+                return;
+            moved_paths.emplace_back(member.key);
+            moved_values.emplace_back(std::string_view(member.value));
+        });
+        if (moved_paths.size() == moved_before)
+            return true;
+
+        moved_count += moved_paths.size() - moved_before;
+        outdated_keys.push_back(key);
+        if (outdated_keys.size() == buckets_read_ahead_k)
+            move_outdated();
+        return !*c.error;
+    };
+    full_scan_collection(c.db,
+                         c.transaction,
+                         c.collection,
+                         c.options,
+                         std::numeric_limits<ukv_key_t>::min(),
+                         buckets_read_ahead_k,
+                         arena,
+                         c.error,
+                         collect_outdated);
+    return_if_error_m(c.error);
+    move_outdated();
+    return_if_error_m(c.error);
+
+    if (c.moved_count)
+        *c.moved_count = static_cast<ukv_size_t>(moved_count);
+}
+
+void ukv_paths_migrate(ukv_paths_migrate_t* c_ptr) {
+
+    ukv_paths_migrate_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    safe_section("Migrating paths", c.error, [&] { migrate_paths(c, arena); });
+}
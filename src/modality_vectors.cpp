@@ -6,19 +6,35 @@
  * Sits on top of any @see "ukv.h"-compatible system.
  *
  * Internally quantizes often f32/f16 vectors into i8 representations,
- * later constructing a Navigable Small World Graph on those vectors.
+ * kept under the same keys in a companion collection, so that search
+ * only scans the compact copies in key order. Engines without named
+ * collections store them in the same collection under negated keys.
+ * Later we may construct a Navigable Small World Graph on those vectors.
  * During search relies on an algorithm resembling A*, adding a
  * stochastic component.
+ *
+ * Once a Product-Quantization codebook is trained for a collection,
+ * the i8 copies are replaced with 4-bit PQ codes in a companion collection.
+ * Search then scans only the codes, scoring them against per-query lookup
+ * tables, and re-ranks the best candidates against the original vectors.
  */
-#include <cmath> // `std::sqrt`
+#include <cmath>   // `std::sqrt`
+#include <cstring> // `std::memcpy`
+#include <random>  // `std::mt19937`
+
+#if defined(__AVX2__)
+#include <immintrin.h> // `_mm256_shuffle_epi8`
+#endif
 
 #include "ukv/vectors.h"
+#include "ukv/docs.h"             // `ukv_docs_gather`
 #include "ukv/cpp/ranges_args.hpp" // `places_arg_t`
 
 #include "helpers/linked_memory.hpp"          // `linked_memory_lock_t`
 #include "helpers/algorithm.hpp"              // `transform_n`
 #include "helpers/full_scan.hpp"              // `full_scan_collection`
 #include "helpers/limited_priority_queue.hpp" // `limited_priority_queue_gt`
+#include "helpers/companion.hpp"              // `companion_collection`
 
 /*********************************************************/
 /*****************	 C++ Implementation	  ****************/
@@ -44,6 +60,25 @@ using pq_t = limited_priority_queue_gt<match_t, lower_similarity_t>;
 
 static constexpr quant_t float_scaling_k = 100;
 static constexpr quant_product_t product_scaling_k = float_scaling_k * float_scaling_k;
+static constexpr ukv_length_t scan_read_ahead_k = 1024;
+/// Exported matrices are aligned to cache lines, which suffices for AVX-512 loads.
+static constexpr std::size_t matrix_alignment_k = 64;
+
+/// Every PQ subspace is clustered into 16 centroids, so each code fits into 4 bits.
+static constexpr std::size_t pq_centroids_k = 16;
+/// Number of candidates scored at once by the ADC kernel.
+static constexpr std::size_t pq_block_k = 32;
+/// Keeps the sum of byte-quantized distances within `std::uint16_t`.
+static constexpr ukv_length_t pq_subspaces_max_k = 256;
+static constexpr ukv_length_t pq_subspaces_default_k = 64;
+static constexpr ukv_length_t pq_samples_default_k = 4096;
+static constexpr ukv_length_t pq_iterations_default_k = 10;
+/// How many more candidates are shortlisted by ADC, than will be returned after re-ranking.
+static constexpr ukv_length_t pq_rerank_factor_k = 4;
+static constexpr ukv_key_t pq_codebook_key_k = 0;
+static constexpr ukv_str_view_t quants_suffix_k = "vectors.i8";
+static constexpr ukv_str_view_t pq_codes_suffix_k = "vectors.pq";
+static constexpr ukv_str_view_t pq_codebook_suffix_k = "vectors.codebook";
 
 template <typename number_at>
 number_at square(number_at n) noexcept {
@@ -101,6 +136,61 @@ struct entry_t {
     value_view_t value;
 };
 
+/**
+ * @brief Decodes an IEEE 754 half-precision number, including subnormals.
+ */
+inline real_t half_to_real(std::uint16_t half) noexcept {
+    std::uint32_t sign = std::uint32_t(half & 0x8000u) << 16;
+    std::uint32_t exponent = (half >> 10) & 0x1Fu;
+    std::uint32_t mantissa = half & 0x3FFu;
+    std::uint32_t bits = sign;
+    if (exponent == 0x1Fu)
+        bits |= 0x7F800000u | (mantissa << 13);
+    else if (exponent != 0)
+        bits |= ((exponent + 112u) << 23) | (mantissa << 13);
+    else if (mantissa != 0) {
+        exponent = 113u;
+        for (; !(mantissa & 0x400u); mantissa <<= 1)
+            --exponent;
+        bits |= (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+    real_t result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/**
+ * @brief Encodes an IEEE 754 half-precision number, rounding to the nearest even.
+ */
+inline std::uint16_t real_to_half(real_t real) noexcept {
+    std::uint32_t bits;
+    std::memcpy(&bits, &real, sizeof(bits));
+    std::uint32_t sign = (bits >> 16) & 0x8000u;
+    std::uint32_t raw_exponent = (bits >> 23) & 0xFFu;
+    std::uint32_t mantissa = bits & 0x7FFFFFu;
+    std::int32_t exponent = std::int32_t(raw_exponent) - 112;
+    if (raw_exponent == 0xFFu)
+        return std::uint16_t(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    if (exponent >= 0x1F)
+        return std::uint16_t(sign | 0x7C00u);
+    if (exponent <= 0) {
+        if (exponent < -10)
+            return std::uint16_t(sign);
+        mantissa |= 0x800000u;
+        std::uint32_t shift = std::uint32_t(14 - exponent);
+        std::uint32_t half = mantissa >> shift;
+        std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        std::uint32_t halfway = 1u << (shift - 1u);
+        half += remainder > halfway || (remainder == halfway && (half & 1u));
+        return std::uint16_t(sign | half);
+    }
+    // Rounding may carry into the exponent, which is still correct
+    std::uint32_t half = sign | (std::uint32_t(exponent) << 10) | (mantissa >> 13);
+    std::uint32_t remainder = mantissa & 0x1FFFu;
+    half += remainder > 0x1000u || (remainder == 0x1000u && (half & 1u));
+    return std::uint16_t(half);
+}
+
 template <typename float_at = real_t>
 void quantize(float_at const* originals, std::size_t dims, quant_t* quants) noexcept {
     for (std::size_t i = 0; i != dims; ++i)
@@ -111,11 +201,75 @@ void quantize(byte_t const* bytes, ukv_vector_scalar_t scalar_type, std::size_t
     switch (scalar_type) {
     case ukv_vector_scalar_f32_k: return quantize((real_t const*)bytes, dims, quants);
     case ukv_vector_scalar_f64_k: return quantize((double const*)bytes, dims, quants);
-    case ukv_vector_scalar_f16_k: return quantize((std::int16_t const*)bytes, dims, quants);
     case ukv_vector_scalar_i8_k: return quantize((quant_t const*)bytes, dims, quants);
+    case ukv_vector_scalar_f16_k:
+        for (std::size_t i = 0; i != dims; ++i)
+            quants[i] = static_cast<quant_t>(half_to_real(((std::uint16_t const*)bytes)[i]) * float_scaling_k);
+        return;
+    }
+}
+
+template <typename scalar_at>
+void cast(scalar_at const* originals, std::size_t dims, real_t* reals) noexcept {
+    for (std::size_t i = 0; i != dims; ++i)
+        reals[i] = static_cast<real_t>(originals[i]);
+}
+
+void cast(byte_t const* bytes, ukv_vector_scalar_t scalar_type, std::size_t dims, real_t* reals) noexcept {
+    switch (scalar_type) {
+    case ukv_vector_scalar_f32_k: return cast((real_t const*)bytes, dims, reals);
+    case ukv_vector_scalar_f64_k: return cast((double const*)bytes, dims, reals);
+    case ukv_vector_scalar_i8_k: return cast((quant_t const*)bytes, dims, reals);
+    case ukv_vector_scalar_f16_k:
+        for (std::size_t i = 0; i != dims; ++i)
+            reals[i] = half_to_real(((std::uint16_t const*)bytes)[i]);
+        return;
+    }
+}
+
+/**
+ * @brief Exports `reals` in the requested `scalar_type`.
+ * Just like the copies we store, requested i8 vectors are quantized.
+ */
+void export_reals(real_t const* reals, std::size_t dims, ukv_vector_scalar_t scalar_type, byte_t* bytes) noexcept {
+    switch (scalar_type) {
+    case ukv_vector_scalar_f32_k: std::memcpy(bytes, reals, dims * sizeof(real_t)); return;
+    case ukv_vector_scalar_f64_k: std::copy_n(reals, dims, (double*)bytes); return;
+    case ukv_vector_scalar_i8_k: return quantize(reals, dims, (quant_t*)bytes);
+    case ukv_vector_scalar_f16_k: std::transform(reals, reals + dims, (std::uint16_t*)bytes, &real_to_half); return;
     }
 }
 
+void dequantize(quant_t const* quants, std::size_t dims, real_t* reals) noexcept {
+    for (std::size_t i = 0; i != dims; ++i)
+        reals[i] = real_t(quants[i]) / float_scaling_k;
+}
+
+void normalize(real_t* vector, std::size_t dims) noexcept {
+    real_t norm = 0;
+    for (std::size_t i = 0; i != dims; ++i)
+        norm += square(vector[i]);
+    if (norm == 0)
+        return;
+    norm = std::sqrt(norm);
+    for (std::size_t i = 0; i != dims; ++i)
+        vector[i] /= norm;
+}
+
+real_t distance_l2_squared(real_t const* a, real_t const* b, std::size_t dims) noexcept {
+    real_t sum = 0;
+    for (std::size_t i = 0; i != dims; ++i)
+        sum += square(a[i] - b[i]);
+    return sum;
+}
+
+real_t dot(real_t const* a, real_t const* b, std::size_t dims) noexcept {
+    real_t sum = 0;
+    for (std::size_t i = 0; i != dims; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
 real_t metric(quant_t const* a, quant_t const* b, std::size_t dims, ukv_vector_metric_t kind) noexcept {
     switch (kind) {
     case ukv_vector_metric_dot_k: return metric_dot_t {}(a, b, dims);
@@ -125,6 +279,43 @@ real_t metric(quant_t const* a, quant_t const* b, std::size_t dims, ukv_vector_m
     }
 }
 
+real_t metric(real_t const* a, real_t const* b, std::size_t dims, ukv_vector_metric_t kind) noexcept {
+    switch (kind) {
+    case ukv_vector_metric_dot_k: return dot(a, b, dims);
+    case ukv_vector_metric_cos_k: {
+        auto denominator = std::sqrt(dot(a, a, dims)) * std::sqrt(dot(b, b, dims));
+        return denominator != 0 ? dot(a, b, dims) / denominator : 0;
+    }
+    case ukv_vector_metric_l2_k: return std::sqrt(distance_l2_squared(a, b, dims));
+    default: return 0;
+    }
+}
+
+/**
+ * @brief Maps metrics to a "higher is better" scale and back, so the same
+ * priority queue keeps the closest matches for distances and similarities.
+ */
+ukv_float_t similarity(real_t metric, ukv_vector_metric_t kind) noexcept {
+    return kind == ukv_vector_metric_l2_k ? -metric : metric;
+}
+
+/**
+ * @brief Infers the scalar type of a stored vector from its length,
+ * as every supported type has a different size.
+ * @return false If the length doesn't match any type.
+ */
+bool scalar_type_of(ukv_length_t length, std::size_t dims, ukv_vector_scalar_t& scalar_type) noexcept {
+    if (!dims || length % dims)
+        return false;
+    switch (length / dims) {
+    case sizeof(real_t): scalar_type = ukv_vector_scalar_f32_k; return true;
+    case sizeof(double): scalar_type = ukv_vector_scalar_f64_k; return true;
+    case sizeof(std::uint16_t): scalar_type = ukv_vector_scalar_f16_k; return true;
+    case sizeof(quant_t): scalar_type = ukv_vector_scalar_i8_k; return true;
+    default: return false;
+    }
+}
+
 ukv_length_t size_bytes(ukv_vector_scalar_t scalar_type) noexcept {
     switch (scalar_type) {
     case ukv_vector_scalar_f32_k: return sizeof(real_t);
@@ -135,6 +326,400 @@ ukv_length_t size_bytes(ukv_vector_scalar_t scalar_type) noexcept {
     }
 }
 
+#pragma region Product Quantization
+
+struct pq_header_t {
+    std::uint32_t dimensions = 0;
+    std::uint32_t subspaces = 0;
+    std::uint32_t metric = 0;
+    std::uint32_t reserved = 0;
+};
+
+std::size_t nearest_centroid(real_t const* point, real_t const* centroids, std::size_t dims) noexcept {
+    std::size_t best = 0;
+    real_t best_distance = distance_l2_squared(point, centroids, dims);
+    for (std::size_t j = 1; j != pq_centroids_k; ++j) {
+        real_t distance = distance_l2_squared(point, centroids + j * dims, dims);
+        if (distance < best_distance)
+            best = j, best_distance = distance;
+    }
+    return best;
+}
+
+/**
+ * @brief Product-Quantization codebook of a collection, with 16 centroids for every
+ * subspace, and the handle of the companion collection with the codes.
+ */
+struct pq_index_t {
+    ukv_collection_t codes = ukv_collection_main_k;
+    pq_header_t header;
+    real_t const* centroids = nullptr;
+
+    explicit operator bool() const noexcept { return centroids; }
+    std::size_t dimensions() const noexcept { return header.dimensions; }
+    std::size_t subspaces() const noexcept { return header.subspaces; }
+    std::size_t subspace_dims() const noexcept { return header.dimensions / header.subspaces; }
+    ukv_length_t code_bytes() const noexcept { return divide_round_up<ukv_length_t>(header.subspaces, 2); }
+    bool normalizes() const noexcept { return header.metric == ukv_vector_metric_cos_k; }
+
+    real_t const* centroid(std::size_t subspace, std::size_t code) const noexcept {
+        return centroids + (subspace * pq_centroids_k + code) * subspace_dims();
+    }
+
+    static std::uint8_t code(std::uint8_t const* codes, std::size_t subspace) noexcept {
+        return (codes[subspace / 2] >> ((subspace % 2) * 4)) & 0x0F;
+    }
+
+    /**
+     * @brief Reconstructs the approximate vector from its codes.
+     */
+    void decode(std::uint8_t const* codes, real_t* vector) const noexcept {
+        auto const slice = subspace_dims();
+        for (std::size_t m = 0; m != subspaces(); ++m)
+            std::copy_n(centroid(m, code(codes, m)), slice, vector + m * slice);
+    }
+
+    /**
+     * @brief Packs two 4-bit codes per byte. Will normalize the `vector` inplace,
+     * if the codebook was trained for the Cosine metric.
+     */
+    void encode(real_t* vector, std::uint8_t* codes) const noexcept {
+        if (normalizes())
+            normalize(vector, dimensions());
+        std::memset(codes, 0, code_bytes());
+        auto const slice = subspace_dims();
+        for (std::size_t m = 0; m != subspaces(); ++m) {
+            auto best = nearest_centroid(vector + m * slice, centroid(m, 0), slice);
+            codes[m / 2] |= static_cast<std::uint8_t>(best << ((m % 2) * 4));
+        }
+    }
+};
+
+/**
+ * @brief Fetches the codebook of a `collection`, if one was trained.
+ * @return Empty index if the collection isn't product-quantized.
+ */
+pq_index_t pq_index(ukv_database_t db,
+                    ukv_transaction_t transaction,
+                    ukv_collection_t collection,
+                    ukv_options_t options,
+                    linked_memory_lock_t& arena,
+                    ukv_error_t* c_error) noexcept {
+
+    pq_index_t index;
+    auto codebooks = companion_collection(db, collection, pq_codebook_suffix_k, false, arena, c_error);
+    if (*c_error || codebooks == ukv_collection_main_k)
+        return index;
+    index.codes = companion_collection(db, collection, pq_codes_suffix_k, false, arena, c_error);
+    if (*c_error || index.codes == ukv_collection_main_k)
+        return index;
+
+    ukv_length_t* found_lengths = nullptr;
+    ukv_byte_t* found_values = nullptr;
+    ukv_read_t read {
+        .db = db,
+        .error = c_error,
+        .transaction = transaction,
+        .arena = arena,
+        .options = ukv_options_t(options | ukv_option_dont_discard_memory_k),
+        .tasks_count = 1,
+        .collections = &codebooks,
+        .keys = &pq_codebook_key_k,
+        .lengths = &found_lengths,
+        .values = &found_values,
+    };
+    ukv_read(&read);
+    if (*c_error || found_lengths[0] == ukv_length_missing_k || found_lengths[0] < sizeof(pq_header_t))
+        return index;
+
+    std::memcpy(&index.header, found_values, sizeof(pq_header_t));
+    std::size_t centroids_count = index.dimensions() * pq_centroids_k;
+    if (!index.header.subspaces || index.dimensions() % index.subspaces() ||
+        found_lengths[0] != sizeof(pq_header_t) + centroids_count * sizeof(real_t)) {
+        log_error_m(c_error, consistency_k, "Corrupted PQ codebook");
+        return index;
+    }
+
+    // The values tape isn't guaranteed to be aligned for floats
+    auto centroids = arena.alloc<real_t>(centroids_count, c_error);
+    if (*c_error)
+        return index;
+    std::memcpy(centroids.begin(), found_values + sizeof(pq_header_t), centroids_count * sizeof(real_t));
+    index.centroids = centroids.begin();
+    return index;
+}
+
+/**
+ * @brief Asymmetric Distance Computation tables of a single query.
+ * Contains the distance from every slice of the query to every centroid
+ * of that subspace, quantized into bytes, so that the distance to a code
+ * is the sum of `subspaces` table lookups, rescaled with `scale` and `offset`.
+ * Lower values mean closer vectors for all metrics.
+ */
+struct pq_lookup_t {
+    std::uint8_t* table = nullptr;
+    real_t scale = 1;
+    real_t offset = 0;
+
+    /**
+     * @param query Will be normalized inplace.
+     * @param distances Temporary buffer for `subspaces * 16` values.
+     */
+    void build(pq_index_t const& index, real_t* query, ukv_vector_metric_t kind, real_t* distances) noexcept {
+        if (kind == ukv_vector_metric_cos_k)
+            normalize(query, index.dimensions());
+
+        auto const slice = index.subspace_dims();
+        real_t widest_range = 0;
+        offset = 0;
+        for (std::size_t m = 0; m != index.subspaces(); ++m) {
+            real_t* subspace_distances = distances + m * pq_centroids_k;
+            for (std::size_t j = 0; j != pq_centroids_k; ++j)
+                subspace_distances[j] = kind == ukv_vector_metric_l2_k
+                                            ? distance_l2_squared(query + m * slice, index.centroid(m, j), slice)
+                                            : -dot(query + m * slice, index.centroid(m, j), slice);
+            auto min_max = std::minmax_element(subspace_distances, subspace_distances + pq_centroids_k);
+            auto min = *min_max.first;
+            for (std::size_t j = 0; j != pq_centroids_k; ++j)
+                subspace_distances[j] -= min;
+            widest_range = std::max(widest_range, *min_max.second - min);
+            offset += min;
+        }
+
+        scale = widest_range > 0 ? widest_range / 255 : 1;
+        for (std::size_t i = 0; i != index.subspaces() * pq_centroids_k; ++i)
+            table[i] = static_cast<std::uint8_t>(std::lround(distances[i] / scale));
+    }
+
+    real_t distance(std::uint16_t sum) const noexcept { return offset + sum * scale; }
+
+    /**
+     * @brief Scores a block of 32 candidates, which codes are transposed into
+     * `subspaces` rows of 32 bytes, each byte containing a single 4-bit code.
+     */
+    void score(std::uint8_t const* codes, std::size_t subspaces, std::uint16_t* sums) const noexcept {
+#if defined(__AVX2__)
+        // Every byte-shuffle performs 32 lookups into a 16-entry table at once.
+        __m256i zeros = _mm256_setzero_si256();
+        __m256i sums_low = zeros;
+        __m256i sums_high = zeros;
+        for (std::size_t m = 0; m != subspaces; ++m) {
+            __m128i lut_half = _mm_loadu_si128((__m128i const*)(table + m * pq_centroids_k));
+            __m256i lut = _mm256_broadcastsi128_si256(lut_half);
+            __m256i indexes = _mm256_loadu_si256((__m256i const*)(codes + m * pq_block_k));
+            __m256i distances = _mm256_shuffle_epi8(lut, indexes);
+            sums_low = _mm256_add_epi16(sums_low, _mm256_unpacklo_epi8(distances, zeros));
+            sums_high = _mm256_add_epi16(sums_high, _mm256_unpackhi_epi8(distances, zeros));
+        }
+        // Unpacking works within 128-bit lanes, so the order of candidates is interleaved.
+        alignas(32) std::uint16_t low[16], high[16];
+        _mm256_store_si256((__m256i*)low, sums_low);
+        _mm256_store_si256((__m256i*)high, sums_high);
+        for (std::size_t i = 0; i != 8; ++i)
+            sums[i] = low[i], sums[i + 8] = high[i], sums[i + 16] = low[i + 8], sums[i + 24] = high[i + 8];
+#else
+        std::fill_n(sums, pq_block_k, std::uint16_t(0));
+        for (std::size_t m = 0; m != subspaces; ++m)
+            for (std::size_t i = 0; i != pq_block_k; ++i)
+                sums[i] += table[m * pq_centroids_k + codes[m * pq_block_k + i]];
+#endif
+    }
+};
+
+#pragma endregion
+
+/**
+ * @brief Resolves the collection with i8 copies of the vectors from `collection`.
+ * Without named collections, those are stored next to the originals under negated keys.
+ * @return `ukv_collection_main_k` if the companion is missing and wasn't created.
+ */
+ukv_collection_t quants_collection(ukv_database_t db,
+                                   ukv_collection_t collection,
+                                   bool create_if_missing,
+                                   linked_memory_lock_t& arena,
+                                   ukv_error_t* c_error) noexcept {
+    if (!ukv_supports_named_collections_k)
+        return collection;
+    return companion_collection(db, collection, quants_suffix_k, create_if_missing, arena, c_error);
+}
+
+#pragma region Filtering
+
+/**
+ * @brief Candidate filters of a single search query.
+ * Key bounds and allow-lists limit the entries we fetch at all,
+ * while the docs predicate is only evaluated for the candidates,
+ * that would otherwise enter the top.
+ */
+struct vectors_filter_t {
+    ukv_key_t start_key = std::numeric_limits<ukv_key_t>::min();
+    ukv_key_t end_key = std::numeric_limits<ukv_key_t>::max();
+    bool has_allowed_keys = false;
+    ptr_range_gt<ukv_key_t const> allowed_keys;
+    ukv_collection_t docs_collection = ukv_collection_main_k;
+    ukv_str_view_t docs_field = nullptr;
+    ukv_float_t docs_min = 0;
+    ukv_float_t docs_max = 0;
+};
+
+/**
+ * @brief Visits the entries of `collection`, that pass the key bounds and
+ * the allow-list of the `filter`. Allowed keys are fetched with point reads,
+ * instead of scanning the whole collection.
+ *
+ * @param mirrored Whether the entries are i8 copies stored under negated keys.
+ */
+template <typename callback_should_continue_at>
+void for_each_candidate(ukv_vectors_search_t const& c,
+                        ukv_collection_t collection,
+                        bool mirrored,
+                        vectors_filter_t const& filter,
+                        linked_memory_lock_t& arena,
+                        callback_should_continue_at&& callback_should_continue) noexcept {
+
+    if (filter.has_allowed_keys) {
+        auto batch_keys = arena.alloc<ukv_key_t>(scan_read_ahead_k, c.error);
+        return_if_error_m(c.error);
+        for (std::size_t batch_begin = 0; batch_begin < filter.allowed_keys.size(); batch_begin += scan_read_ahead_k) {
+            auto allowed_keys = filter.allowed_keys.begin() + batch_begin;
+            auto batch_size = std::min<std::size_t>(scan_read_ahead_k, filter.allowed_keys.size() - batch_begin);
+            for (std::size_t i = 0; i != batch_size; ++i)
+                batch_keys[i] = mirrored ? -allowed_keys[i] : allowed_keys[i];
+
+            ukv_length_t* found_offsets = nullptr;
+            ukv_length_t* found_lengths = nullptr;
+            ukv_byte_t* found_values = nullptr;
+            ukv_read_t read {
+                .db = c.db,
+                .error = c.error,
+                .transaction = c.transaction,
+                .arena = arena,
+                .options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k),
+                .tasks_count = static_cast<ukv_size_t>(batch_size),
+                .collections = &collection,
+                .collections_stride = 0,
+                .keys = batch_keys.begin(),
+                .keys_stride = sizeof(ukv_key_t),
+                .offsets = &found_offsets,
+                .lengths = &found_lengths,
+                .values = &found_values,
+            };
+            ukv_read(&read);
+            return_if_error_m(c.error);
+
+            for (std::size_t i = 0; i != batch_size; ++i) {
+                if (found_lengths[i] == ukv_length_missing_k)
+                    continue;
+                value_view_t value {found_values + found_offsets[i], found_lengths[i]};
+                if (!callback_should_continue(allowed_keys[i], value))
+                    return;
+            }
+        }
+        return;
+    }
+
+    if (!mirrored) {
+        auto callback = [&](ukv_key_t key, value_view_t value) noexcept {
+            return key < filter.end_key && callback_should_continue(key, value);
+        };
+        full_scan_collection(c.db,
+                             c.transaction,
+                             collection,
+                             c.options,
+                             filter.start_key,
+                             scan_read_ahead_k,
+                             arena,
+                             c.error,
+                             callback);
+        return;
+    }
+
+    // Negated keys come in the reverse order of the original ones
+    auto callback = [&](ukv_key_t key, value_view_t value) noexcept {
+        if (key >= 0)
+            return false;
+        ukv_key_t original = -key;
+        if (original >= filter.end_key)
+            return true;
+        if (original < filter.start_key)
+            return false;
+        return callback_should_continue(original, value);
+    };
+    auto min_key = std::numeric_limits<ukv_key_t>::min();
+    full_scan_collection( //
+        c.db,
+        c.transaction,
+        collection,
+        c.options,
+        min_key,
+        scan_read_ahead_k,
+        arena,
+        c.error,
+        callback);
+}
+
+/**
+ * @brief Pushes a block of scored candidates into the `top`.
+ * If the docs predicate is set, it is gathered in one batch, but only
+ * for the candidates, that would make it into the `top`.
+ */
+void push_candidates(ukv_vectors_search_t const& c,
+                     vectors_filter_t const& filter,
+                     match_t* candidates,
+                     std::size_t count,
+                     pq_t& top,
+                     linked_memory_lock_t& arena) noexcept {
+
+    if (!filter.docs_field) {
+        for (std::size_t i = 0; i != count; ++i)
+            top.push(candidates[i]);
+        return;
+    }
+
+    if (!top.capacity())
+        return;
+    std::size_t promising = 0;
+    for (std::size_t i = 0; i != count; ++i)
+        if (top.size() < top.capacity() || top[top.size() - 1].metric < candidates[i].metric)
+            candidates[promising++] = candidates[i];
+    if (!promising)
+        return;
+
+    ukv_octet_t** validities = nullptr;
+    ukv_byte_t** scalars = nullptr;
+    ukv_doc_field_type_t type = ukv_doc_field_f64_k;
+    ukv_docs_gather_t gather {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k),
+        .docs_count = static_cast<ukv_size_t>(promising),
+        .fields_count = 1,
+        .collections = &filter.docs_collection,
+        .collections_stride = 0,
+        .keys = &candidates[0].key,
+        .keys_stride = sizeof(match_t),
+        .fields = &filter.docs_field,
+        .fields_stride = 0,
+        .types = &type,
+        .types_stride = 0,
+        .columns_validities = &validities,
+        .columns_scalars = &scalars,
+    };
+    ukv_docs_gather(&gather);
+    return_if_error_m(c.error);
+
+    auto values = reinterpret_cast<double const*>(scalars[0]);
+    for (std::size_t i = 0; i != promising; ++i) {
+        bool valid = validities[0][i / CHAR_BIT] & (1 << (i % CHAR_BIT));
+        if (valid && values[i] >= filter.docs_min && values[i] <= filter.docs_max)
+            top.push(candidates[i]);
+    }
+}
+
+#pragma endregion
+
 struct vectors_arg_t {
     strided_iterator_gt<ukv_bytes_cptr_t const> contents;
     strided_iterator_gt<ukv_length_t const> offsets;
@@ -182,15 +767,49 @@ void ukv_vectors_write(ukv_vectors_write_t* c_ptr) {
         entry.value = vectors_args[task_idx];
     }
 
-    // Add the mirror tasks for quantized copies
+    // Add the tasks for quantized copies or PQ codes
+    auto reals = arena.alloc<real_t>(c.dimensions, c.error);
+    return_if_error_m(c.error);
+
+    pq_index_t index;
+    ukv_collection_t quants = ukv_collection_main_k;
+    ukv_collection_t index_collection = ukv_collection_main_k;
+    bool index_fetched = false;
     for (std::size_t task_idx = 0; task_idx != c.tasks_count; ++task_idx) {
         auto original_begin = vectors_args[task_idx].begin();
         auto quantized_begin = quantized_vectors.begin() + task_idx * c.dimensions;
+        auto collection = places_args[task_idx].collection;
+        if (!index_fetched || index_collection != collection) {
+            index = pq_index(c.db, c.transaction, collection, c.options, arena, c.error);
+            return_if_error_m(c.error);
+            if (!index) {
+                quants = quants_collection(c.db, collection, true, arena, c.error);
+                return_if_error_m(c.error);
+            }
+            index_collection = collection;
+            index_fetched = true;
+        }
+
         entry_t& entry = quantized_entries[c.tasks_count + task_idx];
-        entry.collection_key.collection = places_args[task_idx].collection;
-        entry.collection_key.key = -places_args[task_idx].key;
-        entry.value = value_view_t {(ukv_bytes_cptr_t)quantized_begin, c.dimensions};
-        quantize(original_begin, c.scalar_type, c.dimensions, quantized_begin);
+        if (index) {
+            return_error_if_m(index.dimensions() == c.dimensions,
+                              c.error,
+                              args_wrong_k,
+                              "Dimensions don't match the trained codebook");
+            // PQ codes are always shorter than i8 copies, so we can reuse the buffer.
+            cast(original_begin, c.scalar_type, c.dimensions, reals.begin());
+            index.encode(reals.begin(), (std::uint8_t*)quantized_begin);
+            entry.collection_key.collection = index.codes;
+            entry.collection_key.key = places_args[task_idx].key;
+            entry.value = value_view_t {(ukv_bytes_cptr_t)quantized_begin, index.code_bytes()};
+        }
+        else {
+            bool mirrored = !ukv_supports_named_collections_k;
+            entry.collection_key.collection = quants;
+            entry.collection_key.key = mirrored ? -places_args[task_idx].key : places_args[task_idx].key;
+            entry.value = value_view_t {(ukv_bytes_cptr_t)quantized_begin, c.dimensions};
+            quantize(original_begin, c.scalar_type, c.dimensions, quantized_begin);
+        }
     }
 
 #if 0 // Future Complex Index Logic
@@ -279,33 +898,150 @@ void ukv_vectors_read(ukv_vectors_read_t* c_ptr) {
     ukv_vectors_read_t& c = *c_ptr;
     linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
     return_if_error_m(c.error);
+    return_error_if_m(c.dimensions, c.error, args_wrong_k, "Vectors must have at least one dimension");
 
     strided_iterator_gt<ukv_collection_t const> collections {c.collections, c.collections_stride};
     strided_iterator_gt<ukv_key_t const> keys {c.keys, c.keys_stride};
     places_arg_t places_args {collections, keys, {}, c.tasks_count};
 
-    auto vector_size = c.dimensions * size_bytes(c.scalar_type);
-
-    // Read from disk, but potentially re-layout the data response.
-    ukv_read_t read {};
-    read.db = c.db;
-    read.error = c.error;
-    read.transaction = c.transaction;
-    read.arena = arena;
-    read.options = c.options;
-    read.tasks_count = c.tasks_count;
-    read.collections = c.collections;
-    read.collections_stride = c.collections_stride;
-    read.keys = keys.get();
-    read.keys_stride = keys.stride();
-    read.offsets = c.offsets;
-    read.presences = c.presences;
-    read.values = c.vectors;
+    std::size_t const dims = c.dimensions;
+    std::size_t const row_size = dims * size_bytes(c.scalar_type);
+
+    // Read the originals, that may have been written in a different scalar type
+    ukv_length_t* found_offsets = nullptr;
+    ukv_length_t* found_lengths = nullptr;
+    ukv_byte_t* found_values = nullptr;
+    ukv_read_t read {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .options = c.options,
+        .tasks_count = c.tasks_count,
+        .collections = c.collections,
+        .collections_stride = c.collections_stride,
+        .keys = keys.get(),
+        .keys_stride = keys.stride(),
+        .offsets = &found_offsets,
+        .lengths = &found_lengths,
+        .values = &found_values,
+    };
     ukv_read(&read);
     return_if_error_m(c.error);
 
-    // From here on, if we have the offsets don't form identical-length chunks,
-    // we must compact the range:
+    // Export a dense row-major matrix, with missing rows zeroed.
+    // The offsets are Arrow-compatible, making it a valid `FixedSizeList` column.
+    auto presences = arena.alloc_or_dummy(c.tasks_count, c.error, c.presences);
+    return_if_error_m(c.error);
+    auto offsets = arena.alloc_or_dummy(c.tasks_count + 1, c.error, c.offsets);
+    return_if_error_m(c.error);
+    auto matrix = arena.alloc<byte_t>(c.tasks_count * row_size, c.error, matrix_alignment_k);
+    return_if_error_m(c.error);
+    auto reals = arena.alloc<real_t>(dims, c.error);
+    return_if_error_m(c.error);
+    if (c.vectors)
+        *c.vectors = reinterpret_cast<ukv_byte_t*>(matrix.begin());
+
+    std::size_t missing_count = 0;
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        byte_t* row = matrix.begin() + i * row_size;
+        auto original = reinterpret_cast<byte_t const*>(found_values + found_offsets[i]);
+        ukv_vector_scalar_t original_type;
+        bool present = found_lengths[i] != ukv_length_missing_k &&
+                       scalar_type_of(found_lengths[i], dims, original_type);
+        offsets[i] = static_cast<ukv_length_t>(i * row_size);
+        presences[i] = present;
+        missing_count += !present;
+        if (!present)
+            std::memset(row, 0, row_size);
+        else if (original_type == c.scalar_type)
+            std::memcpy(row, original, row_size);
+        else {
+            cast(original, original_type, dims, reals.begin());
+            export_reals(reals.begin(), dims, c.scalar_type, row);
+        }
+    }
+    offsets[c.tasks_count] = static_cast<ukv_length_t>(c.tasks_count * row_size);
+    if (!missing_count)
+        return;
+
+    // Reconstruct the missing originals from i8 copies or PQ codes, if those are present
+    auto copies = arena.alloc<collection_key_t>(missing_count, c.error);
+    return_if_error_m(c.error);
+    auto copies_tasks = arena.alloc<std::size_t>(missing_count, c.error);
+    return_if_error_m(c.error);
+    auto copies_indexes = arena.alloc<pq_index_t>(missing_count, c.error);
+    return_if_error_m(c.error);
+
+    // Consecutive tasks generally target the same collection, so we only re-resolve on change
+    pq_index_t index;
+    ukv_collection_t quants = ukv_collection_main_k;
+    ukv_collection_t last_collection = ukv_collection_main_k;
+    bool resolved = false;
+    bool const mirrored = !ukv_supports_named_collections_k;
+    std::size_t copies_count = 0;
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
+        if (presences[i])
+            continue;
+        auto place = places_args[i];
+        if (!resolved || last_collection != place.collection) {
+            index = pq_index(c.db, c.transaction, place.collection, c.options, arena, c.error);
+            return_if_error_m(c.error);
+            quants = quants_collection(c.db, place.collection, false, arena, c.error);
+            return_if_error_m(c.error);
+            last_collection = place.collection;
+            resolved = true;
+        }
+        if (index && index.dimensions() == dims) {
+            copies[copies_count] = {index.codes, place.key};
+            copies_indexes[copies_count] = index;
+        }
+        else if (mirrored || quants != ukv_collection_main_k) {
+            copies[copies_count] = {quants, mirrored ? -place.key : place.key};
+            copies_indexes[copies_count] = pq_index_t {};
+        }
+        else
+            continue;
+        copies_tasks[copies_count] = i;
+        ++copies_count;
+    }
+    if (!copies_count)
+        return;
+
+    ukv_length_t* copies_offsets = nullptr;
+    ukv_length_t* copies_lengths = nullptr;
+    ukv_byte_t* copies_values = nullptr;
+    ukv_read_t read_copies {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k),
+        .tasks_count = static_cast<ukv_size_t>(copies_count),
+        .collections = &copies[0].collection,
+        .collections_stride = sizeof(collection_key_t),
+        .keys = &copies[0].key,
+        .keys_stride = sizeof(collection_key_t),
+        .offsets = &copies_offsets,
+        .lengths = &copies_lengths,
+        .values = &copies_values,
+    };
+    ukv_read(&read_copies);
+    return_if_error_m(c.error);
+
+    for (std::size_t j = 0; j != copies_count; ++j) {
+        auto copy = copies_values + copies_offsets[j];
+        pq_index_t const& copy_index = copies_indexes[j];
+        if (copy_index && copies_lengths[j] == copy_index.code_bytes())
+            copy_index.decode(copy, reals.begin());
+        else if (!copy_index && copies_lengths[j] == dims)
+            dequantize(reinterpret_cast<quant_t const*>(copy), dims, reals.begin());
+        else
+            continue;
+        auto i = copies_tasks[j];
+        export_reals(reals.begin(), dims, c.scalar_type, matrix.begin() + i * row_size);
+        presences[i] = true;
+    }
 }
 
 void ukv_vectors_search(ukv_vectors_search_t* c_ptr) {
@@ -322,6 +1058,14 @@ void ukv_vectors_search(ukv_vectors_search_t* c_ptr) {
     strided_range_gt<ukv_length_t const> count_limits {{c.match_counts_limits, c.match_counts_limits_stride},
                                                        c.tasks_count};
 
+    strided_iterator_gt<ukv_key_t const> start_keys {c.start_keys, c.start_keys_stride};
+    strided_iterator_gt<ukv_key_t const> end_keys {c.end_keys, c.end_keys_stride};
+    ptr_range_gt<ukv_key_t const> allowed_keys {c.allowed_keys, c.allowed_keys_count};
+    return_error_if_m(std::is_sorted(allowed_keys.begin(), allowed_keys.end()),
+                      c.error,
+                      args_wrong_k,
+                      "Allowed keys must be sorted");
+
     auto count_limits_max = ukv_length_t {0};
     auto count_limits_sum = transform_reduce_n(count_limits.begin(), c.tasks_count, 0ul, [&](ukv_length_t l) {
         count_limits_max = std::max(count_limits_max, l);
@@ -342,40 +1086,377 @@ void ukv_vectors_search(ukv_vectors_search_t* c_ptr) {
     auto quant_query = arena.alloc<quant_t>(c.dimensions, c.error);
     return_if_error_m(c.error);
 
+    // Buffers for product-quantized collections are allocated lazily
+    pq_index_t index;
+    ukv_collection_t index_collection = ukv_collection_main_k;
+    bool index_fetched = false;
+    pq_lookup_t lookup;
+    ptr_range_gt<match_t> temp_candidates;
+    ptr_range_gt<real_t> real_queries;
+    ptr_range_gt<real_t> real_candidate;
+    ptr_range_gt<real_t> lookup_distances;
+    ptr_range_gt<std::uint8_t> block_codes;
+    match_t block_matches[pq_block_k];
+    alignas(32) std::uint16_t block_sums[pq_block_k];
+    std::size_t block_size = 0;
+    auto const vector_size = c.dimensions * size_bytes(c.scalar_type);
+
     ukv_length_t total_exported_matches = 0;
-    for (std::size_t i = 0; i != c.tasks_count && !*c.error; ++i) {
+    for (std::size_t i = 0; i != c.tasks_count; ++i) {
         auto col = collections ? collections[i] : ukv_collection_main_k;
         auto query = queries_args[i];
         auto limit = count_limits[i];
-        quantize(query.begin(), c.scalar_type, c.dimensions, quant_query.begin());
+        if (!index_fetched || index_collection != col) {
+            index = pq_index(c.db, c.transaction, col, c.options, arena, c.error);
+            return_if_error_m(c.error);
+            index_collection = col;
+            index_fetched = true;
+        }
+
+        vectors_filter_t filter;
+        filter.start_key = start_keys ? start_keys[i] : filter.start_key;
+        filter.end_key = end_keys ? end_keys[i] : filter.end_key;
+        if (c.allowed_keys) {
+            auto allowed_begin = std::lower_bound(allowed_keys.begin(), allowed_keys.end(), filter.start_key);
+            auto allowed_end = std::lower_bound(allowed_begin, allowed_keys.end(), filter.end_key);
+            filter.has_allowed_keys = true;
+            filter.allowed_keys = {allowed_begin, allowed_end};
+        }
+        filter.docs_collection = c.filter_collection;
+        filter.docs_field = c.filter_field;
+        filter.docs_min = c.filter_min;
+        filter.docs_max = c.filter_max;
 
         pq_t pq {temp_matches.begin(), temp_matches.begin() + limit};
+        block_size = 0;
 
-        auto callback = [&](ukv_key_t key, value_view_t vector) noexcept {
-            if (key >= 0)
-                return false;
-            match_t match;
-            match.key = key;
-            match.metric = metric(quant_query.begin(), (quant_t const*)vector.data(), c.dimensions, c.metric);
-            if (match.metric < c.metric_threshold)
-                return true;
+        if (!index) {
+            bool mirrored = !ukv_supports_named_collections_k;
+            auto quants = quants_collection(c.db, col, false, arena, c.error);
+            return_if_error_m(c.error);
+            quantize(query.begin(), c.scalar_type, c.dimensions, quant_query.begin());
+            auto callback = [&](ukv_key_t key, value_view_t vector) noexcept {
+                if (vector.size() != c.dimensions)
+                    return true;
+                auto distance = metric(quant_query.begin(), (quant_t const*)vector.data(), c.dimensions, c.metric);
+                if (distance < c.metric_threshold)
+                    return true;
 
-            pq.push(match);
-            return true;
-        };
+                block_matches[block_size] = match_t {key, similarity(distance, c.metric)};
+                if (++block_size == pq_block_k)
+                    push_candidates(c, filter, block_matches, std::exchange(block_size, 0), pq, arena);
+                return !*c.error;
+            };
 
-        auto min_key = std::numeric_limits<ukv_key_t>::min();
-        full_scan_collection(c.db, c.transaction, col, c.options, min_key, limit, arena, c.error, callback);
-        auto count = pq.size();
+            // Missing companion means, that nothing was written yet
+            if (mirrored || quants != ukv_collection_main_k)
+                for_each_candidate(c, quants, mirrored, filter, arena, callback);
+            return_if_error_m(c.error);
+            push_candidates(c, filter, block_matches, block_size, pq, arena);
+            return_if_error_m(c.error);
+        }
+        else {
+            return_error_if_m(index.dimensions() == c.dimensions,
+                              c.error,
+                              args_wrong_k,
+                              "Dimensions don't match the trained codebook");
+            if (!lookup.table) {
+                temp_candidates = arena.alloc<match_t>(count_limits_max * pq_rerank_factor_k, c.error);
+                return_if_error_m(c.error);
+                real_queries = arena.alloc<real_t>(c.dimensions * 2, c.error);
+                return_if_error_m(c.error);
+                real_candidate = arena.alloc<real_t>(c.dimensions, c.error);
+                return_if_error_m(c.error);
+                lookup_distances = arena.alloc<real_t>(pq_subspaces_max_k * pq_centroids_k, c.error);
+                return_if_error_m(c.error);
+                auto table = arena.alloc<std::uint8_t>(pq_subspaces_max_k * pq_centroids_k, c.error);
+                return_if_error_m(c.error);
+                lookup.table = table.begin();
+                // Unused slots of incomplete blocks must still hold valid 4-bit codes
+                block_codes = arena.alloc<std::uint8_t>(pq_subspaces_max_k * pq_block_k, c.error);
+                return_if_error_m(c.error);
+                std::fill_n(block_codes.begin(), block_codes.size(), std::uint8_t(0));
+            }
+
+            real_t* real_query = real_queries.begin();
+            real_t* real_query_normalized = real_queries.begin() + c.dimensions;
+            cast(query.begin(), c.scalar_type, c.dimensions, real_query);
+            std::copy_n(real_query, c.dimensions, real_query_normalized);
+            lookup.build(index, real_query_normalized, c.metric, lookup_distances.begin());
+
+            // Shortlist the candidates by approximate distances to their codes
+            pq_t shortlist {temp_candidates.begin(), temp_candidates.begin() + limit * pq_rerank_factor_k};
+            auto score_block = [&]() noexcept {
+                lookup.score(block_codes.begin(), index.subspaces(), block_sums);
+                for (std::size_t j = 0; j != block_size; ++j)
+                    block_matches[j].metric = -lookup.distance(block_sums[j]);
+                push_candidates(c, filter, block_matches, std::exchange(block_size, 0), shortlist, arena);
+            };
+            auto callback = [&](ukv_key_t key, value_view_t codes) noexcept {
+                if (codes.size() != index.code_bytes())
+                    return true;
+                block_matches[block_size].key = key;
+                for (std::size_t m = 0; m != index.subspaces(); ++m)
+                    block_codes[m * pq_block_k + block_size] = pq_index_t::code((std::uint8_t const*)codes.data(), m);
+                if (++block_size == pq_block_k)
+                    score_block();
+                return !*c.error;
+            };
+
+            for_each_candidate(c, index.codes, false, filter, arena, callback);
+            return_if_error_m(c.error);
+            if (block_size)
+                score_block();
+            return_if_error_m(c.error);
+
+            // Re-rank the shortlist against the original vectors
+            if (shortlist.size()) {
+                ukv_length_t* candidates_offsets = nullptr;
+                ukv_length_t* candidates_lengths = nullptr;
+                ukv_byte_t* candidates_values = nullptr;
+                ukv_read_t read {
+                    .db = c.db,
+                    .error = c.error,
+                    .transaction = c.transaction,
+                    .arena = arena,
+                    .options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k),
+                    .tasks_count = static_cast<ukv_size_t>(shortlist.size()),
+                    .collections = &col,
+                    .collections_stride = 0,
+                    .keys = &shortlist.data()->key,
+                    .keys_stride = sizeof(match_t),
+                    .offsets = &candidates_offsets,
+                    .lengths = &candidates_lengths,
+                    .values = &candidates_values,
+                };
+                ukv_read(&read);
+                return_if_error_m(c.error);
 
+                for (std::size_t j = 0; j != shortlist.size(); ++j) {
+                    if (candidates_lengths[j] != vector_size)
+                        continue;
+                    auto candidate = reinterpret_cast<byte_t const*>(candidates_values + candidates_offsets[j]);
+                    cast(candidate, c.scalar_type, c.dimensions, real_candidate.begin());
+                    auto distance = metric(real_query, real_candidate.begin(), c.dimensions, c.metric);
+                    if (distance < c.metric_threshold)
+                        continue;
+                    pq.push(match_t {shortlist[j].key, similarity(distance, c.metric)});
+                }
+            }
+        }
+
+        auto count = pq.size();
         found_counts[i] = count;
         found_offsets[i] = total_exported_matches;
 
         for (std::size_t j = 0; j != count; ++j)
-            found_keys[total_exported_matches + j] = std::abs(temp_matches[j].key), //
-                found_metrics[total_exported_matches + j] = temp_matches[j].metric;
+            found_keys[total_exported_matches + j] = temp_matches[j].key, //
+                found_metrics[total_exported_matches + j] = similarity(temp_matches[j].metric, c.metric);
 
         total_exported_matches += count;
         pq.clear();
     }
-}
\ No newline at end of file
+}
+
+void ukv_vectors_train(ukv_vectors_train_t* c_ptr) {
+
+    ukv_vectors_train_t& c = *c_ptr;
+    linked_memory_lock_t arena = linked_memory(c.arena, c.options, c.error);
+    return_if_error_m(c.error);
+    return_error_if_m(c.dimensions, c.error, args_wrong_k, "Vectors must have at least one dimension");
+
+    ukv_length_t subspaces = c.subspaces;
+    if (!subspaces)
+        for (subspaces = std::min(c.dimensions, pq_subspaces_default_k); c.dimensions % subspaces; --subspaces)
+            ;
+    return_error_if_m(subspaces <= pq_subspaces_max_k && c.dimensions % subspaces == 0,
+                      c.error,
+                      args_wrong_k,
+                      "Subspaces must divide the dimensions and can't exceed 256");
+
+    std::size_t const dims = c.dimensions;
+    std::size_t const slice = dims / subspaces;
+    std::size_t const samples_limit = c.samples_limit ? c.samples_limit : pq_samples_default_k;
+    std::size_t const iterations = c.iterations ? c.iterations : pq_iterations_default_k;
+    auto const vector_size = c.dimensions * size_bytes(c.scalar_type);
+    auto const min_key = std::numeric_limits<ukv_key_t>::min();
+
+    // Reservoir-sample the training set in a single pass.
+    // The generator is seeded with a constant to keep the codebooks reproducible.
+    auto samples = arena.alloc<real_t>(samples_limit * dims, c.error);
+    return_if_error_m(c.error);
+    std::mt19937 random_generator(samples_limit);
+    std::size_t samples_seen = 0;
+    auto sample = [&](ukv_key_t, value_view_t vector) noexcept {
+        if (vector.size() != vector_size)
+            return true;
+        std::size_t slot = samples_seen < samples_limit
+                               ? samples_seen
+                               : std::uniform_int_distribution<std::size_t>(0, samples_seen)(random_generator);
+        if (slot < samples_limit)
+            cast(vector.data(), c.scalar_type, dims, samples.begin() + slot * dims);
+        ++samples_seen;
+        return true;
+    };
+    full_scan_collection( //
+        c.db,
+        c.transaction,
+        c.collection,
+        c.options,
+        min_key,
+        scan_read_ahead_k,
+        arena,
+        c.error,
+        sample);
+    return_if_error_m(c.error);
+
+    std::size_t const samples_count = std::min(samples_seen, samples_limit);
+    return_error_if_m(samples_count >= pq_centroids_k, c.error, args_wrong_k, "Not enough vectors to train a codebook");
+    if (c.metric == ukv_vector_metric_cos_k)
+        for (std::size_t i = 0; i != samples_count; ++i)
+            normalize(samples.begin() + i * dims, dims);
+
+    // Cluster every subspace separately with Lloyd's K-Means
+    auto codebook = arena.alloc<byte_t>(sizeof(pq_header_t) + dims * pq_centroids_k * sizeof(real_t), c.error);
+    return_if_error_m(c.error);
+    auto centroids = arena.alloc<real_t>(dims * pq_centroids_k, c.error);
+    return_if_error_m(c.error);
+    auto sums = arena.alloc<real_t>(slice * pq_centroids_k, c.error);
+    return_if_error_m(c.error);
+    std::size_t counts[pq_centroids_k];
+    std::uniform_int_distribution<std::size_t> random_sample(0, samples_count - 1);
+
+    for (std::size_t m = 0; m != subspaces; ++m) {
+        real_t* subspace_centroids = centroids.begin() + m * slice * pq_centroids_k;
+        auto point = [&](std::size_t i) noexcept { return samples.begin() + i * dims + m * slice; };
+        for (std::size_t j = 0; j != pq_centroids_k; ++j)
+            std::copy_n(point(random_sample(random_generator)), slice, subspace_centroids + j * slice);
+
+        for (std::size_t iteration = 0; iteration != iterations; ++iteration) {
+            std::fill_n(sums.begin(), sums.size(), real_t(0));
+            std::fill_n(counts, pq_centroids_k, std::size_t(0));
+            for (std::size_t i = 0; i != samples_count; ++i) {
+                auto j = nearest_centroid(point(i), subspace_centroids, slice);
+                counts[j]++;
+                for (std::size_t d = 0; d != slice; ++d)
+                    sums[j * slice + d] += point(i)[d];
+            }
+            // Empty clusters are re-seeded with random samples
+            for (std::size_t j = 0; j != pq_centroids_k; ++j)
+                if (counts[j])
+                    for (std::size_t d = 0; d != slice; ++d)
+                        subspace_centroids[j * slice + d] = sums[j * slice + d] / counts[j];
+                else
+                    std::copy_n(point(random_sample(random_generator)), slice, subspace_centroids + j * slice);
+        }
+    }
+
+    pq_index_t index;
+    index.header.dimensions = c.dimensions;
+    index.header.subspaces = subspaces;
+    index.header.metric = c.metric;
+    index.centroids = centroids.begin();
+    std::memcpy(codebook.begin(), &index.header, sizeof(pq_header_t));
+    std::memcpy(codebook.begin() + sizeof(pq_header_t), centroids.begin(), centroids.size() * sizeof(real_t));
+
+    auto codebooks = companion_collection(c.db, c.collection, pq_codebook_suffix_k, true, arena, c.error);
+    return_if_error_m(c.error);
+    index.codes = companion_collection(c.db, c.collection, pq_codes_suffix_k, true, arena, c.error);
+    return_if_error_m(c.error);
+
+    auto codebook_begin = reinterpret_cast<ukv_bytes_cptr_t>(codebook.begin());
+    ukv_length_t codebook_length = codebook.size();
+    ukv_write_t write {
+        .db = c.db,
+        .error = c.error,
+        .transaction = c.transaction,
+        .arena = arena,
+        .options = c.options,
+        .tasks_count = 1,
+        .collections = &codebooks,
+        .keys = &pq_codebook_key_k,
+        .lengths = &codebook_length,
+        .values = &codebook_begin,
+    };
+    ukv_write(&write);
+    return_if_error_m(c.error);
+
+    // Re-encode all the present vectors in batches
+    auto batch_keys = arena.alloc<ukv_key_t>(scan_read_ahead_k, c.error);
+    return_if_error_m(c.error);
+    auto batch_codes = arena.alloc<std::uint8_t>(scan_read_ahead_k * index.code_bytes(), c.error);
+    return_if_error_m(c.error);
+    auto reals = arena.alloc<real_t>(dims, c.error);
+    return_if_error_m(c.error);
+    std::size_t batch_size = 0;
+    auto flush = [&]() noexcept {
+        auto codes_begin = reinterpret_cast<ukv_bytes_cptr_t>(batch_codes.begin());
+        ukv_length_t codes_length = index.code_bytes();
+        ukv_write_t write {
+            .db = c.db,
+            .error = c.error,
+            .transaction = c.transaction,
+            .arena = arena,
+            .options = c.options,
+            .tasks_count = static_cast<ukv_size_t>(batch_size),
+            .collections = &index.codes,
+            .collections_stride = 0,
+            .keys = batch_keys.begin(),
+            .keys_stride = sizeof(ukv_key_t),
+            .lengths = &codes_length,
+            .lengths_stride = 0,
+            .values = &codes_begin,
+            .values_stride = 0,
+        };
+        // All the codes are packed in one buffer, so the offsets grow with a constant step
+        auto offsets = arena.alloc<ukv_length_t>(batch_size, c.error);
+        if (*c.error)
+            return;
+        for (std::size_t i = 0; i != batch_size; ++i)
+            offsets[i] = static_cast<ukv_length_t>(i * codes_length);
+        write.offsets = offsets.begin();
+        write.offsets_stride = sizeof(ukv_length_t);
+        ukv_write(&write);
+        batch_size = 0;
+    };
+    auto encode = [&](ukv_key_t key, value_view_t vector) noexcept {
+        if (vector.size() != vector_size)
+            return true;
+        cast(vector.data(), c.scalar_type, dims, reals.begin());
+        index.encode(reals.begin(), batch_codes.begin() + batch_size * index.code_bytes());
+        batch_keys[batch_size] = key;
+        if (++batch_size == scan_read_ahead_k)
+            flush();
+        return !*c.error;
+    };
+    full_scan_collection( //
+        c.db,
+        c.transaction,
+        c.collection,
+        c.options,
+        min_key,
+        scan_read_ahead_k,
+        arena,
+        c.error,
+        encode);
+    return_if_error_m(c.error);
+    if (batch_size)
+        flush();
+    return_if_error_m(c.error);
+
+    // The i8 copies are superseded by the codes. Inside transactions we keep them,
+    // as collections can't be dropped transactionally.
+    if (c.transaction)
+        return;
+    auto quants = companion_collection(c.db, c.collection, quants_suffix_k, false, arena, c.error);
+    return_if_error_m(c.error);
+    if (quants == ukv_collection_main_k)
+        return;
+    ukv_collection_drop_t drop {
+        .db = c.db,
+        .error = c.error,
+        .id = quants,
+        .mode = ukv_drop_keys_vals_handle_k,
+    };
+    ukv_collection_drop(&drop);
+}
@@ -993,6 +993,605 @@ TEST(db, paths_linked_list) {
     }
 }
 
+/**
+ * Tests the ordered index of the "Paths" Modality on nested paths, sharing long prefixes.
+ * There are enough of them to split the leaves of the index, before and after it is built.
+ * Prefix matches must come in lexicographic order, survive pagination and removals.
+ */
+TEST(db, paths_index) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    arena_t arena(db);
+    status_t status;
+    ukv_paths_index_t paths_index {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+    };
+    if (!ukv_supports_named_collections_k) {
+        ukv_paths_index(&paths_index);
+        EXPECT_FALSE(status);
+        return;
+    }
+
+    std::vector<std::string> all_paths;
+    for (std::size_t i = 0; i != 2000; ++i)
+        all_paths.push_back("home/user/dir" + std::to_string(i % 5) + "/file" + std::to_string(i));
+    for (std::size_t i = 0; i != 100; ++i)
+        all_paths.push_back("var/log/file" + std::to_string(i));
+
+    auto write = [&](std::size_t begin, std::size_t end, bool remove) {
+        std::vector<ukv_str_view_t> paths(end - begin);
+        for (std::size_t i = begin; i != end; ++i)
+            paths[i - begin] = all_paths[i].c_str();
+        ukv_paths_write_t paths_write {
+            .db = db,
+            .error = status.member_ptr(),
+            .arena = arena.member_ptr(),
+            .tasks_count = static_cast<ukv_size_t>(paths.size()),
+            .paths = paths.data(),
+            .paths_stride = sizeof(ukv_str_view_t),
+            .values_bytes = remove ? nullptr : reinterpret_cast<ukv_bytes_cptr_t const*>(paths.data()),
+            .values_bytes_stride = sizeof(ukv_str_view_t),
+        };
+        ukv_paths_write(&paths_write);
+        EXPECT_TRUE(status);
+    };
+    auto match = [&](std::string const& prefix, std::string const& previous, ukv_length_t limit) {
+        ukv_str_view_t prefix_ptr = prefix.c_str();
+        ukv_str_view_t previous_ptr = previous.c_str();
+        ukv_length_t* results_counts = nullptr;
+        ukv_char_t* tape_begin = nullptr;
+        ukv_paths_match_t paths_match {
+            .db = db,
+            .error = status.member_ptr(),
+            .arena = arena.member_ptr(),
+            .tasks_count = 1,
+            .match_counts_limits = &limit,
+            .patterns = &prefix_ptr,
+            .previous = previous.empty() ? nullptr : &previous_ptr,
+            .match_counts = &results_counts,
+            .paths_strings = &tape_begin,
+        };
+        ukv_paths_match(&paths_match);
+        EXPECT_TRUE(status);
+        std::vector<std::string> results;
+        strings_tape_iterator_t tape_iterator {results_counts[0], tape_begin};
+        for (; !tape_iterator.is_end(); ++tape_iterator)
+            results.emplace_back(*tape_iterator);
+        return results;
+    };
+    auto expected = [&](std::string const& prefix) {
+        std::set<std::string> results;
+        for (std::string const& path : all_paths)
+            if (path.substr(0, prefix.size()) == prefix)
+                results.insert(path);
+        return std::vector<std::string>(results.begin(), results.end());
+    };
+    auto match_in_pages = [&](std::string const& prefix, ukv_length_t page_size) {
+        std::vector<std::string> results;
+        while (true) {
+            auto page = match(prefix, results.empty() ? std::string() : results.back(), page_size);
+            results.insert(results.end(), page.begin(), page.end());
+            if (page.size() < page_size)
+                return results;
+        }
+    };
+
+    // Index a part of the paths, and let the writes maintain it for the rest
+    write(0, 1000, false);
+    ukv_paths_index(&paths_index);
+    EXPECT_TRUE(status);
+    write(1000, all_paths.size(), false);
+    EXPECT_EQ(match("home/user/dir3/", {}, 10000), expected("home/user/dir3/"));
+    EXPECT_EQ(match("var/", {}, 10000), expected("var/"));
+    EXPECT_EQ(match_in_pages("home/user/", 37), expected("home/user/"));
+    EXPECT_EQ(match("home/user/dir3/", {}, 10).size(), 10u);
+    EXPECT_TRUE(match("home/users/", {}, 10000).empty());
+
+    // Remove a large range, emptying whole leaves
+    std::vector<std::string> removed(all_paths.begin() + 500, all_paths.begin() + 1900);
+    write(500, 1900, true);
+    all_paths.erase(all_paths.begin() + 500, all_paths.begin() + 1900);
+    EXPECT_EQ(match_in_pages("home/user/", 100), expected("home/user/"));
+    EXPECT_EQ(match("home/user/dir1/", {}, 10000), expected("home/user/dir1/"));
+
+    // Rebuilding the index compacts it without changing the results
+    ukv_paths_index(&paths_index);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(match_in_pages("home/user/", 100), expected("home/user/"));
+    EXPECT_EQ(match("", {}, 10000), expected(""));
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * Tests migrating "Paths" Modality buckets, written with another hash function.
+ * The outdated bucket is crafted manually, keeping a single path under an arbitrary key.
+ */
+TEST(db, paths_migrate) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    std::string bucket;
+    ukv_length_t const counters[3] {1, 6, 5};
+    bucket.append(reinterpret_cast<char const*>(counters), sizeof(counters));
+    bucket.append("legacy");
+    bucket.append("value");
+    EXPECT_TRUE(db.main().at(42).assign(value_view_t(bucket)));
+
+    arena_t arena(db);
+    status_t status;
+    ukv_str_view_t legacy_path = "legacy";
+    ukv_octet_t* found_presences = nullptr;
+    char* found_values = nullptr;
+    ukv_paths_read_t paths_read {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .tasks_count = 1,
+        .paths = &legacy_path,
+        .presences = &found_presences,
+        .values = reinterpret_cast<ukv_bytes_ptr_t*>(&found_values),
+    };
+    // Unmigrated collections are refused, instead of reporting misses
+    ukv_paths_read(&paths_read);
+    EXPECT_FALSE(status);
+    status.release_error();
+
+    ukv_str_view_t new_path = "new";
+    ukv_length_t new_length = 3;
+    auto new_value = reinterpret_cast<ukv_bytes_cptr_t>(new_path);
+    ukv_paths_write_t paths_write {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .tasks_count = 1,
+        .paths = &new_path,
+        .values_lengths = &new_length,
+        .values_bytes = &new_value,
+    };
+    ukv_paths_write(&paths_write);
+    EXPECT_FALSE(status);
+    status.release_error();
+
+    ukv_size_t moved_count = 0;
+    ukv_paths_migrate_t paths_migrate {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .moved_count = &moved_count,
+    };
+    ukv_paths_migrate(&paths_migrate);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(moved_count, 1u);
+    EXPECT_FALSE(*db.main().at(42).present());
+
+    ukv_paths_read(&paths_read);
+    EXPECT_TRUE(status);
+    EXPECT_TRUE(found_presences[0] & 1);
+    EXPECT_EQ(std::string_view(found_values), "value");
+    ukv_paths_write(&paths_write);
+    EXPECT_TRUE(status);
+
+    // Migrating again changes nothing
+    ukv_paths_migrate(&paths_migrate);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(moved_count, 0u);
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * Tests resuming a migration, that was interrupted after the paths were written into
+ * their new buckets, but before their outdated copies were removed.
+ * No path may be lost, and the updates made in between must survive.
+ */
+TEST(db, paths_migrate_interrupted) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    std::string bucket;
+    ukv_length_t const counters[3] {1, 6, 5};
+    bucket.append(reinterpret_cast<char const*>(counters), sizeof(counters));
+    bucket.append("legacy");
+    bucket.append("value");
+    EXPECT_TRUE(db.main().at(42).assign(value_view_t(bucket)));
+
+    arena_t arena(db);
+    status_t status;
+    ukv_size_t moved_count = 0;
+    ukv_paths_migrate_t paths_migrate {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .moved_count = &moved_count,
+    };
+    ukv_paths_migrate(&paths_migrate);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(moved_count, 1u);
+
+    // Bring back the outdated copy, as if the migration stopped right before removing it
+    EXPECT_TRUE(db.main().at(42).assign(value_view_t(bucket)));
+
+    ukv_str_view_t legacy_path = "legacy";
+    ukv_octet_t* found_presences = nullptr;
+    char* found_values = nullptr;
+    ukv_paths_read_t paths_read {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .tasks_count = 1,
+        .paths = &legacy_path,
+        .presences = &found_presences,
+        .values = reinterpret_cast<ukv_bytes_ptr_t*>(&found_values),
+    };
+    ukv_paths_read(&paths_read);
+    EXPECT_TRUE(status);
+    EXPECT_TRUE(found_presences[0] & 1);
+    EXPECT_EQ(std::string_view(found_values), "value");
+
+    ukv_str_view_t fresh_value = "fresh";
+    ukv_length_t fresh_length = 5;
+    auto fresh_bytes = reinterpret_cast<ukv_bytes_cptr_t>(fresh_value);
+    ukv_paths_write_t paths_write {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .tasks_count = 1,
+        .paths = &legacy_path,
+        .values_lengths = &fresh_length,
+        .values_bytes = &fresh_bytes,
+    };
+    ukv_paths_write(&paths_write);
+    EXPECT_TRUE(status);
+
+    // Resuming only removes the outdated copy
+    ukv_paths_migrate(&paths_migrate);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(moved_count, 1u);
+    EXPECT_FALSE(*db.main().at(42).present());
+
+    ukv_paths_read(&paths_read);
+    EXPECT_TRUE(status);
+    EXPECT_TRUE(found_presences[0] & 1);
+    EXPECT_EQ(std::string_view(found_values), "fresh");
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * Tests a single batch, that updates the same paths and buckets many times.
+ * Only the last version of every path must remain, including removals and re-insertions.
+ */
+TEST(db, paths_batched_updates) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    arena_t arena(db);
+    status_t status;
+    std::vector<std::string> keys, values;
+    std::vector<ukv_str_view_t> paths, contents;
+    auto write_all = [&] {
+        paths.resize(keys.size());
+        contents.resize(values.size());
+        for (std::size_t i = 0; i != keys.size(); ++i)
+            paths[i] = keys[i].c_str(), contents[i] = values[i].empty() ? nullptr : values[i].c_str();
+        ukv_paths_write_t paths_write {
+            .db = db,
+            .error = status.member_ptr(),
+            .arena = arena.member_ptr(),
+            .tasks_count = static_cast<ukv_size_t>(paths.size()),
+            .paths = paths.data(),
+            .paths_stride = sizeof(ukv_str_view_t),
+            .values_bytes = reinterpret_cast<ukv_bytes_cptr_t const*>(contents.data()),
+            .values_bytes_stride = sizeof(ukv_str_view_t),
+        };
+        ukv_paths_write(&paths_write);
+        EXPECT_TRUE(status);
+    };
+
+    std::size_t const count = 1000;
+    for (std::size_t i = 0; i != count; ++i)
+        keys.push_back("path" + std::to_string(i)), values.push_back("v0");
+    write_all();
+
+    // Every path is updated twice, and every third is then removed, and every ninth is re-inserted
+    keys.clear(), values.clear();
+    for (std::size_t i = 0; i != count; ++i)
+        keys.push_back("path" + std::to_string(i)), values.push_back("v1");
+    for (std::size_t i = 0; i != count; ++i)
+        keys.push_back("path" + std::to_string(i)), values.push_back(i % 3 ? "v2" : "");
+    for (std::size_t i = 0; i < count; i += 9)
+        keys.push_back("path" + std::to_string(i)), values.push_back("v3");
+    write_all();
+
+    for (std::size_t i = 0; i != count; ++i) {
+        std::string const key = "path" + std::to_string(i);
+        ukv_str_view_t key_ptr = key.c_str();
+        ukv_octet_t* found_presences = nullptr;
+        char* found_values = nullptr;
+        ukv_paths_read_t paths_read {
+            .db = db,
+            .error = status.member_ptr(),
+            .arena = arena.member_ptr(),
+            .tasks_count = 1,
+            .paths = &key_ptr,
+            .presences = &found_presences,
+            .values = reinterpret_cast<ukv_bytes_ptr_t*>(&found_values),
+        };
+        ukv_paths_read(&paths_read);
+        EXPECT_TRUE(status);
+        if (i % 9 == 0)
+            EXPECT_EQ(std::string_view(found_values), "v3");
+        else if (i % 3 == 0)
+            EXPECT_FALSE(found_presences[0] & 1);
+        else
+            EXPECT_EQ(std::string_view(found_values), "v2");
+    }
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * Tests exporting values from the "Paths" Modality without copying them out of buckets.
+ * The values must match the regular export, when sliced with offsets and lengths.
+ */
+TEST(db, paths_read_dont_copy) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    arena_t arena(db);
+    status_t status;
+    std::vector<std::string> keys, values;
+    for (std::size_t i = 0; i != 100; ++i)
+        keys.push_back("object/" + std::to_string(i)), values.push_back(std::string(i * 100, 'a' + i % 26));
+    std::vector<ukv_str_view_t> paths(keys.size()), contents(values.size());
+    std::vector<ukv_length_t> contents_lengths(values.size());
+    for (std::size_t i = 0; i != keys.size(); ++i)
+        paths[i] = keys[i].c_str(), contents[i] = values[i].c_str(),
+        contents_lengths[i] = static_cast<ukv_length_t>(values[i].size());
+    ukv_paths_write_t paths_write {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .tasks_count = static_cast<ukv_size_t>(paths.size()),
+        .paths = paths.data(),
+        .paths_stride = sizeof(ukv_str_view_t),
+        .values_lengths = contents_lengths.data(),
+        .values_lengths_stride = sizeof(ukv_length_t),
+        .values_bytes = reinterpret_cast<ukv_bytes_cptr_t const*>(contents.data()),
+        .values_bytes_stride = sizeof(ukv_str_view_t),
+    };
+    ukv_paths_write(&paths_write);
+    EXPECT_TRUE(status);
+
+    // Query every path with a missing one in the middle
+    paths.insert(paths.begin() + 50, "object/missing");
+    ukv_octet_t* found_presences = nullptr;
+    ukv_length_t* found_offsets = nullptr;
+    ukv_length_t* found_lengths = nullptr;
+    ukv_byte_t* found_values = nullptr;
+    ukv_paths_read_t paths_read {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .options = ukv_option_read_dont_copy_k,
+        .tasks_count = static_cast<ukv_size_t>(paths.size()),
+        .paths = paths.data(),
+        .paths_stride = sizeof(ukv_str_view_t),
+        .presences = &found_presences,
+        .offsets = &found_offsets,
+        .lengths = &found_lengths,
+        .values = &found_values,
+    };
+    ukv_paths_read(&paths_read);
+    EXPECT_TRUE(status);
+    for (std::size_t i = 0; i != paths.size(); ++i) {
+        if (i == 50) {
+            EXPECT_FALSE(found_presences[i / 8] & (1 << (i % 8)));
+            EXPECT_EQ(found_lengths[i], ukv_length_missing_k);
+            continue;
+        }
+        std::string const& expected = values[i < 50 ? i : i - 1];
+        EXPECT_TRUE(found_presences[i / 8] & (1 << (i % 8)));
+        std::string_view found(reinterpret_cast<char const*>(found_values) + found_offsets[i], found_lengths[i]);
+        EXPECT_EQ(found, expected);
+    }
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * Tests paginating matches in the "Paths" Modality with cursors.
+ * Every path must be exported exactly once, in the same order as with `previous` paths,
+ * and the last page must mark the cursor as exhausted.
+ */
+TEST(db, paths_cursors) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    arena_t arena(db);
+    status_t status;
+    std::vector<std::string> all_paths;
+    for (std::size_t i = 0; i != 3000; ++i)
+        all_paths.push_back("home/user" + std::to_string(i % 3) + "/file" + std::to_string(i));
+    std::vector<ukv_str_view_t> paths(all_paths.size());
+    std::transform(all_paths.begin(), all_paths.end(), paths.begin(), [](auto const& p) { return p.c_str(); });
+    ukv_paths_write_t paths_write {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .tasks_count = static_cast<ukv_size_t>(paths.size()),
+        .paths = paths.data(),
+        .paths_stride = sizeof(ukv_str_view_t),
+        .values_bytes = reinterpret_cast<ukv_bytes_cptr_t const*>(paths.data()),
+        .values_bytes_stride = sizeof(ukv_str_view_t),
+    };
+    ukv_paths_write(&paths_write);
+    EXPECT_TRUE(status);
+
+    auto match_in_pages = [&](char const* pattern, ukv_length_t page_size, ukv_size_t threads, bool use_cursors) {
+        std::vector<std::string> results;
+        ukv_paths_cursor_t cursor {};
+        while (true) {
+            std::string const previous = results.empty() ? std::string() : results.back();
+            ukv_str_view_t previous_ptr = previous.c_str();
+            ukv_length_t* results_counts = nullptr;
+            ukv_char_t* tape_begin = nullptr;
+            ukv_paths_cursor_t* next_cursors = nullptr;
+            ukv_octet_t* exhausted = nullptr;
+            ukv_paths_match_t paths_match {
+                .db = db,
+                .error = status.member_ptr(),
+                .arena = arena.member_ptr(),
+                .tasks_count = 1,
+                .match_counts_limits = &page_size,
+                .patterns = &pattern,
+                .previous = previous.empty() ? nullptr : &previous_ptr,
+                .cursors = use_cursors ? &cursor : nullptr,
+                .threads_count = threads,
+                .match_counts = &results_counts,
+                .paths_strings = &tape_begin,
+                .cursors_next = &next_cursors,
+                .cursors_exhausted = &exhausted,
+            };
+            ukv_paths_match(&paths_match);
+            EXPECT_TRUE(status);
+            strings_tape_iterator_t tape_iterator {results_counts[0], tape_begin};
+            for (; !tape_iterator.is_end(); ++tape_iterator)
+                results.emplace_back(*tape_iterator);
+            cursor = next_cursors[0];
+            if (exhausted[0] & 1) {
+                EXPECT_LE(results_counts[0], page_size);
+                return results;
+            }
+            EXPECT_EQ(results_counts[0], page_size);
+        }
+    };
+    auto expected_count = [&](std::string_view needle) {
+        return std::count_if(all_paths.begin(), all_paths.end(), [=](std::string const& path) {
+            return path.find(needle) != std::string::npos;
+        });
+    };
+
+    for (ukv_size_t threads : {1u, 4u}) {
+        auto prefixed = match_in_pages("home/user1/", 17, threads, true);
+        EXPECT_EQ(prefixed, match_in_pages("home/user1/", 17, threads, false));
+        EXPECT_EQ(prefixed.size(), expected_count("home/user1/"));
+        EXPECT_EQ(std::set<std::string>(prefixed.begin(), prefixed.end()).size(), prefixed.size());
+
+        auto matched = match_in_pages("user2/file1[0-9]*$", 10, threads, true);
+        EXPECT_EQ(matched, match_in_pages("user2/file1[0-9]*$", 10, threads, false));
+        EXPECT_EQ(matched.size(), expected_count("user2/file1"));
+        EXPECT_EQ(std::set<std::string>(matched.begin(), matched.end()).size(), matched.size());
+    }
+
+    if (ukv_supports_named_collections_k) {
+        ukv_paths_index_t paths_index {
+            .db = db,
+            .error = status.member_ptr(),
+            .arena = arena.member_ptr(),
+        };
+        ukv_paths_index(&paths_index);
+        EXPECT_TRUE(status);
+        auto indexed = match_in_pages("home/user1/", 17, 1, true);
+        EXPECT_TRUE(std::is_sorted(indexed.begin(), indexed.end()));
+        EXPECT_EQ(indexed, match_in_pages("home/user1/", 17, 1, false));
+        EXPECT_EQ(indexed.size(), expected_count("home/user1/"));
+    }
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * Tests RegEx matching in the "Paths" Modality across different numbers of threads.
+ * Results must be identical and in the same order, also when paginated, and optional
+ * parts of patterns must not be required by the literal prefilter.
+ */
+TEST(db, paths_regex_threads) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    arena_t arena(db);
+    status_t status;
+    std::vector<std::string> all_paths;
+    for (std::size_t i = 0; i != 3000; ++i)
+        all_paths.push_back("home/user" + std::to_string(i % 7) + "/color/file" + std::to_string(i));
+    all_paths.push_back("home/colour/file");
+    all_paths.push_back("home/colr/file");
+    std::vector<ukv_str_view_t> paths(all_paths.size());
+    std::transform(all_paths.begin(), all_paths.end(), paths.begin(), [](auto const& p) { return p.c_str(); });
+    ukv_paths_write_t paths_write {
+        .db = db,
+        .error = status.member_ptr(),
+        .arena = arena.member_ptr(),
+        .tasks_count = static_cast<ukv_size_t>(paths.size()),
+        .paths = paths.data(),
+        .paths_stride = sizeof(ukv_str_view_t),
+        .values_bytes = reinterpret_cast<ukv_bytes_cptr_t const*>(paths.data()),
+        .values_bytes_stride = sizeof(ukv_str_view_t),
+    };
+    ukv_paths_write(&paths_write);
+    EXPECT_TRUE(status);
+
+    auto match = [&](char const* pattern, std::string const& previous, ukv_length_t limit, ukv_size_t threads) {
+        ukv_str_view_t previous_ptr = previous.c_str();
+        ukv_length_t* results_counts = nullptr;
+        ukv_char_t* tape_begin = nullptr;
+        ukv_paths_match_t paths_match {
+            .db = db,
+            .error = status.member_ptr(),
+            .arena = arena.member_ptr(),
+            .tasks_count = 1,
+            .match_counts_limits = &limit,
+            .patterns = &pattern,
+            .previous = previous.empty() ? nullptr : &previous_ptr,
+            .threads_count = threads,
+            .match_counts = &results_counts,
+            .paths_strings = &tape_begin,
+        };
+        ukv_paths_match(&paths_match);
+        EXPECT_TRUE(status);
+        std::vector<std::string> results;
+        strings_tape_iterator_t tape_iterator {results_counts[0], tape_begin};
+        for (; !tape_iterator.is_end(); ++tape_iterator)
+            results.emplace_back(*tape_iterator);
+        return results;
+    };
+    auto match_in_pages = [&](char const* pattern, ukv_length_t page_size, ukv_size_t threads) {
+        std::vector<std::string> results;
+        while (true) {
+            auto page = match(pattern, results.empty() ? std::string() : results.back(), page_size, threads);
+            results.insert(results.end(), page.begin(), page.end());
+            if (page.size() < page_size)
+                return results;
+        }
+    };
+
+    auto single = match("user3/color/file1[0-9]+$", {}, 10000, 1);
+    EXPECT_EQ(single.size(), std::count_if(all_paths.begin(), all_paths.end(), [](std::string const& path) {
+                  return path.find("user3/color/file1") != std::string::npos;
+              }));
+    EXPECT_EQ(match("user3/color/file1[0-9]+$", {}, 10000, 4), single);
+    EXPECT_EQ(match_in_pages("user3/color/file1[0-9]+$", 17, 4), single);
+    std::vector<std::string> first_five(single.begin(), single.begin() + 5);
+    EXPECT_EQ(match("user3/color/file1[0-9]+$", {}, 5, 4), first_five);
+
+    // Optional characters and repetitions
+    EXPECT_EQ(match("home/colou?r/", {}, 10, 4).size(), 1u);
+    EXPECT_EQ(match("home/colou*r/", {}, 10, 4).size(), 1u);
+    EXPECT_EQ(match("home/colou{0,1}r/", {}, 10, 4).size(), 1u);
+    EXPECT_EQ(match("home/colo(u|)r/", {}, 10, 4).size(), 1u);
+    EXPECT_EQ(match("home/col(ou)?r/", {}, 10, 4).size(), 2u);
+    EXPECT_EQ(match("home/colou+r/|home/colr/", {}, 10, 4).size(), 2u);
+    EXPECT_EQ(match("user6/color/file2999$", {}, 10, 4).size(), 0u);
+    EXPECT_EQ(match("user[34]/color/file2999$", {}, 10, 4).size(), 1u);
+    EXPECT_TRUE(db.clear());
+}
+
 #pragma region Documents Modality
 
 std::vector<std::string> make_three_flat_docs() {
@@ -1833,6 +2432,42 @@ TEST(db, graph_remove_vertices) {
     }
 }
 
+TEST(db, graph_remove_vertices_range) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    // A chain of vertices, all of which are also connected to a separate sink
+    graph_collection_t graph = db.main<graph_collection_t>();
+    constexpr ukv_key_t chain_length_k = 3000;
+    constexpr ukv_key_t sink_k = 10000;
+    std::vector<edge_t> es;
+    for (ukv_key_t i = 0; i != chain_length_k; ++i) {
+        if (i + 1 != chain_length_k)
+            es.push_back(make_edge(2 * i, i, i + 1));
+        es.push_back(make_edge(2 * i + 1, i, sink_k));
+    }
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+
+    EXPECT_EQ(*graph.remove_vertices_range(1000, 2500), 1500u);
+    EXPECT_EQ(*graph.remove_vertices_range(1000, 2500), 0u);
+    EXPECT_FALSE(graph.remove_vertices_range(2500, 1000));
+    for (ukv_key_t i : {0, 999, 2500, 2999})
+        EXPECT_TRUE(*graph.contains(i));
+    for (ukv_key_t i : {1000, 1001, 2000, 2499})
+        EXPECT_FALSE(*graph.contains(i));
+
+    // The edges of removed vertices are gone from their neighbors
+    EXPECT_EQ(*graph.degree(999, ukv_vertex_source_k), 1u);
+    EXPECT_EQ(*graph.degree(2500, ukv_vertex_target_k), 0u);
+    EXPECT_EQ(*graph.degree(sink_k, ukv_vertex_target_k), 1500u);
+
+    // Ranges may include the sink itself
+    EXPECT_EQ(*graph.remove_vertices_range(2900, sink_k + 1), 101u);
+    EXPECT_EQ(*graph.degree(0, ukv_vertex_source_k), 1u);
+    EXPECT_EQ(*graph.degree(2899, ukv_vertex_source_k), 0u);
+}
+
 /**
  * Removes just the known list of edges, checking that vertices remain
  * in the graph, even though entirely disconnected.
@@ -1932,29 +2567,671 @@ TEST(db, graph_neighbors) {
     EXPECT_EQ(neighbors[1], 1);
 }
 
-#pragma region Vectors Modality
+/**
+ * Grows a "supernode" far beyond the size of a single page, to make it paged,
+ * and then incrementally inserts and removes its edges, checking that its
+ * neighborhood remains sorted and complete.
+ */
+TEST(db, graph_supernode) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    graph_collection_t graph = db.main<graph_collection_t>();
+
+    constexpr ukv_key_t hub_id = 0;
+    constexpr std::size_t initial_count = 10'000;
+    constexpr std::size_t final_count = 20'000;
+    constexpr std::size_t batch_size = 500;
+    auto make_spoke = [](std::size_t i) {
+        auto id = static_cast<ukv_key_t>(i + 1);
+        return i % 2 ? make_edge(id, hub_id, id) : make_edge(id, id, hub_id);
+    };
+    auto check_hub = [&](std::vector<edge_t> const& expected) {
+        EXPECT_EQ(*graph.degree(hub_id), expected.size());
+        auto found = *graph.edges(hub_id);
+        EXPECT_EQ(found.size(), expected.size());
+        std::vector<edge_t> found_sorted(found.size());
+        for (std::size_t i = 0; i != found.size(); ++i)
+            found_sorted[i] = found[i];
+        auto by_id = [](edge_t const& a, edge_t const& b) { return a.id < b.id; };
+        std::sort(found_sorted.begin(), found_sorted.end(), by_id);
+        EXPECT_TRUE(std::equal(found_sorted.begin(), found_sorted.end(), expected.begin(), expected.end()));
+
+        auto outgoing = *graph.edges(hub_id, ukv_vertex_source_k);
+        EXPECT_TRUE(std::is_sorted(outgoing.target_ids.begin(), outgoing.target_ids.end()));
+    };
+
+    std::vector<edge_t> expected;
+    for (std::size_t i = 0; i != initial_count; ++i)
+        expected.push_back(make_spoke(i));
+    EXPECT_TRUE(graph.upsert_edges(edges(expected)));
+    check_hub(expected);
+
+    // Extend in smaller batches, overflowing and splitting the last pages
+    for (std::size_t i = initial_count; i != final_count; i += batch_size) {
+        std::vector<edge_t> batch;
+        for (std::size_t j = i; j != i + batch_size; ++j)
+            batch.push_back(make_spoke(j));
+        EXPECT_TRUE(graph.upsert_edges(edges(batch)));
+        expected.insert(expected.end(), batch.begin(), batch.end());
+    }
+    check_hub(expected);
+
+    // Repeated upserts must not change anything
+    EXPECT_TRUE(graph.upsert_edges(edges(expected)));
+    check_hub(expected);
+
+    // Remove every third edge and a few spokes
+    std::vector<edge_t> removed;
+    std::vector<edge_t> remaining;
+    for (std::size_t i = 0; i != expected.size(); ++i)
+        (i % 3 == 0 ? removed : remaining).push_back(expected[i]);
+    EXPECT_TRUE(graph.remove_edges(edges(removed)));
+    check_hub(remaining);
+
+    EXPECT_TRUE(graph.remove_vertex(remaining.front().id));
+    remaining.erase(remaining.begin());
+    check_hub(remaining);
+
+    // Removing the hub disconnects everyone else
+    EXPECT_TRUE(graph.remove_vertex(hub_id));
+    EXPECT_FALSE(*graph.contains(hub_id));
+    for (std::size_t i = 0; i < remaining.size(); i += 97) {
+        ukv_key_t spoke_id = remaining[i].id;
+        EXPECT_TRUE(*graph.contains(spoke_id));
+        EXPECT_EQ(*graph.degree(spoke_id), 0u);
+    }
+}
 
 /**
- * Tests "Vector Modality", including both CRUD and more analytical approximate search
- * operations with just three distinctly different vectors in R3 space with Cosine metric.
+ * Breadth-first traversals over a small directed graph with a cycle,
+ * checking the levels with different roles, depths and limits.
  */
-TEST(db, vectors) {
+TEST(db, graph_traverse) {
     clear_environment();
     database_t db;
     EXPECT_TRUE(db.open(path()));
 
-    constexpr std::size_t dims_k = 3;
-    ukv_key_t keys[3] = {'a', 'b', 'c'};
-    float vectors[3][dims_k] = {
-        {0.3, 0.1, 0.2},
-        {0.35, 0.1, 0.2},
-        {-0.1, 0.2, 0.5},
+    graph_collection_t graph = db.main<graph_collection_t>();
+    std::vector<edge_t> es {
+        make_edge(1, 1, 2),
+        make_edge(2, 1, 3),
+        make_edge(3, 2, 4),
+        make_edge(4, 3, 4),
+        make_edge(5, 4, 5),
+        make_edge(6, 5, 1),
+    };
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+
+    using levels_t = std::vector<std::vector<ukv_key_t>>;
+    auto traverse = [&](std::vector<ukv_key_t> starts,
+                        std::size_t depth,
+                        ukv_vertex_role_t role = ukv_vertex_source_k,
+                        std::size_t limit = 0) {
+        auto traversal = graph.traverse(strided_range(starts).immutable(), depth, role, limit).throw_or_release();
+        levels_t levels;
+        for (std::size_t i = 0; i != traversal.levels(); ++i)
+            levels.emplace_back(traversal.level(i).begin(), traversal.level(i).end());
+        return levels;
     };
 
-    arena_t arena(db);
-    status_t status;
+    EXPECT_EQ(traverse({1}, 0), (levels_t {{1}}));
+    EXPECT_EQ(traverse({1}, 2), (levels_t {{1}, {2, 3}, {4}}));
+    EXPECT_EQ(traverse({1}, 10), (levels_t {{1}, {2, 3}, {4}, {5}}));
+    EXPECT_EQ(traverse({4}, 1, ukv_vertex_target_k), (levels_t {{4}, {2, 3}}));
+    EXPECT_EQ(traverse({4}, 1, ukv_vertex_role_any_k), (levels_t {{4}, {2, 3, 5}}));
+    EXPECT_EQ(traverse({4, 1, 4}, 1), (levels_t {{1, 4}, {2, 3, 5}}));
+    EXPECT_EQ(traverse({1}, 10, ukv_vertex_source_k, 3), (levels_t {{1}, {2, 3}}));
+    EXPECT_EQ(traverse({1}, 10, ukv_vertex_source_k, 2), (levels_t {{1}, {2}}));
+    EXPECT_EQ(traverse({100, 1}, 1), (levels_t {{1}, {2, 3}}));
+    EXPECT_EQ(traverse({100}, 1), (levels_t {{}}));
+}
 
-    float* vector_first_begin = &vectors[0][0];
+/**
+ * Runs whole-graph analytics on two 4-cliques, joined by a single bridge,
+ * and a separate pair of vertices.
+ */
+TEST(db, graph_analytics) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    graph_collection_t graph = db.main<graph_collection_t>();
+    std::vector<edge_t> es;
+    ukv_key_t edge_id = 100;
+    for (ukv_key_t offset : {0, 10})
+        for (ukv_key_t i = 1; i != 5; ++i)
+            for (ukv_key_t j = i + 1; j != 5; ++j)
+                es.push_back(make_edge(edge_id++, offset + i, offset + j));
+    es.push_back(make_edge(edge_id++, 4, 11));
+    es.push_back(make_edge(edge_id++, 20, 21));
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+
+    std::vector<ukv_key_t> expected_vertices {1, 2, 3, 4, 11, 12, 13, 14, 20, 21};
+    auto labels_of = [](graph_analysis_t const& analysis) {
+        return std::vector<ukv_key_t>(analysis.labels.begin(), analysis.labels.end());
+    };
+
+    for (std::size_t threads_count : {1, 3}) {
+        auto components = graph.weakly_connected_components(threads_count).throw_or_release();
+        EXPECT_EQ(std::vector<ukv_key_t>(components.vertices.begin(), components.vertices.end()), expected_vertices);
+        EXPECT_EQ(labels_of(components), (std::vector<ukv_key_t> {1, 1, 1, 1, 1, 1, 1, 1, 20, 20}));
+        EXPECT_EQ(components.scores.size(), 0u);
+
+        auto communities = graph.louvain(1, 10, 1e-7, threads_count).throw_or_release();
+        EXPECT_EQ(labels_of(communities), (std::vector<ukv_key_t> {1, 1, 1, 1, 11, 11, 11, 11, 20, 20}));
+
+        auto ranks = graph.pagerank(0.85, 100, 1e-6, threads_count).throw_or_release();
+        ASSERT_EQ(ranks.scores.size(), expected_vertices.size());
+        EXPECT_NEAR(std::accumulate(ranks.scores.begin(), ranks.scores.end(), 0.0), 1.0, 1e-4);
+        // Edges point from smaller to bigger IDs, so the sinks collect the most
+        EXPECT_LT(ranks.scores[0], ranks.scores[3]);
+        EXPECT_LT(ranks.scores[8], ranks.scores[9]);
+    }
+
+    // Results can be written back into a separate collection
+    if (ukv_supports_named_collections_k) {
+        blobs_collection_t results = *db.create("graph.ranks");
+        ukv_collection_t results_id = results;
+        ukv_graph_analyze_t graph_analyze {
+            .algorithm = ukv_graph_weakly_connected_components_k,
+            .results_collection = &results_id,
+        };
+        auto components = graph.analyze(graph_analyze).throw_or_release();
+        EXPECT_EQ(components.labels.size(), expected_vertices.size());
+
+        value_view_t label = *results[21].value();
+        ASSERT_EQ(label.size(), sizeof(ukv_key_t));
+        EXPECT_EQ(*reinterpret_cast<ukv_key_t const*>(label.data()), 20);
+    }
+
+    if (ukv_supports_named_collections_k) {
+        graph_collection_t empty = *db.create<graph_collection_t>("graph.empty");
+        auto analysis = empty.pagerank().throw_or_release();
+        EXPECT_EQ(analysis.vertices.size(), 0u);
+    }
+}
+
+TEST(db, graph_export_csr) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    graph_collection_t graph = db.main<graph_collection_t>();
+    std::vector<edge_t> es {
+        make_edge(1, 10, 20),
+        make_edge(2, 10, 30),
+        make_edge(3, 20, 30),
+        make_edge(4, 30, 10),
+        make_edge(5, 40, 40),
+    };
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+    EXPECT_TRUE(graph.upsert_vertex(50));
+
+    using ids_t = std::vector<ukv_key_t>;
+    using indexes_t = std::vector<ukv_size_t>;
+    for (std::size_t threads_count : {1, 2}) {
+        auto csr = graph.export_csr(ukv_vertex_source_k, true, threads_count).throw_or_release();
+        EXPECT_EQ(ids_t(csr.vertices.begin(), csr.vertices.end()), (ids_t {10, 20, 30, 40, 50}));
+        EXPECT_EQ(indexes_t(csr.offsets.begin(), csr.offsets.end()), (indexes_t {0, 2, 3, 4, 5, 5}));
+        EXPECT_EQ(indexes_t(csr.neighbors.begin(), csr.neighbors.end()), (indexes_t {1, 2, 2, 0, 3}));
+        EXPECT_EQ(ids_t(csr.edges.begin(), csr.edges.end()), (ids_t {1, 2, 3, 4, 5}));
+    }
+
+    auto incoming = graph.export_csr(ukv_vertex_target_k, false).throw_or_release();
+    EXPECT_EQ(incoming.edges.size(), 0u);
+    EXPECT_EQ(indexes_t(incoming.neighbors_of(2).begin(), incoming.neighbors_of(2).end()), (indexes_t {0, 1}));
+
+    // Every edge is exported from both sides, including the self-loop
+    auto both = graph.export_csr(ukv_vertex_role_any_k).throw_or_release();
+    EXPECT_EQ(both.neighbors.size(), es.size() * 2);
+    EXPECT_EQ(indexes_t(both.neighbors_of(0).begin(), both.neighbors_of(0).end()), (indexes_t {1, 2, 2}));
+    EXPECT_EQ(indexes_t(both.neighbors_of(3).begin(), both.neighbors_of(3).end()), (indexes_t {3, 3}));
+}
+
+/**
+ * Checks, that neighborhoods are stored packed, and that neighborships survive
+ * the round-trip with dense and scattered neighbor IDs, default and explicit edge IDs.
+ */
+TEST(db, graph_packed_neighborhoods) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    graph_collection_t graph = db.main<graph_collection_t>();
+    auto check_vertex = [&](ukv_key_t vertex_id, std::vector<edge_t> expected) {
+        auto by_ends = [](edge_t const& a, edge_t const& b) {
+            return std::tie(a.source_id, a.target_id, a.id) < std::tie(b.source_id, b.target_id, b.id);
+        };
+        std::sort(expected.begin(), expected.end(), by_ends);
+        EXPECT_EQ(*graph.degree(vertex_id), expected.size());
+        auto found = *graph.edges(vertex_id);
+        std::vector<edge_t> found_sorted(found.size());
+        for (std::size_t i = 0; i != found.size(); ++i)
+            found_sorted[i] = found[i];
+        std::sort(found_sorted.begin(), found_sorted.end(), by_ends);
+        EXPECT_TRUE(std::equal(found_sorted.begin(), found_sorted.end(), expected.begin(), expected.end()));
+    };
+
+    // Dense outgoing neighbors with default edge IDs, and a few incoming with explicit ones
+    constexpr ukv_key_t dense_id = 0;
+    constexpr std::size_t dense_count = 1000;
+    std::vector<edge_t> dense;
+    for (std::size_t i = 1; i <= dense_count; ++i)
+        dense.push_back(edge_t {dense_id, static_cast<ukv_key_t>(i)});
+    dense.push_back(make_edge(std::numeric_limits<ukv_key_t>::min(), -1, dense_id));
+    dense.push_back(make_edge(42, -2, dense_id));
+    dense.push_back(make_edge(43, -2, dense_id));
+    EXPECT_TRUE(graph.upsert_edges(edges(dense)));
+    check_vertex(dense_id, dense);
+
+    std::size_t const unpacked_length = 2 * sizeof(ukv_vertex_degree_t) + dense.size() * 2 * sizeof(ukv_key_t);
+    EXPECT_LT(db.main()[dense_id].value()->size(), unpacked_length / 3);
+
+    // Scattered neighbors with arbitrary edge IDs
+    constexpr ukv_key_t scattered_id = -1'000'000;
+    std::vector<edge_t> scattered;
+    for (std::size_t i = 0; i != 300; ++i) {
+        auto neighbor_id = static_cast<ukv_key_t>(i * 7919) * 1'000'000'007 - 1'500'000'000'000'000;
+        auto edge_id = static_cast<ukv_key_t>(std::hash<std::size_t> {}(i) ^ (i << 60));
+        scattered.push_back(make_edge(edge_id, scattered_id, neighbor_id));
+    }
+    scattered.push_back(make_edge(std::numeric_limits<ukv_key_t>::max() - 1, 1, scattered_id));
+    EXPECT_TRUE(graph.upsert_edges(edges(scattered)));
+    check_vertex(scattered_id, scattered);
+
+    // Updates must unpack and repack the neighborhoods
+    std::vector<edge_t> removed;
+    std::vector<edge_t> remaining;
+    for (std::size_t i = 0; i != dense.size(); ++i)
+        (i % 5 == 0 ? removed : remaining).push_back(dense[i]);
+    EXPECT_TRUE(graph.remove_edges(edges(removed)));
+    check_vertex(dense_id, remaining);
+
+    EXPECT_TRUE(graph.remove_vertex(-2));
+    remaining.erase(std::remove_if(remaining.begin(),
+                                   remaining.end(),
+                                   [](edge_t const& e) { return e.source_id == -2; }),
+                    remaining.end());
+    check_vertex(dense_id, remaining);
+}
+
+/**
+ * Samples two-hop neighborhoods of a hub vertex and generates random walks
+ * with restarts and a strong node2vec bias towards returning.
+ */
+TEST(db, graph_sampling) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    // The hub links to 100 vertices, each of which links to a single leaf
+    graph_collection_t graph = db.main<graph_collection_t>();
+    std::vector<edge_t> es;
+    for (ukv_key_t i = 1; i <= 100; ++i) {
+        es.push_back(make_edge(i, 0, i));
+        es.push_back(make_edge(1000 + i, i, 1000 + i));
+    }
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+
+    auto sample = [&](std::vector<ukv_key_t> vertices,
+                      std::vector<ukv_size_t> fanouts,
+                      ukv_vertex_role_t role,
+                      bool with_replacement = false,
+                      std::size_t seed = 42) {
+        return graph
+            .sample_neighbors(strided_range(vertices).immutable(),
+                              strided_range(fanouts).immutable(),
+                              role,
+                              with_replacement,
+                              seed)
+            .throw_or_release();
+    };
+    auto walk = [&](std::vector<ukv_key_t> starts,
+                    std::size_t length,
+                    ukv_float_t restart,
+                    ukv_float_t p,
+                    ukv_float_t q,
+                    ukv_vertex_role_t role) {
+        return graph.random_walks(strided_range(starts).immutable(), length, restart, p, q, role, 7).throw_or_release();
+    };
+
+    auto hops = sample({0, 0, 5000}, {5, 2}, ukv_vertex_source_k);
+    EXPECT_EQ(hops.hops(), 2u);
+    EXPECT_EQ(hops.hops_offsets[1], 5u);
+    EXPECT_EQ(hops.hops_offsets[2], 10u);
+    std::unordered_set<ukv_key_t> first_hop(hops.neighbors.begin(), hops.neighbors.begin() + 5);
+    EXPECT_EQ(first_hop.size(), 5u);
+    for (std::size_t i = 0; i != 5; ++i) {
+        EXPECT_EQ(hops.centers[i], 0);
+        EXPECT_EQ(hops.edges[i], hops.neighbors[i]);
+    }
+    for (std::size_t i = 5; i != 10; ++i) {
+        EXPECT_TRUE(first_hop.count(hops.centers[i]));
+        EXPECT_EQ(hops.neighbors[i], 1000 + hops.centers[i]);
+    }
+
+    // Equal seeds reproduce the samples
+    std::vector<ukv_key_t> first_sample(hops.neighbors.begin(), hops.neighbors.end());
+    auto repeated = sample({0, 0, 5000}, {5, 2}, ukv_vertex_source_k);
+    EXPECT_TRUE(std::equal(first_sample.begin(), first_sample.end(), repeated.neighbors.begin()));
+
+    auto replaced = sample({1}, {7}, ukv_vertex_source_k, true);
+    EXPECT_EQ(replaced.neighbors.size(), 7u);
+    for (ukv_key_t neighbor : replaced.neighbors)
+        EXPECT_EQ(neighbor, 1001);
+    EXPECT_EQ(sample({1}, {7}, ukv_vertex_role_any_k).neighbors.size(), 2u);
+
+    // Walks stop at the leaves, or keep restarting from the start
+    auto walks = walk({1, 2, 5000}, 4, 0, 1, 1, ukv_vertex_source_k);
+    EXPECT_EQ(walks.size(), 3u);
+    std::vector<ukv_key_t> first_walk(walks.walk(0).begin(), walks.walk(0).end());
+    EXPECT_EQ(first_walk, (std::vector<ukv_key_t> {1, 1001, ukv_key_unknown_k, ukv_key_unknown_k, ukv_key_unknown_k}));
+    EXPECT_EQ(walks.walk(2)[1], ukv_key_unknown_k);
+    for (ukv_key_t vertex : walk({2}, 4, 1, 1, 1, ukv_vertex_source_k).walk(0))
+        EXPECT_EQ(vertex, 2);
+
+    // With a tiny `p` and a huge `q` walks bounce between two vertices
+    auto bouncing = walk({1}, 6, 0, 1e-6f, 1e6f, ukv_vertex_role_any_k).walk(0);
+    for (std::size_t i = 2; i != bouncing.size(); ++i)
+        EXPECT_EQ(bouncing[i], bouncing[i - 2]);
+}
+
+/**
+ * Intersects neighborhoods of small hand-made and bigger generated vertices,
+ * that need both the block-wise and the galloping intersections.
+ */
+TEST(db, graph_intersections) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    // Triangles {1, 2, 3} and {1, 3, 4}, with a repeated edge and a self-loop
+    graph_collection_t graph = db.main<graph_collection_t>();
+    std::vector<edge_t> es {
+        make_edge(1, 1, 2),
+        make_edge(2, 1, 2),
+        make_edge(3, 2, 3),
+        make_edge(4, 3, 1),
+        make_edge(5, 3, 4),
+        make_edge(6, 4, 1),
+        make_edge(7, 2, 2),
+    };
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+
+    using ids_t = std::vector<ukv_key_t>;
+    auto common = [&](ids_t firsts, ids_t seconds, ukv_vertex_role_t role = ukv_vertex_role_any_k) {
+        auto found = graph.common_neighbors(strided_range(firsts).immutable(), strided_range(seconds).immutable(), role)
+                         .throw_or_release();
+        std::vector<ids_t> result;
+        for (std::size_t i = 0; i != firsts.size(); ++i) {
+            EXPECT_EQ(found.counts[i], found.of(i).size());
+            result.emplace_back(found.of(i).begin(), found.of(i).end());
+        }
+        return result;
+    };
+    EXPECT_EQ(common({2, 1, 1}, {4, 3, 5}), (std::vector<ids_t> {{1, 3}, {2, 4}, {}}));
+    EXPECT_EQ(common({1, 2}, {2, 4}, ukv_vertex_source_k), (std::vector<ids_t> {{2}, {}}));
+
+    ids_t vertices {1, 2, 3, 4, 5, 1};
+    auto triangles = graph.count_triangles(strided_range(vertices).immutable()).throw_or_release();
+    EXPECT_EQ(std::vector<ukv_size_t>(triangles.counts.begin(), triangles.counts.end()),
+              (std::vector<ukv_size_t> {2, 1, 2, 1, 0, 2}));
+    EXPECT_NEAR(triangles.clustering[0], 2.f / 3, 1e-6);
+    EXPECT_NEAR(triangles.clustering[1], 1.f, 1e-6);
+    EXPECT_NEAR(triangles.clustering[4], 0.f, 1e-6);
+
+    // A hub, a vertex with all the even neighbors, and a vertex with just a few
+    es.clear();
+    for (ukv_key_t i = 1; i <= 1000; ++i)
+        es.push_back(make_edge(10000 + i, 0, 100 + i));
+    for (ukv_key_t i = 1; i <= 1000; ++i)
+        es.push_back(make_edge(20000 + i, -1, 100 + i * 2));
+    es.push_back(make_edge(30000, -2, 500));
+    es.push_back(make_edge(30001, -2, 999));
+    es.push_back(make_edge(30002, -2, 5000));
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+    auto big = graph
+                   .common_neighbors(strided_range(ids_t {0, 0}).immutable(),
+                                     strided_range(ids_t {-1, -2}).immutable(),
+                                     ukv_vertex_source_k)
+                   .throw_or_release();
+    EXPECT_EQ(big.counts[0], 500u);
+    EXPECT_EQ(big.counts[1], 2u);
+    EXPECT_EQ(ids_t(big.of(1).begin(), big.of(1).end()), (ids_t {500, 999}));
+}
+
+TEST(db, graph_edges_index) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    graph_collection_t graph = db.main<graph_collection_t>();
+    if (!ukv_supports_named_collections_k) {
+        EXPECT_FALSE(graph.index_edges());
+        return;
+    }
+
+    // Edges, added before the index is built, must be picked up by it
+    std::vector<edge_t> es {
+        make_edge(1, 1, 2),
+        make_edge(2, 2, 3),
+        make_edge(3, 3, 1),
+    };
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+    std::vector<ukv_key_t> ids {1, 2, 3, 4, 5};
+    EXPECT_FALSE(graph.find_edges_by_id(strided_range(ids).immutable()));
+    EXPECT_TRUE(graph.index_edges());
+
+    using ends_t = std::vector<std::pair<ukv_key_t, ukv_key_t>>;
+    auto find = [&](std::vector<ukv_key_t> const& ids) {
+        auto found = graph.find_edges_by_id(strided_range(ids).immutable()).throw_or_release();
+        ends_t result;
+        for (std::size_t i = 0; i != ids.size(); ++i)
+            result.emplace_back(found.sources[i], found.targets[i]);
+        return result;
+    };
+    ukv_key_t const missing_k = ukv_key_unknown_k;
+    EXPECT_EQ(find(ids), (ends_t {{1, 2}, {2, 3}, {3, 1}, {missing_k, missing_k}, {missing_k, missing_k}}));
+
+    // Later updates keep the index fresh
+    es = {make_edge(4, 3, 4), make_edge(5, 4, 5), make_edge(6, 5, 1)};
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+    EXPECT_EQ(find({4, 5, 6}), (ends_t {{3, 4}, {4, 5}, {5, 1}}));
+
+    EXPECT_TRUE(graph.remove_edge(make_edge(2, 2, 3)));
+    EXPECT_EQ(find({1, 2}), (ends_t {{1, 2}, {missing_k, missing_k}}));
+
+    // Removing a vertex drops all of its edges from the index
+    EXPECT_TRUE(graph.remove_vertex(4));
+    EXPECT_EQ(find({3, 4, 5, 6}), (ends_t {{3, 1}, {missing_k, missing_k}, {missing_k, missing_k}, {5, 1}}));
+
+    // Edges with default IDs aren't indexed
+    EXPECT_TRUE(graph.upsert_edge(make_edge(ukv_default_edge_id_k, 7, 8)));
+    EXPECT_EQ(find({ukv_default_edge_id_k}), (ends_t {{missing_k, missing_k}}));
+}
+
+TEST(db, graph_degrees_index) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    graph_collection_t graph = db.main<graph_collection_t>();
+    if (!ukv_supports_named_collections_k) {
+        EXPECT_FALSE(graph.index_degrees());
+        return;
+    }
+
+    // A hub, big enough to be split into pages, and a small chain
+    constexpr ukv_key_t hub_k = 0;
+    constexpr std::size_t hub_degree_k = 10000;
+    std::vector<edge_t> es;
+    for (std::size_t i = 0; i != hub_degree_k; ++i)
+        es.push_back(make_edge(static_cast<ukv_key_t>(i), hub_k, static_cast<ukv_key_t>(100000 + i)));
+    es.push_back(make_edge(ukv_default_edge_id_k, 1, 2));
+    es.push_back(make_edge(ukv_default_edge_id_k, 2, 3));
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+
+    using degrees_t = std::vector<ukv_vertex_degree_t>;
+    std::vector<ukv_key_t> const vertices {hub_k, 1, 2, 3, 100000, 4};
+    auto degrees = [&](ukv_vertex_role_t role) {
+        std::vector<ukv_vertex_role_t> roles(vertices.size(), role);
+        auto found = graph.degrees(strided_range(vertices).immutable(), strided_range(roles).immutable());
+        return degrees_t(found->begin(), found->end());
+    };
+    auto all_degrees = [&] {
+        return std::vector<degrees_t> {
+            degrees(ukv_vertex_source_k),
+            degrees(ukv_vertex_target_k),
+            degrees(ukv_vertex_role_any_k),
+        };
+    };
+    // Missing vertices are reported the same way with and without the index
+    ukv_vertex_degree_t const missing_k = degrees(ukv_vertex_role_any_k).back();
+    auto const before = all_degrees();
+    EXPECT_EQ(before[0], (degrees_t {hub_degree_k, 1, 1, 0, 0, missing_k}));
+    EXPECT_EQ(before[1], (degrees_t {0, 0, 1, 1, 1, missing_k}));
+
+    // Vertices, added before the index is built, must be picked up by it
+    EXPECT_TRUE(graph.index_degrees());
+    EXPECT_EQ(all_degrees(), before);
+
+    // Later updates keep the index fresh
+    EXPECT_TRUE(graph.upsert_edges(edges(std::vector<edge_t> {make_edge(5, 3, 4), make_edge(6, 4, hub_k)})));
+    EXPECT_EQ(degrees(ukv_vertex_source_k), (degrees_t {hub_degree_k, 1, 1, 1, 0, 1}));
+    EXPECT_EQ(degrees(ukv_vertex_target_k), (degrees_t {1, 0, 1, 1, 1, 1}));
+
+    EXPECT_TRUE(graph.remove_edge(make_edge(0, hub_k, 100000)));
+    EXPECT_EQ(degrees(ukv_vertex_role_any_k), (degrees_t {hub_degree_k, 1, 2, 2, 0, 2}));
+
+    // Removed vertices lose their degrees, and their neighbors are updated
+    EXPECT_TRUE(graph.remove_vertex(2));
+    EXPECT_EQ(degrees(ukv_vertex_role_any_k), (degrees_t {hub_degree_k, 0, missing_k, 1, 0, 2}));
+
+    // Vertices without edges have zero degrees
+    EXPECT_TRUE(graph.upsert_vertex(2));
+    EXPECT_EQ(degrees(ukv_vertex_role_any_k), (degrees_t {hub_degree_k, 0, 0, 1, 0, 2}));
+}
+
+TEST(db, graph_stream_batches) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    // Vertices without outgoing edges form whole batches of their own
+    graph_collection_t graph = db.main<graph_collection_t>();
+    constexpr std::size_t edges_count = 1000;
+    std::vector<edge_t> es;
+    for (std::size_t i = 0; i != edges_count; ++i)
+        es.push_back(make_edge(static_cast<ukv_key_t>(i), static_cast<ukv_key_t>(i), 10000 + i));
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+
+    for (std::size_t read_ahead : {1ul, 256ul, 4096ul}) {
+        std::vector<ukv_key_t> ids;
+        auto stream = graph.edges(ukv_vertex_source_k, read_ahead).throw_or_release();
+        for (auto it = std::move(stream).begin(); !it.is_end(); ++it) {
+            EXPECT_EQ((*it).target_id, (*it).source_id + 10000);
+            ids.push_back((*it).id);
+        }
+        EXPECT_EQ(ids.size(), edges_count);
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(std::unique(ids.begin(), ids.end()) - ids.begin(), static_cast<std::ptrdiff_t>(edges_count));
+    }
+
+    // Seeking back, while the next batch is being gathered
+    graph_stream_t stream(db, ukv_collection_main_k, nullptr, 256, ukv_vertex_source_k);
+    EXPECT_TRUE(stream.seek_to_first());
+    EXPECT_TRUE(stream.seek(500));
+    EXPECT_EQ(stream.edge().source_id, 500);
+}
+
+TEST(db, graph_shortest_paths) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    using ids_t = std::vector<ukv_key_t>;
+    using distances_t = std::vector<ukv_float_t>;
+    graph_collection_t graph = db.main<graph_collection_t>();
+    ukv_float_t const inf = std::numeric_limits<ukv_float_t>::infinity();
+    auto paths = [&](ids_t sources, ukv_vertex_role_t role, ukv_float_t max_distance = 0) {
+        return graph.shortest_paths(strided_range(sources).immutable(), role, max_distance).throw_or_release();
+    };
+    auto distances = [](shortest_paths_t const& found, std::size_t i) {
+        auto range = found.distances_from(i);
+        return distances_t(range.begin(), range.end());
+    };
+
+    // Without weights, distances are hop counts
+    std::vector<edge_t> es {
+        make_edge(ukv_default_edge_id_k, 1, 2),
+        make_edge(ukv_default_edge_id_k, 2, 3),
+        make_edge(ukv_default_edge_id_k, 1, 3),
+    };
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+    auto hops = paths({1, 3, 7}, ukv_vertex_source_k);
+    EXPECT_EQ(ids_t(hops.vertices.begin(), hops.vertices.end()), (ids_t {1, 2, 3}));
+    EXPECT_EQ(distances(hops, 0), (distances_t {0, 1, 1}));
+    EXPECT_EQ(distances(hops, 1), (distances_t {inf, inf, 0}));
+    EXPECT_EQ(distances(hops, 2), (distances_t {inf, inf, inf}));
+    EXPECT_EQ(distances(paths({3}, ukv_vertex_target_k), 0), (distances_t {1, 1, 0}));
+    EXPECT_EQ(distances(paths({3}, ukv_vertex_role_any_k), 0), (distances_t {1, 1, 0}));
+
+    std::vector<ukv_float_t> ws {1, 1, 5, 2};
+    es = {make_edge(1, 1, 2), make_edge(2, 2, 3), make_edge(3, 1, 3), make_edge(4, 3, 4)};
+    EXPECT_TRUE(db.clear());
+    if (!ukv_supports_named_collections_k) {
+        EXPECT_FALSE(graph.upsert_edges(edges(es), strided_range(ws).immutable()));
+        return;
+    }
+
+    // Weighted edges need IDs and non-negative weights
+    std::vector<edge_t> unnamed {make_edge(ukv_default_edge_id_k, 1, 2)};
+    std::vector<ukv_float_t> negative {-1};
+    EXPECT_FALSE(graph.upsert_edges(edges(unnamed), strided_range(ws).immutable()));
+    EXPECT_FALSE(graph.upsert_edges(edges(es), strided_range(negative).immutable()));
+
+    EXPECT_TRUE(graph.upsert_edges(edges(es), strided_range(ws).immutable()));
+    auto weighted = paths({1}, ukv_vertex_source_k);
+    EXPECT_EQ(distances(weighted, 0), (distances_t {0, 1, 2, 4}));
+    EXPECT_EQ(ids_t(weighted.predecessors.begin(), weighted.predecessors.end()),
+              (ids_t {ukv_key_unknown_k, 1, 2, 3}));
+    EXPECT_EQ(ids_t(weighted.predecessors_edges.begin(), weighted.predecessors_edges.end()),
+              (ids_t {ukv_key_unknown_k, 1, 2, 4}));
+    EXPECT_EQ(distances(paths({1}, ukv_vertex_source_k, 3), 0), (distances_t {0, 1, 2, inf}));
+
+    // Removed edges take their weights with them
+    EXPECT_TRUE(graph.remove_edge(make_edge(2, 2, 3)));
+    EXPECT_EQ(distances(paths({1}, ukv_vertex_source_k), 0), (distances_t {0, 1, 5, 7}));
+    EXPECT_TRUE(graph.remove_vertex(1));
+    EXPECT_TRUE(graph.upsert_edges(edges(es)));
+    EXPECT_EQ(distances(paths({1}, ukv_vertex_source_k), 0), (distances_t {0, 1, 1, 3}));
+}
+
+#pragma region Vectors Modality
+
+/**
+ * Tests "Vector Modality", including both CRUD and more analytical approximate search
+ * operations with just three distinctly different vectors in R3 space with Cosine metric.
+ */
+TEST(db, vectors) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    constexpr std::size_t dims_k = 3;
+    ukv_key_t keys[3] = {'a', 'b', 'c'};
+    float vectors[3][dims_k] = {
+        {0.3, 0.1, 0.2},
+        {0.35, 0.1, 0.2},
+        {-0.1, 0.2, 0.5},
+    };
+
+    arena_t arena(db);
+    status_t status;
+
+    float* vector_first_begin = &vectors[0][0];
     ukv_vectors_write_t write {};
     write.db = db;
     write.arena = arena.member_ptr();
@@ -1993,6 +3270,367 @@ TEST(db, vectors) {
     EXPECT_EQ(found_keys[1], ukv_key_t('b'));
 }
 
+/**
+ * Tests that "Vector Modality" keeps the originals intact, even for the zero key,
+ * storing the quantized copies outside of the user-facing collection.
+ */
+TEST(db, vectors_zero_key) {
+
+    if (!ukv_supports_named_collections_k)
+        return;
+
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    constexpr std::size_t dims_k = 3;
+    ukv_key_t keys[2] = {0, 1};
+    float vectors[2][dims_k] = {
+        {0.3, 0.1, 0.2},
+        {-0.1, 0.2, 0.5},
+    };
+
+    arena_t arena(db);
+    status_t status;
+
+    float* vector_first_begin = &vectors[0][0];
+    ukv_vectors_write_t write {};
+    write.db = db;
+    write.arena = arena.member_ptr();
+    write.error = status.member_ptr();
+    write.dimensions = dims_k;
+    write.keys = keys;
+    write.keys_stride = sizeof(ukv_key_t);
+    write.vectors_starts = (ukv_bytes_cptr_t*)&vector_first_begin;
+    write.vectors_stride = sizeof(float) * dims_k;
+    write.tasks_count = 2;
+    ukv_vectors_write(&write);
+    EXPECT_TRUE(status);
+
+    blobs_collection_t collection = db.main();
+    EXPECT_EQ(collection.keys().size(), 2ul);
+    auto maybe_original = collection[0].value();
+    EXPECT_TRUE(maybe_original);
+    EXPECT_EQ(maybe_original->size(), sizeof(float) * dims_k);
+    EXPECT_EQ(std::memcmp(maybe_original->data(), vectors[0], sizeof(float) * dims_k), 0);
+
+    ukv_length_t max_results = 1;
+    ukv_length_t* found_results = nullptr;
+    ukv_key_t* found_keys = nullptr;
+    ukv_vectors_search_t search {};
+    search.db = db;
+    search.arena = arena.member_ptr();
+    search.error = status.member_ptr();
+    search.dimensions = dims_k;
+    search.tasks_count = 1;
+    search.match_counts_limits = &max_results;
+    search.queries_starts = (ukv_bytes_cptr_t*)&vector_first_begin;
+    search.queries_stride = sizeof(float) * dims_k;
+    search.match_counts = &found_results;
+    search.match_keys = &found_keys;
+    search.metric = ukv_vector_metric_cos_k;
+    ukv_vectors_search(&search);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(found_results[0], 1u);
+    EXPECT_EQ(found_keys[0], 0);
+}
+
+TEST(db, vectors_read) {
+
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    constexpr std::size_t dims_k = 3;
+    ukv_key_t keys[3] = {1, 2, 3};
+    float vectors[2][dims_k] = {
+        {0.3, 0.1, 0.2},
+        {-0.1, 0.2, 0.5},
+    };
+
+    arena_t arena(db);
+    status_t status;
+
+    float* vector_first_begin = &vectors[0][0];
+    ukv_vectors_write_t write {};
+    write.db = db;
+    write.arena = arena.member_ptr();
+    write.error = status.member_ptr();
+    write.dimensions = dims_k;
+    write.keys = keys;
+    write.keys_stride = sizeof(ukv_key_t);
+    write.vectors_starts = (ukv_bytes_cptr_t*)&vector_first_begin;
+    write.vectors_stride = sizeof(float) * dims_k;
+    write.tasks_count = 2;
+    ukv_vectors_write(&write);
+    EXPECT_TRUE(status);
+
+    // The last key is missing, so its row must be zeroed
+    ukv_octet_t* found_presences = nullptr;
+    ukv_length_t* found_offsets = nullptr;
+    ukv_byte_t* found_vectors = nullptr;
+    ukv_vectors_read_t read {};
+    read.db = db;
+    read.arena = arena.member_ptr();
+    read.error = status.member_ptr();
+    read.dimensions = dims_k;
+    read.tasks_count = 3;
+    read.keys = keys;
+    read.keys_stride = sizeof(ukv_key_t);
+    read.presences = &found_presences;
+    read.offsets = &found_offsets;
+    read.vectors = &found_vectors;
+    ukv_vectors_read(&read);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(found_vectors) % 64, 0u);
+    EXPECT_EQ(found_presences[0] & 0b111, 0b011);
+    EXPECT_EQ(found_offsets[3], sizeof(float) * dims_k * 3);
+    EXPECT_EQ(std::memcmp(found_vectors, vectors, sizeof(vectors)), 0);
+    float const* missing_row = reinterpret_cast<float const*>(found_vectors + found_offsets[2]);
+    EXPECT_EQ(missing_row[0], 0.f);
+    EXPECT_EQ(missing_row[2], 0.f);
+
+    read.scalar_type = ukv_vector_scalar_f64_k;
+    ukv_vectors_read(&read);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(found_offsets[1], sizeof(double) * dims_k);
+    double const* doubles = reinterpret_cast<double const*>(found_vectors);
+    for (std::size_t i = 0; i != 2 * dims_k; ++i)
+        EXPECT_EQ(doubles[i], double(vectors[i / dims_k][i % dims_k]));
+
+    read.scalar_type = ukv_vector_scalar_f16_k;
+    ukv_vectors_read(&read);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(reinterpret_cast<std::uint16_t const*>(found_vectors)[dims_k + 2], 0x3800); // 0.5
+
+    // Without the original, the row is recovered from the quantized copy
+    if (!ukv_supports_named_collections_k)
+        return;
+    blobs_collection_t collection = db.main();
+    EXPECT_TRUE(collection[keys[1]].erase());
+    read.scalar_type = ukv_vector_scalar_f32_k;
+    ukv_vectors_read(&read);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(found_presences[0] & 0b111, 0b011);
+    float const* recovered = reinterpret_cast<float const*>(found_vectors + found_offsets[1]);
+    for (std::size_t i = 0; i != dims_k; ++i)
+        EXPECT_NEAR(recovered[i], vectors[1][i], 0.011f);
+}
+
+/**
+ * Tests Product-Quantization of "Vector Modality" with L2 metric on four
+ * well-separated clusters. Every query must find itself among the originals
+ * after re-ranking, including the vectors added after the codebook was trained.
+ */
+TEST(db, vectors_pq) {
+
+    if (!ukv_supports_named_collections_k)
+        return;
+
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    constexpr std::size_t dims_k = 8;
+    constexpr std::size_t count_k = 256;
+    std::vector<ukv_key_t> keys(count_k);
+    std::vector<float> vectors(count_k * dims_k);
+    std::mt19937 random_generator(42);
+    std::normal_distribution<float> noise(0, 0.05f);
+    for (std::size_t i = 0; i != count_k; ++i) {
+        keys[i] = static_cast<ukv_key_t>(i + 1);
+        for (std::size_t d = 0; d != dims_k; ++d)
+            vectors[i * dims_k + d] = (d % 4 == i % 4 ? 1.f : 0.f) + noise(random_generator);
+    }
+
+    arena_t arena(db);
+    status_t status;
+
+    float const* vectors_begin = vectors.data();
+    ukv_vectors_write_t write {};
+    write.db = db;
+    write.arena = arena.member_ptr();
+    write.error = status.member_ptr();
+    write.dimensions = dims_k;
+    write.keys = keys.data();
+    write.keys_stride = sizeof(ukv_key_t);
+    write.vectors_starts = (ukv_bytes_cptr_t*)&vectors_begin;
+    write.vectors_stride = sizeof(float) * dims_k;
+    write.tasks_count = count_k;
+    ukv_vectors_write(&write);
+    EXPECT_TRUE(status);
+
+    ukv_vectors_train_t train {};
+    train.db = db;
+    train.arena = arena.member_ptr();
+    train.error = status.member_ptr();
+    train.dimensions = dims_k;
+    train.metric = ukv_vector_metric_l2_k;
+    train.subspaces = 4;
+    ukv_vectors_train(&train);
+    EXPECT_TRUE(status);
+
+    // Add one more vector, that will be encoded with the existing codebook
+    float fresh[dims_k] = {0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.1f};
+    float const* fresh_begin = fresh;
+    ukv_key_t fresh_key = count_k + 1;
+    write.keys = &fresh_key;
+    write.vectors_starts = (ukv_bytes_cptr_t*)&fresh_begin;
+    write.tasks_count = 1;
+    ukv_vectors_write(&write);
+    EXPECT_TRUE(status);
+
+    ukv_length_t max_results = 4;
+    ukv_length_t* found_results = nullptr;
+    ukv_key_t* found_keys = nullptr;
+    ukv_float_t* found_distances = nullptr;
+    ukv_vectors_search_t search {};
+    search.db = db;
+    search.arena = arena.member_ptr();
+    search.error = status.member_ptr();
+    search.dimensions = dims_k;
+    search.tasks_count = 1;
+    search.match_counts_limits = &max_results;
+    search.queries_stride = sizeof(float) * dims_k;
+    search.match_counts = &found_results;
+    search.match_keys = &found_keys;
+    search.match_metrics = &found_distances;
+    search.metric = ukv_vector_metric_l2_k;
+
+    for (std::size_t i : {0ul, 5ul, 130ul}) {
+        float const* query_begin = vectors.data() + i * dims_k;
+        search.queries_starts = (ukv_bytes_cptr_t*)&query_begin;
+        ukv_vectors_search(&search);
+        EXPECT_TRUE(status);
+        EXPECT_EQ(found_results[0], max_results);
+        EXPECT_EQ(found_keys[0], keys[i]);
+        EXPECT_FLOAT_EQ(found_distances[0], 0.f);
+        for (std::size_t j = 1; j != max_results; ++j) {
+            EXPECT_EQ(found_keys[j] % 4, keys[i] % 4);
+            EXPECT_LE(found_distances[j - 1], found_distances[j]);
+        }
+    }
+
+    search.queries_starts = (ukv_bytes_cptr_t*)&fresh_begin;
+    ukv_vectors_search(&search);
+    EXPECT_TRUE(status);
+    EXPECT_EQ(found_keys[0], fresh_key);
+}
+
+/**
+ * Tests filtered search in "Vector Modality" over unit vectors on a half-circle,
+ * limiting matches with key ranges, allow-lists and document fields,
+ * both before and after Product-Quantization.
+ */
+TEST(db, vectors_filtered) {
+    clear_environment();
+    database_t db;
+    EXPECT_TRUE(db.open(path()));
+
+    constexpr std::size_t dims_k = 2;
+    constexpr std::size_t count_k = 32;
+    std::vector<ukv_key_t> keys(count_k);
+    std::vector<float> vectors(count_k * dims_k);
+    for (std::size_t i = 0; i != count_k; ++i) {
+        keys[i] = static_cast<ukv_key_t>(i + 1);
+        vectors[i * dims_k + 0] = std::cos(0.087f * i);
+        vectors[i * dims_k + 1] = std::sin(0.087f * i);
+    }
+
+    arena_t arena(db);
+    status_t status;
+
+    float const* vectors_begin = vectors.data();
+    ukv_vectors_write_t write {};
+    write.db = db;
+    write.arena = arena.member_ptr();
+    write.error = status.member_ptr();
+    write.dimensions = dims_k;
+    write.keys = keys.data();
+    write.keys_stride = sizeof(ukv_key_t);
+    write.vectors_starts = (ukv_bytes_cptr_t*)&vectors_begin;
+    write.vectors_stride = sizeof(float) * dims_k;
+    write.tasks_count = count_k;
+    ukv_vectors_write(&write);
+    EXPECT_TRUE(status);
+
+    ukv_length_t max_results = 3;
+    ukv_length_t* found_results = nullptr;
+    ukv_key_t* found_keys = nullptr;
+    ukv_vectors_search_t search {};
+    search.db = db;
+    search.arena = arena.member_ptr();
+    search.error = status.member_ptr();
+    search.dimensions = dims_k;
+    search.tasks_count = 1;
+    search.match_counts_limits = &max_results;
+    search.queries_starts = (ukv_bytes_cptr_t*)&vectors_begin;
+    search.queries_stride = sizeof(float) * dims_k;
+    search.match_counts = &found_results;
+    search.match_keys = &found_keys;
+    search.metric = ukv_vector_metric_cos_k;
+
+    auto expect_found = [&](std::vector<ukv_key_t> expected) {
+        ukv_vectors_search(&search);
+        EXPECT_TRUE(status);
+        EXPECT_EQ(found_results[0], expected.size());
+        EXPECT_EQ(std::vector<ukv_key_t>(found_keys, found_keys + found_results[0]), expected);
+    };
+
+    std::optional<docs_collection_t> docs;
+    if (ukv_supports_named_collections_k) {
+        docs = *db.create<docs_collection_t>("vectors.meta");
+        for (std::size_t i = 0; i != count_k; ++i) {
+            auto json = "{\"year\":" + std::to_string(2000 + keys[i]) + "}";
+            (*docs)[keys[i]] = json.c_str();
+        }
+    }
+
+    auto expect_filters = [&]() {
+        expect_found({1, 2, 3});
+
+        ukv_key_t start_key = 4, end_key = 7;
+        search.start_keys = &start_key;
+        search.end_keys = &end_key;
+        expect_found({4, 5, 6});
+        search.start_keys = nullptr;
+        search.end_keys = nullptr;
+
+        ukv_key_t allowed_keys[4] = {2, 9, 17, 30};
+        search.allowed_keys = allowed_keys;
+        search.allowed_keys_count = 4;
+        expect_found({2, 9, 17});
+        search.end_keys = &end_key;
+        expect_found({2});
+        search.end_keys = nullptr;
+        search.allowed_keys = nullptr;
+        search.allowed_keys_count = 0;
+
+        if (!docs)
+            return;
+        search.filter_collection = *docs;
+        search.filter_field = "year";
+        search.filter_min = 2010;
+        search.filter_max = 2011;
+        expect_found({10, 11});
+        search.filter_field = nullptr;
+    };
+
+    expect_filters();
+    if (!ukv_supports_named_collections_k)
+        return;
+
+    ukv_vectors_train_t train {};
+    train.db = db;
+    train.arena = arena.member_ptr();
+    train.error = status.member_ptr();
+    train.dimensions = dims_k;
+    train.metric = ukv_vector_metric_cos_k;
+    ukv_vectors_train(&train);
+    EXPECT_TRUE(status);
+    expect_filters();
+}
+
 int main(int argc, char** argv) {
 
 #if defined(UKV_FLIGHT_CLIENT)
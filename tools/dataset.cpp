@@ -1 +1,533 @@
+/**
+ * @file dataset.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Bulk imports and exports of graphs from and into files on disk.
+ *
+ * Parquet and CSV files are read with Arrow Datasets, decoding batches on its
+ * own thread-pool, while NDJSON files are parsed with simdjson, a thread per file.
+ * Edges are accumulated in memory, sorted by source and target and upserted in
+ * big batches, so that every neighborhood is rewritten once per batch. Batches
+ * are flushed on a separate thread, while the next one is being read.
+ *
+ * Exports stream vertices in key order, ending a Parquet row group, whenever
+ * `max_batch_size` bytes of edges were written.
+ */
+#include <algorithm>  // `std::sort`
+#include <atomic>     // `std::atomic_size_t`
+#include <cinttypes>  // `PRId64`
+#include <cstdio>     // `std::fprintf`
+#include <filesystem> // `std::filesystem::recursive_directory_iterator`
+#include <limits>     // `std::numeric_limits`
+#include <mutex>      // `std::mutex`
+#include <regex>      // `std::regex_match`
+#include <stdexcept>  // `std::invalid_argument`
+#include <thread>     // `std::thread`
+#include <vector>     // `std::vector`
 
+#include <arrow/compute/api.h>      // `arrow::compute::Cast`
+#include <arrow/dataset/api.h>      // `arrow::dataset::FileSystemDatasetFactory`
+#include <arrow/dataset/file_csv.h> // `arrow::dataset::CsvFileFormat`
+#include <arrow/filesystem/api.h>   // `arrow::fs::LocalFileSystem`
+#include <arrow/io/file.h>          // `arrow::io::FileOutputStream`
+#include <parquet/stream_writer.h>  // `parquet::StreamWriter`
+#include <simdjson.h>
+
+#include "ukv/blobs.h"
+#include "ukv/graph.h"
+#include "ukv/cpp/types.hpp" // `edge_t`
+#include "dataset.h"
+
+namespace fs = std::filesystem;
+namespace ds = arrow::dataset;
+namespace sj = simdjson;
+
+using namespace unum::ukv;
+
+/// Rows requested from Arrow in every decoded batch.
+constexpr std::int64_t arrow_batch_rows_k = 64 * 1024;
+/// Edges parsed from NDJSON before being passed to the `edges_batcher_t`.
+constexpr std::size_t ndjson_batch_edges_k = 64 * 1024;
+/// Vertices exported per scan.
+constexpr ukv_length_t export_batch_vertices_k = 4 * 1024;
+
+/**
+ * @brief Accumulates edges, appended from many threads, and upserts them in sorted batches
+ * of `max_batch_size` bytes. Only one batch is upserted at a time, on a background thread.
+ */
+class edges_batcher_t {
+    ukv_graph_import_t const& c_;
+    std::size_t capacity_ = 0;
+
+    std::mutex mutex_;
+    std::vector<edge_t> pending_;
+    std::vector<edge_t> flushing_;
+    std::thread flusher_;
+    /// Only touched by the `flusher_`, until it is joined.
+    ukv_error_t flusher_error_ = nullptr;
+    ukv_error_t flush_error_ = nullptr;
+    ukv_arena_t arena_ = nullptr;
+
+    void flush() noexcept {
+        try {
+            std::sort(flushing_.begin(), flushing_.end(), [](edge_t const& a, edge_t const& b) {
+                return a.source_id != b.source_id   ? a.source_id < b.source_id
+                       : a.target_id != b.target_id ? a.target_id < b.target_id
+                                                    : a.id < b.id;
+            });
+        }
+        catch (...) {
+            flusher_error_ = "Failed to sort imported edges";
+            return;
+        }
+
+        ukv_graph_upsert_edges_t upsert {
+            .db = c_.db,
+            .error = &flusher_error_,
+            .arena = &arena_,
+            .options = c_.options,
+            .tasks_count = flushing_.size(),
+            .collections = &c_.collection,
+            .edges_ids = &flushing_[0].id,
+            .edges_stride = sizeof(edge_t),
+            .sources_ids = &flushing_[0].source_id,
+            .sources_stride = sizeof(edge_t),
+            .targets_ids = &flushing_[0].target_id,
+            .targets_stride = sizeof(edge_t),
+        };
+        ukv_graph_upsert_edges(&upsert);
+        if (!flusher_error_ && c_.callback)
+            c_.callback(c_.callback_payload);
+    }
+
+    /**
+     * @brief Waits for the previous batch and starts flushing the pending one. Expects the lock.
+     */
+    void start_flush() {
+        join();
+        if (flush_error_ || pending_.empty())
+            return;
+        std::swap(flushing_, pending_);
+        pending_.clear();
+        flusher_ = std::thread(&edges_batcher_t::flush, this);
+    }
+
+    void join() {
+        if (!flusher_.joinable())
+            return;
+        flusher_.join();
+        flush_error_ = flusher_error_;
+    }
+
+  public:
+    edges_batcher_t(ukv_graph_import_t const& c) noexcept
+        : c_(c), capacity_(std::max<std::size_t>(c.max_batch_size / sizeof(edge_t), 1)) {}
+    edges_batcher_t(edges_batcher_t const&) = delete;
+    ~edges_batcher_t() {
+        if (flusher_.joinable())
+            flusher_.join();
+        ukv_arena_free(arena_);
+    }
+
+    /**
+     * @return Error of the last upsert, if any, so that the readers can stop early.
+     */
+    ukv_error_t append(edge_t const* edges, std::size_t count) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if (flush_error_)
+            return flush_error_;
+        pending_.reserve(std::min(capacity_, pending_.size() + count));
+        pending_.insert(pending_.end(), edges, edges + count);
+        if (pending_.size() >= capacity_)
+            start_flush();
+        return flush_error_;
+    }
+
+    ukv_error_t finish() {
+        std::lock_guard<std::mutex> lock {mutex_};
+        start_flush();
+        join();
+        return flush_error_;
+    }
+};
+
+/**
+ * @brief Splits the `pattern` into the longest directory prefix without special characters,
+ * where the search starts, and lists all the files, whose complete paths match the pattern.
+ */
+std::vector<std::string> matching_paths(std::string const& pattern) {
+    std::size_t const first_special = pattern.find_first_of("\\^$.|?*+()[]{}");
+    std::size_t const last_slash = pattern.rfind('/', first_special);
+    fs::path root = last_slash == std::string::npos ? fs::path(".")
+                    : last_slash == 0               ? fs::path("/")
+                                                    : fs::path(pattern.substr(0, last_slash));
+
+    std::regex const regex {pattern};
+    std::vector<std::string> paths;
+    auto opts = fs::directory_options::follow_directory_symlink;
+    for (auto const& entry : fs::recursive_directory_iterator(root, opts))
+        if (entry.is_regular_file() && std::regex_match(entry.path().string(), regex))
+            paths.push_back(entry.path().string());
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+arrow::Result<std::shared_ptr<arrow::Int64Array>> int64_column(std::shared_ptr<arrow::Array> const& array) {
+    if (array->type_id() == arrow::Type::INT64)
+        return std::static_pointer_cast<arrow::Int64Array>(array);
+    ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Array> casted, arrow::compute::Cast(*array, arrow::int64()));
+    return std::static_pointer_cast<arrow::Int64Array>(casted);
+}
+
+/**
+ * @brief Reads the files of a single `format`, passing every decoded batch to the `batcher`.
+ * Rows with missing source or target IDs are skipped.
+ */
+arrow::Status import_arrow( //
+    ukv_graph_import_t const& c,
+    std::vector<std::string> const& paths,
+    std::shared_ptr<ds::FileFormat> format,
+    edges_batcher_t& batcher) {
+
+    auto filesystem = std::make_shared<arrow::fs::LocalFileSystem>();
+    ARROW_ASSIGN_OR_RAISE(auto factory,
+                          ds::FileSystemDatasetFactory::Make(filesystem, paths, format, ds::FileSystemFactoryOptions {}));
+    ARROW_ASSIGN_OR_RAISE(auto dataset, factory->Finish());
+
+    bool const has_edges = c.edge_id_field && dataset->schema()->GetFieldIndex(c.edge_id_field) != -1;
+    std::vector<std::string> columns {c.source_id_field, c.target_id_field};
+    if (has_edges)
+        columns.emplace_back(c.edge_id_field);
+
+    ARROW_ASSIGN_OR_RAISE(auto builder, dataset->NewScan());
+    ARROW_RETURN_NOT_OK(builder->Project(columns));
+    ARROW_RETURN_NOT_OK(builder->UseThreads(true));
+    ARROW_RETURN_NOT_OK(builder->BatchSize(arrow_batch_rows_k));
+    ARROW_ASSIGN_OR_RAISE(auto scanner, builder->Finish());
+    ARROW_ASSIGN_OR_RAISE(auto reader, scanner->ToRecordBatchReader());
+
+    std::vector<edge_t> edges;
+    while (true) {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        ARROW_RETURN_NOT_OK(reader->ReadNext(&batch));
+        if (!batch)
+            return arrow::Status::OK();
+
+        ARROW_ASSIGN_OR_RAISE(auto sources, int64_column(batch->column(0)));
+        ARROW_ASSIGN_OR_RAISE(auto targets, int64_column(batch->column(1)));
+        std::shared_ptr<arrow::Int64Array> ids;
+        if (has_edges) {
+            ARROW_ASSIGN_OR_RAISE(ids, int64_column(batch->column(2)));
+        }
+
+        edges.clear();
+        edges.reserve(batch->num_rows());
+        for (std::int64_t i = 0; i != batch->num_rows(); ++i) {
+            if (sources->IsNull(i) || targets->IsNull(i))
+                continue;
+            edge_t edge {sources->Value(i), targets->Value(i)};
+            if (ids && !ids->IsNull(i))
+                edge.id = ids->Value(i);
+            edges.push_back(edge);
+        }
+        if (batcher.append(edges.data(), edges.size()))
+            return arrow::Status::Cancelled("Upsert failed");
+    }
+}
+
+void import_ndjson( //
+    ukv_graph_import_t const& c,
+    std::string const& path,
+    edges_batcher_t& batcher,
+    ukv_error_t* c_error) {
+
+    sj::padded_string json;
+    if (sj::padded_string::load(path).get(json)) {
+        *c_error = "Failed to read an NDJSON file";
+        return;
+    }
+
+    sj::ondemand::parser parser;
+    sj::ondemand::document_stream docs;
+    if (parser.iterate_many(json).get(docs)) {
+        *c_error = "Failed to parse an NDJSON file";
+        return;
+    }
+
+    std::vector<edge_t> edges;
+    edges.reserve(ndjson_batch_edges_k);
+    for (auto doc : docs) {
+        sj::ondemand::object object;
+        std::int64_t source = 0, target = 0, id = 0;
+        if (doc.get_object().get(object) || //
+            object[c.source_id_field].get_int64().get(source) ||
+            object[c.target_id_field].get_int64().get(target)) {
+            *c_error = "NDJSON rows must be objects with integer source and target IDs";
+            return;
+        }
+        edge_t edge {source, target};
+        if (c.edge_id_field && !object[c.edge_id_field].get_int64().get(id))
+            edge.id = id;
+        edges.push_back(edge);
+
+        if (edges.size() == ndjson_batch_edges_k) {
+            if ((*c_error = batcher.append(edges.data(), edges.size())))
+                return;
+            edges.clear();
+        }
+    }
+    *c_error = batcher.append(edges.data(), edges.size());
+}
+
+void import_graph(ukv_graph_import_t const& c) {
+
+    std::vector<std::string> parquet_paths, csv_paths, ndjson_paths;
+    for (std::string& path : matching_paths(c.paths_pattern)) {
+        auto extension = fs::path(path).extension();
+        if (extension == ".parquet")
+            parquet_paths.push_back(std::move(path));
+        else if (extension == ".csv")
+            csv_paths.push_back(std::move(path));
+        else if (extension == ".ndjson" || extension == ".jsonl")
+            ndjson_paths.push_back(std::move(path));
+    }
+
+    edges_batcher_t batcher {c};
+
+    // NDJSON files are parsed in the background, while Arrow reads the columnar ones
+    std::atomic_size_t next_ndjson {0};
+    std::size_t const threads_count = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<ukv_error_t> ndjson_errors(std::min(threads_count, ndjson_paths.size()), nullptr);
+    std::vector<std::thread> ndjson_threads;
+    for (ukv_error_t& error : ndjson_errors)
+        ndjson_threads.emplace_back([&, error_ptr = &error] {
+            for (std::size_t i = next_ndjson++; i < ndjson_paths.size() && !*error_ptr; i = next_ndjson++)
+                import_ndjson(c, ndjson_paths[i], batcher, error_ptr);
+        });
+
+    arrow::Status status;
+    if (!parquet_paths.empty())
+        status = import_arrow(c, parquet_paths, std::make_shared<ds::ParquetFileFormat>(), batcher);
+    if (status.ok() && !csv_paths.empty())
+        status = import_arrow(c, csv_paths, std::make_shared<ds::CsvFileFormat>(), batcher);
+
+    for (std::thread& thread : ndjson_threads)
+        thread.join();
+    ukv_error_t flush_error = batcher.finish();
+
+    if (flush_error)
+        *c.error = flush_error;
+    else if (!status.ok() && !status.IsCancelled())
+        *c.error = "Failed to read a columnar file";
+    else
+        for (ukv_error_t error : ndjson_errors)
+            if (error)
+                *c.error = error;
+}
+
+void ukv_graph_import(ukv_graph_import_t* c_ptr) {
+    ukv_graph_import_t& c = *c_ptr;
+    if (!c.paths_pattern || !c.source_id_field || !c.target_id_field) {
+        *c.error = "Paths pattern and vertex fields must be provided";
+        return;
+    }
+
+    try {
+        import_graph(c);
+    }
+    catch (std::regex_error const&) {
+        *c.error = "Invalid paths pattern";
+    }
+    catch (fs::filesystem_error const&) {
+        *c.error = "Failed to list the dataset files";
+    }
+    catch (std::bad_alloc const&) {
+        *c.error = "Failed to allocate memory";
+    }
+    catch (...) {
+        *c.error = "Failed to import the graph";
+    }
+}
+
+/**
+ * @brief Writes edges into a file in one of the supported formats, picked by extension.
+ */
+class edges_writer_t {
+    ukv_graph_export_t const& c_;
+    std::string extension_;
+    std::FILE* text_file_ = nullptr;
+    std::unique_ptr<parquet::StreamWriter> parquet_;
+
+  public:
+    edges_writer_t(ukv_graph_export_t const& c) : c_(c), extension_(c.paths_extension) {
+        std::string path = std::string(c.paths_prefix) + extension_;
+        if (extension_ == ".parquet") {
+            std::shared_ptr<arrow::io::FileOutputStream> out_file;
+            PARQUET_ASSIGN_OR_THROW(out_file, arrow::io::FileOutputStream::Open(path));
+
+            parquet::schema::NodeVector columns {};
+            for (ukv_str_view_t field : {c.source_id_field, c.target_id_field, c.edge_id_field})
+                if (field)
+                    columns.push_back(parquet::schema::PrimitiveNode::Make( //
+                        field,
+                        parquet::Repetition::REQUIRED,
+                        parquet::Type::INT64,
+                        parquet::ConvertedType::INT_64));
+            auto schema = std::static_pointer_cast<parquet::schema::GroupNode>(
+                parquet::schema::GroupNode::Make("schema", parquet::Repetition::REQUIRED, columns));
+            parquet::WriterProperties::Builder builder;
+            parquet_ = std::make_unique<parquet::StreamWriter>(
+                parquet::ParquetFileWriter::Open(out_file, schema, builder.build()));
+            // Row groups are only ended explicitly, once per batch
+            parquet_->SetMaxRowGroupSize(std::numeric_limits<std::int64_t>::max());
+        }
+        else if (extension_ == ".csv" || extension_ == ".ndjson") {
+            text_file_ = std::fopen(path.c_str(), "w");
+            if (!text_file_)
+                throw std::runtime_error("Can't open file");
+            if (extension_ == ".csv")
+                std::fprintf(text_file_,
+                             c.edge_id_field ? "%s,%s,%s\n" : "%s,%s\n",
+                             c.source_id_field,
+                             c.target_id_field,
+                             c.edge_id_field);
+        }
+        else
+            throw std::invalid_argument("Unsupported extension");
+    }
+    edges_writer_t(edges_writer_t const&) = delete;
+    ~edges_writer_t() {
+        if (text_file_)
+            std::fclose(text_file_);
+    }
+
+    void write(ukv_key_t source, ukv_key_t target, ukv_key_t edge) {
+        if (parquet_) {
+            *parquet_ << source << target;
+            if (c_.edge_id_field)
+                *parquet_ << edge;
+            *parquet_ << parquet::EndRow;
+        }
+        else if (extension_ == ".csv") {
+            if (c_.edge_id_field)
+                std::fprintf(text_file_, "%" PRId64 ",%" PRId64 ",%" PRId64 "\n", source, target, edge);
+            else
+                std::fprintf(text_file_, "%" PRId64 ",%" PRId64 "\n", source, target);
+        }
+        else {
+            std::fprintf(text_file_,
+                         "{\"%s\":%" PRId64 ",\"%s\":%" PRId64,
+                         c_.source_id_field,
+                         source,
+                         c_.target_id_field,
+                         target);
+            if (c_.edge_id_field)
+                std::fprintf(text_file_, ",\"%s\":%" PRId64, c_.edge_id_field, edge);
+            std::fputs("}\n", text_file_);
+        }
+    }
+
+    void end_batch() {
+        if (parquet_)
+            parquet_->EndRowGroup();
+        else
+            std::fflush(text_file_);
+    }
+};
+
+void export_graph(ukv_graph_export_t const& c, ukv_arena_t* arena) {
+
+    edges_writer_t writer {c};
+    std::size_t const batch_edges = std::max<std::size_t>(c.max_batch_size / sizeof(edge_t), 1);
+    std::size_t passed_edges = 0;
+    ukv_key_t start_key = std::numeric_limits<ukv_key_t>::min();
+    ukv_length_t const count_limit = export_batch_vertices_k;
+    ukv_vertex_role_t const role = ukv_vertex_source_k;
+
+    while (true) {
+        ukv_length_t* found_counts = nullptr;
+        ukv_key_t* found_keys = nullptr;
+        ukv_scan_t scan {
+            .db = c.db,
+            .error = c.error,
+            .arena = arena,
+            .options = c.options,
+            .tasks_count = 1,
+            .collections = &c.collection,
+            .start_keys = &start_key,
+            .count_limits = &count_limit,
+            .counts = &found_counts,
+            .keys = &found_keys,
+        };
+        ukv_scan(&scan);
+        if (*c.error || !found_counts[0])
+            break;
+
+        // Every edge is exported once, from its source
+        ukv_length_t const vertices_count = found_counts[0];
+        ukv_vertex_degree_t* degrees = nullptr;
+        ukv_key_t* ids = nullptr;
+        ukv_graph_find_edges_t find_edges {
+            .db = c.db,
+            .error = c.error,
+            .arena = arena,
+            .options = ukv_options_t(c.options | ukv_option_dont_discard_memory_k),
+            .tasks_count = vertices_count,
+            .collections = &c.collection,
+            .vertices = found_keys,
+            .vertices_stride = sizeof(ukv_key_t),
+            .roles = &role,
+            .degrees_per_vertex = &degrees,
+            .edges_per_vertex = &ids,
+        };
+        ukv_graph_find_edges(&find_edges);
+        if (*c.error)
+            break;
+
+        for (ukv_length_t i = 0; i != vertices_count; ++i) {
+            if (degrees[i] == ukv_vertex_degree_missing_k)
+                continue;
+            for (ukv_vertex_degree_t j = 0; j != degrees[i]; ++j, ids += 3)
+                writer.write(ids[0], ids[1], ids[2]);
+            passed_edges += degrees[i];
+            if (passed_edges < batch_edges)
+                continue;
+            writer.end_batch();
+            passed_edges = 0;
+            if (c.callback)
+                c.callback(c.callback_payload);
+        }
+
+        if (found_keys[vertices_count - 1] == std::numeric_limits<ukv_key_t>::max())
+            break;
+        start_key = found_keys[vertices_count - 1] + 1;
+    }
+
+    if (passed_edges)
+        writer.end_batch();
+    if (passed_edges && c.callback)
+        c.callback(c.callback_payload);
+}
+
+void ukv_graph_export(ukv_graph_export_t* c_ptr) {
+    ukv_graph_export_t& c = *c_ptr;
+    if (!c.paths_prefix || !c.paths_extension || !c.source_id_field || !c.target_id_field) {
+        *c.error = "Paths and vertex fields must be provided";
+        return;
+    }
+
+    ukv_arena_t owned_arena = nullptr;
+    try {
+        export_graph(c, c.arena ? c.arena : &owned_arena);
+    }
+    catch (std::invalid_argument const&) {
+        *c.error = "Only .parquet, .csv and .ndjson exports are supported";
+    }
+    catch (std::bad_alloc const&) {
+        *c.error = "Failed to allocate memory";
+    }
+    catch (...) {
+        *c.error = "Failed to export the graph";
+    }
+    ukv_arena_free(owned_arena);
+}
@@ -36,6 +36,7 @@ typedef struct ukv_graph_export_t {
     ukv_options_t options = ukv_options_default_k;
 
     ukv_collection_t collection = ukv_collection_main_k;
+    ukv_str_view_t paths_prefix = "graph";
     ukv_str_view_t paths_extension = ".parquet";
     ukv_size_t max_batch_size = 1024ul * 1024ul * 1024ul;
     ukv_callback_t callback = NULL;